@@ -1,7 +1,13 @@
 #include "AFISLikelihoodCalculator.h"
 #include "../core/MinutiaeTypes.h"
+#include <opencv2/core.hpp>
 #include <cmath>
 #include <algorithm>
+#include <cstdio>
+#include <random>
+
+// Log de depuração condicionado a config.verbose (desligado em lote, ex.: calibração)
+#define AFIS_LOG(...) do { if (config.verbose) fprintf(stderr, __VA_ARGS__); } while (0)
 
 AFISLikelihoodCalculator::AFISLikelihoodCalculator()
     : config(AFISLikelihoodConfig())
@@ -13,62 +19,86 @@ AFISLikelihoodCalculator::AFISLikelihoodCalculator(const AFISLikelihoodConfig& c
 {
 }
 
+void AFISLikelihoodCalculator::setCalibrationTable(const FingerprintEnhancer::ScoreCalibrationTable& table) {
+    if (table.isValid() && table.matcherSignature != calibrationSignature(config)) {
+        AFIS_LOG("[AFIS-LR] Tabela de calibração ignorada (assinatura %s, esperado %s)\n",
+                 table.matcherSignature.toStdString().c_str(),
+                 calibrationSignature(config).toStdString().c_str());
+        calibration = FingerprintEnhancer::ScoreCalibrationTable();
+        return;
+    }
+    calibration = table;
+}
+
+QString AFISLikelihoodCalculator::calibrationSignature(const AFISLikelihoodConfig& cfg) {
+    // Tolerâncias quantizadas (1 px, 0,1°): tabelas calibradas com outras tolerâncias não se aplicam
+    const QString angle = cfg.angleTolerance >= CV_PI - 1e-6
+        ? QString("off") : QString::number(cfg.angleTolerance * 180.0 / CV_PI, 'f', 1);
+    return QString("afis-likelihood-v2;type=%1;quality=%2;pos=%3;angle=%4")
+        .arg(cfg.useTypeWeighting ? 1 : 0)
+        .arg(cfg.useQualityWeighting ? 1 : 0)
+        .arg(qRound(cfg.positionTolerance))
+        .arg(angle);
+}
+
 QVector<QPair<int, int>> AFISLikelihoodCalculator::findCorrespondences(
     const QVector<FingerprintEnhancer::Minutia>& minutiae1,
-    const QVector<FingerprintEnhancer::Minutia>& minutiae2) const {
+    const QVector<FingerprintEnhancer::Minutia>& minutiae2,
+    quint32 seed) const {
     
     GeometricTransform transform;
-    return findCorrespondencesWithAlignment(minutiae1, minutiae2, transform);
+    return findCorrespondencesWithAlignment(minutiae1, minutiae2, transform, seed);
 }
 
 QVector<QPair<int, int>> AFISLikelihoodCalculator::findCorrespondencesWithAlignment(
     const QVector<FingerprintEnhancer::Minutia>& minutiae1,
     const QVector<FingerprintEnhancer::Minutia>& minutiae2,
-    GeometricTransform& transform) const {
-    
-    fprintf(stderr, "\n[AFIS-LR] ========== INÍCIO DO MATCHING COM ALINHAMENTO ==========\n");
-    fprintf(stderr, "[AFIS-LR] Minúcias fragmento 1: %d\n", static_cast<int>(minutiae1.size()));
-    fprintf(stderr, "[AFIS-LR] Minúcias fragmento 2: %d\n", static_cast<int>(minutiae2.size()));
-    fprintf(stderr, "[AFIS-LR] Tolerância posição: %.1f pixels\n", config.positionTolerance);
-    fprintf(stderr, "[AFIS-LR] Tolerância ângulo: %.3f radianos (%.1f graus)\n", 
+    GeometricTransform& transform,
+    quint32 seed) const {
+    
+    AFIS_LOG("\n[AFIS-LR] ========== INÍCIO DO MATCHING COM ALINHAMENTO ==========\n");
+    AFIS_LOG("[AFIS-LR] Minúcias fragmento 1: %d\n", static_cast<int>(minutiae1.size()));
+    AFIS_LOG("[AFIS-LR] Minúcias fragmento 2: %d\n", static_cast<int>(minutiae2.size()));
+    AFIS_LOG("[AFIS-LR] Tolerância posição: %.1f pixels\n", config.positionTolerance);
+    AFIS_LOG("[AFIS-LR] Tolerância ângulo: %.3f radianos (%.1f graus)\n", 
             config.angleTolerance, config.angleTolerance * 180.0 / M_PI);
-    fprintf(stderr, "[AFIS-LR] Score mínimo: %.2f\n", config.minMatchScore);
+    AFIS_LOG("[AFIS-LR] Score mínimo: %.2f\n", config.minMatchScore);
     
     // DEBUG: Mostrar amostra de minúcias
     if (!minutiae1.isEmpty()) {
-        fprintf(stderr, "[AFIS-LR] DEBUG Amostra Fragmento 1:\n");
+        AFIS_LOG("[AFIS-LR] DEBUG Amostra Fragmento 1:\n");
         for (int i = 0; i < qMin(3, minutiae1.size()); i++) {
-            fprintf(stderr, "[AFIS-LR]   [%d] pos=(%d,%d), angle=%.3f rad, type=%d, quality=%.2f\n",
+            AFIS_LOG("[AFIS-LR]   [%d] pos=(%d,%d), angle=%.3f rad, type=%d, quality=%.2f\n",
                     i, minutiae1[i].position.x(), minutiae1[i].position.y(),
                     minutiae1[i].angle, static_cast<int>(minutiae1[i].type), minutiae1[i].quality);
         }
     }
     if (!minutiae2.isEmpty()) {
-        fprintf(stderr, "[AFIS-LR] DEBUG Amostra Fragmento 2:\n");
+        AFIS_LOG("[AFIS-LR] DEBUG Amostra Fragmento 2:\n");
         for (int i = 0; i < qMin(3, minutiae2.size()); i++) {
-            fprintf(stderr, "[AFIS-LR]   [%d] pos=(%d,%d), angle=%.3f rad, type=%d, quality=%.2f\n",
+            AFIS_LOG("[AFIS-LR]   [%d] pos=(%d,%d), angle=%.3f rad, type=%d, quality=%.2f\n",
                     i, minutiae2[i].position.x(), minutiae2[i].position.y(),
                     minutiae2[i].angle, static_cast<int>(minutiae2[i].type), minutiae2[i].quality);
         }
     }
     
     // PASSO 1: Estimar transformação geométrica (rotação + translação)
-    transform = estimateTransform(minutiae1, minutiae2);
+    transform = estimateTransform(minutiae1, minutiae2, seed);
     
-    fprintf(stderr, "[AFIS-LR] Transformação estimada:\n");
-    fprintf(stderr, "[AFIS-LR]   - Escala: %.3f\n", transform.scale);
-    fprintf(stderr, "[AFIS-LR]   - Rotação: %.3f rad (%.1f°)\n", 
+    AFIS_LOG("[AFIS-LR] Transformação estimada:\n");
+    AFIS_LOG("[AFIS-LR]   - Escala: %.3f\n", transform.scale);
+    AFIS_LOG("[AFIS-LR]   - Rotação: %.3f rad (%.1f°)\n", 
             transform.rotation, transform.rotation * 180.0 / M_PI);
-    fprintf(stderr, "[AFIS-LR]   - Translação: (%.1f, %.1f)\n", 
+    AFIS_LOG("[AFIS-LR]   - Translação: (%.1f, %.1f)\n", 
             transform.translation.x(), transform.translation.y());
-    fprintf(stderr, "[AFIS-LR]   - Confiança: %.3f\n", transform.confidence);
+    AFIS_LOG("[AFIS-LR]   - Confiança: %.3f\n", transform.confidence);
     
     // PASSO 2: Encontrar correspondências aplicando a transformação
     QVector<QPair<int, int>> correspondences;
     
     // Validação defensiva de tamanhos
     if (minutiae1.isEmpty() || minutiae2.isEmpty()) {
-        fprintf(stderr, "[AFIS-LR] AVISO: Um dos vetores está vazio (size1=%d, size2=%d)\n",
+        AFIS_LOG("[AFIS-LR] AVISO: Um dos vetores está vazio (size1=%d, size2=%d)\n",
                 static_cast<int>(minutiae1.size()), static_cast<int>(minutiae2.size()));
         return correspondences;
     }
@@ -78,7 +108,7 @@ QVector<QPair<int, int>> AFISLikelihoodCalculator::findCorrespondencesWithAlignm
     for (int i = 0; i < minutiae1.size(); i++) {
         // Validação adicional dentro do loop
         if (i < 0 || i >= minutiae1.size()) {
-            fprintf(stderr, "[AFIS-LR] ERRO CRÍTICO: índice i=%d fora do range [0,%d)\n",
+            AFIS_LOG("[AFIS-LR] ERRO CRÍTICO: índice i=%d fora do range [0,%d)\n",
                     i, static_cast<int>(minutiae1.size()));
             break;
         }
@@ -89,7 +119,7 @@ QVector<QPair<int, int>> AFISLikelihoodCalculator::findCorrespondencesWithAlignm
         QPointF transformed1 = applyTransform(minutiae1[i].position, transform);
         double transformedAngle1 = applyRotationToAngle(minutiae1[i].angle, transform);
         
-        fprintf(stderr, "\n[AFIS-LR] Minúcia 1[%d]: pos=(%d,%d) → escala×%.2f+rot+trans → (%.1f,%.1f), ângulo=%.2f→%.2f rad, tipo=%d\n",
+        AFIS_LOG("\n[AFIS-LR] Minúcia 1[%d]: pos=(%d,%d) → escala×%.2f+rot+trans → (%.1f,%.1f), ângulo=%.2f→%.2f rad, tipo=%d\n",
                 i, minutiae1[i].position.x(), minutiae1[i].position.y(),
                 transform.scale,
                 transformed1.x(), transformed1.y(),
@@ -99,7 +129,7 @@ QVector<QPair<int, int>> AFISLikelihoodCalculator::findCorrespondencesWithAlignm
         for (int j = 0; j < minutiae2.size(); j++) {
             // Validação tripla antes de qualquer acesso
             if (j < 0 || j >= minutiae2.size() || j >= matched2.size()) {
-                fprintf(stderr, "[AFIS-LR] ERRO: índice j=%d inválido (minutiae2.size=%d, matched2.size=%d)\n",
+                AFIS_LOG("[AFIS-LR] ERRO: índice j=%d inválido (minutiae2.size=%d, matched2.size=%d)\n",
                         j, static_cast<int>(minutiae2.size()), static_cast<int>(matched2.size()));
                 break;
             }
@@ -138,7 +168,7 @@ QVector<QPair<int, int>> AFISLikelihoodCalculator::findCorrespondencesWithAlignm
                 
                 double score = distScore * wDist + angleScore * wAngle + typeScore * wType;
                 
-                fprintf(stderr, "  [AFIS-LR]   Candidato 2[%d]: dist=%.1f, angDiff=%.3f, score=%.3f\n",
+                AFIS_LOG("  [AFIS-LR]   Candidato 2[%d]: dist=%.1f, angDiff=%.3f, score=%.3f\n",
                         j, dist, angleDiff, score);
                 
                 if (score > bestScore) {
@@ -153,18 +183,18 @@ QVector<QPair<int, int>> AFISLikelihoodCalculator::findCorrespondencesWithAlignm
             if (bestMatch >= 0 && bestMatch < minutiae2.size() && bestMatch < matched2.size()) {
                 correspondences.append(qMakePair(i, bestMatch));
                 matched2[bestMatch] = true;
-                fprintf(stderr, "  [AFIS-LR] ✓ MATCH: 1[%d] ↔ 2[%d], score=%.3f\n", i, bestMatch, bestScore);
+                AFIS_LOG("  [AFIS-LR] ✓ MATCH: 1[%d] ↔ 2[%d], score=%.3f\n", i, bestMatch, bestScore);
             } else {
-                fprintf(stderr, "  [AFIS-LR] ERRO: Índice bestMatch=%d fora do range (size=%d)\n", 
+                AFIS_LOG("  [AFIS-LR] ERRO: Índice bestMatch=%d fora do range (size=%d)\n", 
                         bestMatch, static_cast<int>(minutiae2.size()));
             }
         } else {
-            fprintf(stderr, "  [AFIS-LR] ✗ SEM MATCH (candidatos=%d, bestScore=%.3f)\n", candidates, bestScore);
+            AFIS_LOG("  [AFIS-LR] ✗ SEM MATCH (candidatos=%d, bestScore=%.3f)\n", candidates, bestScore);
         }
     }
     
-    fprintf(stderr, "\n[AFIS-LR] TOTAL DE CORRESPONDÊNCIAS: %d\n", static_cast<int>(correspondences.size()));
-    fprintf(stderr, "[AFIS-LR] ========== FIM DO MATCHING ==========\n\n");
+    AFIS_LOG("\n[AFIS-LR] TOTAL DE CORRESPONDÊNCIAS: %d\n", static_cast<int>(correspondences.size()));
+    AFIS_LOG("[AFIS-LR] ========== FIM DO MATCHING ==========\n\n");
     
     return correspondences;
 }
@@ -215,7 +245,7 @@ double AFISLikelihoodCalculator::calculateLikelihoodRatio(
     const QVector<FingerprintEnhancer::Minutia>& minutiae2,
     const QVector<QPair<int, int>>& correspondences) const {
     
-    fprintf(stderr, "\n[AFIS-LR] ========== CÁLCULO DE LIKELIHOOD RATIO ==========\n");
+    AFIS_LOG("\n[AFIS-LR] ========== CÁLCULO DE LIKELIHOOD RATIO ==========\n");
     
     // ==================================================================================
     // TODO: Implementar cálculo completo baseado em Neumann et al. (2007, 2012)
@@ -239,11 +269,22 @@ double AFISLikelihoodCalculator::calculateLikelihoodRatio(
     
     int n = correspondences.size();  // Número de correspondências
     
-    fprintf(stderr, "[AFIS-LR] Número de correspondências: %d\n", n);
+    AFIS_LOG("[AFIS-LR] Número de correspondências: %d\n", n);
+    
+    // ==================== LR CALIBRADO (TABELA) ====================
+    if (calibration.isValid()) {
+        double score = calculateSimilarityScore(minutiae1, minutiae2, correspondences);
+        double LR = calibration.lookupLR(score);
+        AFIS_LOG("[AFIS-LR] LR calibrado (%s, %d gen./%d imp.): score=%.4f → LR=%.2e\n",
+                 calibration.method == FingerprintEnhancer::CalibrationMethod::PAV ? "PAV" : "KDE",
+                 calibration.genuineCount, calibration.impostorCount, score, LR);
+        AFIS_LOG("[AFIS-LR] ========================================\n\n");
+        return LR;
+    }
     
     if (n == 0) {
-        fprintf(stderr, "[AFIS-LR] Nenhuma correspondência - LR = 1e-10\n");
-        fprintf(stderr, "[AFIS-LR] ========================================\n\n");
+        AFIS_LOG("[AFIS-LR] Nenhuma correspondência - LR = 1e-10\n");
+        AFIS_LOG("[AFIS-LR] ========================================\n\n");
         return 1e-10;  // LR muito baixo (forte evidência de não-match)
     }
     
@@ -256,7 +297,7 @@ double AFISLikelihoodCalculator::calculateLikelihoodRatio(
     double exponent = n * 2.5;  // Cada correspondência multiplica por ~10^2.5
     
     double LR = pow(baseLR, exponent);
-    fprintf(stderr, "[AFIS-LR] LR base (10^(2.5*%d)): %.2e\n", n, LR);
+    AFIS_LOG("[AFIS-LR] LR base (10^(2.5*%d)): %.2e\n", n, LR);
     
     // ==================== FATOR DE COMPLETUDE ====================
     // Penalizar se muitas minúcias não foram pareadas
@@ -265,9 +306,9 @@ double AFISLikelihoodCalculator::calculateLikelihoodRatio(
     double completeness = 1.0;
     if (minTotal > 0) {
         completeness = static_cast<double>(n) / static_cast<double>(minTotal);
-        fprintf(stderr, "[AFIS-LR] Fator de completude (%d/%d): %.3f\n", n, minTotal, completeness);
+        AFIS_LOG("[AFIS-LR] Fator de completude (%d/%d): %.3f\n", n, minTotal, completeness);
         LR *= completeness;
-        fprintf(stderr, "[AFIS-LR] LR após completude: %.2e\n", LR);
+        AFIS_LOG("[AFIS-LR] LR após completude: %.2e\n", LR);
     }
     
     // ==================== FATOR DE QUALIDADE ====================
@@ -280,7 +321,7 @@ double AFISLikelihoodCalculator::calculateLikelihoodRatio(
             // Validar índices antes de acessar
             if (pair.first < 0 || pair.first >= minutiae1.size() ||
                 pair.second < 0 || pair.second >= minutiae2.size()) {
-                fprintf(stderr, "[AFIS-LR] ERRO: Índice inválido pair[%d,%d] (tamanhos: %d,%d)\n",
+                AFIS_LOG("[AFIS-LR] ERRO: Índice inválido pair[%d,%d] (tamanhos: %d,%d)\n",
                         pair.first, pair.second, static_cast<int>(minutiae1.size()), static_cast<int>(minutiae2.size()));
                 continue;
             }
@@ -290,21 +331,21 @@ double AFISLikelihoodCalculator::calculateLikelihoodRatio(
             double pairQuality = (m1.quality + m2.quality) / 2.0;
             avgQuality += pairQuality;
             validPairs++;
-            fprintf(stderr, "[AFIS-LR]   Par[%d,%d]: quality campo=%.2f\n", pair.first, pair.second, pairQuality);
+            AFIS_LOG("[AFIS-LR]   Par[%d,%d]: quality campo=%.2f\n", pair.first, pair.second, pairQuality);
         }
         
         if (validPairs == 0) {
-            fprintf(stderr, "[AFIS-LR] AVISO: Nenhum par válido para calcular qualidade\n");
+            AFIS_LOG("[AFIS-LR] AVISO: Nenhum par válido para calcular qualidade\n");
         } else {
             avgQuality /= validPairs;
         }
         
-        fprintf(stderr, "[AFIS-LR] Qualidade média (campo das minúcias): %.3f\n", avgQuality);
+        AFIS_LOG("[AFIS-LR] Qualidade média (campo das minúcias): %.3f\n", avgQuality);
         
         // Se qualidade média é razoável, usar como multiplicador
         if (avgQuality > 0.01) {
             LR *= avgQuality;
-            fprintf(stderr, "[AFIS-LR] LR após qualidade: %.2e\n", LR);
+            AFIS_LOG("[AFIS-LR] LR após qualidade: %.2e\n", LR);
         }
     }
     
@@ -312,8 +353,8 @@ double AFISLikelihoodCalculator::calculateLikelihoodRatio(
     if (LR > 1e15) LR = 1e15;  // Evitar overflow
     if (LR < 1e-15) LR = 1e-15;
     
-    fprintf(stderr, "[AFIS-LR] LR FINAL: %.2e (log10 = %.2f)\n", LR, log10(LR));
-    fprintf(stderr, "[AFIS-LR] ========================================\n\n");
+    AFIS_LOG("[AFIS-LR] LR FINAL: %.2e (log10 = %.2f)\n", LR, log10(LR));
+    AFIS_LOG("[AFIS-LR] ========================================\n\n");
     
     return LR;
 }
@@ -358,7 +399,7 @@ double AFISLikelihoodCalculator::calculateSimilarityScore(
     double similarityContribution = avgLocalSimilarity * 0.3;
     double finalScore = completenessContribution + similarityContribution;
     
-    fprintf(stderr, "[AFIS-SIMILARITY] Completude: %.2f%% (contribui %.2f%%), Similaridade média dos pares: %.2f%% (contribui %.2f%%), Score final: %.2f%%\n",
+    AFIS_LOG("[AFIS-SIMILARITY] Completude: %.2f%% (contribui %.2f%%), Similaridade média dos pares: %.2f%% (contribui %.2f%%), Score final: %.2f%%\n",
             completeness * 100, completenessContribution * 100, avgLocalSimilarity * 100, similarityContribution * 100, finalScore * 100);
     
     return finalScore;
@@ -444,18 +485,19 @@ double AFISLikelihoodCalculator::getTypeWeight(MinutiaeType type) const {
 
 AFISLikelihoodCalculator::GeometricTransform AFISLikelihoodCalculator::estimateTransform(
     const QVector<FingerprintEnhancer::Minutia>& minutiae1,
-    const QVector<FingerprintEnhancer::Minutia>& minutiae2) const {
+    const QVector<FingerprintEnhancer::Minutia>& minutiae2,
+    quint32 seed) const {
     
-    fprintf(stderr, "\n[AFIS-TRANSFORM] Estimando transformação geométrica (com escala)...\n");
+    AFIS_LOG("\n[AFIS-TRANSFORM] Estimando transformação geométrica (com escala)...\n");
     if (config.scaleHint > 0.5 && config.scaleHint < 2.0) {
-        fprintf(stderr, "[AFIS-TRANSFORM] Hint de escala: %.3f (esperado)\n", config.scaleHint);
+        AFIS_LOG("[AFIS-TRANSFORM] Hint de escala: %.3f (esperado)\n", config.scaleHint);
     }
     
     GeometricTransform bestTransform;
     int bestMatchCount = 0;
     
     if (minutiae1.size() < 2 || minutiae2.size() < 2) {
-        fprintf(stderr, "[AFIS-TRANSFORM] Minúcias insuficientes para estimativa\n");
+        AFIS_LOG("[AFIS-TRANSFORM] Minúcias insuficientes para estimativa\n");
         return bestTransform;
     }
     
@@ -464,31 +506,36 @@ AFISLikelihoodCalculator::GeometricTransform AFISLikelihoodCalculator::estimateT
     // Aumentar iterações para melhor convergência
     int maxIterations = qMin(300, minutiae1.size() * minutiae2.size() * 2);
     
+    // Gerador local: a calibração chama isto de várias threads ao mesmo tempo
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> pick1(0, minutiae1.size() - 1);
+    std::uniform_int_distribution<int> pick2(0, minutiae2.size() - 1);
+    
     for (int iter = 0; iter < maxIterations; iter++) {
         // Revalidar tamanhos a cada iteração (pode ter mudado?)
         if (minutiae1.size() < 2 || minutiae2.size() < 2) {
-            fprintf(stderr, "[AFIS-TRANSFORM] Tamanhos mudaram durante RANSAC: m1=%d, m2=%d\n",
+            AFIS_LOG("[AFIS-TRANSFORM] Tamanhos mudaram durante RANSAC: m1=%d, m2=%d\n",
                     static_cast<int>(minutiae1.size()), static_cast<int>(minutiae2.size()));
             break;
         }
         
         // Selecionar DOIS pares de minúcias aleatórios
-        int idx1a = rand() % minutiae1.size();
-        int idx1b = rand() % minutiae1.size();
+        int idx1a = pick1(rng);
+        int idx1b = pick1(rng);
         int maxAttempts = 10;
-        while (idx1b == idx1a && maxAttempts-- > 0) idx1b = rand() % minutiae1.size();
+        while (idx1b == idx1a && maxAttempts-- > 0) idx1b = pick1(rng);
         
-        int idx2a = rand() % minutiae2.size();
-        int idx2b = rand() % minutiae2.size();
+        int idx2a = pick2(rng);
+        int idx2b = pick2(rng);
         maxAttempts = 10;
-        while (idx2b == idx2a && maxAttempts-- > 0) idx2b = rand() % minutiae2.size();
+        while (idx2b == idx2a && maxAttempts-- > 0) idx2b = pick2(rng);
         
         // Validar índices antes de acessar
         if (idx1a < 0 || idx1a >= minutiae1.size() ||
             idx1b < 0 || idx1b >= minutiae1.size() ||
             idx2a < 0 || idx2a >= minutiae2.size() ||
             idx2b < 0 || idx2b >= minutiae2.size()) {
-            fprintf(stderr, "[AFIS-TRANSFORM] ERRO: Índice inválido gerado\n");
+            AFIS_LOG("[AFIS-TRANSFORM] ERRO: Índice inválido gerado\n");
             continue;
         }
         
@@ -550,7 +597,7 @@ AFISLikelihoodCalculator::GeometricTransform AFISLikelihoodCalculator::estimateT
             bestMatchCount = matchCount;
             bestTransform = candidate;
             
-            fprintf(stderr, "[AFIS-TRANSFORM] Iter %d: scale=%.3f, rot=%.2f°, trans=(%.1f,%.1f), matches=%d\n",
+            AFIS_LOG("[AFIS-TRANSFORM] Iter %d: scale=%.3f, rot=%.2f°, trans=(%.1f,%.1f), matches=%d\n",
                     iter, candidate.scale, candidate.rotation * 180.0 / M_PI,
                     candidate.translation.x(), candidate.translation.y(),
                     matchCount);
@@ -562,12 +609,12 @@ AFISLikelihoodCalculator::GeometricTransform AFISLikelihoodCalculator::estimateT
     bestTransform.confidence = (minCount > 0) ? 
         static_cast<double>(bestMatchCount) / static_cast<double>(minCount) : 0.0;
     
-    fprintf(stderr, "[AFIS-TRANSFORM] Melhor transformação: %d matches (confiança=%.2f)\n",
+    AFIS_LOG("[AFIS-TRANSFORM] Melhor transformação: %d matches (confiança=%.2f)\n",
             bestMatchCount, bestTransform.confidence);
-    fprintf(stderr, "[AFIS-TRANSFORM]   Escala: %.3f (frag2/frag1)\n", bestTransform.scale);
-    fprintf(stderr, "[AFIS-TRANSFORM]   Rotação: %.3f rad (%.1f°)\n", 
+    AFIS_LOG("[AFIS-TRANSFORM]   Escala: %.3f (frag2/frag1)\n", bestTransform.scale);
+    AFIS_LOG("[AFIS-TRANSFORM]   Rotação: %.3f rad (%.1f°)\n", 
             bestTransform.rotation, bestTransform.rotation * 180.0 / M_PI);
-    fprintf(stderr, "[AFIS-TRANSFORM]   Translação: (%.1f, %.1f)\n",
+    AFIS_LOG("[AFIS-TRANSFORM]   Translação: (%.1f, %.1f)\n",
             bestTransform.translation.x(), bestTransform.translation.y());
     
     return bestTransform;
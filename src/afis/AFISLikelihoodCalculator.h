@@ -4,6 +4,7 @@
 #include <QVector>
 #include <QPair>
 #include "../core/ProjectModel.h"
+#include "ScoreCalibrationTable.h"
 
 namespace FingerprintEnhancer {
     class Minutia;
@@ -19,6 +20,7 @@ struct AFISLikelihoodConfig {
     bool useTypeWeighting;          // Usar peso de tipo de minúcia (padrão: false)
     bool useQualityWeighting;       // Usar peso de qualidade (padrão: false)
     double scaleHint;               // Hint de escala esperada (padrão: 1.0 = mesma escala)
+    bool verbose;                   // Log detalhado em stderr (padrão: true)
     
     AFISLikelihoodConfig()
         : positionTolerance(120.0),
@@ -26,7 +28,8 @@ struct AFISLikelihoodConfig {
           minMatchScore(0.0),
           useTypeWeighting(false),
           useQualityWeighting(false),
-          scaleHint(1.0) {}
+          scaleHint(1.0),
+          verbose(true) {}
 };
 
 /**
@@ -64,6 +67,18 @@ public:
     void setConfig(const AFISLikelihoodConfig& config) { this->config = config; }
     AFISLikelihoodConfig getConfig() const { return config; }
     
+    /**
+     * @brief Define a tabela de calibração score → LR
+     * Tabelas geradas com outra assinatura de matcher são ignoradas.
+     */
+    void setCalibrationTable(const FingerprintEnhancer::ScoreCalibrationTable& table);
+    bool hasCalibration() const { return calibration.isValid(); }
+    
+    /**
+     * @brief Assinatura do matcher (versão, opções e tolerâncias que alteram o score)
+     */
+    static QString calibrationSignature(const AFISLikelihoodConfig& config);
+    
     // ==================== FUNÇÕES PRINCIPAIS ====================
     
     /**
@@ -83,23 +98,27 @@ public:
      * Usa algoritmo de alinhamento espacial considerando rotação/translação
      * @param minutiae1 Conjunto de minúcias 1
      * @param minutiae2 Conjunto de minúcias 2
+     * @param seed Semente do RANSAC (ex.: índice do par); mesma semente, mesmo resultado
      * @return Vetor de pares (índice em minutiae1, índice em minutiae2)
      */
     QVector<QPair<int, int>> findCorrespondences(
         const QVector<FingerprintEnhancer::Minutia>& minutiae1,
-        const QVector<FingerprintEnhancer::Minutia>& minutiae2) const;
+        const QVector<FingerprintEnhancer::Minutia>& minutiae2,
+        quint32 seed = 0) const;
     
     /**
      * @brief Encontra correspondências COM estimativa de transformação geométrica
      * @param minutiae1 Conjunto de minúcias 1
      * @param minutiae2 Conjunto de minúcias 2
      * @param transform [out] Transformação estimada
+     * @param seed Semente do RANSAC
      * @return Vetor de pares (índice em minutiae1, índice em minutiae2)
      */
     QVector<QPair<int, int>> findCorrespondencesWithAlignment(
         const QVector<FingerprintEnhancer::Minutia>& minutiae1,
         const QVector<FingerprintEnhancer::Minutia>& minutiae2,
-        GeometricTransform& transform) const;
+        GeometricTransform& transform,
+        quint32 seed = 0) const;
     
     /**
      * @brief Calcula score de similaridade local entre duas minúcias
@@ -118,8 +137,9 @@ public:
      * @param correspondences Correspondências encontradas
      * @return Likelihood Ratio (LR)
      * 
-     * Implementação atual usa aproximação simples baseada em número de correspondências.
-     * TODO: Implementar cálculo completo baseado em Neumann et al. (2007, 2012)
+     * Com tabela de calibração carregada, o LR é a consulta O(log n) do score de
+     * similaridade na tabela construída a partir de um corpus genuíno/impostor.
+     * Sem tabela, usa a aproximação simples baseada em número de correspondências.
      */
     double calculateLikelihoodRatio(
         const QVector<FingerprintEnhancer::Minutia>& minutiae1,
@@ -147,6 +167,7 @@ public:
     
 private:
     AFISLikelihoodConfig config;
+    FingerprintEnhancer::ScoreCalibrationTable calibration;
     
     // ==================== FUNÇÕES AUXILIARES ====================
     
@@ -172,10 +193,14 @@ private:
     /**
      * @brief Estima transformação geométrica entre dois conjuntos de minúcias
      * usando RANSAC com pares de minúcias como hipóteses
+     *
+     * O gerador é local à chamada (std::mt19937 com a semente dada): seguro
+     * em threads de trabalho e reproduzível, ao contrário de rand().
      */
     GeometricTransform estimateTransform(
         const QVector<FingerprintEnhancer::Minutia>& minutiae1,
-        const QVector<FingerprintEnhancer::Minutia>& minutiae2) const;
+        const QVector<FingerprintEnhancer::Minutia>& minutiae2,
+        quint32 seed) const;
     
     /**
      * @brief Aplica transformação a um ponto
@@ -1,8 +1,14 @@
 #include "AFISMatcher.h"
-#include "../core/MinutiaeExtractor.h"
 #include "../core/ImageProcessor.h"
+#include "../core/Thinning.h"
+#include "../core/CrossingNumber.h"
+#include "../core/FalseMinutiaeFilter.h"
+#include "../core/RidgeSegmentation.h"
+#include "../core/RidgeQuality.h"
+#include "../core/ResolutionPyramid.h"
 #include <QDir>
 #include <QFileInfo>
+#include <QDebug>
 #include <QtConcurrent>
 #include <cmath>
 #include <algorithm>
@@ -122,9 +128,10 @@ QVector<AFISMatchResult> AFISMatcher::identifyFingerprint(
 
 QVector<AFISMatchResult> AFISMatcher::identifyFingerprintFromImage(
     const cv::Mat& queryImage,
-    int maxResults) {
+    int maxResults,
+    double pixelsPerMM) {
 
-    QVector<MinutiaeData> queryMinutiae = extractMinutiaeFromImage(queryImage);
+    QVector<MinutiaeData> queryMinutiae = extractMinutiaeFromImage(queryImage, pixelsPerMM);
     return identifyFingerprint(queryMinutiae, maxResults);
 }
 
@@ -330,7 +337,7 @@ double AFISMatcher::computeFinalScore(
     return std::max(0.0, std::min(1.0, score));
 }
 
-QVector<MinutiaeData> AFISMatcher::extractMinutiaeFromImage(const cv::Mat& image) {
+QVector<MinutiaeData> AFISMatcher::extractMinutiaeFromImage(const cv::Mat& image, double pixelsPerMM) {
     QVector<MinutiaeData> minutiae;
 
     if (image.empty()) {
@@ -345,38 +352,85 @@ QVector<MinutiaeData> AFISMatcher::extractMinutiaeFromImage(const cv::Mat& image
         processed = image.clone();
     }
 
-    // Aplicar enhancement básico
-    cv::equalizeHist(processed, processed);
+    // Digitalizações acima de 500 ppi: extrair na resolução canônica em que
+    // segmentação, qualidade e limiares foram calibrados
+    const double scale = ResolutionPyramid::canonicalScale(pixelsPerMM);
+    processed = ResolutionPyramid::downscale(processed, scale);
+
+    // Histograma da imagem inteira: o realce não depende do recorte
+    cv::Mat equalized;
+    cv::equalizeHist(processed, equalized);
+
+    // Área da impressão (opcional): processar só o envoltório e descartar minúcias no fundo
+    RidgeMask print;
+    cv::Rect region(0, 0, processed.cols, processed.rows);
+    if (config.restrictToPrint) {
+        print = RidgeSegmentation::compute(processed);
+        if (print.isValid() && !print.boundingBox.empty()) {
+            region = print.boundingBox;
+        } else {
+            print = RidgeMask();
+        }
+    }
+    processed = processed(region).clone();
+    equalized = equalized(region);
+
+    // Campo das cristas no recorte: qualidade local e período para o pós-processamento
+    RidgeField field;
+    if (config.useQualityMap || config.removeFalseMinutiae) {
+        field = RidgeGeometry::compute(processed);
+    }
+
+    // Qualidade local no recorte: minúcias em blocos ruins não entram no template
+    QualityMap quality;
+    if (config.useQualityMap) {
+        quality = RidgeQuality::compute(processed, field,
+                                        print.isValid() ? print.blocksIn(region) : cv::Mat());
+    }
 
     // Binarizar
-    cv::threshold(processed, processed, 128, 255, cv::THRESH_BINARY);
-
-    // Esqueletizar (morfologia)
-    cv::Mat skeleton = cv::Mat::zeros(processed.size(), CV_8UC1);
-    cv::Mat element = cv::getStructuringElement(cv::MORPH_CROSS, cv::Size(3, 3));
-    cv::Mat temp;
-    cv::Mat eroded;
-
-    bool done = false;
-    while (!done) {
-        cv::erode(processed, eroded, element);
-        cv::dilate(eroded, temp, element);
-        cv::subtract(processed, temp, temp);
-        cv::bitwise_or(skeleton, temp, skeleton);
-        eroded.copyTo(processed);
-        done = (cv::countNonZero(processed) == 0);
+    cv::threshold(equalized, processed, 128, 255, cv::THRESH_BINARY);
+
+    // Esqueletizar (afinamento com esqueleto de um pixel)
+    cv::Mat skeleton = Thinning::thin(processed);
+
+    // Extrair minúcias (número de cruzamentos por tabela, em faixas paralelas)
+    std::vector<SkeletonMinutia> extractedMinutiae = CrossingNumber::extract(skeleton);
+
+    // Falsas minúcias (borda, esporas, cristas interrompidas, pontes): templates menores
+    if (config.removeFalseMinutiae) {
+        FalseMinutiaeConfig filterConfig;
+        filterConfig.ridgePeriod = FalseMinutiaeFilter::ridgePeriod(field);
+        FalseMinutiaeStats stats;
+        const int raw = static_cast<int>(extractedMinutiae.size());
+        extractedMinutiae = FalseMinutiaeFilter::apply(extractedMinutiae, skeleton,
+                                                       print.isValid() ? print.pixelMask()(region) : cv::Mat(),
+                                                       filterConfig, &stats);
+        qDebug() << QString("[AFIS] %1 de %2 minúcias removidas (borda %3, esporas %4, fragmentos %5, pares %6; período %7 px)")
+                    .arg(stats.removed()).arg(raw).arg(stats.border).arg(stats.spurs)
+                    .arg(stats.shortRidges).arg(stats.pairs).arg(filterConfig.ridgePeriod, 0, 'f', 1);
     }
 
-    // Extrair minúcias
-    MinutiaeExtractor extractor;
-    std::vector<Minutia> extractedMinutiae = extractor.extractMinutiae(skeleton);
+    // Converter para MinutiaeData (coordenadas de volta à imagem inteira, na resolução nativa)
+    int discarded = 0;
+    for (SkeletonMinutia m : extractedMinutiae) {
+        const float blockQuality = quality.isValid()
+            ? quality.qualityAt(static_cast<int>(m.position.x), static_cast<int>(m.position.y)) : 1.0f;
+        if (blockQuality < config.minBlockQuality) {
+            ++discarded;
+            continue;
+        }
+
+        m.position.x += region.x;
+        m.position.y += region.y;
+        if (print.isValid() && !print.contains(static_cast<int>(m.position.x), static_cast<int>(m.position.y))) {
+            continue;
+        }
 
-    // Converter para MinutiaeData
-    for (const auto& m : extractedMinutiae) {
         MinutiaeData data;
-        data.position = m.position;
+        data.position = ResolutionPyramid::toNative(m.position, scale);
         data.angle = m.angle;
-        data.quality = m.quality;
+        data.quality = m.quality * blockQuality;
         data.id = m.id;
 
         // Converter tipo antigo para novo enum
@@ -391,6 +445,11 @@ QVector<MinutiaeData> AFISMatcher::extractMinutiaeFromImage(const cv::Mat& image
         minutiae.append(data);
     }
 
+    if (discarded > 0) {
+        qDebug() << QString("[AFIS] %1 minúcias descartadas em blocos de qualidade < %2")
+                    .arg(discarded).arg(config.minBlockQuality);
+    }
+
     return minutiae;
 }
 
@@ -39,6 +39,10 @@ struct AFISMatchConfig {
     int minMatchedMinutiae;         // Mínimo de minúcias para match válido
     double minSimilarityScore;      // Score mínimo para considerar match
     bool useQualityWeighting;       // Usar peso de qualidade das minúcias
+    bool restrictToPrint;           // Extrair só na área segmentada da impressão
+    bool useQualityMap;             // Ponderar/descartar minúcias pela qualidade do bloco
+    double minBlockQuality;         // Qualidade mínima do bloco (0.0 a 1.0)
+    bool removeFalseMinutiae;       // Remover esporas, pares opostos e minúcias de borda
     bool performGeometricValidation;// Validar geometria do matching
     int maxCandidates;              // Máximo de candidatos a retornar
 
@@ -48,6 +52,10 @@ struct AFISMatchConfig {
           minMatchedMinutiae(12),
           minSimilarityScore(0.3),
           useQualityWeighting(true),
+          restrictToPrint(false),
+          useQualityMap(true),
+          minBlockQuality(0.3),
+          removeFalseMinutiae(true),
           performGeometricValidation(true),
           maxCandidates(10) {}
 };
@@ -79,9 +87,11 @@ public:
         const QVector<MinutiaeData>& queryMinutiae,
         int maxResults = 10);
 
+    // pixelsPerMM > 0: extração em resolução canônica (500 ppi), minúcias em coordenadas nativas
     QVector<AFISMatchResult> identifyFingerprintFromImage(
         const cv::Mat& queryImage,
-        int maxResults = 10);
+        int maxResults = 10,
+        double pixelsPerMM = 0.0);
 
     // Comparação 1:1
     AFISMatchResult verifyFingerprint(
@@ -138,7 +148,7 @@ private:
         const QVector<MinutiaeData>& candidate) const;
 
     // Métodos auxiliares
-    QVector<MinutiaeData> extractMinutiaeFromImage(const cv::Mat& image);
+    QVector<MinutiaeData> extractMinutiaeFromImage(const cv::Mat& image, double pixelsPerMM = 0.0);
     void normalizeMinutiae(QVector<MinutiaeData>& minutiae);
 };
 
@@ -0,0 +1,291 @@
+#include "DistortionSimulator.h"
+#include "FingerprintLRCalculator.h"
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <opencv2/core.hpp>
+#include <algorithm>
+#include <random>
+
+namespace FingerprintEnhancer {
+
+namespace {
+
+const int kMaxCachedModels = 256;
+
+QMutex modelCacheMutex;
+QHash<QByteArray, DistortionModel> modelCache;
+
+/**
+ * Thin-plate spline 2D: f(p) = a0 + a1·x + a2·y + Σ wᵢ·U(|p - cᵢ|), U(r) = r²·log r²
+ */
+class ThinPlateSpline {
+public:
+    bool solve(const QVector<QPointF>& source, const QVector<QPointF>& target, double lambda) {
+        const int n = source.size();
+        if (n < 3) return false;
+
+        cv::Mat A = cv::Mat::zeros(n + 3, n + 3, CV_64F);
+        cv::Mat b = cv::Mat::zeros(n + 3, 2, CV_64F);
+
+        for (int i = 0; i < n; ++i) {
+            for (int j = 0; j < n; ++j) {
+                A.at<double>(i, j) = (i == j) ? lambda : kernel(source[i], source[j]);
+            }
+            A.at<double>(i, n) = 1.0;
+            A.at<double>(i, n + 1) = source[i].x();
+            A.at<double>(i, n + 2) = source[i].y();
+            A.at<double>(n, i) = 1.0;
+            A.at<double>(n + 1, i) = source[i].x();
+            A.at<double>(n + 2, i) = source[i].y();
+
+            b.at<double>(i, 0) = target[i].x();
+            b.at<double>(i, 1) = target[i].y();
+        }
+
+        // Pontos colineares deixam o sistema singular: recorre a SVD
+        if (!cv::solve(A, b, m_coefficients, cv::DECOMP_LU)) {
+            cv::solve(A, b, m_coefficients, cv::DECOMP_SVD);
+        }
+
+        m_controlPoints = source;
+        return true;
+    }
+
+    QPointF map(const QPointF& p) const {
+        const int n = m_controlPoints.size();
+        double x = m_coefficients.at<double>(n, 0) +
+                   m_coefficients.at<double>(n + 1, 0) * p.x() +
+                   m_coefficients.at<double>(n + 2, 0) * p.y();
+        double y = m_coefficients.at<double>(n, 1) +
+                   m_coefficients.at<double>(n + 1, 1) * p.x() +
+                   m_coefficients.at<double>(n + 2, 1) * p.y();
+
+        for (int i = 0; i < n; ++i) {
+            double u = kernel(p, m_controlPoints[i]);
+            x += m_coefficients.at<double>(i, 0) * u;
+            y += m_coefficients.at<double>(i, 1) * u;
+        }
+
+        return QPointF(x, y);
+    }
+
+private:
+    static double kernel(const QPointF& a, const QPointF& b) {
+        double dx = a.x() - b.x();
+        double dy = a.y() - b.y();
+        double r2 = dx * dx + dy * dy;
+        return (r2 < 1e-12) ? 0.0 : r2 * std::log(r2);
+    }
+
+    QVector<QPointF> m_controlPoints;
+    cv::Mat m_coefficients;
+};
+
+/**
+ * κ de máxima verossimilhança da von Mises a partir do comprimento resultante médio
+ * (aproximação de Best & Fisher, 1981)
+ */
+double estimateKappa(double meanResultant) {
+    double R = std::clamp(meanResultant, 0.0, 0.9999);
+    if (R < 0.53) return 2.0 * R + R * R * R + 5.0 * std::pow(R, 5) / 6.0;
+    if (R < 0.85) return -0.4 + 1.39 * R + 0.43 / (1.0 - R);
+    return 1.0 / (R * R * R - 4.0 * R * R + 3.0 * R);
+}
+
+// Resíduos de uma variante em relação à configuração original
+struct SimulationResiduals {
+    double shapeSquaredSum = 0.0;
+    int shapeCount = 0;
+    double cosineSum = 0.0;
+    int directionCount = 0;
+};
+
+} // namespace
+
+QVector<Minutia> DistortionSimulator::distort(const QVector<Minutia>& minutiae,
+                                              const DistortionSimulationConfig& config,
+                                              quint32 seed) {
+    if (minutiae.size() < 2) return minutiae;
+
+    // Região da configuração, com margem de 10%
+    double minX = minutiae.first().position.x(), maxX = minX;
+    double minY = minutiae.first().position.y(), maxY = minY;
+    for (const auto& m : minutiae) {
+        minX = std::min(minX, static_cast<double>(m.position.x()));
+        maxX = std::max(maxX, static_cast<double>(m.position.x()));
+        minY = std::min(minY, static_cast<double>(m.position.y()));
+        maxY = std::max(maxY, static_cast<double>(m.position.y()));
+    }
+    double marginX = std::max(1.0, 0.1 * (maxX - minX));
+    double marginY = std::max(1.0, 0.1 * (maxY - minY));
+    minX -= marginX; maxX += marginX;
+    minY -= marginY; maxY += marginY;
+
+    double maxDisplacement = (config.pixelsPerMM > 0.0)
+        ? config.maxDisplacementMM * config.pixelsPerMM
+        : config.fallbackDisplacementPx;
+
+    // Deslocamentos gaussianos (σ = máximo/2) truncados no máximo calibrado
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> normal(0.0, maxDisplacement / 2.0);
+
+    const int grid = std::max(2, config.gridSize);
+    QVector<QPointF> source, target;
+    for (int gy = 0; gy < grid; ++gy) {
+        for (int gx = 0; gx < grid; ++gx) {
+            QPointF c(minX + (maxX - minX) * gx / (grid - 1),
+                      minY + (maxY - minY) * gy / (grid - 1));
+            QPointF d(normal(rng), normal(rng));
+            double len = std::hypot(d.x(), d.y());
+            if (len > maxDisplacement) d *= maxDisplacement / len;
+
+            source.append(c);
+            target.append(c + d);
+        }
+    }
+
+    ThinPlateSpline tps;
+    if (!tps.solve(source, target, config.regularization)) return minutiae;
+
+    QVector<Minutia> warped = minutiae;
+    const double h = 0.5;  // Passo das diferenças finitas do jacobiano
+    for (auto& m : warped) {
+        QPointF p(m.position.x(), m.position.y());
+        QPointF mapped = tps.map(p);
+
+        // Direção transformada pelo jacobiano local do TPS
+        QPointF dx = (tps.map(p + QPointF(h, 0)) - tps.map(p - QPointF(h, 0))) / (2.0 * h);
+        QPointF dy = (tps.map(p + QPointF(0, h)) - tps.map(p - QPointF(0, h))) / (2.0 * h);
+        double c = std::cos(m.angle);
+        double s = std::sin(m.angle);
+        double vx = dx.x() * c + dy.x() * s;
+        double vy = dx.y() * c + dy.y() * s;
+
+        m.position = mapped.toPoint();
+        m.angle = std::atan2(vy, vx);
+    }
+
+    return warped;
+}
+
+DistortionModel DistortionSimulator::fit(const QVector<Minutia>& minutiae,
+                                         const DistortionSimulationConfig& config) {
+    DistortionModel model;
+
+    if (minutiae.size() < 3 || config.simulations <= 0) {
+        return model;
+    }
+
+    const ShapeFeatures originalShape = FingerprintLRCalculator::buildShapeFeatures(minutiae);
+    const DirectionFeatures originalDirection =
+        FingerprintLRCalculator::buildDirectionFeatures(minutiae, originalShape.centroid);
+
+    QVector<int> indices(config.simulations);
+    for (int i = 0; i < indices.size(); ++i) indices[i] = i;
+
+    auto simulate = [&](int index) {
+        SimulationResiduals residuals;
+        QVector<Minutia> warped = distort(minutiae, config, config.seed + static_cast<quint32>(index));
+
+        // Mesmo pipeline de features da comparação real (inclui reordenação por AR)
+        ShapeFeatures shape = FingerprintLRCalculator::buildShapeFeatures(warped);
+        int k = std::min(shape.formFactors.size(), originalShape.formFactors.size());
+        for (int i = 0; i < k; ++i) {
+            double r = shape.formFactors[i] - originalShape.formFactors[i];
+            residuals.shapeSquaredSum += r * r;
+            residuals.shapeCount++;
+        }
+
+        DirectionFeatures direction =
+            FingerprintLRCalculator::buildDirectionFeatures(warped, shape.centroid);
+        k = std::min(direction.relativeAngles.size(), originalDirection.relativeAngles.size());
+        for (int i = 0; i < k; ++i) {
+            double diff = FingerprintLRCalculator::angleDifference(
+                direction.relativeAngles[i], originalDirection.relativeAngles[i]);
+            residuals.cosineSum += std::cos(diff);
+            residuals.directionCount++;
+        }
+
+        return residuals;
+    };
+
+    auto reduce = [](SimulationResiduals& total, const SimulationResiduals& part) {
+        total.shapeSquaredSum += part.shapeSquaredSum;
+        total.shapeCount += part.shapeCount;
+        total.cosineSum += part.cosineSum;
+        total.directionCount += part.directionCount;
+    };
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(config.maxThreads > 0 ? config.maxThreads
+                                                 : QThread::idealThreadCount());
+    SimulationResiduals total = QtConcurrent::blockingMappedReduced<SimulationResiduals>(
+        &pool, indices, simulate, reduce);
+
+    model.simulations = config.simulations;
+    model.shapeSamples = total.shapeCount;
+    model.directionSamples = total.directionCount;
+
+    if (total.shapeCount > 0) {
+        model.shapeStdDev = std::max(0.1, std::sqrt(total.shapeSquaredSum / total.shapeCount));
+    }
+    if (total.directionCount > 0) {
+        model.directionKappa = estimateKappa(total.cosineSum / total.directionCount);
+    }
+    model.valid = (total.shapeCount > 0);
+
+    qDebug() << QString("[LR-Distortion] %1 simulações TPS: σ_shape=%2 px, κ_direção=%3")
+        .arg(model.simulations)
+        .arg(model.shapeStdDev, 0, 'f', 3)
+        .arg(model.directionKappa, 0, 'f', 2);
+
+    return model;
+}
+
+DistortionModel DistortionSimulator::cachedFit(const QVector<Minutia>& minutiae,
+                                               const DistortionSimulationConfig& config) {
+    QByteArray key = cacheKey(minutiae, config);
+
+    {
+        QMutexLocker locker(&modelCacheMutex);
+        auto it = modelCache.constFind(key);
+        if (it != modelCache.constEnd()) return it.value();
+    }
+
+    // Simulação fora do lock: chamadas concorrentes para a mesma chave apenas repetem o trabalho
+    DistortionModel model = fit(minutiae, config);
+
+    QMutexLocker locker(&modelCacheMutex);
+    if (modelCache.size() >= kMaxCachedModels) {
+        modelCache.clear();
+    }
+    modelCache.insert(key, model);
+    return model;
+}
+
+void DistortionSimulator::clearCache() {
+    QMutexLocker locker(&modelCacheMutex);
+    modelCache.clear();
+}
+
+QByteArray DistortionSimulator::cacheKey(const QVector<Minutia>& minutiae,
+                                         const DistortionSimulationConfig& config) {
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    for (const auto& m : minutiae) {
+        stream << m.position.x() << m.position.y() << static_cast<double>(m.angle);
+    }
+    stream << config.simulations << config.gridSize << config.maxDisplacementMM
+           << config.pixelsPerMM << config.fallbackDisplacementPx
+           << config.regularization << config.seed;
+
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+} // namespace FingerprintEnhancer
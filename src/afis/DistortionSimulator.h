@@ -0,0 +1,79 @@
+#ifndef DISTORTIONSIMULATOR_H
+#define DISTORTIONSIMULATOR_H
+
+#include <QVector>
+#include <QPointF>
+#include <QByteArray>
+#include "../core/ProjectModel.h"
+
+namespace FingerprintEnhancer {
+
+/**
+ * @brief Parâmetros da simulação de distorção elástica (TPS)
+ */
+struct DistortionSimulationConfig {
+    int simulations = 500;              // Número de variantes distorcidas
+    int gridSize = 3;                   // Pontos de controle em grade gridSize × gridSize
+    double maxDisplacementMM = 0.6;     // Deslocamento máximo de cada ponto de controle
+    double pixelsPerMM = 0.0;           // Escala do fragmento (0 = usar fallbackDisplacementPx)
+    double fallbackDisplacementPx = 6.0;
+    double regularization = 0.0;        // λ do TPS (0 = interpolação exata)
+    quint32 seed = 12345;               // Semente base (variante i usa seed + i)
+    int maxThreads = 0;                 // 0 = QThread::idealThreadCount()
+};
+
+/**
+ * @brief Parâmetros do lado Hp ajustados pela simulação
+ */
+struct DistortionModel {
+    bool valid = false;
+    double shapeStdDev = 2.0;           // σ de N(x, σ) para os form factors (pixels)
+    double directionKappa = 10.0;       // κ da von Mises dos ângulos relativos
+    int simulations = 0;
+    int shapeSamples = 0;
+    int directionSamples = 0;
+};
+
+/**
+ * @brief Simulação de variabilidade intra-fonte por thin-plate splines
+ *
+ * Gera variantes elasticamente distorcidas de uma configuração de minúcias
+ * (pontos de controle em grade com deslocamentos aleatórios limitados),
+ * em paralelo, e ajusta as distribuições de Hp usadas por
+ * FingerprintLRCalculator::computeLRShape e computeLRDirection:
+ * - form factors: σ pela raiz do resíduo quadrático médio
+ * - ângulos relativos: κ de máxima verossimilhança (aprox. de Best & Fisher)
+ *
+ * Os modelos são mantidos em cache por configuração (minúcias + parâmetros).
+ */
+class DistortionSimulator {
+public:
+    /**
+     * @brief Ajusta o modelo de distorção para a configuração (sem cache)
+     */
+    static DistortionModel fit(const QVector<Minutia>& minutiae,
+                               const DistortionSimulationConfig& config = DistortionSimulationConfig());
+
+    /**
+     * @brief Igual a fit(), reutilizando o resultado de configurações já simuladas
+     */
+    static DistortionModel cachedFit(const QVector<Minutia>& minutiae,
+                                     const DistortionSimulationConfig& config = DistortionSimulationConfig());
+
+    /**
+     * @brief Gera uma variante distorcida (TPS aleatório) da configuração
+     */
+    static QVector<Minutia> distort(const QVector<Minutia>& minutiae,
+                                    const DistortionSimulationConfig& config,
+                                    quint32 seed);
+
+    static void clearCache();
+
+private:
+    static QByteArray cacheKey(const QVector<Minutia>& minutiae,
+                               const DistortionSimulationConfig& config);
+};
+
+} // namespace FingerprintEnhancer
+
+#endif // DISTORTIONSIMULATOR_H
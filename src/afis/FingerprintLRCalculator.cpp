@@ -3,7 +3,17 @@
 #include <QDebug>
 #include <QFile>
 #include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QtConcurrent>
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <random>
 
 namespace FingerprintEnhancer {
 
@@ -97,11 +107,54 @@ FingerprintLRCalculator::FingerprintLRCalculator()
     : useBrazilianPriors(true)
     , rarityFactor(1.0)
     , distortionStdDev(2.0)  // pixels - modelo de distorção simplificado
+    , directionDensityHp(10.0)  // Alta concentração (mesma pessoa)
+    , directionDensityHd(1.0)   // Baixa concentração (população)
+    , m_useSimulatedDistortion(false)
     , m_detailedLogging(false)
 {
+    setDistortionStdDev(distortionStdDev);
+    
     qDebug() << "[LR] FingerprintLRCalculator inicializado com priors brasileiros";
 }
 
+void FingerprintLRCalculator::setDistortionStdDev(double stddev) {
+    distortionStdDev = stddev;
+    shapeDensityHp = GaussianDensity(stddev);         // Distorção intra-individual
+    shapeDensityHd = GaussianDensity(5.0 * stddev);   // 5x maior para população
+}
+
+void FingerprintLRCalculator::setUseSimulatedDistortion(bool use, const DistortionSimulationConfig& config) {
+    m_useSimulatedDistortion = use;
+    m_distortionSimulation = config;
+}
+
+void FingerprintLRCalculator::applyDistortionModel(const DistortionModel& model) {
+    if (!model.valid) return;
+    
+    double sigma = std::min(model.shapeStdDev, shapeDensityHd.stddev());
+    double kappa = std::max(model.directionKappa, directionDensityHd.kappa());
+    shapeDensityHp = GaussianDensity(sigma);
+    directionDensityHp = VonMisesDensity(kappa);
+}
+
+void FingerprintLRCalculator::prepareHpDensities(const QVector<Minutia>& reference, double pixelsPerMM) {
+    // Sempre parte do modelo fixo; a simulação só substitui o lado Hp
+    setDistortionStdDev(distortionStdDev);
+    directionDensityHp = VonMisesDensity(10.0);
+    
+    if (!m_useSimulatedDistortion) return;
+    
+    DistortionSimulationConfig config = m_distortionSimulation;
+    if (config.pixelsPerMM <= 0.0) config.pixelsPerMM = pixelsPerMM;
+    
+    DistortionModel model = DistortionSimulator::cachedFit(reference, config);
+    if (model.valid) {
+        applyDistortionModel(model);
+    } else {
+        qWarning() << "[LR] Simulação de distorção sem amostras; mantendo σ fixo";
+    }
+}
+
 void FingerprintLRCalculator::setDetailedLogging(bool enable, const QString& logFilePath) {
     m_detailedLogging = enable;
     if (enable) {
@@ -167,6 +220,12 @@ LRResult FingerprintLRCalculator::calculateLR(
     QVector<Minutia> m1 = minutiae1.mid(0, k);
     QVector<Minutia> m2 = minutiae2.mid(0, k);
     
+    // Variabilidade intra-fonte estimada sobre a configuração de referência
+    prepareHpDensities(m2, fragment2->pixelsPerMM);
+    result.distortionSimulated = m_useSimulatedDistortion;
+    result.sigma_hp = shapeDensityHp.stddev();
+    result.kappa_hp = directionDensityHp.kappa();
+    
     // ===== SHAPE =====
     ShapeFeatures shape1 = extractShapeFeatures(m1);
     ShapeFeatures shape2 = extractShapeFeatures(m2);
@@ -266,9 +325,499 @@ QMap<QString, LRResult> FingerprintLRCalculator::analyzeSensitivity(
     return results;
 }
 
+// ==================== EXPLORAÇÃO DE SUBCONJUNTOS ====================
+
+namespace {
+
+// Acumuladores de uma tarefa da exploração (mesclados sob mutex ao final)
+struct ExplorationAccumulator {
+    qint64 evaluated = 0;
+    qint64 pruned = 0;
+    double bestLog = -std::numeric_limits<double>::infinity();
+    QVector<int> best;
+    
+    // Distribuição: só subconjuntos sem viés de poda (enumeração completa ou amostra uniforme)
+    qint64 recorded = 0;
+    double sum = 0.0;
+    double worstLog = std::numeric_limits<double>::infinity();
+    QVector<int> worst;
+    QVector<double> sumWith;
+    QVector<qint64> countWith;
+    QVector<double> samples;
+    
+    explicit ExplorationAccumulator(int n = 0) : sumWith(n, 0.0), countWith(n, 0) {}
+    
+    void record(const QVector<int>& chosen, double logLR, bool keepSample) {
+        recorded++;
+        sum += logLR;
+        for (int idx : chosen) {
+            sumWith[idx] += logLR;
+            countWith[idx]++;
+        }
+        if (logLR < worstLog) { worstLog = logLR; worst = chosen; }
+        if (keepSample) samples.append(logLR);
+    }
+    
+    void merge(const ExplorationAccumulator& other) {
+        evaluated += other.evaluated;
+        pruned += other.pruned;
+        if (other.bestLog > bestLog) { bestLog = other.bestLog; best = other.best; }
+        recorded += other.recorded;
+        sum += other.sum;
+        if (other.worstLog < worstLog) { worstLog = other.worstLog; worst = other.worst; }
+        for (int i = 0; i < sumWith.size(); ++i) {
+            sumWith[i] += other.sumWith[i];
+            countWith[i] += other.countWith[i];
+        }
+        samples += other.samples;
+    }
+};
+
+double binomialCoefficient(int n, int k) {
+    if (k < 0 || k > n) return 0.0;
+    k = std::min(k, n - k);
+    double c = 1.0;
+    for (int i = 1; i <= k; ++i) {
+        c = c * (n - k + i) / i;
+    }
+    return c;
+}
+
+void atomicMax(std::atomic<double>& target, double value) {
+    double current = target.load();
+    while (value > current && !target.compare_exchange_weak(current, value)) {
+    }
+}
+
+} // namespace
+
+LRExplorationResult FingerprintLRCalculator::exploreSubsets(
+    const Fragment* fragment1,
+    const Fragment* fragment2,
+    const QVector<QPair<int, int>>& correspondences,
+    LRCalculationMode mode,
+    const QString& pattern,
+    double rarity,
+    const LRExplorationConfig& config
+) {
+    LRExplorationResult result;
+    
+    if (!fragment1 || !fragment2) {
+        qWarning() << "[LR-Explore] Fragmentos nulos fornecidos";
+        return result;
+    }
+    
+    const auto& minutiae1 = fragment1->minutiae;
+    const auto& minutiae2 = fragment2->minutiae;
+    
+    // Pares válidos; sem correspondências, usa o pareamento por índice de calculateLR
+    QVector<QPair<int, int>> pairs;
+    if (correspondences.isEmpty()) {
+        int count = std::min(minutiae1.size(), minutiae2.size());
+        for (int i = 0; i < count; ++i) pairs.append(qMakePair(i, i));
+    } else {
+        for (const auto& c : correspondences) {
+            if (c.first >= 0 && c.first < minutiae1.size() &&
+                c.second >= 0 && c.second < minutiae2.size()) {
+                pairs.append(c);
+            }
+        }
+    }
+    
+    const int n = pairs.size();
+    result.pairs = pairs;
+    result.n_pairs = n;
+    
+    if (n == 0) {
+        qWarning() << "[LR-Explore] Nenhum par correspondente para explorar";
+        return result;
+    }
+    
+    const int k = (config.subsetSize > 0) ? std::min(config.subsetSize, n) : n;
+    result.k_minutiae = k;
+    result.totalSubsets = binomialCoefficient(n, k);
+    
+    const double p_v_hd = (rarity > 0) ? rarity : estimatePVHd(k, pattern);
+    
+    // Um único modelo de distorção para toda a exploração: ajustado sobre
+    // todas as minúcias pareadas da referência, não por subconjunto
+    QVector<Minutia> referencePaired;
+    referencePaired.reserve(n);
+    for (const auto& p : pairs) referencePaired.append(minutiae2[p.second]);
+    prepareHpDensities(referencePaired, fragment2->pixelsPerMM);
+    
+    const bool useDirection = (mode == LRCalculationMode::SHAPE_DIRECTION ||
+                               mode == LRCalculationMode::COMPLETE);
+    const bool useType = (mode == LRCalculationMode::SHAPE_TYPE ||
+                          mode == LRCalculationMode::COMPLETE);
+    
+    // ===== LIMITES PARA A PODA =====
+    // Shape e direção dependem do subconjunto inteiro (centroide), então só
+    // entram com o máximo por termo (diferença nula). O termo de tipo de cada
+    // par independe do subconjunto e é somado exatamente.
+    const double shapeMaxLog = std::log10(shapeTermLR(0.0, 0.0));
+    const double dirMaxLog = useDirection ? std::log10(directionTermLR(0.0)) : 0.0;
+    const double structuralBound = k * (shapeMaxLog + dirMaxLog) - std::log10(p_v_hd);
+    
+    QVector<double> typeLog(n, 0.0);
+    if (useType) {
+        for (int i = 0; i < n; ++i) {
+            const Minutia& a = minutiae1[pairs[i].first];
+            const Minutia& b = minutiae2[pairs[i].second];
+            typeLog[i] = std::log10(typeTermLR(typeCategoryName(a.type),
+                                               mapTypeToIndex(a.type),
+                                               mapTypeToIndex(b.type)));
+        }
+    }
+    
+    // suffixTop[j][r] = soma dos r maiores termos de tipo em [j, n)
+    QVector<QVector<double>> suffixTop(n + 1);
+    for (int j = 0; j <= n; ++j) {
+        QVector<double> values = typeLog.mid(j);
+        std::sort(values.begin(), values.end(), std::greater<double>());
+        suffixTop[j].resize(values.size() + 1);
+        suffixTop[j][0] = 0.0;
+        for (int r = 0; r < values.size(); ++r) {
+            suffixTop[j][r + 1] = suffixTop[j][r] + values[r];
+        }
+    }
+    
+    // ===== TAREFAS (prefixos de profundidade até 2 para balancear carga) =====
+    QVector<QVector<int>> tasks;
+    if (k == 1) {
+        for (int i = 0; i < n; ++i) tasks.append(QVector<int>{i});
+    } else {
+        for (int i = 0; i <= n - k; ++i) {
+            for (int j = i + 1; j <= n - k + 1; ++j) {
+                tasks.append(QVector<int>{i, j});
+            }
+        }
+    }
+    
+    qDebug() << QString("[LR-Explore] n=%1 pares, k=%2, C(n,k)=%3, %4 tarefas, orçamento=%5 ms")
+        .arg(n).arg(k).arg(result.totalSubsets, 0, 'g', 6)
+        .arg(tasks.size()).arg(config.timeBudgetMs);
+    
+    // A poda descarta justamente os subconjuntos de LR baixo: serve para achar
+    // o máximo, não para a distribuição. Se a enumeração completa cabe no
+    // limite, uma passada sem poda dá as duas coisas; senão, a busca com poda
+    // dá o máximo e a distribuição vem de uma amostra uniforme de subconjuntos.
+    const bool exhaustive = !config.pruneByBound ||
+                            result.totalSubsets <= config.maxDistributionSubsets;
+    const qint64 searchBudgetMs = exhaustive ? config.timeBudgetMs : config.timeBudgetMs / 2;
+    
+    QElapsedTimer timer;
+    timer.start();
+    
+    std::atomic<bool> timedOut{false};
+    std::atomic<double> bestSoFar{-std::numeric_limits<double>::infinity()};
+    std::atomic<qint64> storedSamples{0};
+    
+    QMutex mergeMutex;
+    ExplorationAccumulator total(n);
+    
+    auto runTask = [&](const QVector<int>& prefix) {
+        if (timedOut.load()) return;
+        
+        ExplorationAccumulator acc(n);
+        
+        // Buffers reutilizados pelas folhas desta tarefa
+        QVector<int> chosen = prefix;
+        chosen.reserve(k);
+        QVector<Minutia> sub1(k);
+        QVector<Minutia> sub2(k);
+        
+        double prefixType = 0.0;
+        for (int idx : prefix) prefixType += typeLog[idx];
+        
+        std::function<void(int, double)> search = [&](int next, double partialType) {
+            if (timedOut.load(std::memory_order_relaxed)) return;
+            
+            const int remaining = k - chosen.size();
+            
+            if (remaining == 0) {
+                for (int t = 0; t < k; ++t) {
+                    sub1[t] = minutiae1[pairs[chosen[t]].first];
+                    sub2[t] = minutiae2[pairs[chosen[t]].second];
+                }
+                
+                double logLR = evaluateSubset(sub1, sub2, mode, p_v_hd);
+                
+                acc.evaluated++;
+                if (logLR > acc.bestLog) { acc.bestLog = logLR; acc.best = chosen; }
+                if (exhaustive) {
+                    acc.record(chosen, logLR, storedSamples.fetch_add(1) < config.maxStoredSamples);
+                }
+                atomicMax(bestSoFar, logLR);
+                
+                if ((acc.evaluated & 63) == 0 && timer.elapsed() > searchBudgetMs) {
+                    timedOut.store(true);
+                }
+                return;
+            }
+            
+            // log10(LR) é limitado a ±15: atingido o teto, o resto da busca é podado
+            if (!exhaustive) {
+                double bound = std::min(15.0, structuralBound + partialType +
+                                              suffixTop[next][remaining]);
+                if (bound <= bestSoFar.load(std::memory_order_relaxed)) {
+                    acc.pruned += static_cast<qint64>(binomialCoefficient(n - next, remaining));
+                    return;
+                }
+            }
+            
+            for (int i = next; i <= n - remaining; ++i) {
+                chosen.append(i);
+                search(i + 1, partialType + typeLog[i]);
+                chosen.removeLast();
+                if (timedOut.load(std::memory_order_relaxed)) return;
+            }
+        };
+        
+        search(prefix.last() + 1, prefixType);
+        
+        QMutexLocker locker(&mergeMutex);
+        total.merge(acc);
+    };
+    
+    // Pool próprio: a exploração costuma ser chamada de dentro do pool global
+    QThreadPool pool;
+    pool.setMaxThreadCount(config.maxThreads > 0 ? config.maxThreads
+                                                 : QThread::idealThreadCount());
+    QtConcurrent::blockingMap(&pool, tasks, runTask);
+    
+    result.completed = !timedOut.load();
+    
+    // ===== AMOSTRA UNIFORME PARA A DISTRIBUIÇÃO =====
+    ExplorationAccumulator sampled(n);
+    if (!exhaustive) {
+        const int chunkSize = 256;
+        const int wanted = std::max(1, config.distributionSamples);
+        QVector<int> chunks;
+        for (int c = 0; c * chunkSize < wanted; ++c) chunks.append(c);
+        
+        QElapsedTimer samplingTimer;
+        samplingTimer.start();
+        const qint64 samplingBudgetMs = std::max<qint64>(1, config.timeBudgetMs - timer.elapsed());
+        std::atomic<bool> samplingTimedOut{false};
+        
+        auto runChunk = [&](const int& chunk) {
+            if (samplingTimedOut.load()) return;
+            
+            ExplorationAccumulator acc(n);
+            
+            // Semente pelo índice do bloco: amostra reproduzível com qualquer número de threads
+            std::mt19937 rng(static_cast<std::mt19937::result_type>(chunk) * 2654435761u + 1u);
+            QVector<int> order(n);
+            std::iota(order.begin(), order.end(), 0);
+            QVector<int> chosen(k);
+            QVector<Minutia> sub1(k);
+            QVector<Minutia> sub2(k);
+            
+            const int count = std::min(chunkSize, wanted - chunk * chunkSize);
+            for (int s = 0; s < count; ++s) {
+                // Fisher-Yates parcial: k pares distintos, todos os C(n, k) equiprováveis
+                for (int t = 0; t < k; ++t) {
+                    std::uniform_int_distribution<int> pick(t, n - 1);
+                    std::swap(order[t], order[pick(rng)]);
+                }
+                std::copy(order.begin(), order.begin() + k, chosen.begin());
+                std::sort(chosen.begin(), chosen.end());
+                
+                for (int t = 0; t < k; ++t) {
+                    sub1[t] = minutiae1[pairs[chosen[t]].first];
+                    sub2[t] = minutiae2[pairs[chosen[t]].second];
+                }
+                acc.record(chosen, evaluateSubset(sub1, sub2, mode, p_v_hd), true);
+                
+                if ((s & 63) == 63 && samplingTimer.elapsed() > samplingBudgetMs) {
+                    samplingTimedOut.store(true);
+                    break;
+                }
+            }
+            
+            QMutexLocker locker(&mergeMutex);
+            sampled.merge(acc);
+        };
+        
+        QtConcurrent::blockingMap(&pool, chunks, runChunk);
+    }
+    ExplorationAccumulator& distribution = exhaustive ? total : sampled;
+    
+    result.elapsedMs = timer.elapsed();
+    result.evaluatedSubsets = total.evaluated;
+    result.prunedSubsets = total.pruned;
+    result.distributionSampled = !exhaustive;
+    result.distributionSubsets = distribution.recorded;
+    
+    if (total.evaluated == 0) {
+        qWarning() << "[LR-Explore] Nenhum subconjunto avaliado dentro do orçamento";
+        return result;
+    }
+    
+    // ===== DISTRIBUIÇÃO =====
+    result.maxLog10 = total.bestLog;
+    if (distribution.recorded > 0) {
+        result.minLog10 = distribution.worstLog;
+        result.meanLog10 = distribution.sum / distribution.recorded;
+    }
+    
+    QVector<double>& samples = distribution.samples;
+    std::sort(samples.begin(), samples.end());
+    if (!samples.isEmpty()) {
+        auto quantile = [&samples](double q) {
+            int idx = static_cast<int>(std::round(q * (samples.size() - 1)));
+            return samples[std::clamp(idx, 0, static_cast<int>(samples.size()) - 1)];
+        };
+        result.medianLog10 = quantile(0.5);
+        result.p05Log10 = quantile(0.05);
+        result.p95Log10 = quantile(0.95);
+        
+        int bins = std::max(1, config.histogramBins);
+        result.histogram.fill(0, bins);
+        result.histogramMin = samples.first();
+        result.histogramMax = samples.last();
+        double range = result.histogramMax - result.histogramMin;
+        for (double v : samples) {
+            int b = (range > 1e-12)
+                ? static_cast<int>((v - result.histogramMin) / range * bins)
+                : 0;
+            result.histogram[std::min(b, bins - 1)]++;
+        }
+    }
+    
+    // ===== SUBCONJUNTO DETERMINANTE =====
+    QVector<Minutia> best1, best2;
+    for (int idx : total.best) {
+        result.drivingSubset.append(pairs[idx]);
+        best1.append(minutiae1[pairs[idx].first]);
+        best2.append(minutiae2[pairs[idx].second]);
+    }
+    for (int idx : distribution.worst) {
+        result.weakestSubset.append(pairs[idx]);
+    }
+    
+    evaluateSubset(best1, best2, mode, p_v_hd, &result.drivingResult);
+    result.drivingResult.interpretation = interpretLR(result.drivingResult.log10_lr_total);
+    
+    // Influência de cada par na distribuição (enumerada ou amostrada)
+    result.pairInfluence.fill(0.0, n);
+    for (int i = 0; i < n; ++i) {
+        qint64 with = distribution.countWith[i];
+        qint64 without = distribution.recorded - with;
+        if (with > 0 && without > 0) {
+            double meanWith = distribution.sumWith[i] / with;
+            double meanWithout = (distribution.sum - distribution.sumWith[i]) / without;
+            result.pairInfluence[i] = meanWith - meanWithout;
+        }
+    }
+    
+    qDebug() << QString("[LR-Explore] %1 avaliados, %2 podados de %3 (%4 ms%5)")
+        .arg(result.evaluatedSubsets).arg(result.prunedSubsets)
+        .arg(result.totalSubsets, 0, 'g', 6).arg(result.elapsedMs)
+        .arg(result.completed ? "" : ", orçamento esgotado");
+    qDebug() << QString("[LR-Explore] log10(LR): min=%1, mediana=%2 (%3 de %4 subconjuntos), máx=%5")
+        .arg(result.minLog10, 0, 'f', 2)
+        .arg(result.medianLog10, 0, 'f', 2)
+        .arg(result.distributionSampled ? "amostra uniforme" : "enumeração sem poda")
+        .arg(result.distributionSubsets)
+        .arg(result.maxLog10, 0, 'f', 2);
+    
+    return result;
+}
+
+double FingerprintLRCalculator::evaluateSubset(
+    const QVector<Minutia>& m1,
+    const QVector<Minutia>& m2,
+    LRCalculationMode mode,
+    double p_v_hd,
+    LRResult* details
+) const {
+    // Mesmo modelo de calculateLR, acumulado em log e sem log de depuração
+    ShapeFeatures shape1 = buildShapeFeatures(m1);
+    ShapeFeatures shape2 = buildShapeFeatures(m2);
+    
+    double log_shape = 0.0;
+    int kShape = std::min(shape1.formFactors.size(), shape2.formFactors.size());
+    for (int i = 0; i < kShape; ++i) {
+        log_shape += std::log10(shapeTermLR(shape1.formFactors[i], shape2.formFactors[i]));
+    }
+    
+    double log_direction = 0.0;
+    if (mode == LRCalculationMode::SHAPE_DIRECTION ||
+        mode == LRCalculationMode::COMPLETE) {
+        DirectionFeatures dir1 = buildDirectionFeatures(m1, shape1.centroid);
+        DirectionFeatures dir2 = buildDirectionFeatures(m2, shape2.centroid);
+        int kDir = std::min(dir1.relativeAngles.size(), dir2.relativeAngles.size());
+        for (int i = 0; i < kDir; ++i) {
+            double diff = angleDifference(dir1.relativeAngles[i], dir2.relativeAngles[i]);
+            log_direction += std::log10(directionTermLR(diff));
+        }
+    }
+    
+    double log_type = 0.0;
+    if (mode == LRCalculationMode::SHAPE_TYPE ||
+        mode == LRCalculationMode::COMPLETE) {
+        int kType = std::min(m1.size(), m2.size());
+        for (int i = 0; i < kType; ++i) {
+            log_type += std::log10(typeTermLR(typeCategoryName(m1[i].type),
+                                              mapTypeToIndex(m1[i].type),
+                                              mapTypeToIndex(m2[i].type)));
+        }
+    }
+    
+    double log_total = log_shape + log_direction + log_type - std::log10(p_v_hd);
+    log_total = std::clamp(log_total, -15.0, 15.0);
+    
+    if (details) {
+        details->mode = mode;
+        details->k_minutiae = std::min(m1.size(), m2.size());
+        details->lr_shape = std::pow(10.0, log_shape);
+        details->lr_direction = std::pow(10.0, log_direction);
+        details->lr_type = std::pow(10.0, log_type);
+        details->p_v_hd = p_v_hd;
+        details->lr_total = std::pow(10.0, log_total);
+        details->log10_lr_total = log_total;
+        details->shape_contribution = details->lr_shape * (1.0 / p_v_hd);
+        details->direction_contribution = details->lr_direction;
+        details->type_contribution = details->lr_type;
+    }
+    
+    return log_total;
+}
+
 // ==================== EXTRAÇÃO DE FEATURES ====================
 
 ShapeFeatures FingerprintLRCalculator::extractShapeFeatures(const QVector<Minutia>& minutiae) {
+    ShapeFeatures features = buildShapeFeatures(minutiae);
+    
+    qDebug() << QString("[LR-Shape] Extraídos %1 triângulos, centroide=(%2, %3)")
+        .arg(features.formFactors.size())
+        .arg(features.centroid.x(), 0, 'f', 1).arg(features.centroid.y(), 0, 'f', 1);
+    
+    return features;
+}
+
+DirectionFeatures FingerprintLRCalculator::extractDirectionFeatures(
+    const QVector<Minutia>& minutiae,
+    const QPointF& centroid
+) {
+    DirectionFeatures features = buildDirectionFeatures(minutiae, centroid);
+    
+    qDebug() << QString("[LR-Direction] Extraídas %1 direções").arg(minutiae.size());
+    
+    return features;
+}
+
+TypeFeatures FingerprintLRCalculator::extractTypeFeatures(const QVector<Minutia>& minutiae) {
+    TypeFeatures features = buildTypeFeatures(minutiae);
+    
+    qDebug() << QString("[LR-Type] Extraídos %1 tipos").arg(minutiae.size());
+    
+    return features;
+}
+
+ShapeFeatures FingerprintLRCalculator::buildShapeFeatures(const QVector<Minutia>& minutiae) {
     ShapeFeatures features;
     
     if (minutiae.isEmpty()) return features;
@@ -318,13 +867,10 @@ ShapeFeatures FingerprintLRCalculator::extractShapeFeatures(const QVector<Minuti
         features.aspectRatios.append(aspectRatios[idx]);
     }
     
-    qDebug() << QString("[LR-Shape] Extraídos %1 triângulos, centroide=(%2, %3)")
-        .arg(k).arg(features.centroid.x(), 0, 'f', 1).arg(features.centroid.y(), 0, 'f', 1);
-    
     return features;
 }
 
-DirectionFeatures FingerprintLRCalculator::extractDirectionFeatures(
+DirectionFeatures FingerprintLRCalculator::buildDirectionFeatures(
     const QVector<Minutia>& minutiae,
     const QPointF& centroid
 ) {
@@ -346,53 +892,17 @@ DirectionFeatures FingerprintLRCalculator::extractDirectionFeatures(
         features.absoluteAngles.append(minutiaAngle);
     }
     
-    qDebug() << QString("[LR-Direction] Extraídas %1 direções").arg(minutiae.size());
-    
     return features;
 }
 
-TypeFeatures FingerprintLRCalculator::extractTypeFeatures(const QVector<Minutia>& minutiae) {
+TypeFeatures FingerprintLRCalculator::buildTypeFeatures(const QVector<Minutia>& minutiae) {
     TypeFeatures features;
     
     for (const auto& m : minutiae) {
-        // Tipo como string (simplificado)
-        QString typeName = "other";
-        
-        switch (m.type) {
-            case MinutiaeType::RIDGE_ENDING_B:
-            case MinutiaeType::RIDGE_ENDING_C:
-                typeName = "ridge_ending";
-                break;
-            case MinutiaeType::BIFURCATION:
-            case MinutiaeType::BTUS:
-            case MinutiaeType::BTUI:
-            case MinutiaeType::BTBS:
-            case MinutiaeType::BTBI:
-                typeName = "bifurcation";
-                break;
-            case MinutiaeType::CONVERGENCE:
-            case MinutiaeType::CTUS:
-            case MinutiaeType::CTUI:
-            case MinutiaeType::CTCS:
-            case MinutiaeType::CTCI:
-                typeName = "convergence";
-                break;
-            case MinutiaeType::FRAGMENT_LARGE:
-                typeName = "fragment_big";
-                break;
-            case MinutiaeType::FRAGMENT_SMALL:
-                typeName = "fragment_small";
-                break;
-            default:
-                typeName = "other";
-        }
-        
-        features.types.append(typeName);
+        features.types.append(typeCategoryName(m.type));
         features.typeIndices.append(mapTypeToIndex(m.type));
     }
     
-    qDebug() << QString("[LR-Type] Extraídos %1 tipos").arg(minutiae.size());
-    
     return features;
 }
 
@@ -416,8 +926,8 @@ double FingerprintLRCalculator::computeLRShape(
     
     qDebug() << QString("[LR-Shape DEBUG] Comparando %1 triângulos").arg(k);
     qDebug() << QString("[LR-Shape DEBUG] sigma_hp=%1, sigma_hd=%2")
-        .arg(distortionStdDev, 0, 'f', 2)
-        .arg(5.0 * distortionStdDev, 0, 'f', 2);
+        .arg(shapeDensityHp.stddev(), 0, 'f', 2)
+        .arg(shapeDensityHd.stddev(), 0, 'f', 2);
     
     // Verificar se form factors são idênticos (fragmento duplicado)
     bool identical = true;
@@ -436,22 +946,11 @@ double FingerprintLRCalculator::computeLRShape(
         double x = reference.formFactors[i];
         double diff = std::abs(y - x);
         
-        // NUMERADOR: p(y | x, Hp, v=1)
-        // Modelo de distorção: y ~ N(x, σ_distortion)
-        double sigma_hp = distortionStdDev;  // Distorção intra-individual
-        double p_numerator = gaussianPDF(y, x, sigma_hp);
-        
-        // DENOMINADOR: p(y | Hd, v=1)
-        // Variabilidade populacional: maior desvio padrão
-        double sigma_hd = 5.0 * distortionStdDev;  // 5x maior para população
-        double mean_hd = x;  // Média aproximada
-        double p_denominator = gaussianPDF(y, mean_hd, sigma_hd);
-        
-        // Evitar divisão por zero
-        if (p_denominator < 1e-15) p_denominator = 1e-15;
-        if (p_numerator < 1e-15) p_numerator = 1e-15;
-        
-        double lr_i = p_numerator / p_denominator;
+        // NUMERADOR: p(y | x, Hp, v=1) - modelo de distorção y ~ N(x, σ_distortion)
+        // DENOMINADOR: p(y | Hd, v=1) - variabilidade populacional (σ maior)
+        double p_numerator = 0.0;
+        double p_denominator = 0.0;
+        double lr_i = shapeTermLR(y, x, &p_numerator, &p_denominator);
         
         // Log detalhado todos os triângulos
         qDebug() << QString("[LR-Shape] Tri[%1]: y=%2, x=%3, diff=%4, P(Hp)=%5, P(Hd)=%6, LR_i=%7")
@@ -463,10 +962,6 @@ double FingerprintLRCalculator::computeLRShape(
             .arg(p_denominator, 0, 'e', 2)
             .arg(lr_i, 0, 'e', 2);
         
-        // Limitar valores extremos por triângulo
-        if (lr_i > 1e6) lr_i = 1e6;
-        if (lr_i < 1e-6) lr_i = 1e-6;
-        
         lr_product *= lr_i;
     }
     
@@ -495,22 +990,8 @@ double FingerprintLRCalculator::computeLRDirection(
         // Diferença angular (circular)
         double diff = angleDifference(y_angle, x_angle);
         
-        // NUMERADOR: von Mises com concentração alta (mesma pessoa)
-        double kappa_hp = 10.0;  // Alta concentração
-        double p_numerator = vonMisesPDF(diff, 0.0, kappa_hp);
-        
-        // DENOMINADOR: von Mises com concentração baixa (população)
-        double kappa_hd = 1.0;  // Baixa concentração (mais disperso)
-        double p_denominator = vonMisesPDF(diff, 0.0, kappa_hd);
-        
-        if (p_denominator < 1e-15) p_denominator = 1e-15;
-        if (p_numerator < 1e-15) p_numerator = 1e-15;
-        
-        double lr_i = p_numerator / p_denominator;
-        
-        // Limitar valores extremos
-        if (lr_i > 1e3) lr_i = 1e3;
-        if (lr_i < 1e-3) lr_i = 1e-3;
+        // von Mises concentrada (Hp) contra von Mises dispersa (Hd)
+        double lr_i = directionTermLR(diff);
         
         lr_product *= lr_i;
     }
@@ -534,30 +1015,10 @@ double FingerprintLRCalculator::computeLRType(
     double lr_product = 1.0;
     
     for (int i = 0; i < k; ++i) {
-        QString y_type = observed.types[i];
-        int y_idx = observed.typeIndices[i];
-        int x_idx = reference.typeIndices[i];
-        
-        // NUMERADOR: p(y_type | x_type, Hp, v=1)
-        // Usa matriz de confusão de examinadores
-        double p_numerator = 0.75;  // Valor padrão (75% de acerto)
-        
-        if (x_idx >= 0 && x_idx < 3 && y_idx >= 0 && y_idx < 3) {
-            p_numerator = populationData.confusionMatrix[x_idx][y_idx];
-        }
-        
-        // DENOMINADOR: p(y_type | Hd, v=1)
-        // Usa priors da população brasileira
-        double p_denominator = populationData.typeFrequencies.value(y_type, 0.01);
-        
-        if (p_denominator < 1e-6) p_denominator = 1e-6;
-        if (p_numerator < 1e-6) p_numerator = 1e-6;
-        
-        double lr_i = p_numerator / p_denominator;
-        
-        // Limitar valores extremos
-        if (lr_i > 1e2) lr_i = 1e2;
-        if (lr_i < 1e-2) lr_i = 1e-2;
+        // Matriz de confusão (Hp) contra priors da população brasileira (Hd)
+        double lr_i = typeTermLR(observed.types[i],
+                                 observed.typeIndices[i],
+                                 reference.typeIndices[i]);
         
         lr_product *= lr_i;
     }
@@ -568,6 +1029,64 @@ double FingerprintLRCalculator::computeLRType(
     return lr_product;
 }
 
+// ==================== TERMOS INDIVIDUAIS ====================
+
+double FingerprintLRCalculator::shapeTermLR(double y, double x, double* pHp, double* pHd) const {
+    // Numerador N(x, σ) e denominador N(x, 5σ) avaliados em log, com o mesmo
+    // piso de 1e-15 nas densidades para evitar divisão por zero
+    static const double logFloor = std::log(1e-15);
+    double logNumerator = std::max(shapeDensityHp.logPdf(y, x), logFloor);
+    double logDenominator = std::max(shapeDensityHd.logPdf(y, x), logFloor);
+    
+    if (pHp) *pHp = std::exp(logNumerator);
+    if (pHd) *pHd = std::exp(logDenominator);
+    
+    double lr_i = std::exp(logNumerator - logDenominator);
+    
+    // Limitar valores extremos por triângulo
+    if (lr_i > 1e6) lr_i = 1e6;
+    if (lr_i < 1e-6) lr_i = 1e-6;
+    
+    return lr_i;
+}
+
+double FingerprintLRCalculator::directionTermLR(double diff) const {
+    static const double logFloor = std::log(1e-15);
+    double logNumerator = std::max(directionDensityHp.logPdf(diff), logFloor);
+    double logDenominator = std::max(directionDensityHd.logPdf(diff), logFloor);
+    
+    double lr_i = std::exp(logNumerator - logDenominator);
+    
+    // Limitar valores extremos
+    if (lr_i > 1e3) lr_i = 1e3;
+    if (lr_i < 1e-3) lr_i = 1e-3;
+    
+    return lr_i;
+}
+
+double FingerprintLRCalculator::typeTermLR(const QString& yType, int yIdx, int xIdx) const {
+    // NUMERADOR: p(y_type | x_type, Hp, v=1) - matriz de confusão de examinadores
+    double p_numerator = 0.75;  // Valor padrão (75% de acerto)
+    
+    if (xIdx >= 0 && xIdx < 3 && yIdx >= 0 && yIdx < 3) {
+        p_numerator = populationData.confusionMatrix[xIdx][yIdx];
+    }
+    
+    // DENOMINADOR: p(y_type | Hd, v=1) - priors da população brasileira
+    double p_denominator = populationData.typeFrequencies.value(yType, 0.01);
+    
+    if (p_denominator < 1e-6) p_denominator = 1e-6;
+    if (p_numerator < 1e-6) p_numerator = 1e-6;
+    
+    double lr_i = p_numerator / p_denominator;
+    
+    // Limitar valores extremos
+    if (lr_i > 1e2) lr_i = 1e2;
+    if (lr_i < 1e-2) lr_i = 1e-2;
+    
+    return lr_i;
+}
+
 double FingerprintLRCalculator::estimatePVHd(int k_minutiae, const QString& pattern) {
     // Estimativa simplificada de p(v=1|Hd)
     // Em implementação real, usaria busca AFIS em banco de referência
@@ -658,6 +1177,32 @@ int FingerprintLRCalculator::mapTypeToIndex(MinutiaeType type) {
     }
 }
 
+QString FingerprintLRCalculator::typeCategoryName(MinutiaeType type) {
+    switch (type) {
+        case MinutiaeType::RIDGE_ENDING_B:
+        case MinutiaeType::RIDGE_ENDING_C:
+            return "ridge_ending";
+        case MinutiaeType::BIFURCATION:
+        case MinutiaeType::BTUS:
+        case MinutiaeType::BTUI:
+        case MinutiaeType::BTBS:
+        case MinutiaeType::BTBI:
+            return "bifurcation";
+        case MinutiaeType::CONVERGENCE:
+        case MinutiaeType::CTUS:
+        case MinutiaeType::CTUI:
+        case MinutiaeType::CTCS:
+        case MinutiaeType::CTCI:
+            return "convergence";
+        case MinutiaeType::FRAGMENT_LARGE:
+            return "fragment_big";
+        case MinutiaeType::FRAGMENT_SMALL:
+            return "fragment_small";
+        default:
+            return "other";
+    }
+}
+
 QString FingerprintLRCalculator::interpretLR(double log10_lr) {
     // Escala ENFSI (European Network of Forensic Science Institutes)
     if (log10_lr < 0) {
@@ -691,40 +1236,6 @@ double FingerprintLRCalculator::angleDifference(double angle1, double angle2) {
 
 // ==================== FUNÇÕES ESTATÍSTICAS ====================
 
-double FingerprintLRCalculator::gaussianPDF(double x, double mean, double stddev) const {
-    if (stddev < 1e-9) return 0.0;
-    
-    double z = (x - mean) / stddev;
-    double coefficient = 1.0 / (stddev * std::sqrt(2.0 * M_PI));
-    return coefficient * std::exp(-0.5 * z * z);
-}
-
-double FingerprintLRCalculator::vonMisesPDF(double x, double mu, double kappa) const {
-    // Distribuição von Mises (circular)
-    // Aproximação simplificada para I_0(kappa) usando série de Taylor
-    
-    if (kappa < 1e-6) {
-        // Uniforme quando kappa → 0
-        return 1.0 / (2.0 * M_PI);
-    }
-    
-    // Bessel I_0(kappa) aproximado
-    double i0_kappa = 1.0;
-    if (kappa < 3.75) {
-        double t = kappa / 3.75;
-        double t2 = t * t;
-        i0_kappa = 1.0 + 3.5156229*t2 + 3.0899424*t2*t2 + 
-                   1.2067492*t2*t2*t2 + 0.2659732*t2*t2*t2*t2;
-    } else {
-        double t = 3.75 / kappa;
-        i0_kappa = (std::exp(kappa) / std::sqrt(kappa)) * 
-                   (0.39894228 + 0.01328592*t + 0.00225319*t*t);
-    }
-    
-    double normalization = 1.0 / (2.0 * M_PI * i0_kappa);
-    return normalization * std::exp(kappa * std::cos(x - mu));
-}
-
 double FingerprintLRCalculator::estimateStdDev(const QVector<double>& samples) const {
     if (samples.size() < 2) return 1.0;
     
@@ -7,6 +7,8 @@
 #include <QPointF>
 #include <cmath>
 #include "../core/ProjectModel.h"
+#include "LRDensity.h"
+#include "DistortionSimulator.h"
 
 namespace FingerprintEnhancer {
 
@@ -88,11 +90,73 @@ struct LRResult {
     LRCalculationMode mode = LRCalculationMode::COMPLETE;
     int k_minutiae = 0;
     
+    // Parâmetros de Hp efetivamente usados (fixos ou ajustados por simulação TPS)
+    bool distortionSimulated = false;
+    double sigma_hp = 2.0;
+    double kappa_hp = 10.0;
+    
     QString interpretation;  // Interpretação verbal
     
     LRResult() = default;
 };
 
+/**
+ * Configuração da exploração de subconjuntos k-de-n
+ */
+struct LRExplorationConfig {
+    int subsetSize = 0;          // k (0 = usar todos os pares correspondentes)
+    int timeBudgetMs = 3000;     // Orçamento de tempo da exploração
+    int maxThreads = 0;          // 0 = QThread::idealThreadCount()
+    bool pruneByBound = true;    // Poda por limite superior do log10(LR) parcial (só na busca do máximo)
+    int histogramBins = 20;      // Número de classes do histograma
+    int maxStoredSamples = 2000000;  // Limite de amostras guardadas para quantis
+    double maxDistributionSubsets = 200000;  // Acima de C(n,k) = isto, a distribuição é amostrada
+    int distributionSamples = 20000;         // Tamanho da amostra uniforme de subconjuntos
+};
+
+/**
+ * Resultado da exploração de subconjuntos k-de-n
+ *
+ * O máximo vem da busca com poda (ramos que não podem superar o máximo
+ * corrente são contabilizados em prunedSubsets). A distribuição (mínimo,
+ * quantis, histograma, subconjunto mais fraco e influência dos pares) nunca
+ * usa a busca podada: vem da enumeração completa sem poda quando C(n, k) cabe
+ * em maxDistributionSubsets, ou de uma amostra uniforme de subconjuntos.
+ */
+struct LRExplorationResult {
+    int n_pairs = 0;                  // Pares correspondentes disponíveis
+    int k_minutiae = 0;               // Tamanho dos subconjuntos
+    double totalSubsets = 0.0;        // C(n, k) - double para evitar overflow
+    qint64 evaluatedSubsets = 0;
+    qint64 prunedSubsets = 0;
+    bool completed = false;           // false se o orçamento de tempo esgotou
+    qint64 elapsedMs = 0;
+    
+    // Distribuição de log10(LR): enumeração sem poda ou amostra uniforme
+    bool distributionSampled = false;
+    qint64 distributionSubsets = 0;
+    double minLog10 = 0.0;
+    double maxLog10 = 0.0;            // Da busca do máximo, não da distribuição
+    double meanLog10 = 0.0;
+    double medianLog10 = 0.0;
+    double p05Log10 = 0.0;
+    double p95Log10 = 0.0;
+    QVector<int> histogram;
+    double histogramMin = 0.0;
+    double histogramMax = 0.0;
+    
+    // Subconjunto que determina o valor máximo (índice frag1, índice frag2)
+    QVector<QPair<int, int>> drivingSubset;
+    LRResult drivingResult;
+    
+    // Subconjunto de menor LR na distribuição
+    QVector<QPair<int, int>> weakestSubset;
+    
+    // Influência de cada par: média log10(LR) com o par - média sem o par
+    QVector<double> pairInfluence;
+    QVector<QPair<int, int>> pairs;
+};
+
 /**
  * Triângulo para cálculo de shape features
  */
@@ -154,6 +218,32 @@ public:
         double rarity = 0.001
     );
     
+    /**
+     * Exploração de subconjuntos k-de-n dos pares correspondentes
+     *
+     * Em vez de usar as k primeiras minúcias (dependente da ordem de marcação),
+     * enumera em paralelo os subconjuntos de k pares com branch-and-bound sobre
+     * o log10(LR) parcial, respeitando um orçamento de tempo.
+     *
+     * Limitação: o pareamento é fixo. Só se escolhe quais pares da lista
+     * entram no subconjunto; pareamentos alternativos de uma mesma minúcia
+     * (outra candidata no fragmento 2) não são explorados, então o resultado
+     * herda os erros de correspondência do alinhamento que gerou a lista.
+     *
+     * @param correspondences Pares (índice frag1, índice frag2); se vazio,
+     *        usa o pareamento por índice de calculateLR
+     * @return Distribuição do LR e subconjunto que determina o valor máximo
+     */
+    LRExplorationResult exploreSubsets(
+        const Fragment* fragment1,
+        const Fragment* fragment2,
+        const QVector<QPair<int, int>>& correspondences,
+        LRCalculationMode mode = LRCalculationMode::COMPLETE,
+        const QString& pattern = QString(),
+        double rarity = 0.001,
+        const LRExplorationConfig& config = LRExplorationConfig()
+    );
+    
     // ==================== EXTRAÇÃO DE FEATURES ====================
     
     ShapeFeatures extractShapeFeatures(const QVector<Minutia>& minutiae);
@@ -163,6 +253,14 @@ public:
     );
     TypeFeatures extractTypeFeatures(const QVector<Minutia>& minutiae);
     
+    // Variantes sem log, para laços de exploração e simulação
+    static ShapeFeatures buildShapeFeatures(const QVector<Minutia>& minutiae);
+    static DirectionFeatures buildDirectionFeatures(
+        const QVector<Minutia>& minutiae,
+        const QPointF& centroid
+    );
+    static TypeFeatures buildTypeFeatures(const QVector<Minutia>& minutiae);
+    
     // ==================== CÁLCULO DOS COMPONENTES ====================
     
     /**
@@ -222,6 +320,11 @@ public:
      */
     static int mapTypeToIndex(MinutiaeType type);
     
+    /**
+     * Nome da categoria de tipo usada nos priors populacionais
+     */
+    static QString typeCategoryName(MinutiaeType type);
+    
     /**
      * Interpretação verbal do LR (escala ENFSI)
      */
@@ -241,7 +344,22 @@ public:
     
     void setUseBrazilianPriors(bool use) { useBrazilianPriors = use; }
     void setRarityFactor(double factor) { rarityFactor = factor; }
-    void setDistortionStdDev(double stddev) { distortionStdDev = stddev; }
+    void setDistortionStdDev(double stddev);
+    
+    /**
+     * Ajusta σ/κ de Hp por simulação de distorção TPS da configuração de
+     * referência (fragmento 2) em vez do σ fixo de setDistortionStdDev.
+     * O Hd continua derivado de setDistortionStdDev.
+     */
+    void setUseSimulatedDistortion(bool use,
+                                   const DistortionSimulationConfig& config = DistortionSimulationConfig());
+    bool useSimulatedDistortion() const { return m_useSimulatedDistortion; }
+    
+    /**
+     * Aplica um modelo de distorção ao lado Hp (σ_hp ≤ σ_hd e κ_hp ≥ κ_hd,
+     * para que cada termo continue máximo em diferença nula)
+     */
+    void applyDistortionModel(const DistortionModel& model);
     
     // Obter dados da população
     const BrazilianPopulationData& getPopulationData() const { return populationData; }
@@ -255,16 +373,41 @@ private:
     double rarityFactor;          // Fator multiplicativo para p(v=1|Hd)
     double distortionStdDev;      // Desvio padrão para modelo de distorção
     
+    // Densidades com normalização pré-calculada (Hp/Hd)
+    GaussianDensity shapeDensityHp;
+    GaussianDensity shapeDensityHd;
+    VonMisesDensity directionDensityHp;
+    VonMisesDensity directionDensityHd;
+    
+    // Distorção simulada (TPS) para o lado Hp
+    bool m_useSimulatedDistortion;
+    DistortionSimulationConfig m_distortionSimulation;
+    void prepareHpDensities(const QVector<Minutia>& reference, double pixelsPerMM);
+    
     // Logging detalhado
     bool m_detailedLogging;
     QString m_logFilePath;
     void logToFile(const QString& message);
     
     // Funções auxiliares para cálculos estatísticos
-    double gaussianPDF(double x, double mean, double stddev) const;
-    double vonMisesPDF(double x, double mu, double kappa) const;
     double estimateStdDev(const QVector<double>& samples) const;
     double estimateMean(const QVector<double>& samples) const;
+    
+    // Termos individuais do LR (já limitados aos extremos de cada componente)
+    double shapeTermLR(double y, double x, double* pHp = nullptr, double* pHd = nullptr) const;
+    double directionTermLR(double diff) const;
+    double typeTermLR(const QString& yType, int yIdx, int xIdx) const;
+    
+    /**
+     * Avalia um subconjunto já pareado sem log; retorna log10(LR_total)
+     */
+    double evaluateSubset(
+        const QVector<Minutia>& m1,
+        const QVector<Minutia>& m2,
+        LRCalculationMode mode,
+        double p_v_hd,
+        LRResult* details = nullptr
+    ) const;
 };
 
 } // namespace FingerprintEnhancer
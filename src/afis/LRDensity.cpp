@@ -0,0 +1,123 @@
+#include "LRDensity.h"
+#include <QDebug>
+#include <QtMath>
+#include <algorithm>
+
+namespace FingerprintEnhancer {
+
+// ==================== VonMisesDensity ====================
+
+VonMisesDensity::VonMisesDensity(double kappa)
+    : m_kappa(kappa)
+{
+    if (kappa < 1e-6) {
+        // Uniforme quando kappa → 0
+        m_kappa = 0.0;
+        m_logNorm = std::log(2.0 * M_PI);
+    } else {
+        m_logNorm = std::log(2.0 * M_PI) + logBesselI0(kappa);
+    }
+}
+
+double VonMisesDensity::logBesselI0(double kappa) {
+    if (kappa < 3.75) {
+        double t = kappa / 3.75;
+        double t2 = t * t;
+        return std::log(1.0 + 3.5156229*t2 + 3.0899424*t2*t2 +
+                        1.2067492*t2*t2*t2 + 0.2659732*t2*t2*t2*t2);
+    }
+
+    double t = 3.75 / kappa;
+    return kappa - 0.5 * std::log(kappa) +
+           std::log(0.39894228 + 0.01328592*t + 0.00225319*t*t);
+}
+
+// ==================== GaussianDensity ====================
+
+GaussianDensity::GaussianDensity(double stddev)
+    : m_stddev(stddev)
+    , m_invStdDev(0.0)
+    , m_logNorm(0.0)
+    , m_valid(stddev >= 1e-9)
+{
+    if (m_valid) {
+        m_invStdDev = 1.0 / stddev;
+        m_logNorm = std::log(stddev * std::sqrt(2.0 * M_PI));
+    }
+}
+
+// ==================== LRDensityCheck ====================
+
+namespace {
+
+// Fórmulas diretas do modelo original, mantidas como referência da verificação
+double referenceGaussianPDF(double x, double mean, double stddev) {
+    if (stddev < 1e-9) return 0.0;
+
+    double z = (x - mean) / stddev;
+    double coefficient = 1.0 / (stddev * std::sqrt(2.0 * M_PI));
+    return coefficient * std::exp(-0.5 * z * z);
+}
+
+double referenceVonMisesPDF(double x, double mu, double kappa) {
+    if (kappa < 1e-6) return 1.0 / (2.0 * M_PI);
+
+    double i0_kappa = 1.0;
+    if (kappa < 3.75) {
+        double t = kappa / 3.75;
+        double t2 = t * t;
+        i0_kappa = 1.0 + 3.5156229*t2 + 3.0899424*t2*t2 +
+                   1.2067492*t2*t2*t2 + 0.2659732*t2*t2*t2*t2;
+    } else {
+        double t = 3.75 / kappa;
+        i0_kappa = (std::exp(kappa) / std::sqrt(kappa)) *
+                   (0.39894228 + 0.01328592*t + 0.00225319*t*t);
+    }
+
+    return std::exp(kappa * std::cos(x - mu)) / (2.0 * M_PI * i0_kappa);
+}
+
+double relativeError(double value, double reference) {
+    if (reference == 0.0) return std::abs(value);
+    return std::abs(value - reference) / std::abs(reference);
+}
+
+} // namespace
+
+double LRDensityCheck::verifyAccuracy(bool verbose) {
+    const double kappas[] = {0.0, 0.5, 1.0, 2.0, 3.7, 3.8, 10.0, 50.0};
+    const double sigmas[] = {1e-10, 0.01, 0.5, 2.0, 10.0};
+
+    double maxVonMisesError = 0.0;
+    for (double kappa : kappas) {
+        VonMisesDensity density(kappa);
+        for (int i = 0; i <= 64; ++i) {
+            double x = -M_PI + 2.0 * M_PI * i / 64.0;
+            double error = relativeError(density.pdf(x, 0.3),
+                                         referenceVonMisesPDF(x, 0.3, kappa));
+            maxVonMisesError = std::max(maxVonMisesError, error);
+        }
+    }
+
+    double maxGaussianError = 0.0;
+    for (double sigma : sigmas) {
+        GaussianDensity density(sigma);
+        for (int i = 0; i <= 64; ++i) {
+            // Até 6σ: além disso ambas as formas caem abaixo do piso de 1e-15 do modelo
+            double x = 1.0 + sigma * (-6.0 + 12.0 * i / 64.0);
+            double error = relativeError(density.pdf(x, 1.0),
+                                         referenceGaussianPDF(x, 1.0, sigma));
+            maxGaussianError = std::max(maxGaussianError, error);
+        }
+    }
+
+    if (verbose) {
+        qDebug() << QString("[LR-Density] Erro relativo máximo: von Mises=%1, Gaussiana=%2")
+            .arg(maxVonMisesError, 0, 'e', 2)
+            .arg(maxGaussianError, 0, 'e', 2);
+    }
+
+    return std::max(maxVonMisesError, maxGaussianError);
+}
+
+} // namespace FingerprintEnhancer
@@ -0,0 +1,86 @@
+#ifndef LRDENSITY_H
+#define LRDENSITY_H
+
+#include <cmath>
+#include <limits>
+
+namespace FingerprintEnhancer {
+
+/**
+ * @brief Densidade von Mises com normalização pré-calculada
+ *
+ * log f(x) = κ·cos(x - μ) - log(2π·I₀(κ)); a constante log(2π·I₀(κ)) é
+ * calculada uma vez por κ, evitando repetir a aproximação de Bessel e
+ * o exp() nos laços por minúcia.
+ */
+class VonMisesDensity {
+public:
+    explicit VonMisesDensity(double kappa = 0.0);
+
+    double kappa() const { return m_kappa; }
+
+    double logPdf(double x, double mu = 0.0) const {
+        return m_kappa * std::cos(x - mu) - m_logNorm;
+    }
+
+    double pdf(double x, double mu = 0.0) const {
+        return std::exp(logPdf(x, mu));
+    }
+
+    /**
+     * log I₀(κ) pela aproximação de Abramowitz-Stegun usada no modelo de LR
+     * (calculada em log para não estourar com κ grande)
+     */
+    static double logBesselI0(double kappa);
+
+private:
+    double m_kappa;
+    double m_logNorm;  // log(2π·I₀(κ))
+};
+
+/**
+ * @brief Densidade normal com coeficiente pré-calculado
+ */
+class GaussianDensity {
+public:
+    explicit GaussianDensity(double stddev = 1.0);
+
+    double stddev() const { return m_stddev; }
+    bool isValid() const { return m_valid; }
+
+    double logPdf(double x, double mean) const {
+        if (!m_valid) return -std::numeric_limits<double>::infinity();
+        double z = (x - mean) * m_invStdDev;
+        return -0.5 * z * z - m_logNorm;
+    }
+
+    double pdf(double x, double mean) const {
+        return m_valid ? std::exp(logPdf(x, mean)) : 0.0;
+    }
+
+private:
+    double m_stddev;
+    double m_invStdDev;
+    double m_logNorm;  // log(σ·√(2π))
+    bool m_valid;      // σ degenerado (< 1e-9) → densidade nula, como gaussianPDF
+};
+
+/**
+ * @brief Conferência das densidades pré-calculadas contra as fórmulas diretas
+ *
+ * As densidades são construídas quando os parâmetros do modelo mudam e
+ * guardadas pelo próprio calculador; não há cache global por parâmetro.
+ */
+class LRDensityCheck {
+public:
+    /**
+     * @brief Compara as densidades pré-calculadas com as fórmulas diretas do modelo
+     * @param verbose Imprimir o erro de cada família
+     * @return Maior erro relativo encontrado na grade de verificação
+     */
+    static double verifyAccuracy(bool verbose = false);
+};
+
+} // namespace FingerprintEnhancer
+
+#endif // LRDENSITY_H
@@ -0,0 +1,318 @@
+#include "ScoreCalibrationBuilder.h"
+#include "LRDensity.h"
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <QDebug>
+#include <algorithm>
+#include <atomic>
+
+namespace FingerprintEnhancer {
+
+namespace {
+
+// Par do corpus a ser comparado; o score é preenchido pela tarefa paralela
+struct CalibrationPair {
+    int first;
+    int second;
+    bool genuine;
+    double score;
+};
+
+double silvermanBandwidth(const QVector<double>& values) {
+    if (values.size() < 2) return 0.05;
+
+    double mean = 0.0;
+    for (double v : values) mean += v;
+    mean /= values.size();
+
+    double var = 0.0;
+    for (double v : values) var += (v - mean) * (v - mean);
+    double sd = std::sqrt(var / (values.size() - 1));
+
+    return std::max(1e-3, 1.06 * sd * std::pow(values.size(), -0.2));
+}
+
+/**
+ * Densidade KDE nos nós da grade, a partir de contagens em classes finas
+ * (evita O(nós × amostras) com centenas de milhares de impostores)
+ */
+QVector<double> binnedKDE(const QVector<double>& values, const QVector<double>& grid,
+                          double lo, double hi, double bandwidth) {
+    const int bins = 2048;
+    QVector<double> counts(bins, 0.0);
+    double width = (hi - lo) / bins;
+    for (double v : values) {
+        int b = static_cast<int>((v - lo) / width);
+        counts[std::clamp(b, 0, bins - 1)] += 1.0;
+    }
+
+    GaussianDensity kernel(bandwidth);
+    int reach = static_cast<int>(std::ceil(5.0 * bandwidth / width));
+
+    // Piso conservador: equivalente a uma observação a 3 larguras de banda
+    double floor = kernel.pdf(3.0 * bandwidth, 0.0) / (values.size() + 1);
+
+    QVector<double> density(grid.size(), 0.0);
+    for (int g = 0; g < grid.size(); ++g) {
+        int center = static_cast<int>((grid[g] - lo) / width);
+        double sum = 0.0;
+        for (int b = std::max(0, center - reach); b <= std::min(bins - 1, center + reach); ++b) {
+            if (counts[b] == 0.0) continue;
+            double binCenter = lo + (b + 0.5) * width;
+            sum += counts[b] * kernel.pdf(grid[g], binCenter);
+        }
+        density[g] = std::max(sum / std::max(1, static_cast<int>(values.size())), floor);
+    }
+
+    return density;
+}
+
+} // namespace
+
+ScoreCalibrationBuilder::ScoreCalibrationBuilder(const AFISLikelihoodConfig& matcherConfig)
+    : m_matcherConfig(matcherConfig)
+{
+    // Milhares de comparações: log detalhado do matcher desligado
+    m_matcherConfig.verbose = false;
+}
+
+QVector<CalibrationSample> ScoreCalibrationBuilder::loadCorpus(const QString& directory) {
+    QVector<CalibrationSample> corpus;
+
+    QDir dir(directory);
+    if (!dir.exists()) {
+        qWarning() << "[LR-Calibration] Diretório do corpus não existe:" << directory;
+        return corpus;
+    }
+
+    QFileInfoList files = dir.entryInfoList(QStringList() << "*.json", QDir::Files, QDir::Name);
+    for (const QFileInfo& fileInfo : files) {
+        QFile file(fileInfo.absoluteFilePath());
+        if (!file.open(QIODevice::ReadOnly)) continue;
+
+        QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+        file.close();
+        if (!doc.isObject()) {
+            qWarning() << "[LR-Calibration] JSON inválido ignorado:" << fileInfo.fileName();
+            continue;
+        }
+
+        QJsonObject root = doc.object();
+        CalibrationSample sample;
+        sample.sourcePath = fileInfo.absoluteFilePath();
+        sample.subjectId = root["subject"].toString();
+        if (sample.subjectId.isEmpty()) {
+            QString base = fileInfo.completeBaseName();
+            int sep = base.lastIndexOf('_');
+            sample.subjectId = (sep > 0) ? base.left(sep) : base;
+        }
+
+        for (const QJsonValue& value : root["minutiae"].toArray()) {
+            QJsonObject m = value.toObject();
+            Minutia minutia(QPoint(m["x"].toInt(), m["y"].toInt()),
+                            static_cast<MinutiaeType>(m["type"].toInt()));
+            minutia.angle = m["angle"].toDouble();
+            minutia.quality = m["quality"].toDouble();
+            sample.minutiae.append(minutia);
+        }
+
+        if (!sample.minutiae.isEmpty()) {
+            corpus.append(sample);
+        }
+    }
+
+    qDebug() << QString("[LR-Calibration] Corpus: %1 impressões de %2")
+        .arg(corpus.size()).arg(directory);
+
+    return corpus;
+}
+
+void ScoreCalibrationBuilder::computeScores(const QVector<CalibrationSample>& corpus,
+                                            const ScoreCalibrationConfig& config,
+                                            std::function<void(int, int)> progress) {
+    m_genuine.clear();
+    m_impostor.clear();
+
+    // Todos os pares genuínos; impostores opcionalmente limitados por impressão
+    QVector<CalibrationPair> pairs;
+    for (int i = 0; i < corpus.size(); ++i) {
+        int impostors = 0;
+        for (int j = i + 1; j < corpus.size(); ++j) {
+            bool genuine = (corpus[i].subjectId == corpus[j].subjectId);
+            if (!genuine && config.maxImpostorsPerSample > 0 &&
+                impostors >= config.maxImpostorsPerSample) {
+                continue;
+            }
+            if (!genuine) impostors++;
+            pairs.append({i, j, genuine, 0.0});
+        }
+    }
+
+    const int total = pairs.size();
+    std::atomic<int> done{0};
+    const AFISLikelihoodConfig matcherConfig = m_matcherConfig;
+
+    auto scorePair = [&](CalibrationPair& pair) {
+        AFISLikelihoodCalculator calculator(matcherConfig);
+        const auto& m1 = corpus[pair.first].minutiae;
+        const auto& m2 = corpus[pair.second].minutiae;
+        // Semente pelo índice do par: o RANSAC de cada par não depende da ordem das threads
+        const quint32 seed = static_cast<quint32>(pair.first * corpus.size() + pair.second);
+        QVector<QPair<int, int>> correspondences = calculator.findCorrespondences(m1, m2, seed);
+        pair.score = calculator.calculateSimilarityScore(m1, m2, correspondences);
+
+        int finished = ++done;
+        if (progress && (finished % 64 == 0 || finished == total)) {
+            progress(finished, total);
+        }
+    };
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(config.maxThreads > 0 ? config.maxThreads
+                                                 : QThread::idealThreadCount());
+    QtConcurrent::blockingMap(&pool, pairs, scorePair);
+
+    for (const auto& pair : pairs) {
+        (pair.genuine ? m_genuine : m_impostor).append(pair.score);
+    }
+
+    qDebug() << QString("[LR-Calibration] %1 scores genuínos, %2 impostores")
+        .arg(m_genuine.size()).arg(m_impostor.size());
+}
+
+ScoreCalibrationTable ScoreCalibrationBuilder::build(const ScoreCalibrationConfig& config) const {
+    ScoreCalibrationTable table = (config.method == CalibrationMethod::PAV)
+        ? buildPAV(m_genuine, m_impostor, config)
+        : buildKDE(m_genuine, m_impostor, config);
+
+    table.matcherSignature = AFISLikelihoodCalculator::calibrationSignature(m_matcherConfig);
+    table.createdAt = QDateTime::currentDateTime().toString(Qt::ISODate);
+    return table;
+}
+
+ScoreCalibrationTable ScoreCalibrationBuilder::buildKDE(const QVector<double>& genuine,
+                                                        const QVector<double>& impostor,
+                                                        const ScoreCalibrationConfig& config) {
+    ScoreCalibrationTable table;
+    table.method = CalibrationMethod::KDE;
+    table.genuineCount = genuine.size();
+    table.impostorCount = impostor.size();
+
+    if (genuine.isEmpty() || impostor.isEmpty()) {
+        qWarning() << "[LR-Calibration] KDE requer scores genuínos e impostores";
+        return table;
+    }
+
+    auto [gMin, gMax] = std::minmax_element(genuine.constBegin(), genuine.constEnd());
+    auto [iMin, iMax] = std::minmax_element(impostor.constBegin(), impostor.constEnd());
+    double lo = std::min(*gMin, *iMin);
+    double hi = std::max(*gMax, *iMax);
+    if (hi - lo < 1e-9) {
+        lo -= 0.5;
+        hi += 0.5;
+    }
+
+    double hGenuine = (config.bandwidth > 0) ? config.bandwidth : silvermanBandwidth(genuine);
+    double hImpostor = (config.bandwidth > 0) ? config.bandwidth : silvermanBandwidth(impostor);
+
+    int nodes = std::max(2, config.tableSize);
+    QVector<double> grid(nodes);
+    for (int g = 0; g < nodes; ++g) {
+        grid[g] = lo + (hi - lo) * g / (nodes - 1);
+    }
+
+    QVector<double> fGenuine = binnedKDE(genuine, grid, lo, hi, hGenuine);
+    QVector<double> fImpostor = binnedKDE(impostor, grid, lo, hi, hImpostor);
+
+    table.scores = grid;
+    table.log10LR.resize(nodes);
+    for (int g = 0; g < nodes; ++g) {
+        double value = std::log10(fGenuine[g]) - std::log10(fImpostor[g]);
+        table.log10LR[g] = std::clamp(value, -config.maxAbsLog10LR, config.maxAbsLog10LR);
+    }
+
+    return table;
+}
+
+ScoreCalibrationTable ScoreCalibrationBuilder::buildPAV(const QVector<double>& genuine,
+                                                        const QVector<double>& impostor,
+                                                        const ScoreCalibrationConfig& config) {
+    ScoreCalibrationTable table;
+    table.method = CalibrationMethod::PAV;
+    table.genuineCount = genuine.size();
+    table.impostorCount = impostor.size();
+
+    if (genuine.isEmpty() || impostor.isEmpty()) {
+        qWarning() << "[LR-Calibration] PAV requer scores genuínos e impostores";
+        return table;
+    }
+
+    // (score, rótulo) ordenados; empates agrupados no mesmo bloco inicial
+    QVector<QPair<double, int>> labelled;
+    labelled.reserve(genuine.size() + impostor.size());
+    for (double s : genuine) labelled.append(qMakePair(s, 1));
+    for (double s : impostor) labelled.append(qMakePair(s, 0));
+    std::sort(labelled.begin(), labelled.end());
+
+    struct Block {
+        double sum;
+        double count;
+        double minScore;
+        double maxScore;
+    };
+
+    QVector<Block> blocks;
+    for (int i = 0; i < labelled.size(); ) {
+        Block block{0.0, 0.0, labelled[i].first, labelled[i].first};
+        double score = labelled[i].first;
+        while (i < labelled.size() && labelled[i].first == score) {
+            block.sum += labelled[i].second;
+            block.count += 1.0;
+            ++i;
+        }
+
+        blocks.append(block);
+
+        // Pool Adjacent Violators: fundir enquanto a posterior não for crescente
+        while (blocks.size() > 1) {
+            const Block& last = blocks[blocks.size() - 1];
+            const Block& prev = blocks[blocks.size() - 2];
+            if (prev.sum / prev.count < last.sum / last.count) break;
+
+            Block merged{prev.sum + last.sum, prev.count + last.count,
+                         prev.minScore, last.maxScore};
+            blocks.removeLast();
+            blocks.last() = merged;
+        }
+    }
+
+    // Posterior → LR, removendo o efeito da proporção genuínos/impostores do corpus
+    const double n = labelled.size();
+    const double eps = 1.0 / (2.0 * n);
+    const double priorOdds = static_cast<double>(genuine.size()) / impostor.size();
+
+    for (const Block& block : blocks) {
+        double p = std::clamp(block.sum / block.count, eps, 1.0 - eps);
+        double value = std::log10(p / (1.0 - p)) - std::log10(priorOdds);
+        value = std::clamp(value, -config.maxAbsLog10LR, config.maxAbsLog10LR);
+
+        table.scores.append(block.minScore);
+        table.log10LR.append(value);
+        if (block.maxScore > block.minScore) {
+            table.scores.append(block.maxScore);
+            table.log10LR.append(value);
+        }
+    }
+
+    return table;
+}
+
+} // namespace FingerprintEnhancer
@@ -0,0 +1,81 @@
+#ifndef SCORECALIBRATIONBUILDER_H
+#define SCORECALIBRATIONBUILDER_H
+
+#include <QVector>
+#include <QString>
+#include <functional>
+#include "../core/ProjectModel.h"
+#include "AFISLikelihoodCalculator.h"
+#include "ScoreCalibrationTable.h"
+
+namespace FingerprintEnhancer {
+
+/**
+ * @brief Impressão rotulada do corpus de calibração
+ */
+struct CalibrationSample {
+    QString subjectId;            // Mesma origem ⇔ mesmo subjectId
+    QString sourcePath;
+    QVector<Minutia> minutiae;
+};
+
+/**
+ * @brief Parâmetros de construção da tabela
+ */
+struct ScoreCalibrationConfig {
+    CalibrationMethod method = CalibrationMethod::KDE;
+    int tableSize = 256;              // Nós da tabela (KDE)
+    double bandwidth = 0.0;           // Largura do kernel (0 = regra de Silverman)
+    double maxAbsLog10LR = 15.0;      // Mesmo limite usado pelas calculadoras
+    int maxImpostorsPerSample = 0;    // 0 = todos os pares de origens diferentes
+    int maxThreads = 0;               // 0 = QThread::idealThreadCount()
+};
+
+/**
+ * @brief Construção offline de tabelas de calibração a partir de um corpus rotulado
+ *
+ * Executa o matcher (AFISLikelihoodCalculator) sobre todos os pares do corpus
+ * em paralelo, separa scores genuínos e impostores e gera a tabela score → LR.
+ * Deve ser refeito sempre que o matcher mudar (ver AFISLikelihoodCalculator::calibrationSignature).
+ */
+class ScoreCalibrationBuilder {
+public:
+    explicit ScoreCalibrationBuilder(const AFISLikelihoodConfig& matcherConfig = AFISLikelihoodConfig());
+
+    /**
+     * @brief Carrega o corpus de um diretório de arquivos JSON de minúcias
+     *
+     * Formato: {"subject": "...", "minutiae": [{"x", "y", "angle", "type", "quality"}]}.
+     * Sem "subject", usa o prefixo do nome do arquivo até o último '_' (ex.: 101_3.json).
+     */
+    static QVector<CalibrationSample> loadCorpus(const QString& directory);
+
+    /**
+     * @brief Calcula scores genuínos e impostores em paralelo
+     * @param progress Callback opcional (pares concluídos, total); chamado de threads do pool
+     */
+    void computeScores(const QVector<CalibrationSample>& corpus,
+                       const ScoreCalibrationConfig& config = ScoreCalibrationConfig(),
+                       std::function<void(int, int)> progress = nullptr);
+
+    const QVector<double>& genuineScores() const { return m_genuine; }
+    const QVector<double>& impostorScores() const { return m_impostor; }
+
+    ScoreCalibrationTable build(const ScoreCalibrationConfig& config = ScoreCalibrationConfig()) const;
+
+    static ScoreCalibrationTable buildKDE(const QVector<double>& genuine,
+                                          const QVector<double>& impostor,
+                                          const ScoreCalibrationConfig& config);
+    static ScoreCalibrationTable buildPAV(const QVector<double>& genuine,
+                                          const QVector<double>& impostor,
+                                          const ScoreCalibrationConfig& config);
+
+private:
+    AFISLikelihoodConfig m_matcherConfig;
+    QVector<double> m_genuine;
+    QVector<double> m_impostor;
+};
+
+} // namespace FingerprintEnhancer
+
+#endif // SCORECALIBRATIONBUILDER_H
@@ -0,0 +1,136 @@
+#include "ScoreCalibrationTable.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QStandardPaths>
+#include <QMutex>
+#include <QDebug>
+#include <algorithm>
+
+namespace FingerprintEnhancer {
+
+double ScoreCalibrationTable::lookupLog10LR(double score) const {
+    if (!isValid()) return 0.0;
+
+    if (score <= scores.first()) return log10LR.first();
+    if (score >= scores.last()) return log10LR.last();
+
+    // Primeiro nó com score maior que o consultado
+    auto it = std::upper_bound(scores.constBegin(), scores.constEnd(), score);
+    int hi = static_cast<int>(it - scores.constBegin());
+    int lo = hi - 1;
+
+    double span = scores[hi] - scores[lo];
+    if (span <= 0.0) return log10LR[hi];
+
+    double t = (score - scores[lo]) / span;
+    return log10LR[lo] + t * (log10LR[hi] - log10LR[lo]);
+}
+
+bool ScoreCalibrationTable::saveToJson(const QString& filePath) const {
+    QJsonArray scoreArray;
+    QJsonArray lrArray;
+    for (int i = 0; i < scores.size(); ++i) {
+        scoreArray.append(scores[i]);
+        lrArray.append(log10LR[i]);
+    }
+
+    QJsonObject root;
+    root["method"] = (method == CalibrationMethod::PAV) ? "pav" : "kde";
+    root["matcher_signature"] = matcherSignature;
+    root["genuine_count"] = genuineCount;
+    root["impostor_count"] = impostorCount;
+    root["created_at"] = createdAt;
+    root["scores"] = scoreArray;
+    root["log10_lr"] = lrArray;
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "[LR-Calibration] Falha ao salvar tabela:" << filePath;
+        return false;
+    }
+
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    file.close();
+    return true;
+}
+
+bool ScoreCalibrationTable::loadFromJson(const QString& filePath) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QJsonDocument doc = QJsonDocument::fromJson(file.readAll());
+    file.close();
+
+    if (doc.isNull() || !doc.isObject()) {
+        qWarning() << "[LR-Calibration] Tabela inválida:" << filePath;
+        return false;
+    }
+
+    QJsonObject root = doc.object();
+    method = (root["method"].toString() == "pav") ? CalibrationMethod::PAV : CalibrationMethod::KDE;
+    matcherSignature = root["matcher_signature"].toString();
+    genuineCount = root["genuine_count"].toInt();
+    impostorCount = root["impostor_count"].toInt();
+    createdAt = root["created_at"].toString();
+
+    scores.clear();
+    log10LR.clear();
+    QJsonArray scoreArray = root["scores"].toArray();
+    QJsonArray lrArray = root["log10_lr"].toArray();
+    for (int i = 0; i < std::min(scoreArray.size(), lrArray.size()); ++i) {
+        scores.append(scoreArray[i].toDouble());
+        log10LR.append(lrArray[i].toDouble());
+    }
+
+    if (!isValid() || !std::is_sorted(scores.constBegin(), scores.constEnd())) {
+        qWarning() << "[LR-Calibration] Nós da tabela inconsistentes:" << filePath;
+        scores.clear();
+        log10LR.clear();
+        return false;
+    }
+
+    return true;
+}
+
+QString ScoreCalibrationTable::defaultPath() {
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) +
+           "/calibration/afis_score_calibration.json";
+}
+
+ScoreCalibrationTable ScoreCalibrationTable::loadDefault() {
+    static QMutex mutex;
+    static ScoreCalibrationTable cached;
+    static QDateTime cachedModified;
+
+    QMutexLocker locker(&mutex);
+
+    QFileInfo info(defaultPath());
+    if (!info.exists()) {
+        cached = ScoreCalibrationTable();
+        cachedModified = QDateTime();
+        return cached;
+    }
+
+    if (info.lastModified() != cachedModified) {
+        ScoreCalibrationTable table;
+        if (table.loadFromJson(info.absoluteFilePath())) {
+            qDebug() << QString("[LR-Calibration] Tabela carregada: %1 nós (%2 genuínos, %3 impostores)")
+                .arg(table.scores.size()).arg(table.genuineCount).arg(table.impostorCount);
+        }
+        cached = table;
+        cachedModified = info.lastModified();
+    }
+
+    return cached;
+}
+
+} // namespace FingerprintEnhancer
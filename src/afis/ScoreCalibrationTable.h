@@ -0,0 +1,56 @@
+#ifndef SCORECALIBRATIONTABLE_H
+#define SCORECALIBRATIONTABLE_H
+
+#include <QVector>
+#include <QString>
+#include <cmath>
+
+namespace FingerprintEnhancer {
+
+/**
+ * @brief Método de calibração score → LR
+ */
+enum class CalibrationMethod {
+    KDE,    // Razão de densidades por kernel gaussiano (genuínos / impostores)
+    PAV     // Regressão isotônica (Pool Adjacent Violators) da posterior
+};
+
+/**
+ * @brief Tabela compacta score → log10(LR)
+ *
+ * Nós ordenados por score; a consulta é uma busca binária com interpolação
+ * linear (O(log n)). Fora do intervalo tabulado, usa o valor da extremidade.
+ */
+struct ScoreCalibrationTable {
+    CalibrationMethod method = CalibrationMethod::KDE;
+    QString matcherSignature;     // Versão/opções do matcher que geraram os scores
+    int genuineCount = 0;
+    int impostorCount = 0;
+    QString createdAt;
+
+    QVector<double> scores;       // Nós (crescentes)
+    QVector<double> log10LR;      // log10(LR) em cada nó
+
+    bool isValid() const { return scores.size() >= 2 && scores.size() == log10LR.size(); }
+
+    double lookupLog10LR(double score) const;
+    double lookupLR(double score) const { return std::pow(10.0, lookupLog10LR(score)); }
+
+    bool saveToJson(const QString& filePath) const;
+    bool loadFromJson(const QString& filePath);
+
+    /**
+     * @brief Caminho padrão da tabela (AppDataLocation/calibration)
+     */
+    static QString defaultPath();
+
+    /**
+     * @brief Tabela padrão, recarregada quando o arquivo muda (thread-safe)
+     * @return Tabela inválida se não houver calibração salva
+     */
+    static ScoreCalibrationTable loadDefault();
+};
+
+} // namespace FingerprintEnhancer
+
+#endif // SCORECALIBRATIONTABLE_H
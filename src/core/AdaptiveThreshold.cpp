@@ -0,0 +1,107 @@
+#include "AdaptiveThreshold.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace {
+
+const int kRowsPerBand = 64;
+
+// Metade da faixa de valores da profundidade (R do Sauvola)
+double halfRange(int depth) {
+    switch (depth) {
+        case CV_8U:  return 128.0;
+        case CV_16U: return 32768.0;
+        default:     return 0.5;    // Ponto flutuante em [0, 1]
+    }
+}
+
+} // namespace
+
+QString LocalThresholdConfig::toString() const {
+    return QString("method=%1, window=%2px, k=%3")
+        .arg(method == LocalThresholdMethod::Sauvola ? "Sauvola" : "Niblack")
+        .arg(windowSize).arg(k, 0, 'f', 2);
+}
+
+double LocalThresholdConfig::defaultK(LocalThresholdMethod method) {
+    return method == LocalThresholdMethod::Sauvola ? 0.34 : -0.2;
+}
+
+cv::Mat AdaptiveThreshold::apply(const cv::Mat& image, const LocalThresholdConfig& config,
+                                 const ProgressCallback& progress) {
+    if (image.empty()) return cv::Mat();
+
+    cv::Mat gray;
+    if (image.channels() > 1) {
+        cv::cvtColor(image, gray, image.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    } else {
+        gray = image;
+    }
+    if (gray.depth() != CV_8U && gray.depth() != CV_16U && gray.depth() != CV_32F) {
+        gray.convertTo(gray, CV_32F);
+    }
+
+    // Somas em double: a integral dos quadrados de uma imagem 16 bits excede 32 bits
+    cv::Mat sum, sqsum;
+    cv::integral(gray, sum, sqsum, CV_64F, CV_64F);
+
+    const int r = std::max(1, config.windowSize / 2);
+    const double R = config.dynamicRange > 0.0 ? config.dynamicRange : halfRange(gray.depth());
+    const double k = config.k;
+    const bool sauvola = config.method == LocalThresholdMethod::Sauvola;
+
+    cv::Mat value;
+    gray.convertTo(value, CV_32F);
+    cv::Mat result(gray.size(), CV_8U);
+
+    const int bands = (gray.rows + kRowsPerBand - 1) / kRowsPerBand;
+    std::atomic<int> done{0};
+    std::atomic<bool> cancelled{false};
+
+    cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range& range) {
+        for (int band = range.start; band < range.end; ++band) {
+            if (cancelled.load()) return;
+
+            const int yEnd = std::min(gray.rows, (band + 1) * kRowsPerBand);
+            for (int y = band * kRowsPerBand; y < yEnd; ++y) {
+                const int y0 = std::max(0, y - r);
+                const int y1 = std::min(gray.rows, y + r + 1);
+                const double* s0 = sum.ptr<double>(y0);
+                const double* s1 = sum.ptr<double>(y1);
+                const double* q0 = sqsum.ptr<double>(y0);
+                const double* q1 = sqsum.ptr<double>(y1);
+                const float* src = value.ptr<float>(y);
+                uchar* dst = result.ptr<uchar>(y);
+
+                for (int x = 0; x < gray.cols; ++x) {
+                    const int x0 = std::max(0, x - r);
+                    const int x1 = std::min(gray.cols, x + r + 1);
+                    const double n = static_cast<double>(x1 - x0) * (y1 - y0);
+
+                    const double mean = (s1[x1] - s1[x0] - s0[x1] + s0[x0]) / n;
+                    const double variance = (q1[x1] - q1[x0] - q0[x1] + q0[x0]) / n - mean * mean;
+                    const double deviation = std::sqrt(std::max(0.0, variance));
+
+                    const double threshold = sauvola ? mean * (1.0 + k * (deviation / R - 1.0))
+                                                     : mean + k * deviation;
+                    dst[x] = src[x] > threshold ? 255 : 0;
+                }
+            }
+
+            int finished = ++done;
+            if (progress && !progress(finished, bands)) {
+                cancelled = true;
+            }
+        }
+    });
+
+    if (cancelled.load()) return cv::Mat();
+    return result;
+}
+
+int AdaptiveThreshold::windowFromMillimetres(double millimetres, double pixelsPerMM) {
+    const int pixels = static_cast<int>(std::lround(millimetres * pixelsPerMM));
+    return std::max(3, pixels | 1);
+}
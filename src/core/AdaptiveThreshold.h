@@ -0,0 +1,60 @@
+#ifndef ADAPTIVETHRESHOLD_H
+#define ADAPTIVETHRESHOLD_H
+
+#include <opencv2/core.hpp>
+#include <QString>
+#include <functional>
+
+/**
+ * @brief Fórmula do limiar local
+ */
+enum class LocalThresholdMethod {
+    Niblack,        // T = m + k·s
+    Sauvola         // T = m·(1 + k·(s/R − 1)): menos ruído no fundo liso
+};
+
+/**
+ * @brief Parâmetros da binarização adaptativa
+ */
+struct LocalThresholdConfig {
+    LocalThresholdMethod method = LocalThresholdMethod::Sauvola;
+    int windowSize = 21;            // Lado da janela (pixels, ímpar)
+    double k = 0.34;                // Sauvola: 0,2-0,5; Niblack: tipicamente −0,2
+    double dynamicRange = 0.0;      // R do Sauvola; 0 = metade da faixa da profundidade
+
+    QString toString() const;
+
+    /**
+     * @brief k recomendado para o método
+     */
+    static double defaultK(LocalThresholdMethod method);
+};
+
+/**
+ * @brief Binarização adaptativa Niblack/Sauvola por imagens integrais
+ *
+ * Média e desvio padrão de cada janela saem da imagem integral e da integral
+ * dos quadrados com quatro acessos cada, então o custo por pixel não depende
+ * do tamanho da janela. Na borda a janela é cortada à imagem (sem extrapolação).
+ * As linhas são divididas em faixas processadas em paralelo.
+ *
+ * Saída CV_8U: 255 onde o pixel é maior que o limiar local (vales e fundo),
+ * 0 nas cristas — a mesma polaridade do Otsu global.
+ */
+class AdaptiveThreshold {
+public:
+    using ProgressCallback = std::function<bool(int done, int total)>;
+
+    /**
+     * @return Imagem binária CV_8U, ou vazia se cancelada
+     */
+    static cv::Mat apply(const cv::Mat& image, const LocalThresholdConfig& config = LocalThresholdConfig(),
+                         const ProgressCallback& progress = nullptr);
+
+    /**
+     * @brief Lado da janela em pixels (ímpar, ≥ 3) para um tamanho em milímetros
+     */
+    static int windowFromMillimetres(double millimetres, double pixelsPerMM);
+};
+
+#endif // ADAPTIVETHRESHOLD_H
@@ -0,0 +1,189 @@
+#include "BackgroundEstimator.h"
+#include <opencv2/imgproc.hpp>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+
+/**
+ * Máximo/mínimo deslizante de janela k (van Herk/Gil-Werman) numa linha.
+ * A linha é estendida com r = k/2 valores neutros de cada lado e dividida em
+ * blocos de k: g acumula do início de cada bloco, h do fim. Toda janela cobre
+ * no máximo dois blocos, então o resultado é op(h[x], g[x + k − 1]).
+ */
+template <typename T, typename Op>
+void slidingRow(const T* src, T* dst, int n, int k, T identity, Op op,
+                std::vector<T>& g, std::vector<T>& h) {
+    const int r = k / 2;
+    const int extended = n + 2 * r;
+    const int padded = ((extended + k - 1) / k) * k;
+    g.resize(padded);
+    h.resize(padded);
+
+    auto at = [&](int i) {
+        const int x = i - r;
+        return (x >= 0 && x < n) ? src[x] : identity;
+    };
+
+    for (int block = 0; block < padded; block += k) {
+        g[block] = at(block);
+        for (int i = block + 1; i < block + k; ++i) g[i] = op(g[i - 1], at(i));
+
+        h[block + k - 1] = at(block + k - 1);
+        for (int i = block + k - 2; i >= block; --i) h[i] = op(h[i + 1], at(i));
+    }
+
+    for (int x = 0; x < n; ++x) {
+        dst[x] = op(h[x], g[x + k - 1]);
+    }
+}
+
+template <typename T, typename Op>
+cv::Mat filterRows(const cv::Mat& src, int k, T identity, Op op) {
+    cv::Mat dst(src.size(), src.type());
+    cv::parallel_for_(cv::Range(0, src.rows), [&](const cv::Range& range) {
+        std::vector<T> g, h;
+        for (int y = range.start; y < range.end; ++y) {
+            slidingRow<T>(src.ptr<T>(y), dst.ptr<T>(y), src.cols, k, identity, op, g, h);
+        }
+    });
+    return dst;
+}
+
+// Retângulo k×k separável: linhas, depois colunas (transpostas para acesso contíguo)
+template <typename T, typename Op>
+cv::Mat filterRect(const cv::Mat& src, int k, T identity, Op op) {
+    cv::Mat rows = filterRows<T>(src, k, identity, op);
+    cv::Mat transposed;
+    cv::transpose(rows, transposed);
+    transposed = filterRows<T>(transposed, k, identity, op);
+    cv::transpose(transposed, rows);
+    return rows;
+}
+
+template <typename T>
+cv::Mat closeRectT(const cv::Mat& gray, int k, const BackgroundEstimator::ProgressCallback& progress) {
+    auto maxOp = [](T a, T b) { return std::max(a, b); };
+    auto minOp = [](T a, T b) { return std::min(a, b); };
+
+    // Bordas neutras, como o valor padrão de borda da morfologia do OpenCV
+    cv::Mat dilated = filterRect<T>(gray, k, std::numeric_limits<T>::lowest(), maxOp);
+    if (progress && !progress(1, 2)) return cv::Mat();
+
+    cv::Mat closed = filterRect<T>(dilated, k, std::numeric_limits<T>::max(), minOp);
+    if (progress && !progress(2, 2)) return cv::Mat();
+    return closed;
+}
+
+cv::Mat toGray(const cv::Mat& image) {
+    if (image.channels() == 1) return image;
+    cv::Mat gray;
+    cv::cvtColor(image, gray, image.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    return gray;
+}
+
+cv::Mat closeEllipse(const cv::Mat& gray, int k) {
+    cv::Mat closed;
+    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(k, k));
+    cv::morphologyEx(gray, closed, cv::MORPH_CLOSE, kernel);
+    return closed;
+}
+
+} // namespace
+
+QString BackgroundConfig::toString() const {
+    QString name;
+    switch (method) {
+        case BackgroundMethod::VanHerk: name = "vanHerk"; break;
+        case BackgroundMethod::Pyramid: name = "pyramid"; break;
+        case BackgroundMethod::Exact:   name = "exact"; break;
+    }
+    return QString("method=%1, kernel=%2px").arg(name).arg(kernelSize);
+}
+
+cv::Mat BackgroundEstimator::closeRect(const cv::Mat& gray, int kernelSize, const ProgressCallback& progress) {
+    CV_Assert(gray.channels() == 1);
+    const int k = std::max(1, kernelSize | 1);
+
+    switch (gray.depth()) {
+        case CV_8U:  return closeRectT<uchar>(gray, k, progress);
+        case CV_16U: return closeRectT<ushort>(gray, k, progress);
+        case CV_32F: return closeRectT<float>(gray, k, progress);
+        default: {
+            // Outras profundidades: via float
+            cv::Mat asFloat, closed;
+            gray.convertTo(asFloat, CV_32F);
+            closed = closeRectT<float>(asFloat, k, progress);
+            if (!closed.empty()) closed.convertTo(closed, gray.type());
+            return closed;
+        }
+    }
+}
+
+cv::Mat BackgroundEstimator::estimate(const cv::Mat& image, const BackgroundConfig& config,
+                                      const ProgressCallback& progress) {
+    if (image.empty()) return cv::Mat();
+
+    cv::Mat gray = toGray(image);
+    const int k = std::max(3, config.kernelSize | 1);
+
+    switch (config.method) {
+        case BackgroundMethod::VanHerk:
+            return closeRect(gray, k, progress);
+
+        case BackgroundMethod::Pyramid: {
+            // Maior redução (potência de 2) que mantém o núcleo com ao menos pyramidKernel pixels
+            int factor = 1;
+            while (k / (factor * 2) >= config.pyramidKernel &&
+                   std::min(gray.cols, gray.rows) / (factor * 2) >= 32) {
+                factor *= 2;
+            }
+
+            cv::Mat reduced = gray;
+            if (factor > 1) {
+                cv::resize(gray, reduced, cv::Size(), 1.0 / factor, 1.0 / factor, cv::INTER_AREA);
+            }
+            if (progress && !progress(1, 3)) return cv::Mat();
+
+            cv::Mat closed = closeEllipse(reduced, std::max(3, (k / factor) | 1));
+            if (progress && !progress(2, 3)) return cv::Mat();
+
+            cv::Mat background;
+            if (factor > 1) {
+                cv::resize(closed, background, gray.size(), 0, 0, cv::INTER_LINEAR);
+            } else {
+                background = closed;
+            }
+            qDebug() << QString("[Background] Pirâmide 1/%1: núcleo %2px no nível reduzido")
+                        .arg(factor).arg((k / factor) | 1);
+            if (progress && !progress(3, 3)) return cv::Mat();
+            return background;
+        }
+
+        case BackgroundMethod::Exact: {
+            cv::Mat background = closeEllipse(gray, k);
+            if (progress && !progress(1, 1)) return cv::Mat();
+            return background;
+        }
+    }
+    return cv::Mat();
+}
+
+cv::Mat BackgroundEstimator::subtract(const cv::Mat& image, const BackgroundConfig& config,
+                                      const ProgressCallback& progress) {
+    cv::Mat gray = toGray(image);
+    cv::Mat background = estimate(gray, config, progress);
+    if (background.empty()) return cv::Mat();
+
+    cv::Mat result;
+    cv::subtract(background, gray, result);
+    return result;
+}
+
+int BackgroundEstimator::kernelFromMillimetres(double millimetres, double pixelsPerMM) {
+    const int pixels = static_cast<int>(std::lround(millimetres * pixelsPerMM));
+    return std::max(3, pixels | 1);
+}
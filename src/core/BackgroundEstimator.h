@@ -0,0 +1,70 @@
+#ifndef BACKGROUNDESTIMATOR_H
+#define BACKGROUNDESTIMATOR_H
+
+#include <opencv2/core.hpp>
+#include <QString>
+#include <functional>
+
+/**
+ * @brief Algoritmo de estimativa do fundo
+ */
+enum class BackgroundMethod {
+    VanHerk,        // Fechamento retangular van Herk/Gil-Werman: custo constante por pixel
+    Pyramid,        // Fechamento elíptico num nível reduzido, ampliado de volta
+    Exact           // Fechamento elíptico em resolução total (referência, lento)
+};
+
+/**
+ * @brief Parâmetros da subtração de fundo
+ */
+struct BackgroundConfig {
+    BackgroundMethod method = BackgroundMethod::VanHerk;
+    int kernelSize = 51;            // Lado do elemento estruturante (pixels, ímpar)
+    int pyramidKernel = 15;         // Pyramid: lado mínimo do elemento no nível reduzido
+
+    QString toString() const;
+};
+
+/**
+ * @brief Estimativa e subtração de fundo por fechamento morfológico de núcleo grande
+ *
+ * O fechamento (dilatação seguida de erosão) preenche as cristas escuras mais
+ * estreitas que o elemento estruturante, restando o fundo (papel, manchas,
+ * gradientes de iluminação). O resultado é fundo − imagem: cristas claras
+ * sobre fundo escuro, como na rotina original.
+ *
+ * - VanHerk: máximo/mínimo 1D por blocos (prefixo/sufixo), três comparações
+ *   por pixel independentemente do tamanho do núcleo; o retângulo é separável
+ *   em linhas e colunas.
+ * - Pyramid: reduz a imagem até o núcleo ficar com ~pyramidKernel pixels,
+ *   fecha com elipse e amplia o fundo; adequado porque o fundo é suave.
+ */
+class BackgroundEstimator {
+public:
+    using ProgressCallback = std::function<bool(int done, int total)>;
+
+    /**
+     * @brief Fundo estimado (mesmo tamanho e profundidade, um canal)
+     * @return Vazia se cancelada
+     */
+    static cv::Mat estimate(const cv::Mat& image, const BackgroundConfig& config = BackgroundConfig(),
+                            const ProgressCallback& progress = nullptr);
+
+    /**
+     * @brief fundo − imagem, em tons de cinza
+     */
+    static cv::Mat subtract(const cv::Mat& image, const BackgroundConfig& config = BackgroundConfig(),
+                            const ProgressCallback& progress = nullptr);
+
+    /**
+     * @brief Fechamento retangular van Herk/Gil-Werman (CV_8U, CV_16U ou CV_32F, um canal)
+     */
+    static cv::Mat closeRect(const cv::Mat& gray, int kernelSize, const ProgressCallback& progress = nullptr);
+
+    /**
+     * @brief Lado do núcleo em pixels (ímpar, ≥ 3) para um tamanho em milímetros
+     */
+    static int kernelFromMillimetres(double millimetres, double pixelsPerMM);
+};
+
+#endif // BACKGROUNDESTIMATOR_H
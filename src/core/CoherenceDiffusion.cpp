@@ -0,0 +1,169 @@
+#include "CoherenceDiffusion.h"
+#include <opencv2/imgproc.hpp>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+const int kRowsPerBand = 32;
+
+// Tensor de difusão (a b; b c) a partir do tensor de estrutura suavizado
+void diffusionTensor(const cv::Mat& j11, const cv::Mat& j12, const cv::Mat& j22,
+                     const CoherenceDiffusionConfig& config, cv::Mat& a, cv::Mat& b, cv::Mat& c) {
+    a.create(j11.size(), CV_32F);
+    b.create(j11.size(), CV_32F);
+    c.create(j11.size(), CV_32F);
+
+    const float alpha = static_cast<float>(config.alpha);
+    const float contrast = static_cast<float>(config.contrast);
+
+    cv::parallel_for_(cv::Range(0, j11.rows), [&](const cv::Range& range) {
+        for (int y = range.start; y < range.end; ++y) {
+            const float* p11 = j11.ptr<float>(y);
+            const float* p12 = j12.ptr<float>(y);
+            const float* p22 = j22.ptr<float>(y);
+            float* pa = a.ptr<float>(y);
+            float* pb = b.ptr<float>(y);
+            float* pc = c.ptr<float>(y);
+
+            for (int x = 0; x < j11.cols; ++x) {
+                const float d = p11[x] - p22[x];
+                const float coherence = std::sqrt(d * d + 4.0f * p12[x] * p12[x]);   // μ1 − μ2
+
+                // v1: autovetor de μ1 (normal às cristas)
+                float vx = 2.0f * p12[x];
+                float vy = p22[x] - p11[x] + coherence;
+                const float norm = std::sqrt(vx * vx + vy * vy);
+                if (norm > 1e-12f) {
+                    vx /= norm;
+                    vy /= norm;
+                } else {
+                    vx = 1.0f;
+                    vy = 0.0f;
+                }
+
+                const float lambda1 = alpha;
+                const float lambda2 = coherence > 1e-12f
+                    ? alpha + (1.0f - alpha) * std::exp(-contrast / (coherence * coherence))
+                    : alpha;
+
+                pa[x] = lambda1 * vx * vx + lambda2 * vy * vy;
+                pb[x] = (lambda1 - lambda2) * vx * vy;
+                pc[x] = lambda1 * vy * vy + lambda2 * vx * vx;
+            }
+        }
+    });
+}
+
+} // namespace
+
+QString CoherenceDiffusionConfig::toString() const {
+    return QString("iterations=%1, dt=%2, sigma=%3, rho=%4, alpha=%5, C=%6")
+        .arg(iterations).arg(timeStep).arg(gradientSigma).arg(integrationSigma).arg(alpha).arg(contrast);
+}
+
+cv::Mat CoherenceDiffusion::apply(const cv::Mat& image, const CoherenceDiffusionConfig& config,
+                                  const ProgressCallback& progress, int* iterationsRun) {
+    if (iterationsRun) *iterationsRun = 0;
+    if (image.empty()) return cv::Mat();
+
+    cv::Mat gray;
+    if (image.channels() > 1) {
+        cv::cvtColor(image, gray, image.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    } else {
+        gray = image;
+    }
+
+    // Trabalha em 0-255 para que C e a tolerância independam da profundidade
+    const double scale = gray.depth() == CV_16U ? 255.0 / 65535.0 : 1.0;
+    cv::Mat u;
+    gray.convertTo(u, CV_32F, scale);
+
+    const float dt = static_cast<float>(std::min(config.timeStep, 0.25));
+    const int bands = (u.rows + kRowsPerBand - 1) / kRowsPerBand;
+    std::vector<double> bandChange(bands);
+
+    cv::Mat smoothed, gx, gy, j11, j12, j22, a, b, c;
+    cv::Mat up, ap, bp, cp;
+    int iteration = 0;
+
+    for (; iteration < config.iterations; ++iteration) {
+        // Tensor de estrutura J_ρ(∇u_σ)
+        cv::GaussianBlur(u, smoothed, cv::Size(0, 0), config.gradientSigma);
+        cv::Scharr(smoothed, gx, CV_32F, 1, 0, 1.0 / 32.0);
+        cv::Scharr(smoothed, gy, CV_32F, 0, 1, 1.0 / 32.0);
+        cv::GaussianBlur(gx.mul(gx), j11, cv::Size(0, 0), config.integrationSigma);
+        cv::GaussianBlur(gx.mul(gy), j12, cv::Size(0, 0), config.integrationSigma);
+        cv::GaussianBlur(gy.mul(gy), j22, cv::Size(0, 0), config.integrationSigma);
+        diffusionTensor(j11, j12, j22, config, a, b, c);
+
+        // Borda replicada: fluxo nulo na borda e laços sem testes de limite
+        cv::copyMakeBorder(u, up, 1, 1, 1, 1, cv::BORDER_REPLICATE);
+        cv::copyMakeBorder(a, ap, 1, 1, 1, 1, cv::BORDER_REPLICATE);
+        cv::copyMakeBorder(b, bp, 1, 1, 1, 1, cv::BORDER_REPLICATE);
+        cv::copyMakeBorder(c, cp, 1, 1, 1, 1, cv::BORDER_REPLICATE);
+
+        cv::parallel_for_(cv::Range(0, bands), [&](const cv::Range& range) {
+            for (int band = range.start; band < range.end; ++band) {
+                double change = 0.0;
+                const int yEnd = std::min(u.rows, (band + 1) * kRowsPerBand);
+
+                for (int y = band * kRowsPerBand; y < yEnd; ++y) {
+                    // Linha y da imagem é a linha y + 1 das matrizes com borda; +1 na coluna
+                    const float* uN = up.ptr<float>(y) + 1;
+                    const float* uC = up.ptr<float>(y + 1) + 1;
+                    const float* uS = up.ptr<float>(y + 2) + 1;
+                    const float* aC = ap.ptr<float>(y + 1) + 1;
+                    const float* bN = bp.ptr<float>(y) + 1;
+                    const float* bC = bp.ptr<float>(y + 1) + 1;
+                    const float* bS = bp.ptr<float>(y + 2) + 1;
+                    const float* cN = cp.ptr<float>(y) + 1;
+                    const float* cC = cp.ptr<float>(y + 1) + 1;
+                    const float* cS = cp.ptr<float>(y + 2) + 1;
+                    float* out = u.ptr<float>(y);
+
+                    for (int x = 0; x < u.cols; ++x) {
+                        // ∂x(a ∂x u) e ∂y(c ∂y u): fluxos nas meias posições
+                        const float fxx = 0.5f * ((aC[x + 1] + aC[x]) * (uC[x + 1] - uC[x])
+                                                - (aC[x] + aC[x - 1]) * (uC[x] - uC[x - 1]));
+                        const float fyy = 0.5f * ((cS[x] + cC[x]) * (uS[x] - uC[x])
+                                                - (cC[x] + cN[x]) * (uC[x] - uN[x]));
+
+                        // ∂x(b ∂y u) + ∂y(b ∂x u): diferenças centrais
+                        const float fxy = 0.25f * (bC[x + 1] * (uS[x + 1] - uN[x + 1])
+                                                 - bC[x - 1] * (uS[x - 1] - uN[x - 1]))
+                                        + 0.25f * (bS[x] * (uS[x + 1] - uS[x - 1])
+                                                 - bN[x] * (uN[x + 1] - uN[x - 1]));
+
+                        const float delta = dt * (fxx + fyy + fxy);
+                        out[x] = uC[x] + delta;
+                        change += std::abs(delta);
+                    }
+                }
+                bandChange[band] = change;
+            }
+        });
+
+        double totalChange = 0.0;
+        for (double change : bandChange) totalChange += change;
+        const double meanChange = totalChange / static_cast<double>(u.total());
+
+        if (progress && !progress(iteration + 1, config.iterations)) {
+            return cv::Mat();
+        }
+        if (meanChange < config.tolerance) {
+            ++iteration;
+            qDebug() << QString("[CoherenceDiffusion] Convergiu em %1 passos (variação média %2)")
+                        .arg(iteration).arg(meanChange, 0, 'g', 3);
+            break;
+        }
+    }
+
+    if (iterationsRun) *iterationsRun = iteration;
+
+    cv::Mat result;
+    u.convertTo(result, gray.depth(), 1.0 / scale);
+    return result;
+}
@@ -0,0 +1,281 @@
+#include "CrossingNumber.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+namespace {
+
+/**
+ * Vizinhança 8 no sentido horário a partir do norte (mesma codificação de Thinning):
+ * bit0=N bit1=NE bit2=E bit3=SE bit4=S bit5=SW bit6=W bit7=NW
+ */
+const int kDx[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+const int kDy[8] = {-1, -1, 0, 1, 1, 1, 0, -1};
+
+const double kTwoPi = 2.0 * CV_PI;
+
+struct NeighbourhoodClass {
+    uchar crossings = 0;    // Número de cruzamentos: transições 0 → 1 na volta
+    float direction = 0.0f; // Radianos [0, 2π), eixo y para cima
+};
+
+double angularDistance(double a, double b) {
+    double d = std::fmod(std::abs(a - b), kTwoPi);
+    return d > CV_PI ? kTwoPi - d : d;
+}
+
+/**
+ * Cada sequência de vizinhos acesos é um ramo; sua direção é a média dos
+ * vetores unitários dos vizinhos. A minúcia aponta para longe do ramo
+ * distinguido: o único (terminação) ou o mais afastado dos outros dois
+ * (tronco da bifurcação).
+ */
+NeighbourhoodClass classify(const int p[8]) {
+    NeighbourhoodClass result;
+    double branches[4];
+    int count = 0;
+
+    for (int b = 0; b < 8; ++b) {
+        if (p[b] != 0 || p[(b + 1) % 8] == 0) continue;
+
+        double sx = 0.0, sy = 0.0;
+        for (int k = (b + 1) % 8; p[k] != 0; k = (k + 1) % 8) {
+            const double length = (kDx[k] != 0 && kDy[k] != 0) ? CV_SQRT2 : 1.0;
+            sx += kDx[k] / length;
+            sy -= kDy[k] / length;
+        }
+        branches[count++] = std::atan2(sy, sx);
+    }
+
+    result.crossings = static_cast<uchar>(count);
+
+    int distinguished = -1;
+    if (count == 1) {
+        distinguished = 0;
+    } else if (count == 3) {
+        double widest = -1.0;
+        for (int i = 0; i < 3; ++i) {
+            double gap = std::numeric_limits<double>::max();
+            for (int j = 0; j < 3; ++j) {
+                if (j != i) gap = std::min(gap, angularDistance(branches[i], branches[j]));
+            }
+            if (gap > widest) {
+                widest = gap;
+                distinguished = i;
+            }
+        }
+    }
+
+    if (distinguished >= 0) {
+        double direction = std::fmod(branches[distinguished] + CV_PI, kTwoPi);
+        if (direction < 0.0) direction += kTwoPi;
+        result.direction = static_cast<float>(direction);
+    }
+    return result;
+}
+
+using ClassTable = std::array<NeighbourhoodClass, 256>;
+
+const ClassTable& classTable() {
+    static const ClassTable table = [] {
+        ClassTable t{};
+        for (int code = 0; code < 256; ++code) {
+            int p[8];
+            for (int b = 0; b < 8; ++b) p[b] = (code >> b) & 1;
+            t[code] = classify(p);
+        }
+        return t;
+    }();
+    return table;
+}
+
+inline bool isMinutia(uchar crossings) {
+    return crossings == 1 || crossings == 3;
+}
+
+inline SkeletonMinutia candidate(int x, int y, const NeighbourhoodClass& entry) {
+    SkeletonMinutia m;
+    m.position = cv::Point2f(static_cast<float>(x), static_cast<float>(y));
+    m.angle = entry.direction;
+    m.type = entry.crossings == 1 ? 0 : 1;
+    return m;
+}
+
+// Esqueleto 0/1 em CV_8U, qualquer profundidade ou número de canais na entrada
+cv::Mat skeletonBits(const cv::Mat& skeleton) {
+    cv::Mat gray;
+    if (skeleton.channels() > 1) {
+        cv::cvtColor(skeleton, gray, skeleton.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    } else {
+        gray = skeleton;
+    }
+
+    cv::Mat bits;
+    cv::compare(gray, 0, bits, cv::CMP_NE);
+    bits.setTo(1, bits);
+    return bits;
+}
+
+void assignIds(std::vector<SkeletonMinutia>& minutiae) {
+    for (size_t i = 0; i < minutiae.size(); ++i) {
+        minutiae[i].id = static_cast<int>(i) + 1;
+    }
+}
+
+} // namespace
+
+std::vector<SkeletonMinutia> CrossingNumber::extract(const cv::Mat& skeleton, int margin) {
+    std::vector<SkeletonMinutia> minutiae;
+    margin = std::max(1, margin);
+    if (skeleton.empty() || skeleton.rows <= 2 * margin || skeleton.cols <= 2 * margin) {
+        return minutiae;
+    }
+
+    const cv::Mat bits = skeletonBits(skeleton);
+    const ClassTable& table = classTable();
+    const int yBegin = margin;
+    const int yEnd = bits.rows - margin;
+    const int xBegin = margin;
+    const int xEnd = bits.cols - margin;
+
+    const int rows = yEnd - yBegin;
+    const int stripRows = std::max(1, rows / std::max(1, cv::getNumThreads() * 4));
+    const int stripCount = (rows + stripRows - 1) / stripRows;
+    std::vector<std::vector<SkeletonMinutia>> stripMinutiae(stripCount);
+
+    cv::parallel_for_(cv::Range(0, stripCount), [&](const cv::Range& range) {
+        for (int s = range.start; s < range.end; ++s) {
+            std::vector<SkeletonMinutia>& found = stripMinutiae[s];
+            const int stripEnd = std::min(yEnd, yBegin + (s + 1) * stripRows);
+
+            for (int y = yBegin + s * stripRows; y < stripEnd; ++y) {
+                const uchar* north = bits.ptr<uchar>(y - 1);
+                const uchar* centre = bits.ptr<uchar>(y);
+                const uchar* south = bits.ptr<uchar>(y + 1);
+
+                auto visit = [&](int x) {
+                    const int code = north[x]
+                                   | (north[x + 1]  << 1)
+                                   | (centre[x + 1] << 2)
+                                   | (south[x + 1]  << 3)
+                                   | (south[x]      << 4)
+                                   | (south[x - 1]  << 5)
+                                   | (centre[x - 1] << 6)
+                                   | (north[x - 1]  << 7);
+                    const NeighbourhoodClass& entry = table[code];
+                    if (isMinutia(entry.crossings)) found.push_back(candidate(x, y, entry));
+                };
+
+                // O esqueleto é esparso: blocos de 8 pixels de fundo são pulados com uma leitura
+                int x = xBegin;
+                for (; x + 8 <= xEnd; x += 8) {
+                    std::uint64_t word;
+                    std::memcpy(&word, centre + x, sizeof(word));
+                    if (word == 0) continue;
+                    for (int k = x; k < x + 8; ++k) {
+                        if (centre[k]) visit(k);
+                    }
+                }
+                for (; x < xEnd; ++x) {
+                    if (centre[x]) visit(x);
+                }
+            }
+        }
+    });
+
+    size_t total = 0;
+    for (const auto& found : stripMinutiae) total += found.size();
+    minutiae.reserve(total);
+    for (const auto& found : stripMinutiae) {
+        minutiae.insert(minutiae.end(), found.begin(), found.end());
+    }
+
+    assignIds(minutiae);
+    return minutiae;
+}
+
+int CrossingNumber::crossingsAt(const cv::Mat& skeleton, int x, int y) {
+    CV_Assert(skeleton.type() == CV_8UC1);
+    if (x < 0 || y < 0 || x >= skeleton.cols || y >= skeleton.rows) return 0;
+    if (skeleton.at<uchar>(y, x) == 0) return 0;
+
+    int code = 0;
+    for (int b = 0; b < 8; ++b) {
+        const int nx = x + kDx[b];
+        const int ny = y + kDy[b];
+        if (nx >= 0 && ny >= 0 && nx < skeleton.cols && ny < skeleton.rows && skeleton.at<uchar>(ny, nx)) {
+            code |= 1 << b;
+        }
+    }
+    return classTable()[code].crossings;
+}
+
+std::vector<SkeletonMinutia> CrossingNumber::extractReference(const cv::Mat& skeleton, int margin) {
+    std::vector<SkeletonMinutia> minutiae;
+    margin = std::max(1, margin);
+    if (skeleton.empty() || skeleton.rows <= 2 * margin || skeleton.cols <= 2 * margin) {
+        return minutiae;
+    }
+
+    const cv::Mat bits = skeletonBits(skeleton);
+    for (int y = margin; y < bits.rows - margin; ++y) {
+        for (int x = margin; x < bits.cols - margin; ++x) {
+            if (bits.at<uchar>(y, x) == 0) continue;
+
+            int p[8];
+            for (int b = 0; b < 8; ++b) p[b] = bits.at<uchar>(y + kDy[b], x + kDx[b]);
+
+            const NeighbourhoodClass entry = classify(p);
+            if (isMinutia(entry.crossings)) minutiae.push_back(candidate(x, y, entry));
+        }
+    }
+
+    assignIds(minutiae);
+    return minutiae;
+}
+
+bool CrossingNumber::verifyAgainstReference(const cv::Mat& skeleton, int margin) {
+    const std::vector<SkeletonMinutia> reference = extractReference(skeleton, margin);
+    const std::vector<SkeletonMinutia> fast = extract(skeleton, margin);
+
+    if (fast.size() != reference.size()) return false;
+    for (size_t i = 0; i < fast.size(); ++i) {
+        if (fast[i].position != reference[i].position ||
+            fast[i].type != reference[i].type ||
+            fast[i].angle != reference[i].angle ||
+            fast[i].id != reference[i].id) {
+            return false;
+        }
+    }
+    return true;
+}
+
+CrossingNumberBenchmark CrossingNumber::benchmark(const cv::Mat& skeleton, int repetitions) {
+    CrossingNumberBenchmark result;
+    result.size = skeleton.size();
+    repetitions = std::max(1, repetitions);
+
+    auto bestOf = [&](const std::function<std::vector<SkeletonMinutia>()>& run) {
+        double best = std::numeric_limits<double>::max();
+        for (int r = 0; r < repetitions; ++r) {
+            cv::TickMeter timer;
+            timer.start();
+            std::vector<SkeletonMinutia> minutiae = run();
+            timer.stop();
+            best = std::min(best, timer.getTimeMilli());
+            result.minutiae = static_cast<int>(minutiae.size());
+        }
+        return best;
+    };
+
+    result.referenceMs = bestOf([&] { return extractReference(skeleton); });
+    result.tableMs = bestOf([&] { return extract(skeleton); });
+    result.identical = verifyAgainstReference(skeleton);
+
+    return result;
+}
@@ -0,0 +1,130 @@
+#include "FFTService.h"
+#include "RidgeGeometry.h"
+#include <QHash>
+#include <QMutex>
+#include <QDebug>
+
+namespace {
+
+struct SpectrumEntry {
+    quint64 hash = 0;
+    std::shared_ptr<const cv::Mat> ccs;
+    size_t bytes = 0;
+    quint64 lastUse = 0;
+};
+
+QMutex spectrumMutex;
+QHash<QString, SpectrumEntry> spectrumCache;
+size_t cachedBytes = 0;
+size_t cacheBudget = size_t(256) << 20;
+quint64 useCounter = 0;
+
+// Buffers de trabalho por thread: create() só realoca quando o tamanho muda
+thread_local cv::Mat paddedBuffer;
+thread_local cv::Mat productBuffer;
+thread_local cv::Mat inverseBuffer;
+
+// Descartar entradas menos usadas até caber no orçamento (mutex já adquirido)
+void evictToBudget(size_t incoming) {
+    while (!spectrumCache.isEmpty() && cachedBytes + incoming > cacheBudget) {
+        auto oldest = spectrumCache.begin();
+        for (auto it = spectrumCache.begin(); it != spectrumCache.end(); ++it) {
+            if (it->lastUse < oldest->lastUse) oldest = it;
+        }
+        cachedBytes -= oldest->bytes;
+        spectrumCache.erase(oldest);
+    }
+}
+
+} // namespace
+
+cv::Size FFTService::optimalSize(const cv::Size& imageSize) {
+    return cv::Size(cv::getOptimalDFTSize(imageSize.width), cv::getOptimalDFTSize(imageSize.height));
+}
+
+cv::Mat FFTService::forward(const cv::Mat& gray) {
+    const cv::Size dftSize = optimalSize(gray.size());
+
+    // Expansão com zeros no buffer reaproveitado
+    paddedBuffer.create(dftSize, CV_32F);
+    gray.convertTo(paddedBuffer(cv::Rect(0, 0, gray.cols, gray.rows)), CV_32F);
+    if (dftSize.width > gray.cols) {
+        paddedBuffer(cv::Rect(gray.cols, 0, dftSize.width - gray.cols, dftSize.height)).setTo(0);
+    }
+    if (dftSize.height > gray.rows) {
+        paddedBuffer(cv::Rect(0, gray.rows, gray.cols, dftSize.height - gray.rows)).setTo(0);
+    }
+
+    // DFT real: espectro empacotado (CCS); só as linhas não nulas entram na primeira passada
+    cv::Mat ccs;
+    cv::dft(paddedBuffer, ccs, 0, gray.rows);
+    return ccs;
+}
+
+cv::Mat FFTService::inverseMasked(const cv::Mat& ccs, const cv::Mat& packedMask, const cv::Size& outputSize) {
+    cv::multiply(ccs, packedMask, productBuffer);
+    cv::dft(productBuffer, inverseBuffer, cv::DFT_INVERSE | cv::DFT_SCALE | cv::DFT_REAL_OUTPUT);
+    return inverseBuffer(cv::Rect(0, 0, outputSize.width, outputSize.height));
+}
+
+std::shared_ptr<const cv::Mat> FFTService::spectrum(const QString& key, const cv::Mat& gray) {
+    quint64 hash = RidgeGeometry::contentHash(gray);
+
+    {
+        QMutexLocker locker(&spectrumMutex);
+        auto it = spectrumCache.find(key);
+        if (it != spectrumCache.end() && it->hash == hash) {
+            it->lastUse = ++useCounter;
+            return it->ccs;
+        }
+    }
+
+    auto ccs = std::make_shared<const cv::Mat>(forward(gray));
+    const size_t bytes = ccs->total() * ccs->elemSize();
+
+    QMutexLocker locker(&spectrumMutex);
+    auto existing = spectrumCache.find(key);
+    if (existing != spectrumCache.end()) {
+        cachedBytes -= existing->bytes;
+        spectrumCache.erase(existing);
+    }
+
+    // Espectros maiores que o orçamento não são guardados
+    if (bytes <= cacheBudget) {
+        evictToBudget(bytes);
+
+        SpectrumEntry entry;
+        entry.hash = hash;
+        entry.ccs = ccs;
+        entry.bytes = bytes;
+        entry.lastUse = ++useCounter;
+        spectrumCache.insert(key, entry);
+        cachedBytes += bytes;
+    }
+
+    qDebug() << QString("[FFTService] Espectro calculado para %1: %2x%3 (%4 MB em cache)")
+                .arg(key).arg(ccs->cols).arg(ccs->rows)
+                .arg(cachedBytes / double(1 << 20), 0, 'f', 1);
+    return ccs;
+}
+
+void FFTService::invalidate(const QString& key) {
+    QMutexLocker locker(&spectrumMutex);
+    auto it = spectrumCache.find(key);
+    if (it != spectrumCache.end()) {
+        cachedBytes -= it->bytes;
+        spectrumCache.erase(it);
+    }
+}
+
+void FFTService::clearCache() {
+    QMutexLocker locker(&spectrumMutex);
+    spectrumCache.clear();
+    cachedBytes = 0;
+}
+
+void FFTService::setCacheBudget(size_t bytes) {
+    QMutexLocker locker(&spectrumMutex);
+    cacheBudget = bytes;
+    evictToBudget(0);
+}
@@ -0,0 +1,55 @@
+#ifndef FFTSERVICE_H
+#define FFTSERVICE_H
+
+#include <opencv2/core.hpp>
+#include <QString>
+#include <memory>
+
+/**
+ * @brief Transformadas de Fourier reais com buffers reaproveitados e espectros em cache
+ *
+ * - Os buffers de trabalho (imagem expandida, produto com a máscara, saída
+ *   da inversa) são mantidos por thread e só realocados quando o tamanho
+ *   muda, evitando alocar centenas de MB a cada filtragem de imagens grandes.
+ * - O espectro direto (CCS) é guardado por chave (entidade) e validado pelo
+ *   conteúdo da imagem, que funciona como revisão: editar a imagem invalida
+ *   a entrada sozinho. O cache é limitado em bytes e descarta o menos usado.
+ *
+ * Usado pelo diálogo de filtro FFT, pelo ProcessingWorker e pela detecção
+ * automática de padrões periódicos.
+ */
+class FFTService {
+public:
+    /**
+     * @brief Tamanho da DFT (expansão com zeros à direita e abaixo)
+     */
+    static cv::Size optimalSize(const cv::Size& imageSize);
+
+    /**
+     * @brief DFT real direta da imagem em tons de cinza
+     * @return Espectro CCS (CV_32F) com o tamanho de optimalSize(); matriz nova
+     */
+    static cv::Mat forward(const cv::Mat& gray);
+
+    /**
+     * @brief Espectro multiplicado pela máscara CCS e transformado de volta
+     * @return Parte real recortada em outputSize (CV_32F). Aponta para um
+     *         buffer da thread: válida até a próxima chamada na mesma thread.
+     */
+    static cv::Mat inverseMasked(const cv::Mat& ccs, const cv::Mat& packedMask, const cv::Size& outputSize);
+
+    /**
+     * @brief Espectro direto da entidade, recalculado só se a imagem mudou
+     */
+    static std::shared_ptr<const cv::Mat> spectrum(const QString& key, const cv::Mat& gray);
+
+    static void invalidate(const QString& key);
+    static void clearCache();
+
+    /**
+     * @brief Limite de memória dos espectros em cache (padrão 256 MB)
+     */
+    static void setCacheBudget(size_t bytes);
+};
+
+#endif // FFTSERVICE_H
@@ -0,0 +1,306 @@
+#include "FalseMinutiaeFilter.h"
+#include "RidgeGeometry.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double kTwoPi = 2.0 * CV_PI;
+
+// Vizinhos 4-conexos primeiro: o percurso segue a crista sem cortar cantos
+const int kTraceDx[8] = {0, 1, 0, -1, 1, 1, -1, -1};
+const int kTraceDy[8] = {-1, 0, 1, 0, -1, 1, 1, -1};
+
+double angularDistance(double a, double b) {
+    double d = std::fmod(std::abs(a - b), kTwoPi);
+    return d > CV_PI ? kTwoPi - d : d;
+}
+
+/**
+ * Grid espacial em layout compacto (contagem por célula + índices): montado
+ * em O(n + células) sem alocação por célula.
+ */
+class MinutiaeGrid {
+public:
+    MinutiaeGrid(const std::vector<SkeletonMinutia>& minutiae, const cv::Size& size, double cellSize)
+        : m_minutiae(minutiae),
+          m_cellSize(std::max(1.0, cellSize)),
+          m_cols(static_cast<int>(size.width / m_cellSize) + 1),
+          m_rows(static_cast<int>(size.height / m_cellSize) + 1),
+          m_cellStart(static_cast<size_t>(m_cols) * m_rows + 1, 0),
+          m_indices(minutiae.size()) {
+        std::vector<int> cellOf(minutiae.size());
+        for (size_t i = 0; i < minutiae.size(); ++i) {
+            cellOf[i] = cellIndex(minutiae[i].position);
+            m_cellStart[cellOf[i] + 1]++;
+        }
+        for (size_t c = 1; c < m_cellStart.size(); ++c) m_cellStart[c] += m_cellStart[c - 1];
+
+        std::vector<int> fill(m_cellStart.begin(), m_cellStart.end() - 1);
+        for (size_t i = 0; i < minutiae.size(); ++i) {
+            m_indices[fill[cellOf[i]]++] = static_cast<int>(i);
+        }
+    }
+
+    /**
+     * Índices a até radius de point (radius ≤ célula: no máximo 3x3 células)
+     */
+    template <typename Visitor>
+    void forEachNear(const cv::Point2f& point, double radius, Visitor visit) const {
+        const int cx0 = std::clamp(static_cast<int>((point.x - radius) / m_cellSize), 0, m_cols - 1);
+        const int cx1 = std::clamp(static_cast<int>((point.x + radius) / m_cellSize), 0, m_cols - 1);
+        const int cy0 = std::clamp(static_cast<int>((point.y - radius) / m_cellSize), 0, m_rows - 1);
+        const int cy1 = std::clamp(static_cast<int>((point.y + radius) / m_cellSize), 0, m_rows - 1);
+        const double radius2 = radius * radius;
+
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                const int cell = cy * m_cols + cx;
+                for (int k = m_cellStart[cell]; k < m_cellStart[cell + 1]; ++k) {
+                    const int index = m_indices[k];
+                    const cv::Point2f d = m_minutiae[index].position - point;
+                    if (d.x * d.x + d.y * d.y <= radius2) visit(index);
+                }
+            }
+        }
+    }
+
+private:
+    const std::vector<SkeletonMinutia>& m_minutiae;
+    double m_cellSize;
+    int m_cols;
+    int m_rows;
+    std::vector<int> m_cellStart;
+    std::vector<int> m_indices;
+
+    int cellIndex(const cv::Point2f& p) const {
+        const int cx = std::clamp(static_cast<int>(p.x / m_cellSize), 0, m_cols - 1);
+        const int cy = std::clamp(static_cast<int>(p.y / m_cellSize), 0, m_rows - 1);
+        return cy * m_cols + cx;
+    }
+};
+
+enum class TraceEnd {
+    Open,           // Percorreu o comprimento máximo sem encontrar nada
+    Bifurcation,    // Chegou a um pixel com número de cruzamentos ≥ 3
+    Ending          // A crista acabou (outra terminação)
+};
+
+struct Trace {
+    TraceEnd end = TraceEnd::Open;
+    cv::Point point;
+};
+
+/**
+ * Segue o esqueleto a partir de uma terminação por até maxLength pixels
+ */
+Trace traceRidge(const cv::Mat& skeleton, const cv::Point& start, int maxLength) {
+    std::vector<cv::Point> visited;
+    visited.reserve(maxLength + 1);
+    visited.push_back(start);
+
+    auto isVisited = [&](const cv::Point& p) {
+        return std::find(visited.begin(), visited.end(), p) != visited.end();
+    };
+
+    Trace trace;
+    trace.point = start;
+
+    for (int step = 0; step < maxLength; ++step) {
+        bool moved = false;
+        for (int b = 0; b < 8; ++b) {
+            const cv::Point next(trace.point.x + kTraceDx[b], trace.point.y + kTraceDy[b]);
+            if (next.x < 0 || next.y < 0 || next.x >= skeleton.cols || next.y >= skeleton.rows) continue;
+            if (!skeleton.at<uchar>(next) || isVisited(next)) continue;
+
+            visited.push_back(next);
+            trace.point = next;
+            moved = true;
+            break;
+        }
+
+        if (!moved) {
+            trace.end = TraceEnd::Ending;
+            return trace;
+        }
+
+        const int crossings = CrossingNumber::crossingsAt(skeleton, trace.point.x, trace.point.y);
+        if (crossings >= 3) {
+            trace.end = TraceEnd::Bifurcation;
+            return trace;
+        }
+        if (crossings == 1) {
+            trace.end = TraceEnd::Ending;
+            return trace;
+        }
+    }
+    return trace;
+}
+
+} // namespace
+
+QString FalseMinutiaeConfig::toString() const {
+    return QString("period=%1, spur=%2, pair=%3, border=%4, opposite=%5")
+        .arg(ridgePeriod).arg(spurLength).arg(pairDistance).arg(borderDistance).arg(oppositeTolerance);
+}
+
+std::vector<SkeletonMinutia> FalseMinutiaeFilter::apply(const std::vector<SkeletonMinutia>& minutiae,
+                                                        const cv::Mat& skeleton,
+                                                        const cv::Mat& foreground,
+                                                        const FalseMinutiaeConfig& config,
+                                                        FalseMinutiaeStats* stats) {
+    FalseMinutiaeStats counts;
+    std::vector<SkeletonMinutia> kept;
+    if (minutiae.empty() || skeleton.empty()) {
+        if (stats) *stats = counts;
+        return minutiae;
+    }
+
+    cv::Mat gray;
+    if (skeleton.channels() > 1) {
+        cv::cvtColor(skeleton, gray, skeleton.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    } else {
+        gray = skeleton;
+    }
+    cv::Mat bits;
+    cv::compare(gray, 0, bits, cv::CMP_NE);
+
+    const double period = std::max(1.0, config.ridgePeriod);
+    const int n = static_cast<int>(minutiae.size());
+    std::vector<uchar> removed(n, 0);
+
+    // 1. Borda: distância de cada pixel da impressão até o fundo (a moldura conta como fundo)
+    const double borderDistance = config.borderDistance * period;
+    if (borderDistance > 0.0) {
+        cv::Mat inside;
+        if (foreground.empty()) {
+            inside = cv::Mat(bits.size(), CV_8UC1, cv::Scalar(255));
+        } else {
+            CV_Assert(foreground.size() == bits.size());
+            cv::compare(foreground, 0, inside, cv::CMP_NE);
+        }
+        cv::copyMakeBorder(inside, inside, 1, 1, 1, 1, cv::BORDER_CONSTANT, cv::Scalar(0));
+
+        cv::Mat distance;
+        cv::distanceTransform(inside, distance, cv::DIST_L2, cv::DIST_MASK_3);
+
+        for (int i = 0; i < n; ++i) {
+            const int x = std::clamp(static_cast<int>(minutiae[i].position.x), 0, bits.cols - 1);
+            const int y = std::clamp(static_cast<int>(minutiae[i].position.y), 0, bits.rows - 1);
+            if (distance.at<float>(y + 1, x + 1) < borderDistance) {
+                removed[i] = 1;
+                counts.border++;
+            }
+        }
+    }
+
+    const double pairDistance = config.pairDistance * period;
+    const double cellSize = std::max(pairDistance, 2.0);
+    const MinutiaeGrid grid(minutiae, bits.size(), cellSize);
+
+    // Minúcia ainda ativa, do tipo pedido, mais próxima de point (dentro do raio)
+    auto nearestActive = [&](const cv::Point2f& point, double radius, int type, int exclude) {
+        int best = -1;
+        double bestDistance = radius * radius + 1.0;
+        grid.forEachNear(point, radius, [&](int j) {
+            if (j == exclude || removed[j] || minutiae[j].type != type) return;
+            const cv::Point2f d = minutiae[j].position - point;
+            const double distance = d.x * d.x + d.y * d.y;
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                best = j;
+            }
+        });
+        return best;
+    };
+
+    // 2. Esporas e fragmentos curtos, percorrendo o esqueleto a partir das terminações
+    const int spurLength = static_cast<int>(std::lround(config.spurLength * period));
+    if (spurLength > 0) {
+        for (int i = 0; i < n; ++i) {
+            if (removed[i] || minutiae[i].type != 0) continue;
+
+            const cv::Point start(static_cast<int>(minutiae[i].position.x),
+                                  static_cast<int>(minutiae[i].position.y));
+            const Trace trace = traceRidge(bits, start, spurLength);
+            if (trace.end == TraceEnd::Open) continue;
+
+            // A junção pode ocupar alguns pixels: a bifurcação registrada fica a ≤ 2 px
+            const bool spur = trace.end == TraceEnd::Bifurcation;
+            const int partner = nearestActive(cv::Point2f(trace.point), 2.0, spur ? 1 : 0, i);
+
+            removed[i] = 1;
+            int& count = spur ? counts.spurs : counts.shortRidges;
+            count++;
+            if (partner >= 0) {
+                removed[partner] = 1;
+                count++;
+            }
+        }
+    }
+
+    // 3. Pares opostos próximos: crista interrompida (terminações frente a frente) ou ponte
+    if (pairDistance > 0.0) {
+        for (int i = 0; i < n; ++i) {
+            if (removed[i]) continue;
+            const SkeletonMinutia& a = minutiae[i];
+
+            int partner = -1;
+            double partnerDistance = pairDistance * pairDistance + 1.0;
+            grid.forEachNear(a.position, pairDistance, [&](int j) {
+                if (j == i || removed[j] || minutiae[j].type != a.type) return;
+                const SkeletonMinutia& b = minutiae[j];
+                if (angularDistance(a.angle, b.angle + CV_PI) > config.oppositeTolerance) return;
+
+                const cv::Point2f d = b.position - a.position;
+                if (a.type == 0) {
+                    // Terminações de uma crista interrompida apontam uma para a outra (eixo y para cima)
+                    const double towards = std::atan2(-d.y, d.x);
+                    if (angularDistance(a.angle, towards) > config.oppositeTolerance) return;
+                }
+
+                const double distance = d.x * d.x + d.y * d.y;
+                if (distance < partnerDistance) {
+                    partnerDistance = distance;
+                    partner = j;
+                }
+            });
+
+            if (partner >= 0) {
+                removed[i] = 1;
+                removed[partner] = 1;
+                counts.pairs += 2;
+            }
+        }
+    }
+
+    kept.reserve(n - counts.removed());
+    for (int i = 0; i < n; ++i) {
+        if (removed[i]) continue;
+        kept.push_back(minutiae[i]);
+        kept.back().id = static_cast<int>(kept.size());
+    }
+
+    if (stats) *stats = counts;
+    return kept;
+}
+
+double FalseMinutiaeFilter::ridgePeriod(const RidgeField& field, double fallback) {
+    if (!field.isValid() || field.frequency.empty()) return fallback;
+
+    std::vector<float> frequencies;
+    frequencies.reserve(field.frequency.total());
+    for (int y = 0; y < field.frequency.rows; ++y) {
+        const float* f = field.frequency.ptr<float>(y);
+        const uchar* valid = field.frequencyValid.empty() ? nullptr : field.frequencyValid.ptr<uchar>(y);
+        for (int x = 0; x < field.frequency.cols; ++x) {
+            if (f[x] > 0.0f && (!valid || valid[x])) frequencies.push_back(f[x]);
+        }
+    }
+    if (frequencies.empty()) return fallback;
+
+    auto middle = frequencies.begin() + frequencies.size() / 2;
+    std::nth_element(frequencies.begin(), middle, frequencies.end());
+    return 1.0 / *middle;
+}
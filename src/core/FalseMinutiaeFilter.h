@@ -0,0 +1,74 @@
+#ifndef FALSEMINUTIAEFILTER_H
+#define FALSEMINUTIAEFILTER_H
+
+#include <opencv2/core.hpp>
+#include <QString>
+#include <vector>
+#include "CrossingNumber.h"
+
+struct RidgeField;
+
+/**
+ * @brief Parâmetros da remoção de falsas minúcias
+ *
+ * Distâncias em múltiplos do período das cristas, para valerem em qualquer resolução.
+ */
+struct FalseMinutiaeConfig {
+    double ridgePeriod = 9.0;           // Período das cristas em pixels (~500 ppi)
+    double spurLength = 1.0;            // Ramos até uma bifurcação ou terminação mais curtos que isto
+    double pairDistance = 1.0;          // Pares opostos do mesmo tipo mais próximos que isto
+    double borderDistance = 1.5;        // Distância mínima à borda da segmentação (0 = não filtrar)
+    double oppositeTolerance = 0.6;     // Desvio aceito de direções opostas (radianos, ~35°)
+
+    QString toString() const;
+};
+
+/**
+ * @brief Quantas minúcias cada regra removeu
+ */
+struct FalseMinutiaeStats {
+    int border = 0;         // Perto da borda da impressão ou da imagem
+    int spurs = 0;          // Esporas: terminação ligada a bifurcação próxima (conta as duas)
+    int shortRidges = 0;    // Fragmentos de crista curtos: duas terminações (conta as duas)
+    int pairs = 0;          // Pares opostos próximos: crista interrompida ou ponte (conta as duas)
+
+    int removed() const { return border + spurs + shortRidges + pairs; }
+};
+
+/**
+ * @brief Pós-processamento da saída do número de cruzamentos
+ *
+ * Remove, nesta ordem:
+ * - minúcias a menos de borderDistance da borda da máscara de segmentação
+ *   (transformada de distância da máscara, calculada uma vez);
+ * - esporas e fragmentos curtos: a partir de cada terminação o esqueleto é
+ *   percorrido por no máximo spurLength; se encontrar uma bifurcação ou outra
+ *   terminação, as duas saem;
+ * - pares do mesmo tipo com direções opostas a menos de pairDistance
+ *   (terminações também precisam apontar uma para a outra).
+ *
+ * As vizinhanças vêm de um grid espacial com células do tamanho do raio de
+ * busca: cada consulta olha só as células vizinhas, então o custo é linear
+ * no número de minúcias (mais a transformada de distância), em vez de O(n²).
+ */
+class FalseMinutiaeFilter {
+public:
+    /**
+     * @param skeleton Esqueleto usado na extração (CV_8UC1, não nulo = crista)
+     * @param foreground Máscara da impressão do mesmo tamanho (não nulo = dentro);
+     *                   vazia = imagem inteira, só a borda da imagem conta
+     * @return Minúcias mantidas, na ordem original e renumeradas a partir de 1
+     */
+    static std::vector<SkeletonMinutia> apply(const std::vector<SkeletonMinutia>& minutiae,
+                                              const cv::Mat& skeleton,
+                                              const cv::Mat& foreground = cv::Mat(),
+                                              const FalseMinutiaeConfig& config = FalseMinutiaeConfig(),
+                                              FalseMinutiaeStats* stats = nullptr);
+
+    /**
+     * @brief Período mediano dos blocos com frequência medida, ou fallback se não houver
+     */
+    static double ridgePeriod(const RidgeField& field, double fallback = FalseMinutiaeConfig().ridgePeriod);
+};
+
+#endif // FALSEMINUTIAEFILTER_H
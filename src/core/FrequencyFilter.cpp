@@ -0,0 +1,238 @@
+#include "FrequencyFilter.h"
+#include "FFTService.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+
+// ==================== Espectro ====================
+
+cv::Mat FrequencyFilter::toGray(const cv::Mat& image) {
+    if (image.channels() == 1) return image;
+    cv::Mat gray;
+    cv::cvtColor(image, gray, image.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    return gray;
+}
+
+cv::Mat FrequencyFilter::forward(const cv::Mat& gray) {
+    return FFTService::forward(gray);
+}
+
+cv::Mat FrequencyFilter::magnitude(const cv::Mat& ccs) {
+    // Layout CCS (OpenCV): colunas internas guardam pares (Re, Im) de Y(j, c),
+    // c = 1..(cols-1)/2, para todas as linhas; a coluna 0 e, com cols par, a
+    // última guardam as colunas reais c = 0 e c = cols/2 empacotadas ao longo
+    // das linhas. A outra metade vem da simetria Y(j, c) = conj(Y(-j, -c)).
+    const int rows = ccs.rows;
+    const int cols = ccs.cols;
+    cv::Mat result(rows, cols, CV_32F);
+
+    const int innerCols = (cols - 1) / 2;
+    for (int j = 0; j < rows; ++j) {
+        const float* src = ccs.ptr<float>(j);
+        float* dst = result.ptr<float>(j);
+        for (int c = 1; c <= innerCols; ++c) {
+            dst[c] = std::hypot(src[2 * c - 1], src[2 * c]);
+        }
+    }
+
+    auto unpackColumn = [&](int ccsCol, int c) {
+        result.at<float>(0, c) = std::abs(ccs.at<float>(0, ccsCol));
+        for (int r = 1; r <= (rows - 1) / 2; ++r) {
+            result.at<float>(r, c) = std::hypot(ccs.at<float>(2 * r - 1, ccsCol), ccs.at<float>(2 * r, ccsCol));
+        }
+        if (rows % 2 == 0 && rows > 1) {
+            result.at<float>(rows / 2, c) = std::abs(ccs.at<float>(rows - 1, ccsCol));
+        }
+        for (int r = rows / 2 + 1; r < rows; ++r) {
+            result.at<float>(r, c) = result.at<float>(rows - r, c);
+        }
+    };
+    unpackColumn(0, 0);
+    if (cols % 2 == 0 && cols > 1) {
+        unpackColumn(cols - 1, cols / 2);
+    }
+
+    // Metade conjugada: |Y(j, c)| = |Y(-j, -c)|
+    for (int j = 0; j < rows; ++j) {
+        float* dst = result.ptr<float>(j);
+        const float* mirror = result.ptr<float>((rows - j) % rows);
+        for (int c = cols / 2 + 1; c < cols; ++c) {
+            dst[c] = mirror[cols - c];
+        }
+    }
+
+    return result;
+}
+
+cv::Mat FrequencyFilter::centeredLogMagnitude(const cv::Mat& ccs) {
+    cv::Mat logMagnitude = magnitude(ccs);
+    logMagnitude += cv::Scalar::all(1);
+    cv::log(logMagnitude, logMagnitude);
+    return shift(logMagnitude);
+}
+
+cv::Mat FrequencyFilter::shift(const cv::Mat& image) {
+    cv::Mat result = image.clone();
+    int cx = result.cols / 2;
+    int cy = result.rows / 2;
+
+    cv::Mat q0(result, cv::Rect(0, 0, cx, cy));   // Top-Left
+    cv::Mat q1(result, cv::Rect(cx, 0, cx, cy));  // Top-Right
+    cv::Mat q2(result, cv::Rect(0, cy, cx, cy));  // Bottom-Left
+    cv::Mat q3(result, cv::Rect(cx, cy, cx, cy)); // Bottom-Right
+
+    cv::Mat tmp;
+    q0.copyTo(tmp);
+    q3.copyTo(q0);
+    tmp.copyTo(q3);
+
+    q1.copyTo(tmp);
+    q2.copyTo(q1);
+    tmp.copyTo(q2);
+
+    return result;
+}
+
+// ==================== Máscaras ====================
+
+cv::Mat FrequencyFilter::maskFromRects(const QVector<QRect>& rects, const cv::Size& size, bool invert) {
+    // Criar máscara com todos 1s
+    cv::Mat mask = cv::Mat::ones(size, CV_32F);
+
+    // Descentrar os retângulos (inverter shift)
+    int cx = size.width / 2;
+    int cy = size.height / 2;
+
+    for (const QRect& rect : rects) {
+        // Converter coordenadas de centralizado para normal
+        cv::Rect shiftedRect = cv::Rect(rect.x(), rect.y(), rect.width(), rect.height());
+
+        // Aplicar shift reverso (4 quadrantes)
+        std::vector<cv::Rect> quadrants;
+
+        // Quadrante onde o retângulo está
+        if (shiftedRect.x < cx && shiftedRect.y < cy) {
+            // Top-Left -> Bottom-Right
+            quadrants.push_back(cv::Rect(shiftedRect.x + cx, shiftedRect.y + cy, shiftedRect.width, shiftedRect.height));
+        }
+        if (shiftedRect.x >= cx && shiftedRect.y < cy) {
+            // Top-Right -> Bottom-Left
+            quadrants.push_back(cv::Rect(shiftedRect.x - cx, shiftedRect.y + cy, shiftedRect.width, shiftedRect.height));
+        }
+        if (shiftedRect.x < cx && shiftedRect.y >= cy) {
+            // Bottom-Left -> Top-Right
+            quadrants.push_back(cv::Rect(shiftedRect.x + cx, shiftedRect.y - cy, shiftedRect.width, shiftedRect.height));
+        }
+        if (shiftedRect.x >= cx && shiftedRect.y >= cy) {
+            // Bottom-Right -> Top-Left
+            quadrants.push_back(cv::Rect(shiftedRect.x - cx, shiftedRect.y - cy, shiftedRect.width, shiftedRect.height));
+        }
+
+        // Zerar (remover) ou manter as regiões
+        for (const cv::Rect& qr : quadrants) {
+            cv::Rect clipped = qr & cv::Rect(0, 0, size.width, size.height);
+            if (clipped.area() > 0) {
+                if (invert) {
+                    // Inverter: começar com zeros e manter apenas seleção
+                    // Implementação simplificada - na prática precisa de lógica mais complexa
+                    mask(clipped) = 1.0;
+                } else {
+                    mask(clipped) = 0.0;
+                }
+            }
+        }
+    }
+
+    // Se invert, precisamos inverter toda a máscara
+    if (invert && !rects.isEmpty()) {
+        cv::Mat tempMask = cv::Mat::zeros(size, CV_32F);
+        for (const QRect& rect : rects) {
+            cv::Rect shiftedRect(rect.x(), rect.y(), rect.width(), rect.height());
+            // Aplicar lógica similar mas setando 1 na seleção
+            std::vector<cv::Rect> quadrants;
+
+            if (shiftedRect.x < cx && shiftedRect.y < cy) {
+                quadrants.push_back(cv::Rect(shiftedRect.x + cx, shiftedRect.y + cy, shiftedRect.width, shiftedRect.height));
+            }
+            if (shiftedRect.x >= cx && shiftedRect.y < cy) {
+                quadrants.push_back(cv::Rect(shiftedRect.x - cx, shiftedRect.y + cy, shiftedRect.width, shiftedRect.height));
+            }
+            if (shiftedRect.x < cx && shiftedRect.y >= cy) {
+                quadrants.push_back(cv::Rect(shiftedRect.x + cx, shiftedRect.y - cy, shiftedRect.width, shiftedRect.height));
+            }
+            if (shiftedRect.x >= cx && shiftedRect.y >= cy) {
+                quadrants.push_back(cv::Rect(shiftedRect.x - cx, shiftedRect.y - cy, shiftedRect.width, shiftedRect.height));
+            }
+
+            for (const cv::Rect& qr : quadrants) {
+                cv::Rect clipped = qr & cv::Rect(0, 0, size.width, size.height);
+                if (clipped.area() > 0) {
+                    tempMask(clipped) = 1.0;
+                }
+            }
+        }
+        mask = tempMask;
+    }
+
+    return mask;
+}
+
+cv::Mat FrequencyFilter::packMask(const cv::Mat& mask, bool invert) {
+    // O espectro CCS guarda só metade do plano: a máscara é simetrizada
+    // (m(j, c) e m(-j, -c)) para que a saída continue real. Remoção vale se
+    // qualquer um dos pontos foi marcado; com inversão, mantém se qualquer um.
+    const int rows = mask.rows;
+    const int cols = mask.cols;
+    auto value = [&](int j, int c) {
+        float a = mask.at<float>(j, c);
+        float b = mask.at<float>((rows - j) % rows, (cols - c) % cols);
+        return invert ? std::max(a, b) : std::min(a, b);
+    };
+
+    cv::Mat packed(rows, cols, CV_32F);
+
+    const int innerCols = (cols - 1) / 2;
+    for (int j = 0; j < rows; ++j) {
+        float* dst = packed.ptr<float>(j);
+        for (int c = 1; c <= innerCols; ++c) {
+            dst[2 * c - 1] = dst[2 * c] = value(j, c);
+        }
+    }
+
+    auto packColumn = [&](int ccsCol, int c) {
+        packed.at<float>(0, ccsCol) = value(0, c);
+        for (int r = 1; r <= (rows - 1) / 2; ++r) {
+            packed.at<float>(2 * r - 1, ccsCol) = packed.at<float>(2 * r, ccsCol) = value(r, c);
+        }
+        if (rows % 2 == 0 && rows > 1) {
+            packed.at<float>(rows - 1, ccsCol) = value(rows / 2, c);
+        }
+    };
+    packColumn(0, 0);
+    if (cols % 2 == 0 && cols > 1) {
+        packColumn(cols - 1, cols / 2);
+    }
+
+    return packed;
+}
+
+// ==================== Filtragem ====================
+
+cv::Mat FrequencyFilter::apply(const cv::Mat& ccs, const QVector<QRect>& rects, bool invert,
+                               const cv::Size& outputSize, int channels) {
+    // Máscara aplicada diretamente no espectro empacotado; IFFT real cortada ao tamanho original
+    cv::Mat mask = maskFromRects(rects, ccs.size(), invert);
+    cv::Mat ifft = FFTService::inverseMasked(ccs, packMask(mask, invert), outputSize);
+
+    // Normalizar e converter
+    cv::Mat result;
+    cv::normalize(ifft, result, 0, 255, cv::NORM_MINMAX);
+    result.convertTo(result, CV_8U);
+
+    // Se original era colorido, converter de volta
+    if (channels == 3) {
+        cv::cvtColor(result, result, cv::COLOR_GRAY2BGR);
+    }
+
+    return result;
+}
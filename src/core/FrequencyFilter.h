@@ -0,0 +1,68 @@
+#ifndef FREQUENCYFILTER_H
+#define FREQUENCYFILTER_H
+
+#include <opencv2/core.hpp>
+#include <QVector>
+#include <QRect>
+
+/**
+ * @brief Filtragem no domínio da frequência sobre espectros CCS
+ *
+ * O espectro direto de uma imagem real é guardado no formato empacotado do
+ * OpenCV (CCS): um canal CV_32F com o tamanho da imagem expandida, metade da
+ * memória do espectro complexo. As máscaras são desenhadas em coordenadas do
+ * espectro centralizado (DC no centro), simetrizadas e empacotadas no mesmo
+ * layout, de modo que filtrar é um produto elemento a elemento seguido da
+ * DFT inversa real.
+ */
+class FrequencyFilter {
+public:
+    /**
+     * @brief Conversão para tons de cinza (cópia rasa se já for 1 canal)
+     */
+    static cv::Mat toGray(const cv::Mat& image);
+
+    /**
+     * @brief DFT real direta da imagem expandida com zeros ao tamanho ótimo
+     * @return Espectro CCS (CV_32F)
+     * @see FFTService::forward
+     */
+    static cv::Mat forward(const cv::Mat& gray);
+
+    /**
+     * @brief Magnitude |Y| no plano completo, sem centralizar
+     */
+    static cv::Mat magnitude(const cv::Mat& ccs);
+
+    /**
+     * @brief log(1 + |Y|) centralizado, na mesma geometria exibida ao usuário
+     */
+    static cv::Mat centeredLogMagnitude(const cv::Mat& ccs);
+
+    /**
+     * @brief Troca de quadrantes (centraliza o DC)
+     */
+    static cv::Mat shift(const cv::Mat& image);
+
+    /**
+     * @brief Máscara do plano completo a partir de retângulos no espectro centralizado
+     * @param invert false = remover os retângulos; true = manter apenas os retângulos
+     */
+    static cv::Mat maskFromRects(const QVector<QRect>& rects, const cv::Size& size, bool invert);
+
+    /**
+     * @brief Máscara simetrizada no layout CCS
+     */
+    static cv::Mat packMask(const cv::Mat& mask, bool invert);
+
+    /**
+     * @brief Aplica a máscara e volta ao domínio espacial
+     * @param outputSize Tamanho original (antes da expansão)
+     * @param channels 3 para devolver BGR
+     * @return CV_8U normalizado para 0-255
+     */
+    static cv::Mat apply(const cv::Mat& ccs, const QVector<QRect>& rects, bool invert,
+                         const cv::Size& outputSize, int channels = 1);
+};
+
+#endif // FREQUENCYFILTER_H
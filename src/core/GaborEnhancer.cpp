@@ -0,0 +1,271 @@
+#include "GaborEnhancer.h"
+#include <opencv2/imgproc.hpp>
+#include <QMutex>
+#include <QDebug>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace {
+
+struct BankCacheEntry {
+    GaborConfig config;
+    int blockSize;
+    std::shared_ptr<const GaborFilterBank> bank;
+};
+
+QMutex bankMutex;
+std::vector<BankCacheEntry> bankCache;
+
+// Blocos por faixa de trabalho paralela
+const int kBlockRowsPerStripe = 2;
+
+} // namespace
+
+// ==================== GaborConfig ====================
+
+bool GaborConfig::operator==(const GaborConfig& other) const {
+    return orientationBins == other.orientationBins &&
+           frequencyBins == other.frequencyBins &&
+           minFrequency == other.minFrequency &&
+           maxFrequency == other.maxFrequency &&
+           kx == other.kx && ky == other.ky &&
+           fftKernelSize == other.fftKernelSize;
+}
+
+QString GaborConfig::toString() const {
+    return QString("orientations=%1, frequencies=%2, period=%3-%4px, kx=%5, ky=%6")
+        .arg(orientationBins).arg(frequencyBins)
+        .arg(1.0 / maxFrequency, 0, 'f', 1).arg(1.0 / minFrequency, 0, 'f', 1)
+        .arg(kx).arg(ky);
+}
+
+// ==================== GaborFilterBank ====================
+
+GaborFilterBank::GaborFilterBank(const GaborConfig& config, int blockSize)
+    : m_config(config)
+    , m_maxRadius(0)
+{
+    const int orientations = std::max(1, config.orientationBins);
+    const int frequencies = std::max(1, config.frequencyBins);
+
+    for (int f = 0; f < frequencies; ++f) {
+        double t = (frequencies > 1) ? static_cast<double>(f) / (frequencies - 1) : 0.5;
+        m_logFrequencies.push_back(std::log(config.minFrequency) +
+                                   t * (std::log(config.maxFrequency) - std::log(config.minFrequency)));
+    }
+
+    m_kernels.resize(static_cast<size_t>(orientations) * frequencies);
+
+    for (int o = 0; o < orientations; ++o) {
+        double theta = M_PI * o / orientations;
+        double c = std::cos(theta);
+        double s = std::sin(theta);
+
+        for (int f = 0; f < frequencies; ++f) {
+            GaborKernel& k = m_kernels[static_cast<size_t>(o) * frequencies + f];
+            k.orientation = theta;
+            k.frequency = std::exp(m_logFrequencies[f]);
+
+            double period = 1.0 / k.frequency;
+            double sigmaX = config.kx * period;
+            double sigmaY = config.ky * period;
+            k.radius = static_cast<int>(std::ceil(3.0 * std::max(sigmaX, sigmaY)));
+            m_maxRadius = std::max(m_maxRadius, k.radius);
+
+            int size = 2 * k.radius + 1;
+            k.kernel.create(size, size, CV_32F);
+            for (int y = -k.radius; y <= k.radius; ++y) {
+                float* row = k.kernel.ptr<float>(y + k.radius);
+                for (int x = -k.radius; x <= k.radius; ++x) {
+                    double across = -x * s + y * c;   // Normal às cristas
+                    double along = x * c + y * s;     // Ao longo das cristas
+                    double envelope = std::exp(-0.5 * (across * across / (sigmaX * sigmaX) +
+                                                       along * along / (sigmaY * sigmaY)));
+                    row[x + k.radius] = static_cast<float>(envelope * std::cos(2.0 * M_PI * k.frequency * across));
+                }
+            }
+
+            // Média zero: regiões uniformes não geram resposta
+            k.kernel -= cv::mean(k.kernel)[0];
+
+            k.useFFT = (size >= config.fftKernelSize);
+            if (k.useFFT) {
+                int patch = blockSize + 2 * k.radius;
+                k.dftSize = cv::Size(cv::getOptimalDFTSize(patch + size - 1),
+                                     cv::getOptimalDFTSize(patch + size - 1));
+                cv::Mat padded = cv::Mat::zeros(k.dftSize, CV_32F);
+                k.kernel.copyTo(padded(cv::Rect(0, 0, size, size)));
+                cv::dft(padded, k.spectrum, 0, size);
+            }
+        }
+    }
+}
+
+const GaborKernel& GaborFilterBank::kernel(int orientationIndex, int frequencyIndex) const {
+    return m_kernels[static_cast<size_t>(orientationIndex) * m_logFrequencies.size() + frequencyIndex];
+}
+
+int GaborFilterBank::orientationIndex(double orientation) const {
+    const int bins = std::max(1, m_config.orientationBins);
+    int index = static_cast<int>(std::lround(orientation / M_PI * bins));
+    return ((index % bins) + bins) % bins;
+}
+
+int GaborFilterBank::frequencyIndex(double frequency) const {
+    double value = std::log(std::clamp(frequency, m_config.minFrequency, m_config.maxFrequency));
+    int best = 0;
+    for (int f = 1; f < static_cast<int>(m_logFrequencies.size()); ++f) {
+        if (std::abs(m_logFrequencies[f] - value) < std::abs(m_logFrequencies[best] - value)) {
+            best = f;
+        }
+    }
+    return best;
+}
+
+std::shared_ptr<const GaborFilterBank> GaborFilterBank::get(const GaborConfig& config, int blockSize) {
+    QMutexLocker locker(&bankMutex);
+    for (const auto& entry : bankCache) {
+        if (entry.blockSize == blockSize && entry.config == config) {
+            return entry.bank;
+        }
+    }
+
+    auto bank = std::make_shared<const GaborFilterBank>(config, blockSize);
+    if (bankCache.size() >= 4) {
+        bankCache.erase(bankCache.begin());
+    }
+    bankCache.push_back({config, blockSize, bank});
+    return bank;
+}
+
+// ==================== GaborEnhancer ====================
+
+cv::Mat GaborEnhancer::enhance(const cv::Mat& image, const RidgeField& field,
+                               const GaborConfig& config, const ProgressCallback& progress,
+                               const cv::Mat& blockMask) {
+    if (image.empty() || !field.isValid()) return cv::Mat();
+
+    const int bs = field.blockSize;
+    const cv::Size blocks = field.blocks();
+
+    // Máscara por bloco (área da impressão) expandida para pixels
+    const bool masked = !blockMask.empty() && blockMask.size() == blocks;
+    cv::Mat activePixels;
+    if (masked) {
+        cv::resize(blockMask, activePixels, cv::Size(blocks.width * bs, blocks.height * bs), 0, 0, cv::INTER_NEAREST);
+        activePixels = activePixels(cv::Rect(0, 0, image.cols, image.rows));
+    }
+
+    cv::Mat gray;
+    if (image.channels() > 1) {
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        gray = image;
+    }
+
+    // Normalização global para média zero e variância unitária
+    cv::Mat normalized;
+    gray.convertTo(normalized, CV_32F);
+    cv::Scalar mean, stddev;
+    cv::meanStdDev(normalized, mean, stddev, activePixels);
+    normalized = (normalized - mean[0]) / std::max(1e-6, stddev[0]);
+
+    std::shared_ptr<const GaborFilterBank> bank = GaborFilterBank::get(config, bs);
+
+    // Borda refletida com o maior raio: todo bloco tem vizinhança completa
+    const int pad = bank->maxRadius();
+    cv::Mat source;
+    cv::copyMakeBorder(normalized, source, pad, pad, pad, pad, cv::BORDER_REFLECT_101);
+
+    // Frequência de referência para blocos sem estimativa
+    double fallbackFrequency = 0.0;
+    {
+        cv::Mat validMask = field.frequency > 0;
+        fallbackFrequency = (cv::countNonZero(validMask) > 0)
+            ? cv::mean(field.frequency, validMask)[0] : 1.0 / 9.0;
+    }
+
+    cv::Mat response(gray.size(), CV_32F, cv::Scalar(0));
+
+    const int stripes = (blocks.height + kBlockRowsPerStripe - 1) / kBlockRowsPerStripe;
+    std::atomic<int> done{0};
+    std::atomic<bool> cancelled{false};
+
+    cv::parallel_for_(cv::Range(0, stripes), [&](const cv::Range& range) {
+        cv::Mat patchSpectrum, product, filtered, padded;
+
+        for (int stripe = range.start; stripe < range.end; ++stripe) {
+            if (cancelled.load()) return;
+
+            int byEnd = std::min(blocks.height, (stripe + 1) * kBlockRowsPerStripe);
+            for (int by = stripe * kBlockRowsPerStripe; by < byEnd; ++by) {
+                for (int bx = 0; bx < blocks.width; ++bx) {
+                    if (masked && !blockMask.at<uchar>(by, bx)) continue;
+
+                    cv::Rect block(bx * bs, by * bs,
+                                   std::min(bs, gray.cols - bx * bs),
+                                   std::min(bs, gray.rows - by * bs));
+
+                    double frequency = field.frequency.at<float>(by, bx);
+                    if (frequency <= 0.0) frequency = fallbackFrequency;
+
+                    const GaborKernel& k = bank->kernel(
+                        bank->orientationIndex(field.orientation.at<float>(by, bx)),
+                        bank->frequencyIndex(frequency));
+
+                    const int r = k.radius;
+                    cv::Mat out = response(block);
+
+                    if (k.useFFT) {
+                        // Bloco + halo no tamanho da DFT pré-calculada do kernel
+                        cv::Rect patchRect(block.x + pad - r, block.y + pad - r,
+                                           block.width + 2 * r, block.height + 2 * r);
+                        padded = cv::Mat::zeros(k.dftSize, CV_32F);
+                        source(patchRect).copyTo(padded(cv::Rect(0, 0, patchRect.width, patchRect.height)));
+                        cv::dft(padded, patchSpectrum, 0, patchRect.height);
+                        cv::mulSpectrums(patchSpectrum, k.spectrum, product, 0);
+                        cv::dft(product, filtered, cv::DFT_INVERSE | cv::DFT_SCALE | cv::DFT_REAL_OUTPUT);
+
+                        // Convolução linear: saída válida começa em 2r; kernel simétrico
+                        filtered(cv::Rect(2 * r, 2 * r, block.width, block.height)).copyTo(out);
+                    } else {
+                        for (int y = 0; y < block.height; ++y) {
+                            float* dst = out.ptr<float>(y);
+                            for (int x = 0; x < block.width; ++x) {
+                                int sx = block.x + x + pad - r;
+                                int sy = block.y + y + pad - r;
+                                float sum = 0.0f;
+                                for (int ky = 0; ky < k.kernel.rows; ++ky) {
+                                    const float* src = source.ptr<float>(sy + ky) + sx;
+                                    const float* kr = k.kernel.ptr<float>(ky);
+                                    for (int kx = 0; kx < k.kernel.cols; ++kx) {
+                                        sum += src[kx] * kr[kx];
+                                    }
+                                }
+                                dst[x] = sum;
+                            }
+                        }
+                    }
+                }
+            }
+
+            int finished = ++done;
+            if (progress && !progress(finished, stripes)) {
+                cancelled = true;
+            }
+        }
+    });
+
+    if (cancelled.load()) return cv::Mat();
+
+    // Cristas escuras como na entrada: resposta positiva = vale; saturar em ±3σ
+    cv::Scalar responseMean, responseStd;
+    cv::meanStdDev(response, responseMean, responseStd, activePixels);
+    double limit = 3.0 * std::max(1e-6, responseStd[0]);
+
+    cv::Mat result;
+    response.convertTo(result, CV_8U, 127.5 / limit, 127.5);
+    if (masked) result.setTo(255, activePixels == 0);
+    return result;
+}
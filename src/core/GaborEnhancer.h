@@ -0,0 +1,87 @@
+#ifndef GABORENHANCER_H
+#define GABORENHANCER_H
+
+#include <opencv2/core.hpp>
+#include <QString>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "RidgeGeometry.h"
+
+/**
+ * @brief Parâmetros do banco de filtros de Gabor
+ */
+struct GaborConfig {
+    int orientationBins = 16;       // Quantização de [0, π)
+    int frequencyBins = 8;          // Quantização geométrica de [minFrequency, maxFrequency]
+    double minFrequency = 1.0 / 25.0;
+    double maxFrequency = 1.0 / 3.0;
+    double kx = 0.65;               // σ normal às cristas = kx · período
+    double ky = 0.65;               // σ ao longo das cristas = ky · período
+    int fftKernelSize = 23;         // Kernels a partir deste lado usam convolução por FFT
+
+    bool operator==(const GaborConfig& other) const;
+    QString toString() const;
+};
+
+/**
+ * @brief Kernel pré-calculado de uma combinação (orientação, frequência)
+ */
+struct GaborKernel {
+    double orientation = 0.0;       // Direção das cristas (radianos)
+    double frequency = 0.0;         // 1/pixel
+    int radius = 0;
+    cv::Mat kernel;                 // CV_32F, (2r+1)², média zero
+    bool useFFT = false;
+    cv::Size dftSize;               // Tamanho da DFT para bloco + halo
+    cv::Mat spectrum;               // DFT do kernel (CCS), para blocos com useFFT
+};
+
+/**
+ * @brief Banco de kernels de Gabor pares, indexado por (orientação, frequência)
+ *
+ * Construído uma vez por configuração e tamanho de bloco; obtido via GaborFilterBank::get().
+ */
+class GaborFilterBank {
+public:
+    GaborFilterBank(const GaborConfig& config, int blockSize);
+
+    const GaborKernel& kernel(int orientationIndex, int frequencyIndex) const;
+    int orientationIndex(double orientation) const;
+    int frequencyIndex(double frequency) const;
+    int maxRadius() const { return m_maxRadius; }
+
+    static std::shared_ptr<const GaborFilterBank> get(const GaborConfig& config, int blockSize);
+
+private:
+    GaborConfig m_config;
+    std::vector<GaborKernel> m_kernels;
+    std::vector<double> m_logFrequencies;
+    int m_maxRadius;
+};
+
+/**
+ * @brief Realce contextual por filtros de Gabor orientados (Hong, Wan & Jain, 1998)
+ *
+ * Cada bloco do campo de orientação/frequência é filtrado com o kernel do
+ * banco mais próximo dos seus valores: convolução direta para kernels
+ * pequenos, multiplicação de espectros com a DFT pré-calculada do kernel
+ * para os grandes. Os blocos são processados em paralelo por faixas.
+ */
+class GaborEnhancer {
+public:
+    using ProgressCallback = std::function<bool(int done, int total)>;
+
+    /**
+     * @brief Realça a imagem usando um campo já calculado
+     * @param blockMask CV_8U com o grid do campo (opcional): blocos zerados não
+     *        são filtrados e saem como fundo claro (255)
+     * @return Imagem CV_8U com cristas escuras, ou vazia se cancelada
+     */
+    static cv::Mat enhance(const cv::Mat& image, const RidgeField& field,
+                           const GaborConfig& config = GaborConfig(),
+                           const ProgressCallback& progress = nullptr,
+                           const cv::Mat& blockMask = cv::Mat());
+};
+
+#endif // GABORENHANCER_H
@@ -0,0 +1,431 @@
+#include "GeometricTransform.h"
+#include "RidgeGeometry.h"
+#include <opencv2/imgproc.hpp>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QMutex>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Bases são imagens inteiras: poucas entidades em memória
+const int kMaxCachedEntities = 4;
+
+// Imagens de trabalho com geometria conhecida por entidade (desfazer/refazer voltam a elas)
+const int kMaxKnownOutputs = 16;
+
+struct CacheEntry {
+    cv::Mat base;
+    GeometricTransform fromOriginal;
+    GeometricTransform current;
+    quint64 outputHash = 0;
+    QList<QPair<quint64, GeometricTransform>> known;    // Conteúdo → original → imagem
+    quint64 lastUse = 0;
+
+    // Última imagem de trabalho consultada em current(): o mesmo buffer, sem commit/carry/touch
+    // desde então, tem o mesmo conteúdo (evita o hash da imagem inteira a cada pintura)
+    const uchar* seenData = nullptr;
+    cv::Size seenSize;
+    int seenType = -1;
+    quint64 seenHash = 0;
+
+    bool sawBuffer(const cv::Mat& working) const {
+        return seenData && working.data == seenData && working.size() == seenSize && working.type() == seenType;
+    }
+
+    void forgetBuffer() {
+        seenData = nullptr;
+    }
+
+    GeometricTransform geometryOf(quint64 hash) const {
+        for (const auto& item : known) {
+            if (item.first == hash) return item.second;
+        }
+        return GeometricTransform();
+    }
+
+    void remember(quint64 hash, const GeometricTransform& geometry) {
+        for (int i = 0; i < known.size(); ++i) {
+            if (known[i].first == hash) {
+                known.removeAt(i);
+                break;
+            }
+        }
+        known.append(qMakePair(hash, geometry));
+        while (known.size() > kMaxKnownOutputs) known.removeFirst();
+    }
+};
+
+QMutex cacheMutex;
+QHash<QString, CacheEntry> stackCache;
+quint64 useCounter = 0;
+
+// Elimina o resíduo de ponto flutuante: 90° + espelhos viram permutações exatas
+double snap(double value, double tolerance) {
+    const double rounded = std::round(value);
+    return std::abs(value - rounded) < tolerance ? rounded : value;
+}
+
+cv::Matx23d snapped(const cv::Matx23d& m) {
+    return cv::Matx23d(snap(m(0, 0), 1e-12), snap(m(0, 1), 1e-12), snap(m(0, 2), 1e-9),
+                       snap(m(1, 0), 1e-12), snap(m(1, 1), 1e-12), snap(m(1, 2), 1e-9));
+}
+
+cv::Matx23d compose(const cv::Matx23d& outer, const cv::Matx23d& inner) {
+    return cv::Matx23d(
+        outer(0, 0) * inner(0, 0) + outer(0, 1) * inner(1, 0),
+        outer(0, 0) * inner(0, 1) + outer(0, 1) * inner(1, 1),
+        outer(0, 0) * inner(0, 2) + outer(0, 1) * inner(1, 2) + outer(0, 2),
+        outer(1, 0) * inner(0, 0) + outer(1, 1) * inner(1, 0),
+        outer(1, 0) * inner(0, 1) + outer(1, 1) * inner(1, 1),
+        outer(1, 0) * inner(0, 2) + outer(1, 1) * inner(1, 2) + outer(1, 2));
+}
+
+cv::Matx23d inverse(const cv::Matx23d& m) {
+    const double det = m(0, 0) * m(1, 1) - m(0, 1) * m(1, 0);
+    const double a = m(1, 1) / det, b = -m(0, 1) / det;
+    const double c = -m(1, 0) / det, d = m(0, 0) / det;
+    return cv::Matx23d(a, b, -(a * m(0, 2) + b * m(1, 2)),
+                       c, d, -(c * m(0, 2) + d * m(1, 2)));
+}
+
+cv::Point2d transformPoint(const cv::Matx23d& m, const cv::Point2d& p) {
+    return cv::Point2d(m(0, 0) * p.x + m(0, 1) * p.y + m(0, 2),
+                       m(1, 0) * p.x + m(1, 1) * p.y + m(1, 2));
+}
+
+double whiteLevel(int depth) {
+    switch (depth) {
+        case CV_16U: return 65535.0;
+        case CV_32F:
+        case CV_64F: return 1.0;
+        default:     return 255.0;
+    }
+}
+
+} // namespace
+
+// ========== GeometricTransform ==========
+
+GeometricTransform::GeometricTransform(const cv::Size& sourceSize)
+    : m_sourceSize(sourceSize), m_outputSize(sourceSize) {
+}
+
+GeometricTransform GeometricTransform::composed(const cv::Matx22d& linear) const {
+    GeometricTransform result = *this;
+    result.m_matrix = compose(cv::Matx23d(linear(0, 0), linear(0, 1), 0, linear(1, 0), linear(1, 1), 0),
+                              m_matrix);
+    result.m_matrix = snapped(result.m_matrix);
+
+    // Tela = envoltório da origem transformada (bordas dos pixels em ±0,5)
+    const double w = m_sourceSize.width - 0.5, h = m_sourceSize.height - 0.5;
+    const cv::Point2d corners[4] = {{-0.5, -0.5}, {w, -0.5}, {w, h}, {-0.5, h}};
+    double minX = HUGE_VAL, minY = HUGE_VAL, maxX = -HUGE_VAL, maxY = -HUGE_VAL;
+    for (const cv::Point2d& corner : corners) {
+        const cv::Point2d p = transformPoint(result.m_matrix, corner);
+        minX = std::min(minX, p.x);
+        minY = std::min(minY, p.y);
+        maxX = std::max(maxX, p.x);
+        maxY = std::max(maxY, p.y);
+    }
+
+    result.m_outputSize = cv::Size(std::max(1, static_cast<int>(std::ceil(maxX - minX - 1e-6))),
+                                   std::max(1, static_cast<int>(std::ceil(maxY - minY - 1e-6))));
+    result.m_matrix(0, 2) += -0.5 - minX;
+    result.m_matrix(1, 2) += -0.5 - minY;
+    result.m_matrix = snapped(result.m_matrix);
+    return result;
+}
+
+GeometricTransform GeometricTransform::rotated(double degrees) const {
+    const double radians = degrees * CV_PI / 180.0;
+    const double c = std::cos(radians), s = std::sin(radians);
+    // Eixo y para baixo: ângulo positivo gira no sentido horário na tela
+    return composed(cv::Matx22d(c, -s, s, c));
+}
+
+GeometricTransform GeometricTransform::flippedHorizontal() const {
+    return composed(cv::Matx22d(-1, 0, 0, 1));
+}
+
+GeometricTransform GeometricTransform::flippedVertical() const {
+    return composed(cv::Matx22d(1, 0, 0, -1));
+}
+
+GeometricTransform GeometricTransform::scaled(double factor) const {
+    return composed(cv::Matx22d(factor, 0, 0, factor));
+}
+
+GeometricTransform GeometricTransform::relativeTo(const GeometricTransform& earlier) const {
+    GeometricTransform result;
+    result.m_matrix = snapped(compose(m_matrix, inverse(earlier.m_matrix)));
+    result.m_sourceSize = earlier.m_outputSize;
+    result.m_outputSize = m_outputSize;
+    return result;
+}
+
+bool GeometricTransform::isIdentity() const {
+    return m_matrix == cv::Matx23d(1, 0, 0, 0, 1, 0) && m_sourceSize == m_outputSize;
+}
+
+bool GeometricTransform::isAxisAligned() const {
+    auto unitOrZero = [](double v) { return v == 0.0 || v == 1.0 || v == -1.0; };
+    return unitOrZero(m_matrix(0, 0)) && unitOrZero(m_matrix(0, 1)) &&
+           unitOrZero(m_matrix(1, 0)) && unitOrZero(m_matrix(1, 1)) &&
+           m_matrix(0, 2) == std::round(m_matrix(0, 2)) && m_matrix(1, 2) == std::round(m_matrix(1, 2));
+}
+
+bool GeometricTransform::matches(const cv::Size& source, const cv::Size& output) const {
+    return isValid() && m_sourceSize == source && m_outputSize == output;
+}
+
+double GeometricTransform::angle() const {
+    double degrees = std::atan2(m_matrix(1, 0), m_matrix(0, 0)) * 180.0 / CV_PI;
+    if (degrees < 0.0) degrees += 360.0;
+    return degrees >= 360.0 - 1e-9 ? 0.0 : degrees;
+}
+
+cv::Mat GeometricTransform::apply(const cv::Mat& source, bool transparentBorder) const {
+    if (source.empty()) return cv::Mat();
+
+    cv::Mat result;
+    if (isAxisAligned() && !transparentBorder) {
+        const int b = static_cast<int>(m_matrix(0, 1));
+        const int c = static_cast<int>(m_matrix(1, 0));
+        const int a = static_cast<int>(m_matrix(0, 0));
+        const int d = static_cast<int>(m_matrix(1, 1));
+
+        if (a == 1 && d == 1)        result = source.clone();
+        else if (a == -1 && d == 1)  cv::flip(source, result, 1);
+        else if (a == 1 && d == -1)  cv::flip(source, result, 0);
+        else if (a == -1 && d == -1) cv::flip(source, result, -1);
+        else if (b == -1 && c == 1)  cv::rotate(source, result, cv::ROTATE_90_CLOCKWISE);
+        else if (b == 1 && c == -1)  cv::rotate(source, result, cv::ROTATE_90_COUNTERCLOCKWISE);
+        else if (b == 1 && c == 1)   cv::transpose(source, result);
+        else {
+            cv::transpose(source, result);
+            cv::flip(result, result, -1);
+        }
+        return result;
+    }
+
+    cv::Mat input = source;
+    cv::Scalar border = cv::Scalar::all(whiteLevel(source.depth()));
+    if (transparentBorder) {
+        if (source.channels() == 3) {
+            cv::cvtColor(source, input, cv::COLOR_BGR2BGRA);
+        } else if (source.channels() == 1) {
+            cv::cvtColor(source, input, cv::COLOR_GRAY2BGRA);
+        }
+        border = cv::Scalar(0, 0, 0, 0);
+    }
+
+    cv::warpAffine(input, result, cv::Mat(m_matrix), m_outputSize,
+                   cv::INTER_LINEAR, cv::BORDER_CONSTANT, border);
+    return result;
+}
+
+cv::Point2d GeometricTransform::map(const cv::Point2d& point) const {
+    return transformPoint(m_matrix, point);
+}
+
+cv::Point2d GeometricTransform::unmap(const cv::Point2d& point) const {
+    return transformPoint(inverse(m_matrix), point);
+}
+
+double GeometricTransform::mapAngle(double degrees) const {
+    // Vetor da direção em coordenadas da imagem (y para baixo)
+    const double radians = degrees * CV_PI / 180.0;
+    const double vx = std::cos(radians);
+    const double vy = -std::sin(radians);
+    const double mx = m_matrix(0, 0) * vx + m_matrix(0, 1) * vy;
+    const double my = m_matrix(1, 0) * vx + m_matrix(1, 1) * vy;
+
+    const double mapped = std::atan2(-my, mx) * 180.0 / CV_PI;
+    return mapped < 0.0 ? mapped + 360.0 : mapped;
+}
+
+std::vector<cv::Point2d> GeometricTransform::mapRect(const cv::Rect& rect) const {
+    // Bordas do retângulo (convenção QRect/QPainter) ↔ centros de pixel: deslocamento de 0,5
+    const cv::Point2d corners[4] = {
+        {rect.x - 0.5, rect.y - 0.5},
+        {rect.x + rect.width - 0.5, rect.y - 0.5},
+        {rect.x + rect.width - 0.5, rect.y + rect.height - 0.5},
+        {rect.x - 0.5, rect.y + rect.height - 0.5}
+    };
+
+    std::vector<cv::Point2d> mapped;
+    mapped.reserve(4);
+    for (const cv::Point2d& corner : corners) {
+        mapped.push_back(map(corner) + cv::Point2d(0.5, 0.5));
+    }
+    return mapped;
+}
+
+cv::Rect GeometricTransform::unmapRect(const cv::Rect& rect) const {
+    const cv::Matx23d inv = inverse(m_matrix);
+    const cv::Point2d corners[4] = {
+        {rect.x - 0.5, rect.y - 0.5},
+        {rect.x + rect.width - 0.5, rect.y - 0.5},
+        {rect.x + rect.width - 0.5, rect.y + rect.height - 0.5},
+        {rect.x - 0.5, rect.y + rect.height - 0.5}
+    };
+
+    double minX = HUGE_VAL, minY = HUGE_VAL, maxX = -HUGE_VAL, maxY = -HUGE_VAL;
+    for (const cv::Point2d& corner : corners) {
+        const cv::Point2d p = transformPoint(inv, corner) + cv::Point2d(0.5, 0.5);
+        minX = std::min(minX, p.x);
+        minY = std::min(minY, p.y);
+        maxX = std::max(maxX, p.x);
+        maxY = std::max(maxY, p.y);
+    }
+
+    const int x0 = static_cast<int>(std::floor(snap(minX, 1e-6)));
+    const int y0 = static_cast<int>(std::floor(snap(minY, 1e-6)));
+    const int x1 = static_cast<int>(std::ceil(snap(maxX, 1e-6)));
+    const int y1 = static_cast<int>(std::ceil(snap(maxY, 1e-6)));
+    return cv::Rect(x0, y0, x1 - x0, y1 - y0) & cv::Rect(cv::Point(0, 0), m_sourceSize);
+}
+
+// ========== TransformStack ==========
+
+TransformBase TransformStack::base(const QString& entityId, const cv::Mat& working,
+                                   const cv::Mat& original, const GeometricTransform& seed) {
+    const quint64 hash = RidgeGeometry::contentHash(working);
+
+    // Geometria da imagem de trabalho, da fonte mais confiável para a menos
+    GeometricTransform geometry;
+    {
+        QMutexLocker locker(&cacheMutex);
+        auto it = stackCache.find(entityId);
+        if (it != stackCache.end()) {
+            it->lastUse = ++useCounter;
+            if (it->outputHash == hash) {
+                return TransformBase{it->base, it->fromOriginal, it->current};
+            }
+            // Edição radiométrica registrada (carry) ou imagem recuperada por desfazer/refazer
+            geometry = it->geometryOf(hash);
+        }
+    }
+
+    if (!geometry.isValid()) {
+        // Conteúdo igual ao da original (ex.: após resetar): sem geometria, mesmo que o tamanho
+        // também confira com a semente
+        const bool isOriginal = working.size() == original.size() && working.type() == original.type() &&
+                                RidgeGeometry::contentHash(original) == hash;
+        if (isOriginal) {
+            geometry = GeometricTransform(original.size());
+        } else if (seed.matches(original.size(), working.size())) {
+            geometry = seed;
+        } else if (working.size() == original.size()) {
+            geometry = GeometricTransform(original.size());
+        } else {
+            geometry = GeometricTransform(working.size());   // Relação com a original desconhecida
+        }
+    }
+
+    TransformBase result;
+    result.fromOriginal = geometry;
+    result.current = geometry;
+
+    // Sem edições nem geometria: partir da original, sem cópia
+    const bool unedited = geometry.isIdentity() && geometry.matches(original.size(), working.size()) &&
+                          working.type() == original.type() && RidgeGeometry::contentHash(original) == hash;
+    result.image = unedited ? original : working.clone();
+    return result;
+}
+
+cv::Mat TransformStack::render(const TransformBase& base, const GeometricTransform& target,
+                               bool transparentBorder) {
+    return target.relativeTo(base.fromOriginal).apply(base.image, transparentBorder);
+}
+
+void TransformStack::commit(const QString& entityId, const TransformBase& base,
+                            const GeometricTransform& target, const cv::Mat& output) {
+    CacheEntry entry;
+    entry.base = base.image;
+    entry.fromOriginal = base.fromOriginal;
+    entry.current = target;
+    entry.outputHash = RidgeGeometry::contentHash(output);
+
+    QMutexLocker locker(&cacheMutex);
+    auto previous = stackCache.find(entityId);
+    if (previous != stackCache.end()) entry.known = previous->known;
+    entry.remember(entry.outputHash, target);
+
+    if (!stackCache.contains(entityId) && stackCache.size() >= kMaxCachedEntities) {
+        // Descartar a entidade usada há mais tempo
+        auto oldest = stackCache.begin();
+        for (auto it = stackCache.begin(); it != stackCache.end(); ++it) {
+            if (it->lastUse < oldest->lastUse) oldest = it;
+        }
+        stackCache.erase(oldest);
+    }
+
+    entry.lastUse = ++useCounter;
+    stackCache.insert(entityId, entry);
+
+    qDebug() << QString("[TransformStack] %1: %2° %3x%4 → %5x%6 (uma reamostragem da base)")
+        .arg(entityId).arg(target.angle(), 0, 'f', 1)
+        .arg(base.image.cols).arg(base.image.rows).arg(output.cols).arg(output.rows);
+}
+
+void TransformStack::carry(const QString& entityId, const cv::Mat& before, const cv::Mat& after) {
+    {
+        QMutexLocker locker(&cacheMutex);
+        if (!stackCache.contains(entityId)) return;
+    }
+
+    const quint64 beforeHash = RidgeGeometry::contentHash(before);
+    const quint64 afterHash = RidgeGeometry::contentHash(after);
+
+    QMutexLocker locker(&cacheMutex);
+    auto it = stackCache.find(entityId);
+    if (it == stackCache.end()) return;
+
+    const GeometricTransform geometry = it->geometryOf(beforeHash);
+    if (geometry.isValid() && geometry.outputSize() == after.size()) {
+        it->remember(afterHash, geometry);
+    }
+    // O resultado costuma ser copiado para o mesmo buffer de trabalho
+    it->forgetBuffer();
+}
+
+GeometricTransform TransformStack::current(const QString& entityId, const cv::Mat& working) {
+    {
+        QMutexLocker locker(&cacheMutex);
+        auto it = stackCache.find(entityId);
+        if (it == stackCache.end()) return GeometricTransform();
+        if (it->sawBuffer(working)) return it->geometryOf(it->seenHash);
+    }
+
+    const quint64 hash = RidgeGeometry::contentHash(working);
+
+    QMutexLocker locker(&cacheMutex);
+    auto it = stackCache.find(entityId);
+    if (it == stackCache.end()) return GeometricTransform();
+    it->seenData = working.data;
+    it->seenSize = working.size();
+    it->seenType = working.type();
+    it->seenHash = hash;
+    return it->geometryOf(hash);
+}
+
+void TransformStack::touch(const QString& entityId) {
+    QMutexLocker locker(&cacheMutex);
+    auto it = stackCache.find(entityId);
+    if (it != stackCache.end()) it->forgetBuffer();
+}
+
+void TransformStack::invalidate(const QString& entityId) {
+    QMutexLocker locker(&cacheMutex);
+    stackCache.remove(entityId);
+}
+
+void TransformStack::clearCache() {
+    QMutexLocker locker(&cacheMutex);
+    stackCache.clear();
+}
@@ -0,0 +1,167 @@
+#ifndef GEOMETRICTRANSFORM_H
+#define GEOMETRICTRANSFORM_H
+
+#include <opencv2/core.hpp>
+#include <QString>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Transformação afim acumulada (rotações e espelhamentos) origem → imagem atual
+ *
+ * Coordenadas contínuas com o centro do pixel em inteiros. Cada operação
+ * recalcula a tela como o envoltório da imagem de origem transformada, então
+ * rotações que se cancelam voltam exatamente à identidade e ao tamanho de
+ * origem. Ângulos positivos giram no sentido horário (como na tela).
+ */
+class GeometricTransform {
+public:
+    GeometricTransform() = default;
+    explicit GeometricTransform(const cv::Size& sourceSize);
+
+    /**
+     * @brief Rotação da imagem atual em torno do centro; a tela cresce para conter tudo
+     */
+    GeometricTransform rotated(double degrees) const;
+    GeometricTransform flippedHorizontal() const;
+    GeometricTransform flippedVertical() const;
+
+    /**
+     * @brief Mudança de escala da imagem atual (ex.: prévia na resolução da tela)
+     */
+    GeometricTransform scaled(double factor) const;
+
+    /**
+     * @brief Transformação da saída de earlier para a saída desta (mesma origem)
+     */
+    GeometricTransform relativeTo(const GeometricTransform& earlier) const;
+
+    bool isValid() const { return !m_sourceSize.empty(); }
+    bool isIdentity() const;
+
+    /**
+     * @brief Múltiplos de 90° e espelhamentos: permutação exata dos pixels
+     */
+    bool isAxisAligned() const;
+
+    /**
+     * @brief Relaciona exatamente estas imagens (tamanhos de origem e de saída)
+     */
+    bool matches(const cv::Size& source, const cv::Size& output) const;
+
+    /**
+     * @brief Ângulo da componente de rotação em [0, 360)
+     */
+    double angle() const;
+
+    const cv::Matx23d& matrix() const { return m_matrix; }
+    cv::Size sourceSize() const { return m_sourceSize; }
+    cv::Size outputSize() const { return m_outputSize; }
+
+    /**
+     * @brief Reamostra a origem numa única passada
+     *
+     * Transformações alinhadas aos eixos usam cv::rotate/flip/transpose (sem
+     * interpolação); as demais, warpAffine bilinear com fundo branco ou transparente.
+     */
+    cv::Mat apply(const cv::Mat& source, bool transparentBorder = false) const;
+
+    cv::Point2d map(const cv::Point2d& point) const;
+    cv::Point2d unmap(const cv::Point2d& point) const;
+
+    /**
+     * @brief Direção em graus (anti-horário, eixo y para cima) após a transformação, em [0, 360)
+     *
+     * Usa a parte linear da matriz, então espelhamentos invertem o sentido.
+     */
+    double mapAngle(double degrees) const;
+
+    /**
+     * @brief Cantos de um retângulo da origem na imagem atual (sup. esq., sup. dir., inf. dir., inf. esq.)
+     */
+    std::vector<cv::Point2d> mapRect(const cv::Rect& rect) const;
+
+    /**
+     * @brief Envoltório, na origem, de um retângulo da imagem atual (limitado à origem)
+     */
+    cv::Rect unmapRect(const cv::Rect& rect) const;
+
+private:
+    cv::Matx23d m_matrix = cv::Matx23d(1, 0, 0, 0, 1, 0);
+    cv::Size m_sourceSize;
+    cv::Size m_outputSize;
+
+    GeometricTransform composed(const cv::Matx22d& linear) const;
+};
+
+/**
+ * @brief Ponto de partida para compor operações geométricas de uma entidade
+ */
+struct TransformBase {
+    cv::Mat image;                      // Imagem reamostrada a partir daqui
+    GeometricTransform fromOriginal;    // original → image
+    GeometricTransform current;         // original → imagem de trabalho atual
+};
+
+/**
+ * @brief Pilha de rotações e espelhamentos por entidade, aplicada de uma vez
+ *
+ * Girar ou espelhar repetidamente a imagem de trabalho acumula o borrão de
+ * cada interpolação e faz a tela crescer a cada rotação livre. Aqui cada
+ * entidade guarda a base (a imagem original enquanto a de trabalho não foi
+ * editada) e a transformação acumulada; uma nova operação é composta à
+ * matriz e a base é reamostrada uma única vez.
+ *
+ * A geometria é associada ao conteúdo: cada resultado registrado e cada
+ * edição radiométrica informada por carry() guardam a assinatura da imagem.
+ * Uma imagem de trabalho desconhecida (reset, edição sem registro) não herda
+ * a geometria só porque o tamanho confere; desfazer/refazer voltam a imagens
+ * conhecidas. Se a imagem de trabalho não é a última saída registrada, ela
+ * vira a nova base. Entidades com descarte LRU.
+ */
+class TransformStack {
+public:
+    using Step = std::function<GeometricTransform(const GeometricTransform& current)>;
+
+    /**
+     * @brief Base da entidade para a imagem de trabalho atual
+     * @param seed original → working a assumir se a entidade ainda não tem pilha
+     *             (ex.: ângulo salvo no projeto); ignorada se os tamanhos não conferem
+     */
+    static TransformBase base(const QString& entityId, const cv::Mat& working,
+                              const cv::Mat& original, const GeometricTransform& seed = GeometricTransform());
+
+    /**
+     * @brief Imagem para a transformação alvo (original → resultado), sem registrar
+     */
+    static cv::Mat render(const TransformBase& base, const GeometricTransform& target,
+                          bool transparentBorder = false);
+
+    /**
+     * @brief Registra o resultado como nova imagem de trabalho da entidade
+     */
+    static void commit(const QString& entityId, const TransformBase& base,
+                       const GeometricTransform& target, const cv::Mat& output);
+
+    /**
+     * @brief Edição sem mudança geométrica (filtros, conversões): after herda a geometria de before
+     */
+    static void carry(const QString& entityId, const cv::Mat& before, const cv::Mat& after);
+
+    /**
+     * @brief Transformação original → working, se esta imagem de trabalho é conhecida (inválida se não)
+     */
+    static GeometricTransform current(const QString& entityId, const cv::Mat& working);
+
+    /**
+     * @brief Imagem de trabalho alterada no lugar fora de commit/carry (ex.: desfazer/refazer)
+     *
+     * current() guarda o hash do último buffer consultado; este aviso força recalculá-lo.
+     */
+    static void touch(const QString& entityId);
+
+    static void invalidate(const QString& entityId);
+    static void clearCache();
+};
+
+#endif // GEOMETRICTRANSFORM_H
@@ -0,0 +1,154 @@
+#include "NotchDetector.h"
+#include "FrequencyFilter.h"
+#include "RidgeGeometry.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Período típico das cristas a 500 ppi quando não há estimativa
+const double kDefaultRidgeFrequency = 1.0 / 9.0;
+
+} // namespace
+
+std::vector<SpectralNotch> NotchDetector::detect(const cv::Mat& ccs, const cv::Size& imageSize,
+                                                 const cv::Mat& gray, const NotchDetectorConfig& config) {
+    std::vector<SpectralNotch> notches;
+    if (ccs.empty() || imageSize.area() == 0) return notches;
+
+    double ridgeFrequency = config.ridgeFrequency;
+    if (ridgeFrequency <= 0.0 && !gray.empty()) {
+        ridgeFrequency = estimateRidgeFrequency(gray);
+    }
+    if (ridgeFrequency <= 0.0) {
+        ridgeFrequency = kDefaultRidgeFrequency;
+    }
+    const double bandLow = ridgeFrequency / (1.0 + config.ridgeBandTolerance);
+    const double bandHigh = ridgeFrequency * (1.0 + config.ridgeBandTolerance);
+
+    cv::Mat logMagnitude = FrequencyFilter::centeredLogMagnitude(ccs);
+    const int rows = logMagnitude.rows;
+    const int cols = logMagnitude.cols;
+    const int cx = cols / 2;
+    const int cy = rows / 2;
+
+    // Fundo espectral (decaimento ~1/f e vazamentos largos) removido por top-hat
+    const int window = std::max(3, config.backgroundWindow | 1);
+    cv::Mat residual;
+    cv::morphologyEx(logMagnitude, residual, cv::MORPH_TOPHAT,
+                     cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(window, window)));
+
+    // Região elegível: fora do DC, dos eixos e do anel das cristas
+    auto frequencyAt = [&](int x, int y) {
+        return std::hypot(static_cast<double>(x - cx) / cols, static_cast<double>(y - cy) / rows);
+    };
+    cv::Mat allowed(rows, cols, CV_8U, cv::Scalar(0));
+    for (int y = 0; y < rows; ++y) {
+        if (std::abs(y - cy) <= config.axisExclusion) continue;
+        uchar* row = allowed.ptr<uchar>(y);
+        for (int x = 0; x < cols; ++x) {
+            if (std::abs(x - cx) <= config.axisExclusion) continue;
+            double f = frequencyAt(x, y);
+            if (f < config.minFrequency) continue;
+            if (f >= bandLow && f <= bandHigh) continue;
+            row[x] = 255;
+        }
+    }
+
+    cv::Scalar mean, stddev;
+    cv::meanStdDev(residual, mean, stddev, allowed);
+    if (stddev[0] <= 1e-6) return notches;
+    const double limit = mean[0] + config.threshold * stddev[0];
+
+    // Máximos locais na vizinhança do retângulo proposto
+    const int half = std::max(1, config.notchHalfSize);
+    cv::Mat dilated;
+    cv::dilate(residual, dilated, cv::getStructuringElement(cv::MORPH_RECT, cv::Size(2 * half + 1, 2 * half + 1)));
+
+    // Apenas o semiplano superior: o simétrico é acrescentado depois
+    for (int y = 0; y < cy; ++y) {
+        const float* r = residual.ptr<float>(y);
+        const float* d = dilated.ptr<float>(y);
+        const uchar* a = allowed.ptr<uchar>(y);
+        for (int x = 0; x < cols; ++x) {
+            if (!a[x] || r[x] < limit || r[x] < d[x]) continue;
+            SpectralNotch notch;
+            notch.center = cv::Point(x, y);
+            notch.frequency = frequencyAt(x, y);
+            notch.score = (r[x] - mean[0]) / stddev[0];
+            notches.push_back(notch);
+        }
+    }
+
+    std::sort(notches.begin(), notches.end(), [](const SpectralNotch& a, const SpectralNotch& b) {
+        return a.score > b.score;
+    });
+    if (static_cast<int>(notches.size()) > config.maxNotches) {
+        notches.resize(std::max(0, config.maxNotches));
+    }
+
+    std::vector<SpectralNotch> result;
+    result.reserve(notches.size() * 2);
+    for (SpectralNotch notch : notches) {
+        notch.rect = QRect(notch.center.x - half, notch.center.y - half, 2 * half + 1, 2 * half + 1);
+        result.push_back(notch);
+
+        SpectralNotch mirror = notch;
+        mirror.center = cv::Point(2 * cx - notch.center.x, 2 * cy - notch.center.y);
+        mirror.rect = QRect(mirror.center.x - half, mirror.center.y - half, 2 * half + 1, 2 * half + 1);
+        if (mirror.center.x >= 0 && mirror.center.x < cols && mirror.center.y >= 0 && mirror.center.y < rows) {
+            result.push_back(mirror);
+        }
+    }
+
+    return result;
+}
+
+std::vector<SpectralNotch> NotchDetector::detect(const cv::Mat& image, const NotchDetectorConfig& config) {
+    if (image.empty()) return {};
+    cv::Mat gray = FrequencyFilter::toGray(image);
+    return detect(FrequencyFilter::forward(gray), gray.size(), gray, config);
+}
+
+cv::Mat NotchDetector::removePeriodicBackground(const cv::Mat& image, const NotchDetectorConfig& config,
+                                                int* notchCount) {
+    if (notchCount) *notchCount = 0;
+    if (image.empty()) return cv::Mat();
+
+    cv::Mat gray = FrequencyFilter::toGray(image);
+    cv::Mat ccs = FrequencyFilter::forward(gray);
+    std::vector<SpectralNotch> notches = detect(ccs, gray.size(), gray, config);
+    if (notches.empty()) return image.clone();
+
+    if (notchCount) *notchCount = static_cast<int>(notches.size());
+    return FrequencyFilter::apply(ccs, toRects(notches), false, gray.size(), image.channels() == 3 ? 3 : 1);
+}
+
+QVector<QRect> NotchDetector::toRects(const std::vector<SpectralNotch>& notches) {
+    QVector<QRect> rects;
+    rects.reserve(static_cast<int>(notches.size()));
+    for (const SpectralNotch& notch : notches) {
+        rects.append(notch.rect);
+    }
+    return rects;
+}
+
+double NotchDetector::estimateRidgeFrequency(const cv::Mat& gray) {
+    RidgeField field = RidgeGeometry::compute(gray);
+    if (!field.isValid()) return 0.0;
+
+    std::vector<float> values;
+    for (int by = 0; by < field.frequency.rows; ++by) {
+        const float* f = field.frequency.ptr<float>(by);
+        const uchar* v = field.frequencyValid.ptr<uchar>(by);
+        for (int bx = 0; bx < field.frequency.cols; ++bx) {
+            if (v[bx] && f[bx] > 0.0f) values.push_back(f[bx]);
+        }
+    }
+    if (values.empty()) return 0.0;
+
+    auto middle = values.begin() + values.size() / 2;
+    std::nth_element(values.begin(), middle, values.end());
+    return *middle;
+}
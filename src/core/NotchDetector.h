@@ -0,0 +1,80 @@
+#ifndef NOTCHDETECTOR_H
+#define NOTCHDETECTOR_H
+
+#include <opencv2/core.hpp>
+#include <QVector>
+#include <QRect>
+#include <vector>
+
+/**
+ * @brief Parâmetros da detecção de picos periódicos no espectro
+ *
+ * Frequências em ciclos por pixel da imagem original.
+ */
+struct NotchDetectorConfig {
+    double ridgeFrequency = 0.0;        // Frequência das cristas; 0 = estimar pelo campo de cristas
+    double ridgeBandTolerance = 0.35;   // Anel protegido: [f/(1+t), f·(1+t)]
+    double minFrequency = 1.0 / 40.0;   // Abaixo disso é iluminação/fundo, não padrão
+    int axisExclusion = 2;              // Faixa ignorada nos eixos (vazamento das bordas)
+    int backgroundWindow = 15;          // Janela do top-hat que remove o fundo do espectro
+    double threshold = 4.0;             // Desvios-padrão acima do fundo local
+    int maxNotches = 12;                // Pares simétricos no máximo
+    int notchHalfSize = 4;              // Meio lado do retângulo proposto (pixels do espectro)
+};
+
+/**
+ * @brief Pico detectado, em coordenadas do espectro centralizado
+ */
+struct SpectralNotch {
+    cv::Point center;
+    double frequency = 0.0;    // Ciclos por pixel
+    double score = 0.0;        // Altura acima do fundo, em desvios-padrão
+    QRect rect;
+};
+
+/**
+ * @brief Detecção automática de padrões periódicos de fundo (notas, tecidos, tramas)
+ *
+ * Padrões regulares aparecem como picos isolados no log-magnitude do
+ * espectro. O fundo espectral é removido por top-hat morfológico e os máximos
+ * locais acima do limiar viram propostas de máscara, fora do anel das
+ * frequências das cristas (que não pode ser removido), da vizinhança do DC e
+ * dos eixos. Cada pico é devolvido junto com o seu simétrico.
+ */
+class NotchDetector {
+public:
+    /**
+     * @brief Detecta picos num espectro CCS já calculado
+     * @param imageSize Tamanho da imagem antes da expansão
+     * @param gray Imagem usada para estimar a frequência das cristas quando
+     *        config.ridgeFrequency = 0 (pode ser vazia: usa 500 ppi típico)
+     */
+    static std::vector<SpectralNotch> detect(const cv::Mat& ccs, const cv::Size& imageSize,
+                                             const cv::Mat& gray,
+                                             const NotchDetectorConfig& config = NotchDetectorConfig());
+
+    /**
+     * @brief Calcula o espectro e detecta os picos da imagem
+     */
+    static std::vector<SpectralNotch> detect(const cv::Mat& image,
+                                             const NotchDetectorConfig& config = NotchDetectorConfig());
+
+    /**
+     * @brief Detecta e remove os picos da imagem (modo em lote)
+     * @param notchCount Se não nulo, recebe o número de retângulos aplicados
+     * @return Imagem filtrada (mesmo número de canais), ou cópia se nada foi detectado
+     */
+    static cv::Mat removePeriodicBackground(const cv::Mat& image,
+                                            const NotchDetectorConfig& config = NotchDetectorConfig(),
+                                            int* notchCount = nullptr);
+
+    static QVector<QRect> toRects(const std::vector<SpectralNotch>& notches);
+
+    /**
+     * @brief Frequência mediana das cristas medida pelo campo de cristas
+     * @return 0 se nenhum bloco tiver medida
+     */
+    static double estimateRidgeFrequency(const cv::Mat& gray);
+};
+
+#endif // NOTCHDETECTOR_H
@@ -0,0 +1,103 @@
+#include "PointLUT.h"
+#include <QDebug>
+#include <algorithm>
+#include <vector>
+
+PointLUT::PointLUT()
+    : m_table(1, 256, CV_8UC1)
+{
+    uchar* table = m_table.ptr<uchar>();
+    for (int i = 0; i < 256; ++i) table[i] = static_cast<uchar>(i);
+}
+
+PointLUT::PointLUT(const cv::Mat& table)
+    : m_table(table)
+{
+}
+
+PointLUT PointLUT::linear(double alpha, double beta) {
+    cv::Mat table(1, 256, CV_8UC1);
+    uchar* values = table.ptr<uchar>();
+    for (int i = 0; i < 256; ++i) values[i] = cv::saturate_cast<uchar>(alpha * i + beta);
+    return PointLUT(table);
+}
+
+PointLUT PointLUT::invert() {
+    cv::Mat table(1, 256, CV_8UC1);
+    uchar* values = table.ptr<uchar>();
+    for (int i = 0; i < 256; ++i) values[i] = static_cast<uchar>(255 - i);
+    return PointLUT(table);
+}
+
+PointLUT PointLUT::threshold(double thresh, double maxValue) {
+    cv::Mat table(1, 256, CV_8UC1);
+    uchar* values = table.ptr<uchar>();
+    const uchar high = cv::saturate_cast<uchar>(maxValue);
+    for (int i = 0; i < 256; ++i) values[i] = i > thresh ? high : 0;
+    return PointLUT(table);
+}
+
+PointLUT PointLUT::channelOffsets(int offset1, int offset2, int offset3) {
+    cv::Mat table(1, 256, CV_8UC3);
+    cv::Vec3b* values = table.ptr<cv::Vec3b>();
+    for (int i = 0; i < 256; ++i) {
+        values[i] = cv::Vec3b(cv::saturate_cast<uchar>(i + offset1),
+                              cv::saturate_cast<uchar>(i + offset2),
+                              cv::saturate_cast<uchar>(i + offset3));
+    }
+    return PointLUT(table);
+}
+
+cv::Mat PointLUT::expanded(int channels) const {
+    if (m_table.channels() == channels) return m_table;
+
+    std::vector<cv::Mat> planes;
+    if (m_table.channels() == 1) {
+        planes.assign(channels, m_table);
+    } else {
+        // Três canais → BGRA: alfa inalterado
+        cv::split(m_table, planes);
+        planes.push_back(PointLUT().m_table);
+    }
+    cv::Mat table;
+    cv::merge(planes, table);
+    return table;
+}
+
+PointLUT PointLUT::then(const PointLUT& next) const {
+    // Aplicar next à própria tabela compõe as duas: out[i][c] = next[this[i][c]][c]
+    const int channels = std::max(m_table.channels(), next.m_table.channels());
+    cv::Mat composed;
+    cv::LUT(expanded(channels), next.expanded(channels), composed);
+    return PointLUT(composed);
+}
+
+bool PointLUT::isIdentity() const {
+    return cv::norm(m_table, PointLUT().expanded(m_table.channels()), cv::NORM_INF) == 0;
+}
+
+cv::Mat PointLUT::apply(const cv::Mat& image) const {
+    cv::Mat output;
+    apply(image, output);
+    return output;
+}
+
+void PointLUT::apply(const cv::Mat& image, cv::Mat& output) const {
+    if (!supports(image)) {
+        qDebug() << QString("[PointLUT] Imagem sem suporte (profundidade %1); esperado CV_8U").arg(image.depth());
+        output.release();
+        return;
+    }
+
+    const int channels = image.channels();
+    if (m_table.channels() == 1 || m_table.channels() == channels) {
+        cv::LUT(image, m_table, output);
+    } else if (channels == 4) {
+        cv::LUT(image, expanded(4), output);
+    } else {
+        // Tabela por canal numa imagem de um canal: usa o primeiro canal
+        cv::Mat first;
+        cv::extractChannel(m_table, first, 0);
+        cv::LUT(image, first, output);
+    }
+}
@@ -0,0 +1,72 @@
+#ifndef POINTLUT_H
+#define POINTLUT_H
+
+#include <opencv2/core.hpp>
+
+/**
+ * @brief Operação pontual (pixel a pixel) representada por uma tabela de 256 entradas
+ *
+ * Brilho/contraste, inversão, limiar fixo e deslocamentos de canal dependem
+ * só do valor do próprio pixel, então cabem numa tabela CV_8U (um canal, ou
+ * um por canal). Tabelas se compõem sem tocar na imagem: uma sequência de
+ * operações pontuais vira uma única passada vetorizada de cv::LUT.
+ *
+ * Válido para imagens CV_8U (os valores de entrada são 0-255).
+ */
+class PointLUT {
+public:
+    /**
+     * @brief Identidade (um canal)
+     */
+    PointLUT();
+
+    /**
+     * @brief saturate(alpha·v + beta), como cv::Mat::convertTo
+     */
+    static PointLUT linear(double alpha, double beta);
+
+    /**
+     * @brief 255 − v
+     */
+    static PointLUT invert();
+
+    /**
+     * @brief maxValue se v > thresh, senão 0 (cv::THRESH_BINARY)
+     */
+    static PointLUT threshold(double thresh, double maxValue = 255);
+
+    /**
+     * @brief saturate(v + offset) por canal (três canais)
+     */
+    static PointLUT channelOffsets(int offset1, int offset2, int offset3);
+
+    /**
+     * @brief Composição: aplica esta tabela e depois next
+     */
+    PointLUT then(const PointLUT& next) const;
+
+    bool isIdentity() const;
+    int channels() const { return m_table.channels(); }
+    const cv::Mat& table() const { return m_table; }
+
+    static bool supports(const cv::Mat& image) { return !image.empty() && image.depth() == CV_8U; }
+
+    /**
+     * @brief Aplica a tabela numa única passada (pode ser in-place)
+     *
+     * Tabelas de um canal valem para todos os canais; tabelas de três canais
+     * em imagens BGRA preservam o alfa.
+     * @return Imagem resultante, ou vazia se a imagem não for CV_8U
+     */
+    cv::Mat apply(const cv::Mat& image) const;
+    void apply(const cv::Mat& image, cv::Mat& output) const;
+
+private:
+    explicit PointLUT(const cv::Mat& table);
+
+    cv::Mat m_table;    // 1x256, CV_8UC1 ou CV_8UC3
+
+    cv::Mat expanded(int channels) const;
+};
+
+#endif // POINTLUT_H
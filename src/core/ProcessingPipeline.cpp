@@ -0,0 +1,317 @@
+#include "ProcessingPipeline.h"
+#include "RidgeGeometry.h"
+#include <QDebug>
+#include <QMutex>
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+// Registro dos pipelines abertos: o orçamento de saídas memorizadas é global
+QMutex pipelineMutex;
+std::vector<ProcessingPipeline*> pipelines;
+size_t totalBytes = 0;
+size_t memoryBudget = size_t(192) << 20;
+quint64 useCounter = 0;
+
+} // namespace
+
+ProcessingPipeline::ProcessingPipeline()
+    : m_cachedBytes(0)
+    , m_outputHash(0)
+{
+    QMutexLocker locker(&pipelineMutex);
+    pipelines.push_back(this);
+}
+
+ProcessingPipeline::~ProcessingPipeline() {
+    QMutexLocker locker(&pipelineMutex);
+    totalBytes -= m_cachedBytes;
+    pipelines.erase(std::remove(pipelines.begin(), pipelines.end(), this), pipelines.end());
+}
+
+void ProcessingPipeline::reset(const cv::Mat& source) {
+    QMutexLocker locker(&pipelineMutex);
+    m_source = source.clone();
+    m_steps.clear();
+    m_outputs.clear();
+    m_rewound.clear();
+    totalBytes -= m_cachedBytes;
+    m_cachedBytes = 0;
+    m_sourceHash = m_source.empty() ? 0 : RidgeGeometry::contentHash(m_source);
+    m_outputHash = m_sourceHash;
+}
+
+int ProcessingPipeline::appendStep(const QString& name, const QMap<QString, double>& values,
+                                   PipelineStepFunction function, const cv::Mat& precomputed) {
+    QMutexLocker locker(&pipelineMutex);
+    PipelineStep step;
+    step.name = name;
+    step.values = values;
+    step.function = std::move(function);
+    m_steps.push_back(step);
+    m_outputs.emplace_back();
+    m_rewound.clear();
+
+    const int index = stepCount() - 1;
+    if (!precomputed.empty()) {
+        store(index, precomputed, false);
+        m_outputHash = RidgeGeometry::contentHash(precomputed);
+        m_outputs[index].hash = m_outputHash;
+    }
+    return index;
+}
+
+int ProcessingPipeline::appendPointStep(const QString& name, const QMap<QString, double>& values,
+                                       PipelineStepFunction function, PipelineLutFunction lut,
+                                       const cv::Mat& precomputed) {
+    const int index = appendStep(name, values, std::move(function), precomputed);
+    m_steps[index].lut = std::move(lut);
+    return index;
+}
+
+void ProcessingPipeline::setValues(int index, const QMap<QString, double>& values) {
+    QMutexLocker locker(&pipelineMutex);
+    if (index < 0 || index >= stepCount() || m_steps[index].values == values) return;
+    m_steps[index].values = values;
+    invalidateFrom(index);
+}
+
+void ProcessingPipeline::setEnabled(int index, bool enabled) {
+    QMutexLocker locker(&pipelineMutex);
+    if (index < 0 || index >= stepCount() || m_steps[index].enabled == enabled) return;
+    m_steps[index].enabled = enabled;
+    invalidateFrom(index);
+}
+
+void ProcessingPipeline::removeStep(int index) {
+    QMutexLocker locker(&pipelineMutex);
+    if (index < 0 || index >= stepCount()) return;
+    invalidateFrom(index);
+    m_steps.erase(m_steps.begin() + index);
+    m_outputs.erase(m_outputs.begin() + index);
+}
+
+void ProcessingPipeline::setHistoryEntry(int index, int type, const QString& params) {
+    QMutexLocker locker(&pipelineMutex);
+    if (index < 0 || index >= stepCount()) return;
+    m_steps[index].historyType = type;
+    m_steps[index].historyParams = params;
+}
+
+int ProcessingPipeline::historyEntryCount() const {
+    QMutexLocker locker(&pipelineMutex);
+    return static_cast<int>(std::count_if(m_steps.begin(), m_steps.end(), [](const PipelineStep& step) {
+        return step.enabled && step.historyType >= 0;
+    }));
+}
+
+PipelineStepInfo ProcessingPipeline::stepInfo(int index) const {
+    PipelineStepInfo info;
+    if (index < 0 || index >= stepCount()) return info;
+    info.name = m_steps[index].name;
+    info.values = m_steps[index].values;
+    info.enabled = m_steps[index].enabled;
+    info.historyType = m_steps[index].historyType;
+    info.historyParams = m_steps[index].historyParams;
+    return info;
+}
+
+int ProcessingPipeline::firstDirtyStep() const {
+    QMutexLocker locker(&pipelineMutex);
+    return dirtyFrom();
+}
+
+int ProcessingPipeline::dirtyFrom() const {
+    for (int i = stepCount() - 1; i >= 0; --i) {
+        if (!m_outputs[i].image.empty()) return i + 1;
+    }
+    return 0;
+}
+
+cv::Mat ProcessingPipeline::evaluate(const PipelineProgressCallback& progress) {
+    // Entrada: saída memorizada mais próxima (ou a origem), lida antes que outro pipeline a descarte
+    int start = 0;
+    cv::Mat current;
+    {
+        QMutexLocker locker(&pipelineMutex);
+        start = dirtyFrom();
+        current = m_source;
+        if (start > 0) {
+            m_outputs[start - 1].lastUse = ++useCounter;
+            current = m_outputs[start - 1].image;
+        }
+    }
+    const int total = stepCount() - start;
+
+    for (int i = start; i < stepCount(); ++i) {
+        const PipelineStep& step = m_steps[i];
+
+        // Operações pontuais consecutivas: tabelas compostas, uma única passada
+        if (step.enabled && step.lut && PointLUT::supports(current)) {
+            PointLUT fused = step.lut(step.values);
+            int last = i;
+            for (int j = i + 1; j < stepCount() && m_steps[j].lut; ++j) {
+                if (m_steps[j].enabled) fused = fused.then(m_steps[j].lut(m_steps[j].values));
+                last = j;
+            }
+            if (last > i) {
+                cv::Mat output = fused.apply(current);
+                const quint64 hash = RidgeGeometry::contentHash(output);
+                {
+                    QMutexLocker locker(&pipelineMutex);
+                    // Intermediárias do trecho não foram calculadas: sem assinatura, fora do alcance de rewindTo()
+                    for (int j = i; j < last; ++j) m_outputs[j].hash = 0;
+                    store(last, output, false);
+                    m_outputs[last].hash = hash;
+                }
+                current = output;
+                qDebug() << QString("[Pipeline] Passos %1-%2 pontuais fundidos em uma passada").arg(i).arg(last);
+
+                if (progress && !progress(last - start + 1, total)) return cv::Mat();
+                i = last;
+                continue;
+            }
+        }
+
+        if (step.enabled) {
+            cv::Mat output = step.function(current, step.values);
+            if (output.empty()) {
+                qDebug() << QString("[Pipeline] Passo %1 (%2) não produziu resultado").arg(i).arg(step.name);
+                return cv::Mat();
+            }
+            const quint64 hash = RidgeGeometry::contentHash(output);
+            QMutexLocker locker(&pipelineMutex);
+            store(i, output, false);
+            m_outputs[i].hash = hash;
+            current = output;
+        } else {
+            // Passo desativado: repassa a entrada sem copiar
+            QMutexLocker locker(&pipelineMutex);
+            store(i, current, true);
+            m_outputs[i].hash = i > 0 ? m_outputs[i - 1].hash : m_sourceHash;
+        }
+
+        if (progress && !progress(i - start + 1, total)) return cv::Mat();
+    }
+
+    if (total > 0) {
+        qDebug() << QString("[Pipeline] %1 de %2 passos recalculados (%3 MB em cache, %4 MB em todos os pipelines)")
+                    .arg(total).arg(stepCount())
+                    .arg(m_cachedBytes / double(1 << 20), 0, 'f', 1)
+                    .arg(totalCachedBytes() / double(1 << 20), 0, 'f', 1);
+    }
+
+    if (current.empty()) {
+        m_outputHash = 0;
+    } else {
+        m_outputHash = stepCount() > 0 ? m_outputs.back().hash : m_sourceHash;
+    }
+    return current;
+}
+
+bool ProcessingPipeline::rewindTo(quint64 hash) {
+    QMutexLocker locker(&pipelineMutex);
+    // Saída mais recente com essa assinatura (a origem conta como índice -1)
+    int target = -2;
+    for (int i = stepCount() - 1; i >= 0; --i) {
+        if (m_outputs[i].hash == hash && m_outputs[i].hash != 0) { target = i; break; }
+    }
+    if (target == -2 && hash == m_sourceHash && m_sourceHash != 0) target = -1;
+    if (target == -2) return false;
+
+    while (stepCount() - 1 > target) {
+        const int last = stepCount() - 1;
+        m_rewound.emplace_back(m_steps[last], m_outputs[last].hash);
+        release(last);
+        m_steps.pop_back();
+        m_outputs.pop_back();
+    }
+    m_outputHash = hash;
+    return true;
+}
+
+bool ProcessingPipeline::replay(const cv::Mat& image, quint64 hash) {
+    QMutexLocker locker(&pipelineMutex);
+    if (m_rewound.empty() || m_rewound.back().second != hash) return false;
+
+    m_steps.push_back(m_rewound.back().first);
+    m_outputs.emplace_back();
+    m_rewound.pop_back();
+
+    const int index = stepCount() - 1;
+    store(index, image.clone(), false);
+    m_outputs[index].hash = hash;
+    m_outputHash = hash;
+    return true;
+}
+
+void ProcessingPipeline::setMemoryBudget(size_t bytes) {
+    QMutexLocker locker(&pipelineMutex);
+    memoryBudget = bytes;
+    trimToBudget(nullptr, -1);
+}
+
+size_t ProcessingPipeline::totalCachedBytes() {
+    QMutexLocker locker(&pipelineMutex);
+    return totalBytes;
+}
+
+void ProcessingPipeline::invalidateFrom(int index) {
+    m_rewound.clear();
+    for (int i = std::max(0, index); i < stepCount(); ++i) {
+        release(i);
+        m_outputs[i] = CachedOutput();
+    }
+}
+
+void ProcessingPipeline::release(int index) {
+    CachedOutput& slot = m_outputs[index];
+    // Imagem repassada por um passo desativado seguinte: a contagem passa para ele
+    if (slot.bytes > 0 && index + 1 < stepCount()) {
+        CachedOutput& next = m_outputs[index + 1];
+        if (!next.image.empty() && next.image.data == slot.image.data) {
+            next.bytes = slot.bytes;
+            slot.bytes = 0;
+        }
+    }
+    m_cachedBytes -= slot.bytes;
+    totalBytes -= slot.bytes;
+    slot.image.release();
+    slot.bytes = 0;
+}
+
+void ProcessingPipeline::store(int index, const cv::Mat& image, bool sharesInput) {
+    release(index);
+
+    CachedOutput& slot = m_outputs[index];
+    slot.image = image;
+    slot.bytes = sharesInput ? 0 : image.total() * image.elemSize();
+    slot.lastUse = ++useCounter;
+    m_cachedBytes += slot.bytes;
+    totalBytes += slot.bytes;
+
+    trimToBudget(this, index);
+}
+
+void ProcessingPipeline::trimToBudget(const ProcessingPipeline* keepOwner, int keepIndex) {
+    while (totalBytes > memoryBudget) {
+        // Saída intermediária usada há mais tempo em qualquer pipeline; as finais e a recém-calculada ficam
+        ProcessingPipeline* owner = nullptr;
+        int victim = -1;
+        for (ProcessingPipeline* pipeline : pipelines) {
+            const int last = pipeline->stepCount() - 1;
+            for (int i = 0; i < last; ++i) {
+                const CachedOutput& slot = pipeline->m_outputs[i];
+                if ((pipeline == keepOwner && i == keepIndex) || slot.image.empty() || slot.bytes == 0) continue;
+                if (!owner || slot.lastUse < owner->m_outputs[victim].lastUse) {
+                    owner = pipeline;
+                    victim = i;
+                }
+            }
+        }
+        if (!owner) break;
+
+        owner->release(victim);
+    }
+}
@@ -0,0 +1,181 @@
+#ifndef PROCESSINGPIPELINE_H
+#define PROCESSINGPIPELINE_H
+
+#include "PointLUT.h"
+#include <opencv2/core.hpp>
+#include <QMap>
+#include <QString>
+#include <functional>
+#include <vector>
+
+/**
+ * @brief Operação de um passo: recebe a saída do passo anterior e os parâmetros atuais
+ *
+ * Não deve alterar a entrada. Pode ser chamada de uma thread de trabalho.
+ */
+using PipelineStepFunction = std::function<cv::Mat(const cv::Mat& input, const QMap<QString, double>& values)>;
+
+/**
+ * @brief Tabela de uma operação pontual a partir dos parâmetros atuais
+ */
+using PipelineLutFunction = std::function<PointLUT(const QMap<QString, double>& values)>;
+
+/**
+ * @brief Progresso por passo: (concluídos, total). Retornar false cancela.
+ */
+using PipelineProgressCallback = std::function<bool(int done, int total)>;
+
+/**
+ * @brief Passo do pipeline
+ */
+struct PipelineStep {
+    QString name;                       // Descrição exibida / histórico
+    QMap<QString, double> values;       // Parâmetros editáveis (vazio = passo fixo)
+    PipelineStepFunction function;
+    PipelineLutFunction lut;            // Definida só para operações pontuais
+    bool enabled = true;
+    int historyType = -1;               // Tipo no histórico do projeto (-1 = sem registro)
+    QString historyParams;
+};
+
+/**
+ * @brief Descrição de um passo para edição (sem a função)
+ */
+struct PipelineStepInfo {
+    QString name;
+    QMap<QString, double> values;
+    bool enabled = true;
+    int historyType = -1;
+    QString historyParams;
+};
+
+/**
+ * @brief Histórico de processamento executável, com resultados intermediários memorizados
+ *
+ * A imagem de origem não é alterada; cada passo guarda a sua saída enquanto
+ * couber no orçamento de memória. Alterar parâmetros, desativar ou remover um
+ * passo invalida apenas as saídas dele em diante, e evaluate() recomeça da
+ * última saída válida anterior. O orçamento é único para todos os pipelines
+ * abertos (um por entidade): quando estoura, as saídas intermediárias usadas
+ * há mais tempo, de qualquer pipeline, são descartadas (a saída final de cada
+ * um é sempre mantida) e recalculadas a partir do ancestral mais próximo se
+ * voltarem a ser necessárias.
+ *
+ * Passos pontuais consecutivos (appendPointStep) são fundidos no recálculo:
+ * as tabelas são compostas e a imagem é percorrida uma única vez. As saídas
+ * intermediárias de um trecho fundido não existem, então não servem de
+ * destino para rewindTo().
+ *
+ * Passos desativados repassam a imagem de entrada sem cópia; a memória de
+ * uma imagem compartilhada é contada uma única vez.
+ */
+class ProcessingPipeline {
+public:
+    ProcessingPipeline();
+    ~ProcessingPipeline();
+
+    ProcessingPipeline(const ProcessingPipeline&) = delete;
+    ProcessingPipeline& operator=(const ProcessingPipeline&) = delete;
+
+    /**
+     * @brief Define a imagem de origem e descarta todos os passos
+     */
+    void reset(const cv::Mat& source);
+
+    /**
+     * @brief Acrescenta um passo no final
+     * @param precomputed Saída já calculada (ex.: pelo worker); vazia = calcular em evaluate()
+     */
+    int appendStep(const QString& name, const QMap<QString, double>& values,
+                   PipelineStepFunction function, const cv::Mat& precomputed = cv::Mat());
+
+    /**
+     * @brief Acrescenta uma operação pontual (fundível com as vizinhas)
+     * @param function Mesma operação sem tabela: passos isolados e imagens que não são CV_8U
+     */
+    int appendPointStep(const QString& name, const QMap<QString, double>& values,
+                        PipelineStepFunction function, PipelineLutFunction lut,
+                        const cv::Mat& precomputed = cv::Mat());
+
+    void setValues(int index, const QMap<QString, double>& values);
+
+    /**
+     * @brief Registro do passo no histórico de processamento do projeto
+     */
+    void setHistoryEntry(int index, int type, const QString& params);
+
+    /**
+     * @brief Passos ativos com registro: entradas do fim do histórico do projeto que o pipeline representa
+     */
+    int historyEntryCount() const;
+    void setEnabled(int index, bool enabled);
+    void removeStep(int index);
+
+    int stepCount() const { return static_cast<int>(m_steps.size()); }
+    PipelineStepInfo stepInfo(int index) const;
+    const cv::Mat& source() const { return m_source; }
+    bool isEmpty() const { return m_source.empty(); }
+
+    /**
+     * @brief Índice do primeiro passo que precisa ser recalculado (stepCount() se nenhum)
+     */
+    int firstDirtyStep() const;
+
+    /**
+     * @brief Calcula a saída final a partir do último resultado válido
+     * @return Saída do último passo (a origem se não houver passos), ou vazia se cancelado
+     */
+    cv::Mat evaluate(const PipelineProgressCallback& progress = nullptr);
+
+    /**
+     * @brief Assinatura da última saída calculada, para detectar edições externas
+     */
+    quint64 outputHash() const { return m_outputHash; }
+
+    /**
+     * @brief Desfaz passos do fim até a saída com a assinatura dada (desfazer)
+     *
+     * Os passos retirados ficam guardados para replay() até o próximo appendStep().
+     * Saídas intermediárias de passos pontuais fundidos não têm assinatura.
+     * @return false se nenhum passo (nem a origem) produziu essa imagem
+     */
+    bool rewindTo(quint64 hash);
+
+    /**
+     * @brief Recoloca o próximo passo desfeito se ele produz a imagem dada (refazer)
+     */
+    bool replay(const cv::Mat& image, quint64 hash);
+
+    size_t cachedBytes() const { return m_cachedBytes; }
+
+    /**
+     * @brief Orçamento compartilhado por todos os pipelines (padrão 192 MB)
+     */
+    static void setMemoryBudget(size_t bytes);
+    static size_t totalCachedBytes();
+
+private:
+    struct CachedOutput {
+        cv::Mat image;
+        size_t bytes = 0;
+        quint64 lastUse = 0;
+        quint64 hash = 0;           // Mantida mesmo após descartar a imagem
+    };
+
+    cv::Mat m_source;
+    quint64 m_sourceHash = 0;
+    std::vector<PipelineStep> m_steps;
+    std::vector<CachedOutput> m_outputs;
+    std::vector<std::pair<PipelineStep, quint64>> m_rewound;   // Topo = próximo a refazer
+    size_t m_cachedBytes;
+    quint64 m_outputHash;
+
+    // Funções abaixo esperam o mutex global já adquirido
+    int dirtyFrom() const;
+    void invalidateFrom(int index);
+    void release(int index);
+    void store(int index, const cv::Mat& image, bool sharesInput);
+    static void trimToBudget(const ProcessingPipeline* keepOwner, int keepIndex);
+};
+
+#endif // PROCESSINGPIPELINE_H
@@ -0,0 +1,109 @@
+#include "ResolutionPyramid.h"
+#include "RidgeGeometry.h"
+#include <opencv2/imgproc.hpp>
+#include <QHash>
+#include <QMutex>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const int kMaxCachedEntities = 8;
+
+struct CacheEntry {
+    quint64 hash = 0;
+    double scale = 1.0;
+    std::shared_ptr<const cv::Mat> level;
+    quint64 lastUse = 0;
+};
+
+QMutex cacheMutex;
+QHash<QString, CacheEntry> levelCache;
+quint64 useCounter = 0;
+
+} // namespace
+
+double ResolutionPyramid::canonicalScale(double pixelsPerMM, double targetPPI) {
+    if (pixelsPerMM <= 0.0 || targetPPI <= 0.0) return 1.0;
+    const double scale = (targetPPI / 25.4) / pixelsPerMM;
+    return scale < 1.0 / 1.2 ? scale : 1.0;
+}
+
+cv::Mat ResolutionPyramid::downscale(const cv::Mat& image, double scale) {
+    if (image.empty() || scale >= 1.0) return image;
+
+    const cv::Size size(std::max(1, static_cast<int>(std::lround(image.cols * scale))),
+                        std::max(1, static_cast<int>(std::lround(image.rows * scale))));
+    cv::Mat reduced;
+    cv::resize(image, reduced, size, 0, 0, cv::INTER_AREA);
+    return reduced;
+}
+
+std::shared_ptr<const cv::Mat> ResolutionPyramid::level(const QString& entityId, const cv::Mat& image, double scale) {
+    quint64 hash = RidgeGeometry::contentHash(image);
+
+    {
+        QMutexLocker locker(&cacheMutex);
+        auto it = levelCache.find(entityId);
+        if (it != levelCache.end() && it->hash == hash && it->scale == scale) {
+            it->lastUse = ++useCounter;
+            return it->level;
+        }
+    }
+
+    auto level = std::make_shared<const cv::Mat>(downscale(image, scale).clone());
+
+    QMutexLocker locker(&cacheMutex);
+    if (!levelCache.contains(entityId) && levelCache.size() >= kMaxCachedEntities) {
+        // Descartar a entidade usada há mais tempo
+        auto oldest = levelCache.begin();
+        for (auto it = levelCache.begin(); it != levelCache.end(); ++it) {
+            if (it->lastUse < oldest->lastUse) oldest = it;
+        }
+        levelCache.erase(oldest);
+    }
+
+    CacheEntry entry;
+    entry.hash = hash;
+    entry.scale = scale;
+    entry.level = level;
+    entry.lastUse = ++useCounter;
+    levelCache.insert(entityId, entry);
+
+    qDebug() << QString("[ResolutionPyramid] %1: %2x%3 → %4x%5 (fator %6)")
+        .arg(entityId).arg(image.cols).arg(image.rows)
+        .arg(level->cols).arg(level->rows).arg(scale, 0, 'f', 3);
+
+    return level;
+}
+
+cv::Mat ResolutionPyramid::upscale(const cv::Mat& result, const cv::Size& nativeSize, bool binary) {
+    if (result.empty() || result.size() == nativeSize) return result;
+
+    cv::Mat enlarged;
+    cv::resize(result, enlarged, nativeSize, 0, 0, binary ? cv::INTER_NEAREST : cv::INTER_CUBIC);
+    return enlarged;
+}
+
+cv::Mat ResolutionPyramid::process(const cv::Mat& image, double scale,
+                                   const std::function<cv::Mat(const cv::Mat&)>& operation) {
+    if (scale >= 1.0) return operation(image);
+    return upscale(operation(downscale(image, scale)), image.size());
+}
+
+cv::Point2f ResolutionPyramid::toNative(const cv::Point2f& point, double scale) {
+    if (scale >= 1.0) return point;
+    const float inverse = static_cast<float>(1.0 / scale);
+    return cv::Point2f((point.x + 0.5f) * inverse - 0.5f, (point.y + 0.5f) * inverse - 0.5f);
+}
+
+void ResolutionPyramid::invalidate(const QString& entityId) {
+    QMutexLocker locker(&cacheMutex);
+    levelCache.remove(entityId);
+}
+
+void ResolutionPyramid::clearCache() {
+    QMutexLocker locker(&cacheMutex);
+    levelCache.clear();
+}
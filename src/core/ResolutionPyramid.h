@@ -0,0 +1,63 @@
+#ifndef RESOLUTIONPYRAMID_H
+#define RESOLUTIONPYRAMID_H
+
+#include <opencv2/core.hpp>
+#include <QString>
+#include <functional>
+#include <memory>
+
+/**
+ * @brief Processamento em resolução canônica (500 ppi) com níveis em cache
+ *
+ * Operações no nível das cristas (campo de orientação, Gabor, difusão,
+ * qualidade, extração) foram calibradas para ~500 ppi; em digitalizações de
+ * 1000-2000 ppi elas custam 4-16× mais sem ganho. A imagem é reduzida uma vez
+ * por entidade (INTER_AREA), processada e o resultado ampliado de volta;
+ * coordenadas (minúcias, sobreposições) são convertidas com toNative.
+ *
+ * O nível em cache é revalidado pelo conteúdo da imagem nativa.
+ */
+class ResolutionPyramid {
+public:
+    static constexpr double kCanonicalPPI = 500.0;
+
+    /**
+     * @brief Fator nativo → canônico (≤ 1)
+     *
+     * 1 quando a escala é desconhecida ou a imagem já está perto da resolução
+     * canônica (até 20% acima): reduzir não compensaria a reamostragem.
+     */
+    static double canonicalScale(double pixelsPerMM, double targetPPI = kCanonicalPPI);
+
+    /**
+     * @brief Imagem reduzida pelo fator (cópia rasa se scale ≥ 1)
+     */
+    static cv::Mat downscale(const cv::Mat& image, double scale);
+
+    /**
+     * @brief Nível reduzido da entidade, recalculado só se a imagem ou o fator mudaram
+     */
+    static std::shared_ptr<const cv::Mat> level(const QString& entityId, const cv::Mat& image, double scale);
+
+    /**
+     * @brief Amplia um resultado de volta ao tamanho nativo
+     * @param binary Interpolação pelo vizinho mais próximo (mantém imagens binárias)
+     */
+    static cv::Mat upscale(const cv::Mat& result, const cv::Size& nativeSize, bool binary = false);
+
+    /**
+     * @brief Reduz, aplica a operação e amplia; sem redução se scale ≥ 1
+     */
+    static cv::Mat process(const cv::Mat& image, double scale,
+                           const std::function<cv::Mat(const cv::Mat&)>& operation);
+
+    /**
+     * @brief Coordenada no nível reduzido → coordenada nativa (centros de pixel alinhados)
+     */
+    static cv::Point2f toNative(const cv::Point2f& point, double scale);
+
+    static void invalidate(const QString& entityId);
+    static void clearCache();
+};
+
+#endif // RESOLUTIONPYRAMID_H
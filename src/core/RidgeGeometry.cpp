@@ -0,0 +1,315 @@
+#include "RidgeGeometry.h"
+#include <opencv2/imgproc.hpp>
+#include <QHash>
+#include <QMutex>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+const int kMaxCachedEntities = 16;
+
+struct CacheEntry {
+    quint64 hash = 0;
+    RidgeFieldConfig config;
+    std::shared_ptr<const RidgeField> field;
+    quint64 lastUse = 0;
+};
+
+QMutex cacheMutex;
+QHash<QString, CacheEntry> fieldCache;
+quint64 useCounter = 0;
+
+// Soma de uma janela [x0, x1) × [y0, y1) numa imagem integral CV_64F
+inline double windowSum(const cv::Mat& integral, int x0, int y0, int x1, int y1) {
+    return integral.at<double>(y1, x1) - integral.at<double>(y0, x1)
+         - integral.at<double>(y1, x0) + integral.at<double>(y0, x0);
+}
+
+// Amostragem bilinear com coordenadas limitadas à imagem
+inline float sampleBilinear(const cv::Mat& image, float x, float y) {
+    x = std::clamp(x, 0.0f, static_cast<float>(image.cols - 1));
+    y = std::clamp(y, 0.0f, static_cast<float>(image.rows - 1));
+    int x0 = static_cast<int>(x);
+    int y0 = static_cast<int>(y);
+    int x1 = std::min(x0 + 1, image.cols - 1);
+    int y1 = std::min(y0 + 1, image.rows - 1);
+    float fx = x - x0;
+    float fy = y - y0;
+    const float* r0 = image.ptr<float>(y0);
+    const float* r1 = image.ptr<float>(y1);
+    return (r0[x0] * (1 - fx) + r0[x1] * fx) * (1 - fy) +
+           (r1[x0] * (1 - fx) + r1[x1] * fx) * fy;
+}
+
+} // namespace
+
+// ==================== RidgeFieldConfig / RidgeField ====================
+
+bool RidgeFieldConfig::operator==(const RidgeFieldConfig& other) const {
+    return blockSize == other.blockSize &&
+           orientationWindow == other.orientationWindow &&
+           gradientSigma == other.gradientSigma &&
+           orientationSmoothing == other.orientationSmoothing &&
+           frequencyWindowLength == other.frequencyWindowLength &&
+           frequencyWindowWidth == other.frequencyWindowWidth &&
+           minWavelength == other.minWavelength &&
+           maxWavelength == other.maxWavelength;
+}
+
+float RidgeField::orientationAt(int x, int y) const {
+    int bx = std::clamp(x / blockSize, 0, orientation.cols - 1);
+    int by = std::clamp(y / blockSize, 0, orientation.rows - 1);
+    return orientation.at<float>(by, bx);
+}
+
+float RidgeField::coherenceAt(int x, int y) const {
+    int bx = std::clamp(x / blockSize, 0, coherence.cols - 1);
+    int by = std::clamp(y / blockSize, 0, coherence.rows - 1);
+    return coherence.at<float>(by, bx);
+}
+
+float RidgeField::frequencyAt(int x, int y) const {
+    int bx = std::clamp(x / blockSize, 0, frequency.cols - 1);
+    int by = std::clamp(y / blockSize, 0, frequency.rows - 1);
+    return frequency.at<float>(by, bx);
+}
+
+// ==================== RidgeGeometry ====================
+
+RidgeField RidgeGeometry::compute(const cv::Mat& image, const RidgeFieldConfig& config) {
+    RidgeField field;
+    if (image.empty()) return field;
+
+    cv::Mat gray;
+    if (image.channels() > 1) {
+        cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        gray = image;
+    }
+    gray.convertTo(gray, CV_32F);
+
+    field.blockSize = std::max(4, config.blockSize);
+    field.imageSize = gray.size();
+
+    computeOrientation(gray, config, field);
+    computeFrequency(gray, config, field);
+
+    return field;
+}
+
+void RidgeGeometry::computeOrientation(const cv::Mat& gray, const RidgeFieldConfig& config,
+                                       RidgeField& field) {
+    const int bs = field.blockSize;
+    const int blocksX = (gray.cols + bs - 1) / bs;
+    const int blocksY = (gray.rows + bs - 1) / bs;
+
+    cv::Mat smoothed;
+    cv::GaussianBlur(gray, smoothed, cv::Size(0, 0), config.gradientSigma);
+
+    cv::Mat gx, gy;
+    cv::Sobel(smoothed, gx, CV_32F, 1, 0, 3);
+    cv::Sobel(smoothed, gy, CV_32F, 0, 1, 3);
+
+    // Imagens integrais dos produtos: soma por janela em O(1)
+    cv::Mat gxx = gx.mul(gx);
+    cv::Mat gyy = gy.mul(gy);
+    cv::Mat gxy = gx.mul(gy);
+    cv::Mat ixx, iyy, ixy;
+    cv::integral(gxx, ixx, CV_64F);
+    cv::integral(gyy, iyy, CV_64F);
+    cv::integral(gxy, ixy, CV_64F);
+
+    // Campo de ângulo duplo (cos 2φ, sin 2φ) ponderado pela energia anisotrópica
+    cv::Mat vx(blocksY, blocksX, CV_32F);
+    cv::Mat vy(blocksY, blocksX, CV_32F);
+    cv::Mat energy(blocksY, blocksX, CV_32F);
+
+    const int half = std::max(bs, config.orientationWindow) / 2;
+
+    cv::parallel_for_(cv::Range(0, blocksY), [&](const cv::Range& range) {
+        for (int by = range.start; by < range.end; ++by) {
+            int cy = by * bs + bs / 2;
+            int y0 = std::max(0, cy - half);
+            int y1 = std::min(gray.rows, cy + half);
+            for (int bx = 0; bx < blocksX; ++bx) {
+                int cx = bx * bs + bs / 2;
+                int x0 = std::max(0, cx - half);
+                int x1 = std::min(gray.cols, cx + half);
+
+                double sxx = windowSum(ixx, x0, y0, x1, y1);
+                double syy = windowSum(iyy, x0, y0, x1, y1);
+                double sxy = windowSum(ixy, x0, y0, x1, y1);
+
+                double a = sxx - syy;
+                double b = 2.0 * sxy;
+                double anisotropy = std::sqrt(a * a + b * b);
+                double total = sxx + syy;
+
+                vx.at<float>(by, bx) = static_cast<float>(a);
+                vy.at<float>(by, bx) = static_cast<float>(b);
+                energy.at<float>(by, bx) = (total > 1e-9) ? static_cast<float>(anisotropy / total) : 0.0f;
+            }
+        }
+    });
+
+    if (config.orientationSmoothing > 0.0) {
+        cv::GaussianBlur(vx, vx, cv::Size(0, 0), config.orientationSmoothing);
+        cv::GaussianBlur(vy, vy, cv::Size(0, 0), config.orientationSmoothing);
+    }
+
+    field.orientation.create(blocksY, blocksX, CV_32F);
+    for (int by = 0; by < blocksY; ++by) {
+        for (int bx = 0; bx < blocksX; ++bx) {
+            // Direção do gradiente dominante; as cristas são perpendiculares
+            double phi = 0.5 * std::atan2(vy.at<float>(by, bx), vx.at<float>(by, bx));
+            double theta = phi + M_PI / 2.0;
+            if (theta >= M_PI) theta -= M_PI;
+            if (theta < 0.0) theta += M_PI;
+            field.orientation.at<float>(by, bx) = static_cast<float>(theta);
+        }
+    }
+    field.coherence = energy;
+}
+
+void RidgeGeometry::computeFrequency(const cv::Mat& gray, const RidgeFieldConfig& config,
+                                     RidgeField& field) {
+    const int bs = field.blockSize;
+    const cv::Size blocks = field.blocks();
+    const int length = std::max(8, config.frequencyWindowLength);
+    const int width = std::max(1, config.frequencyWindowWidth);
+
+    cv::Mat frequency(blocks, CV_32F, cv::Scalar(0));
+    cv::Mat valid(blocks, CV_8U, cv::Scalar(0));
+
+    cv::parallel_for_(cv::Range(0, blocks.height), [&](const cv::Range& range) {
+        std::vector<float> signature(length);
+        std::vector<int> peaks;
+        peaks.reserve(length);
+
+        for (int by = range.start; by < range.end; ++by) {
+            for (int bx = 0; bx < blocks.width; ++bx) {
+                float cx = bx * bs + bs / 2.0f;
+                float cy = by * bs + bs / 2.0f;
+                float theta = field.orientation.at<float>(by, bx);
+
+                // Eixo ao longo das cristas (r) e normal a elas (n)
+                float rx = std::cos(theta), ry = std::sin(theta);
+                float nx = -ry, ny = rx;
+
+                for (int k = 0; k < length; ++k) {
+                    float t = k - length / 2.0f;
+                    float sum = 0.0f;
+                    for (int d = 0; d < width; ++d) {
+                        float s = d - width / 2.0f;
+                        sum += sampleBilinear(gray, cx + t * nx + s * rx, cy + t * ny + s * ry);
+                    }
+                    signature[k] = sum / width;
+                }
+
+                peaks.clear();
+                for (int k = 1; k < length - 1; ++k) {
+                    if (signature[k] > signature[k - 1] && signature[k] >= signature[k + 1]) {
+                        peaks.push_back(k);
+                    }
+                }
+                if (peaks.size() < 2) continue;
+
+                double wavelength = static_cast<double>(peaks.back() - peaks.front()) / (peaks.size() - 1);
+                if (wavelength >= config.minWavelength && wavelength <= config.maxWavelength) {
+                    frequency.at<float>(by, bx) = static_cast<float>(1.0 / wavelength);
+                    valid.at<uchar>(by, bx) = 1;
+                }
+            }
+        }
+    });
+
+    // Blocos sem medida: média gaussiana dos vizinhos válidos (convolução normalizada)
+    cv::Mat weights;
+    valid.convertTo(weights, CV_32F);
+    cv::Mat weightedSum, weightSum;
+    cv::GaussianBlur(frequency, weightedSum, cv::Size(7, 7), 0);
+    cv::GaussianBlur(weights, weightSum, cv::Size(7, 7), 0);
+
+    for (int by = 0; by < blocks.height; ++by) {
+        for (int bx = 0; bx < blocks.width; ++bx) {
+            if (valid.at<uchar>(by, bx)) continue;
+            float w = weightSum.at<float>(by, bx);
+            frequency.at<float>(by, bx) = (w > 1e-3f) ? weightedSum.at<float>(by, bx) / w : 0.0f;
+        }
+    }
+
+    field.frequency = frequency;
+    field.frequencyValid = valid;
+}
+
+quint64 RidgeGeometry::contentHash(const cv::Mat& image) {
+    quint64 hash = 1469598103934665603ULL;
+    auto mix = [&hash](quint64 value) {
+        hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    };
+
+    mix(static_cast<quint64>(image.rows));
+    mix(static_cast<quint64>(image.cols));
+    mix(static_cast<quint64>(image.type()));
+
+    const size_t rowBytes = image.cols * image.elemSize();
+    for (int y = 0; y < image.rows; ++y) {
+        std::string_view row(reinterpret_cast<const char*>(image.ptr(y)), rowBytes);
+        mix(std::hash<std::string_view>{}(row));
+    }
+    return hash;
+}
+
+std::shared_ptr<const RidgeField> RidgeGeometry::cached(const QString& entityId,
+                                                        const cv::Mat& image,
+                                                        const RidgeFieldConfig& config) {
+    quint64 hash = contentHash(image);
+
+    {
+        QMutexLocker locker(&cacheMutex);
+        auto it = fieldCache.find(entityId);
+        if (it != fieldCache.end() && it->hash == hash && it->config == config) {
+            it->lastUse = ++useCounter;
+            return it->field;
+        }
+    }
+
+    auto field = std::make_shared<const RidgeField>(compute(image, config));
+
+    QMutexLocker locker(&cacheMutex);
+    if (!fieldCache.contains(entityId) && fieldCache.size() >= kMaxCachedEntities) {
+        // Descartar a entidade usada há mais tempo
+        auto oldest = fieldCache.begin();
+        for (auto it = fieldCache.begin(); it != fieldCache.end(); ++it) {
+            if (it->lastUse < oldest->lastUse) oldest = it;
+        }
+        fieldCache.erase(oldest);
+    }
+
+    CacheEntry entry;
+    entry.hash = hash;
+    entry.config = config;
+    entry.field = field;
+    entry.lastUse = ++useCounter;
+    fieldCache.insert(entityId, entry);
+
+    qDebug() << QString("[RidgeGeometry] Campo calculado para %1: %2x%3 blocos")
+        .arg(entityId).arg(field->blocks().width).arg(field->blocks().height);
+
+    return field;
+}
+
+void RidgeGeometry::invalidate(const QString& entityId) {
+    QMutexLocker locker(&cacheMutex);
+    fieldCache.remove(entityId);
+}
+
+void RidgeGeometry::clearCache() {
+    QMutexLocker locker(&cacheMutex);
+    fieldCache.clear();
+}
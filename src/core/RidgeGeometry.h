@@ -0,0 +1,89 @@
+#ifndef RIDGEGEOMETRY_H
+#define RIDGEGEOMETRY_H
+
+#include <opencv2/core.hpp>
+#include <QString>
+#include <memory>
+
+/**
+ * @brief Parâmetros do campo de orientação e da frequência das cristas
+ *
+ * Valores padrão calibrados para 500 ppi (período típico de 8-12 pixels).
+ */
+struct RidgeFieldConfig {
+    int blockSize = 16;                 // Lado do bloco (pixels)
+    int orientationWindow = 32;         // Janela do tensor de estrutura, centrada no bloco
+    double gradientSigma = 1.0;         // Suavização antes do gradiente
+    double orientationSmoothing = 1.0;  // σ (em blocos) da suavização do campo vetorial
+    int frequencyWindowLength = 32;     // Janela orientada: comprimento normal às cristas
+    int frequencyWindowWidth = 16;      // Janela orientada: largura ao longo das cristas
+    double minWavelength = 3.0;         // Período mínimo aceito (pixels)
+    double maxWavelength = 25.0;        // Período máximo aceito (pixels)
+
+    bool operator==(const RidgeFieldConfig& other) const;
+};
+
+/**
+ * @brief Campo de orientação e frequência por bloco
+ *
+ * As matrizes têm uma entrada por bloco (linhas × colunas de blocos), CV_32F.
+ */
+struct RidgeField {
+    int blockSize = 16;
+    cv::Size imageSize;
+    cv::Mat orientation;    // Direção das cristas em radianos, [0, π), eixo x para a direita, y para baixo
+    cv::Mat coherence;      // Coerência do tensor de estrutura, [0, 1]
+    cv::Mat frequency;      // Frequência das cristas (1/pixel); 0 = sem estimativa
+    cv::Mat frequencyValid; // CV_8U: 1 onde a frequência foi medida (não interpolada)
+
+    bool isValid() const { return !orientation.empty(); }
+    cv::Size blocks() const { return orientation.size(); }
+
+    /**
+     * @brief Valores do bloco que contém o pixel (x, y)
+     */
+    float orientationAt(int x, int y) const;
+    float coherenceAt(int x, int y) const;
+    float frequencyAt(int x, int y) const;
+};
+
+/**
+ * @brief Estimativa de orientação (tensor de estrutura) e frequência das cristas
+ *
+ * - Orientação: produtos de gradiente acumulados em imagens integrais, de
+ *   modo que a soma em cada janela de bloco custa O(1); o campo de vetores
+ *   de ângulo duplo é suavizado para atravessar ruído e poros.
+ * - Frequência: assinatura x (Hong, Wan & Jain, 1998) numa janela orientada
+ *   normal às cristas; blocos sem medida são preenchidos a partir dos vizinhos.
+ * - Blocos processados em paralelo por faixas de linhas (cv::parallel_for_).
+ *
+ * O cache por entidade permite que Gabor, mapas de qualidade, pontos
+ * singulares e calibração compartilhem o mesmo campo; a entrada é
+ * revalidada pelo conteúdo da imagem, então edições invalidam sozinhas.
+ */
+class RidgeGeometry {
+public:
+    static RidgeField compute(const cv::Mat& image,
+                              const RidgeFieldConfig& config = RidgeFieldConfig());
+
+    /**
+     * @brief Campo da entidade, recalculado só se a imagem ou a configuração mudaram
+     */
+    static std::shared_ptr<const RidgeField> cached(const QString& entityId,
+                                                    const cv::Mat& image,
+                                                    const RidgeFieldConfig& config = RidgeFieldConfig());
+
+    static void invalidate(const QString& entityId);
+    static void clearCache();
+
+    /**
+     * @brief Assinatura do conteúdo da imagem usada para validar o cache
+     */
+    static quint64 contentHash(const cv::Mat& image);
+
+private:
+    static void computeOrientation(const cv::Mat& gray, const RidgeFieldConfig& config, RidgeField& field);
+    static void computeFrequency(const cv::Mat& gray, const RidgeFieldConfig& config, RidgeField& field);
+};
+
+#endif // RIDGEGEOMETRY_H
@@ -0,0 +1,215 @@
+#include "RidgeQuality.h"
+#include "RidgeSegmentation.h"
+#include <opencv2/imgproc.hpp>
+#include <QHash>
+#include <QMutex>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+const int kMaxCachedEntities = 16;
+
+struct CacheEntry {
+    quint64 hash = 0;
+    QualityMapConfig config;
+    std::shared_ptr<const QualityMap> map;
+    quint64 lastUse = 0;
+};
+
+QMutex cacheMutex;
+QHash<QString, CacheEntry> mapCache;
+quint64 useCounter = 0;
+
+// Soma de uma janela [x0, x1) × [y0, y1) numa imagem integral CV_64F
+inline double windowSum(const cv::Mat& integral, int x0, int y0, int x1, int y1) {
+    return integral.at<double>(y1, x1) - integral.at<double>(y0, x1)
+         - integral.at<double>(y1, x0) + integral.at<double>(y0, x0);
+}
+
+} // namespace
+
+bool QualityMapConfig::operator==(const QualityMapConfig& other) const {
+    return coherenceWeight == other.coherenceWeight && contrastWeight == other.contrastWeight &&
+           frequencyWeight == other.frequencyWeight && minWavelength == other.minWavelength &&
+           maxWavelength == other.maxWavelength;
+}
+
+float QualityMap::qualityAt(int x, int y) const {
+    if (!isValid() || x < 0 || y < 0 || x >= imageSize.width || y >= imageSize.height) return 0.0f;
+    return quality.at<float>(y / blockSize, x / blockSize);
+}
+
+int QualityMap::levelAt(int x, int y) const {
+    // Faixas iguais de 0,2: qualidade ≥ 0,8 → 1, < 0,2 → 5
+    const float q = qualityAt(x, y);
+    return std::clamp(5 - static_cast<int>(q * 5.0f), 1, 5);
+}
+
+double QualityMap::meanQuality() const {
+    if (!isValid()) return 0.0;
+    cv::Mat foreground = quality > 0;
+    return cv::countNonZero(foreground) > 0 ? cv::mean(quality, foreground)[0] : 0.0;
+}
+
+QualityMap RidgeQuality::compute(const cv::Mat& image, const RidgeField& field,
+                                 const cv::Mat& blockMask, const QualityMapConfig& config) {
+    QualityMap map;
+    if (image.empty() || !field.isValid()) return map;
+
+    const int bs = field.blockSize;
+    const cv::Size grid = field.blocks();
+    map.blockSize = bs;
+    map.imageSize = image.size();
+
+    cv::Mat gray;
+    if (image.channels() > 1) {
+        cv::cvtColor(image, gray, image.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    } else {
+        gray = image;
+    }
+
+    cv::Mat sum, sqsum;
+    cv::integral(gray, sum, sqsum, CV_64F, CV_64F);
+
+    const bool masked = !blockMask.empty() && blockMask.size() == grid;
+
+    // Desvio padrão por bloco (imagens integrais: O(1) por bloco)
+    cv::Mat deviation(grid, CV_32F);
+    cv::parallel_for_(cv::Range(0, grid.height), [&](const cv::Range& range) {
+        for (int by = range.start; by < range.end; ++by) {
+            const int y0 = by * bs;
+            const int y1 = std::min(y0 + bs, gray.rows);
+            for (int bx = 0; bx < grid.width; ++bx) {
+                const int x0 = bx * bs;
+                const int x1 = std::min(x0 + bs, gray.cols);
+                const double n = static_cast<double>(x1 - x0) * (y1 - y0);
+                const double mean = windowSum(sum, x0, y0, x1, y1) / n;
+                const double variance = windowSum(sqsum, x0, y0, x1, y1) / n - mean * mean;
+                deviation.at<float>(by, bx) = static_cast<float>(std::sqrt(std::max(0.0, variance)));
+            }
+        }
+    });
+
+    // Contraste de referência: percentil 95 dos blocos da impressão
+    std::vector<float> values;
+    values.reserve(grid.area());
+    for (int by = 0; by < grid.height; ++by) {
+        for (int bx = 0; bx < grid.width; ++bx) {
+            if (!masked || blockMask.at<uchar>(by, bx)) values.push_back(deviation.at<float>(by, bx));
+        }
+    }
+    double reference = 1.0;
+    if (!values.empty()) {
+        auto p95 = values.begin() + static_cast<long>(0.95 * (values.size() - 1));
+        std::nth_element(values.begin(), p95, values.end());
+        reference = std::max(1e-6, static_cast<double>(*p95));
+    }
+
+    const double totalWeight = std::max(1e-9, config.coherenceWeight + config.contrastWeight + config.frequencyWeight);
+    map.quality = cv::Mat(grid, CV_32F, cv::Scalar(0));
+
+    cv::parallel_for_(cv::Range(0, grid.height), [&](const cv::Range& range) {
+        for (int by = range.start; by < range.end; ++by) {
+            for (int bx = 0; bx < grid.width; ++bx) {
+                if (masked && !blockMask.at<uchar>(by, bx)) continue;
+
+                const double coherence = std::clamp(static_cast<double>(field.coherence.at<float>(by, bx)), 0.0, 1.0);
+                const double contrast = std::min(1.0, deviation.at<float>(by, bx) / reference);
+
+                // Frequência medida e plausível vale 1; interpolada, metade; implausível, quase nada
+                const double frequency = field.frequency.at<float>(by, bx);
+                const double wavelength = frequency > 0.0 ? 1.0 / frequency : 0.0;
+                double frequencyScore = 0.0;
+                if (wavelength >= config.minWavelength && wavelength <= config.maxWavelength) {
+                    frequencyScore = field.frequencyValid.at<uchar>(by, bx) ? 1.0 : 0.5;
+                } else if (frequency > 0.0) {
+                    frequencyScore = 0.1;
+                }
+
+                const double q = (config.coherenceWeight * coherence + config.contrastWeight * contrast +
+                                  config.frequencyWeight * frequencyScore) / totalWeight;
+                map.quality.at<float>(by, bx) = static_cast<float>(q);
+            }
+        }
+    });
+
+    return map;
+}
+
+std::shared_ptr<const QualityMap> RidgeQuality::cached(const QString& entityId,
+                                                       const cv::Mat& image,
+                                                       const QualityMapConfig& config) {
+    quint64 hash = RidgeGeometry::contentHash(image);
+
+    {
+        QMutexLocker locker(&cacheMutex);
+        auto it = mapCache.find(entityId);
+        if (it != mapCache.end() && it->hash == hash && it->config == config) {
+            it->lastUse = ++useCounter;
+            return it->map;
+        }
+    }
+
+    // Campo e máscara também vêm dos caches da entidade (mesmo grid de blocos)
+    std::shared_ptr<const RidgeField> field = RidgeGeometry::cached(entityId, image);
+    RidgeMaskConfig maskConfig;
+    maskConfig.blockSize = field->blockSize;
+    std::shared_ptr<const RidgeMask> mask = RidgeSegmentation::cached(entityId, image, maskConfig);
+
+    auto map = std::make_shared<const QualityMap>(compute(image, *field, mask->blocks, config));
+
+    QMutexLocker locker(&cacheMutex);
+    if (!mapCache.contains(entityId) && mapCache.size() >= kMaxCachedEntities) {
+        // Descartar a entidade usada há mais tempo
+        auto oldest = mapCache.begin();
+        for (auto it = mapCache.begin(); it != mapCache.end(); ++it) {
+            if (it->lastUse < oldest->lastUse) oldest = it;
+        }
+        mapCache.erase(oldest);
+    }
+
+    CacheEntry entry;
+    entry.hash = hash;
+    entry.config = config;
+    entry.map = map;
+    entry.lastUse = ++useCounter;
+    mapCache.insert(entityId, entry);
+
+    qDebug() << QString("[RidgeQuality] Mapa de %1: %2x%3 blocos, qualidade média %4")
+        .arg(entityId).arg(map->blocks().width).arg(map->blocks().height)
+        .arg(map->meanQuality(), 0, 'f', 2);
+
+    return map;
+}
+
+cv::Mat RidgeQuality::overlay(const QualityMap& map, int alpha) {
+    if (!map.isValid()) return cv::Mat();
+
+    cv::Mat result(map.blocks(), CV_8UC4, cv::Scalar(0, 0, 0, 0));
+    for (int by = 0; by < result.rows; ++by) {
+        const float* q = map.quality.ptr<float>(by);
+        cv::Vec4b* dst = result.ptr<cv::Vec4b>(by);
+        for (int bx = 0; bx < result.cols; ++bx) {
+            if (q[bx] <= 0.0f) continue;
+            // Vermelho → amarelo (0,5) → verde (BGR)
+            const float t = std::clamp(q[bx], 0.0f, 1.0f);
+            const uchar red = cv::saturate_cast<uchar>(255.0f * std::min(1.0f, 2.0f * (1.0f - t)));
+            const uchar green = cv::saturate_cast<uchar>(255.0f * std::min(1.0f, 2.0f * t));
+            dst[bx] = cv::Vec4b(0, green, red, cv::saturate_cast<uchar>(alpha));
+        }
+    }
+    return result;
+}
+
+void RidgeQuality::invalidate(const QString& entityId) {
+    QMutexLocker locker(&cacheMutex);
+    mapCache.remove(entityId);
+}
+
+void RidgeQuality::clearCache() {
+    QMutexLocker locker(&cacheMutex);
+    mapCache.clear();
+}
@@ -0,0 +1,82 @@
+#ifndef RIDGEQUALITY_H
+#define RIDGEQUALITY_H
+
+#include <opencv2/core.hpp>
+#include <QString>
+#include <memory>
+#include "RidgeGeometry.h"
+
+/**
+ * @brief Pesos e faixas do mapa de qualidade local
+ */
+struct QualityMapConfig {
+    double coherenceWeight = 0.4;
+    double contrastWeight = 0.3;
+    double frequencyWeight = 0.3;
+    double minWavelength = 5.0;         // Período plausível das cristas a 500 ppi (pixels)
+    double maxWavelength = 15.0;
+
+    bool operator==(const QualityMapConfig& other) const;
+};
+
+/**
+ * @brief Qualidade por bloco, no mesmo grid do campo de orientação
+ */
+struct QualityMap {
+    int blockSize = 16;
+    cv::Size imageSize;
+    cv::Mat quality;        // CV_32F por bloco, [0, 1]; 0 = fundo
+
+    bool isValid() const { return !quality.empty(); }
+    cv::Size blocks() const { return quality.size(); }
+
+    /**
+     * @brief Qualidade do bloco que contém o pixel (x, y); 0 fora da imagem
+     */
+    float qualityAt(int x, int y) const;
+
+    /**
+     * @brief Nível no estilo NFIQ: 1 (excelente) a 5 (inutilizável)
+     */
+    int levelAt(int x, int y) const;
+
+    /**
+     * @brief Qualidade média dos blocos com impressão
+     */
+    double meanQuality() const;
+};
+
+/**
+ * @brief Mapa de qualidade local por bloco (estilo NFIQ)
+ *
+ * Combina três medidas já disponíveis por bloco:
+ * - coerência do tensor de estrutura (orientação bem definida);
+ * - contraste: desvio padrão do bloco relativo ao percentil 95 da impressão;
+ * - frequência: medida e dentro da faixa plausível de período.
+ * Blocos fora da área da impressão (RidgeSegmentation) valem 0. Calculado em
+ * paralelo por linhas de blocos; o cache por entidade reaproveita o campo e
+ * a máscara em cache e é revalidado pelo conteúdo da imagem.
+ */
+class RidgeQuality {
+public:
+    /**
+     * @param blockMask CV_8U com o grid do campo (opcional): blocos zerados valem 0
+     */
+    static QualityMap compute(const cv::Mat& image, const RidgeField& field,
+                              const cv::Mat& blockMask = cv::Mat(),
+                              const QualityMapConfig& config = QualityMapConfig());
+
+    static std::shared_ptr<const QualityMap> cached(const QString& entityId,
+                                                    const cv::Mat& image,
+                                                    const QualityMapConfig& config = QualityMapConfig());
+
+    /**
+     * @brief Sobreposição BGRA por bloco: vermelho (ruim) → amarelo → verde (bom); fundo transparente
+     */
+    static cv::Mat overlay(const QualityMap& map, int alpha = 96);
+
+    static void invalidate(const QString& entityId);
+    static void clearCache();
+};
+
+#endif // RIDGEQUALITY_H
@@ -0,0 +1,297 @@
+#include "RidgeSegmentation.h"
+#include "RidgeGeometry.h"
+#include <opencv2/imgproc.hpp>
+#include <QHash>
+#include <QMutex>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+const int kMaxCachedEntities = 16;
+
+struct CacheEntry {
+    quint64 hash = 0;
+    RidgeMaskConfig config;
+    std::shared_ptr<const RidgeMask> mask;
+    quint64 lastUse = 0;
+};
+
+QMutex cacheMutex;
+QHash<QString, CacheEntry> maskCache;
+quint64 useCounter = 0;
+
+// Soma de uma janela [x0, x1) × [y0, y1) numa imagem integral CV_64F
+inline double windowSum(const cv::Mat& integral, int x0, int y0, int x1, int y1) {
+    return integral.at<double>(y1, x1) - integral.at<double>(y0, x1)
+         - integral.at<double>(y1, x0) + integral.at<double>(y0, x0);
+}
+
+cv::Mat toGrayFloat(const cv::Mat& image) {
+    cv::Mat gray;
+    if (image.channels() > 1) {
+        cv::cvtColor(image, gray, image.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+    } else {
+        gray = image;
+    }
+    cv::Mat result;
+    gray.convertTo(result, CV_32F);
+    return result;
+}
+
+// Fechamento, abertura, buracos e componentes pequenos no grid de blocos
+void cleanUp(cv::Mat& foreground, const RidgeMaskConfig& config) {
+    const cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
+    if (config.closingBlocks > 0) {
+        cv::morphologyEx(foreground, foreground, cv::MORPH_CLOSE, kernel, cv::Point(-1, -1), config.closingBlocks);
+    }
+    cv::morphologyEx(foreground, foreground, cv::MORPH_OPEN, kernel);
+
+    cv::Mat labels, stats, centroids;
+    const int count = cv::connectedComponentsWithStats(foreground, labels, stats, centroids, 8, CV_32S);
+    int largest = 0;
+    for (int i = 1; i < count; ++i) largest = std::max(largest, stats.at<int>(i, cv::CC_STAT_AREA));
+
+    std::vector<uchar> keep(count, 0);
+    for (int i = 1; i < count; ++i) {
+        keep[i] = stats.at<int>(i, cv::CC_STAT_AREA) >= config.minComponentRatio * largest ? 255 : 0;
+    }
+    for (int y = 0; y < foreground.rows; ++y) {
+        const int* label = labels.ptr<int>(y);
+        uchar* dst = foreground.ptr<uchar>(y);
+        for (int x = 0; x < foreground.cols; ++x) dst[x] = keep[label[x]];
+    }
+
+    // Buracos: fundo não alcançável a partir da borda
+    cv::Mat padded;
+    cv::copyMakeBorder(foreground, padded, 1, 1, 1, 1, cv::BORDER_CONSTANT, cv::Scalar(0));
+    cv::floodFill(padded, cv::Point(0, 0), cv::Scalar(128));
+    foreground.setTo(255, padded(cv::Rect(1, 1, foreground.cols, foreground.rows)) == 0);
+
+    if (config.marginBlocks > 0) {
+        cv::dilate(foreground, foreground, kernel, cv::Point(-1, -1), config.marginBlocks);
+    }
+}
+
+} // namespace
+
+bool RidgeMaskConfig::operator==(const RidgeMaskConfig& other) const {
+    return blockSize == other.blockSize && downscale == other.downscale &&
+           minContrast == other.minContrast && minCoherence == other.minCoherence &&
+           closingBlocks == other.closingBlocks && marginBlocks == other.marginBlocks &&
+           minComponentRatio == other.minComponentRatio;
+}
+
+double RidgeMask::coverage() const {
+    if (imageSize.area() <= 0) return 0.0;
+    return static_cast<double>(boundingBox.area()) / imageSize.area();
+}
+
+bool RidgeMask::contains(int x, int y) const {
+    if (!isValid() || x < 0 || y < 0 || x >= imageSize.width || y >= imageSize.height) return false;
+    return blocks.at<uchar>(y / blockSize, x / blockSize) != 0;
+}
+
+bool RidgeMask::intersects(const cv::Rect& rect) const {
+    if (!isValid()) return true;
+    cv::Rect clipped = rect & cv::Rect(0, 0, imageSize.width, imageSize.height);
+    if (clipped.empty()) return false;
+
+    const int bx0 = clipped.x / blockSize;
+    const int by0 = clipped.y / blockSize;
+    const int bx1 = (clipped.x + clipped.width - 1) / blockSize;
+    const int by1 = (clipped.y + clipped.height - 1) / blockSize;
+    return cv::countNonZero(blocks(cv::Rect(bx0, by0, bx1 - bx0 + 1, by1 - by0 + 1))) > 0;
+}
+
+cv::Mat RidgeMask::blocksIn(const cv::Rect& region) const {
+    const int bx0 = region.x / blockSize;
+    const int by0 = region.y / blockSize;
+    const int bx1 = std::min(blocks.cols, (region.x + region.width + blockSize - 1) / blockSize);
+    const int by1 = std::min(blocks.rows, (region.y + region.height + blockSize - 1) / blockSize);
+    return blocks(cv::Rect(bx0, by0, bx1 - bx0, by1 - by0));
+}
+
+cv::Mat RidgeMask::pixelMask() const {
+    if (!isValid()) return cv::Mat();
+    cv::Mat expanded;
+    cv::resize(blocks, expanded, cv::Size(blocks.cols * blockSize, blocks.rows * blockSize), 0, 0, cv::INTER_NEAREST);
+    return expanded(cv::Rect(0, 0, imageSize.width, imageSize.height)).clone();
+}
+
+RidgeMask RidgeSegmentation::compute(const cv::Mat& image, const RidgeMaskConfig& config) {
+    RidgeMask mask;
+    if (image.empty()) return mask;
+
+    const int bs = std::max(4, config.blockSize);
+    mask.blockSize = bs;
+    mask.imageSize = image.size();
+    const cv::Size grid((image.cols + bs - 1) / bs, (image.rows + bs - 1) / bs);
+
+    // Redução limitada: blocos com ao menos 4 pixels e cristas ainda resolvidas
+    cv::Mat gray = toGrayFloat(image);
+    const int factor = std::clamp(config.downscale, 1, std::max(1, bs / 4));
+    if (factor > 1) {
+        cv::resize(gray, gray, cv::Size(std::max(1, gray.cols / factor), std::max(1, gray.rows / factor)),
+                   0, 0, cv::INTER_AREA);
+    }
+    const double sx = static_cast<double>(gray.cols) / image.cols;
+    const double sy = static_cast<double>(gray.rows) / image.rows;
+
+    cv::Mat gx, gy;
+    cv::Sobel(gray, gx, CV_32F, 1, 0, 3);
+    cv::Sobel(gray, gy, CV_32F, 0, 1, 3);
+
+    cv::Mat sum, sqsum, ixx, iyy, ixy;
+    cv::integral(gray, sum, sqsum, CV_64F, CV_64F);
+    cv::integral(gx.mul(gx), ixx, CV_64F);
+    cv::integral(gy.mul(gy), iyy, CV_64F);
+    cv::integral(gx.mul(gy), ixy, CV_64F);
+
+    cv::Mat deviation(grid, CV_32F), txx(grid, CV_32F), tyy(grid, CV_32F), txy(grid, CV_32F);
+    cv::parallel_for_(cv::Range(0, grid.height), [&](const cv::Range& range) {
+        for (int by = range.start; by < range.end; ++by) {
+            const int y0 = std::min(static_cast<int>(by * bs * sy), gray.rows - 1);
+            const int y1 = std::max(y0 + 1, std::min(static_cast<int>(std::ceil((by + 1) * bs * sy)), gray.rows));
+            for (int bx = 0; bx < grid.width; ++bx) {
+                const int x0 = std::min(static_cast<int>(bx * bs * sx), gray.cols - 1);
+                const int x1 = std::max(x0 + 1, std::min(static_cast<int>(std::ceil((bx + 1) * bs * sx)), gray.cols));
+                const double n = static_cast<double>(x1 - x0) * (y1 - y0);
+
+                const double mean = windowSum(sum, x0, y0, x1, y1) / n;
+                const double variance = windowSum(sqsum, x0, y0, x1, y1) / n - mean * mean;
+                deviation.at<float>(by, bx) = static_cast<float>(std::sqrt(std::max(0.0, variance)));
+                txx.at<float>(by, bx) = static_cast<float>(windowSum(ixx, x0, y0, x1, y1) / n);
+                tyy.at<float>(by, bx) = static_cast<float>(windowSum(iyy, x0, y0, x1, y1) / n);
+                txy.at<float>(by, bx) = static_cast<float>(windowSum(ixy, x0, y0, x1, y1) / n);
+            }
+        }
+    });
+
+    // Tensor médio em 3x3 blocos: blocos pequenos isolados têm orientação ruidosa
+    cv::blur(txx, txx, cv::Size(3, 3), cv::Point(-1, -1), cv::BORDER_REPLICATE);
+    cv::blur(tyy, tyy, cv::Size(3, 3), cv::Point(-1, -1), cv::BORDER_REPLICATE);
+    cv::blur(txy, txy, cv::Size(3, 3), cv::Point(-1, -1), cv::BORDER_REPLICATE);
+
+    // Contraste relativo: independe da profundidade e da exposição da imagem
+    std::vector<float> values(deviation.begin<float>(), deviation.end<float>());
+    auto p95 = values.begin() + static_cast<long>(0.95 * (values.size() - 1));
+    std::nth_element(values.begin(), p95, values.end());
+    const double minDeviation = config.minContrast * (*p95);
+
+    cv::Mat foreground(grid, CV_8U, cv::Scalar(0));
+    if (*p95 > 1e-6) {
+        for (int by = 0; by < grid.height; ++by) {
+            for (int bx = 0; bx < grid.width; ++bx) {
+                const double a = txx.at<float>(by, bx);
+                const double b = tyy.at<float>(by, bx);
+                const double c = txy.at<float>(by, bx);
+                const double coherence = std::sqrt((a - b) * (a - b) + 4.0 * c * c) / std::max(1e-9, a + b);
+                if (deviation.at<float>(by, bx) >= minDeviation && coherence >= config.minCoherence) {
+                    foreground.at<uchar>(by, bx) = 255;
+                }
+            }
+        }
+        cleanUp(foreground, config);
+    }
+
+    if (cv::countNonZero(foreground) == 0) {
+        // Nada segmentado: não restringir
+        qDebug() << QString("[RidgeSegmentation] Nenhuma região com cristas; imagem inteira mantida");
+        foreground.setTo(255);
+    }
+
+    mask.blocks = foreground;
+    cv::Rect blockBox = cv::boundingRect(foreground);
+    mask.boundingBox = cv::Rect(blockBox.x * bs, blockBox.y * bs, blockBox.width * bs, blockBox.height * bs)
+                       & cv::Rect(0, 0, image.cols, image.rows);
+    return mask;
+}
+
+std::shared_ptr<const RidgeMask> RidgeSegmentation::cached(const QString& entityId,
+                                                           const cv::Mat& image,
+                                                           const RidgeMaskConfig& config) {
+    quint64 hash = RidgeGeometry::contentHash(image);
+
+    {
+        QMutexLocker locker(&cacheMutex);
+        auto it = maskCache.find(entityId);
+        if (it != maskCache.end() && it->hash == hash && it->config == config) {
+            it->lastUse = ++useCounter;
+            return it->mask;
+        }
+    }
+
+    auto mask = std::make_shared<const RidgeMask>(compute(image, config));
+
+    QMutexLocker locker(&cacheMutex);
+    if (!maskCache.contains(entityId) && maskCache.size() >= kMaxCachedEntities) {
+        // Descartar a entidade usada há mais tempo
+        auto oldest = maskCache.begin();
+        for (auto it = maskCache.begin(); it != maskCache.end(); ++it) {
+            if (it->lastUse < oldest->lastUse) oldest = it;
+        }
+        maskCache.erase(oldest);
+    }
+
+    CacheEntry entry;
+    entry.hash = hash;
+    entry.config = config;
+    entry.mask = mask;
+    entry.lastUse = ++useCounter;
+    maskCache.insert(entityId, entry);
+
+    qDebug() << QString("[RidgeSegmentation] Máscara de %1: envoltório %2x%3 (%4% da imagem)")
+        .arg(entityId).arg(mask->boundingBox.width).arg(mask->boundingBox.height)
+        .arg(100.0 * mask->coverage(), 0, 'f', 1);
+
+    return mask;
+}
+
+std::shared_ptr<const RidgeMask> RidgeSegmentation::restricting(const QString& entityId,
+                                                                const cv::Mat& image,
+                                                                const RidgeMaskConfig& config) {
+    std::shared_ptr<const RidgeMask> mask = entityId.isEmpty()
+        ? std::make_shared<const RidgeMask>(compute(image, config))
+        : cached(entityId, image, config);
+    return mask->restricts() ? mask : nullptr;
+}
+
+TileSchedulerConfig RidgeSegmentation::tileConfig(const std::shared_ptr<const RidgeMask>& mask,
+                                                  TileSchedulerConfig base) {
+    if (mask) {
+        base.tileActive = [mask](const cv::Rect& tile) { return mask->intersects(tile); };
+    }
+    return base;
+}
+
+cv::Mat RidgeSegmentation::embed(const cv::Mat& regionResult, const RidgeMask& mask) {
+    if (regionResult.empty() || regionResult.size() != mask.boundingBox.size()) return regionResult;
+
+    // Nível do fundo: média do resultado nos blocos sem impressão dentro do recorte
+    cv::Mat regionBlocks = mask.blocksIn(mask.boundingBox);
+    cv::Mat background;
+    cv::resize(regionBlocks, background,
+               cv::Size(regionBlocks.cols * mask.blockSize, regionBlocks.rows * mask.blockSize),
+               0, 0, cv::INTER_NEAREST);
+    background = background(cv::Rect(0, 0, regionResult.cols, regionResult.rows)) == 0;
+
+    const cv::Scalar level = cv::countNonZero(background) > 0 ? cv::mean(regionResult, background)
+                                                               : cv::mean(regionResult);
+
+    cv::Mat result(mask.imageSize, regionResult.type(), level);
+    regionResult.copyTo(result(mask.boundingBox));
+    return result;
+}
+
+void RidgeSegmentation::invalidate(const QString& entityId) {
+    QMutexLocker locker(&cacheMutex);
+    maskCache.remove(entityId);
+}
+
+void RidgeSegmentation::clearCache() {
+    QMutexLocker locker(&cacheMutex);
+    maskCache.clear();
+}
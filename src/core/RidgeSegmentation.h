@@ -0,0 +1,109 @@
+#ifndef RIDGESEGMENTATION_H
+#define RIDGESEGMENTATION_H
+
+#include <opencv2/core.hpp>
+#include <QString>
+#include <memory>
+#include "TileScheduler.h"
+
+/**
+ * @brief Parâmetros da segmentação da área da impressão
+ */
+struct RidgeMaskConfig {
+    int blockSize = 16;             // Lado do bloco em resolução total (pixels)
+    int downscale = 2;              // Redução da análise; limitada para manter as cristas resolvidas
+    double minContrast = 0.2;       // Desvio do bloco relativo ao percentil 95 dos blocos
+    double minCoherence = 0.25;     // Coerência mínima do tensor de estrutura (vizinhança 3x3 blocos)
+    int closingBlocks = 2;          // Fechamento no grid: atravessa dobras e falhas de tinta
+    int marginBlocks = 1;           // Dilatação final: folga para o halo dos filtros
+    double minComponentRatio = 0.1; // Componentes menores que esta fração da maior são descartados
+
+    bool operator==(const RidgeMaskConfig& other) const;
+};
+
+/**
+ * @brief Máscara da área da impressão por bloco
+ */
+struct RidgeMask {
+    int blockSize = 16;
+    cv::Size imageSize;
+    cv::Mat blocks;             // CV_8U, uma entrada por bloco: 255 = impressão
+    cv::Rect boundingBox;       // Envoltório dos blocos ativos em pixels, alinhado ao grid
+
+    bool isValid() const { return !blocks.empty(); }
+
+    /**
+     * @brief Fração da imagem ocupada pelo envoltório
+     */
+    double coverage() const;
+
+    /**
+     * @brief Vale a pena restringir o processamento (envoltório menor que 90% da imagem)
+     */
+    bool restricts() const { return isValid() && coverage() < 0.9; }
+
+    bool contains(int x, int y) const;
+    bool intersects(const cv::Rect& rect) const;
+
+    /**
+     * @brief Blocos de uma região alinhada ao grid (p.ex. boundingBox)
+     */
+    cv::Mat blocksIn(const cv::Rect& region) const;
+
+    /**
+     * @brief Máscara CV_8U em resolução total
+     */
+    cv::Mat pixelMask() const;
+};
+
+/**
+ * @brief Segmentação rápida da área com cristas (frente) e do fundo
+ *
+ * Levantamentos de latentes costumam ter uma impressão pequena num fundo
+ * grande e vazio. Em cada bloco de uma versão reduzida da imagem, o desvio
+ * padrão (contraste) e a coerência do tensor de estrutura saem de imagens
+ * integrais em O(1); blocos com contraste e orientação definida formam a
+ * impressão. O grid é limpo por morfologia (fechamento, abertura, buracos
+ * preenchidos, componentes pequenos descartados) e dilatado por uma margem.
+ *
+ * Os filtros usam o envoltório para recortar a imagem e os blocos para
+ * pular regiões sem impressão. Cache por entidade revalidado pelo conteúdo.
+ */
+class RidgeSegmentation {
+public:
+    static RidgeMask compute(const cv::Mat& image, const RidgeMaskConfig& config = RidgeMaskConfig());
+
+    /**
+     * @brief Máscara da entidade, recalculada só se a imagem ou a configuração mudaram
+     */
+    static std::shared_ptr<const RidgeMask> cached(const QString& entityId,
+                                                   const cv::Mat& image,
+                                                   const RidgeMaskConfig& config = RidgeMaskConfig());
+
+    /**
+     * @brief Máscara a usar para restringir o processamento, ou nullptr se a impressão ocupa quase tudo
+     * @param entityId Vazio = sem cache
+     */
+    static std::shared_ptr<const RidgeMask> restricting(const QString& entityId,
+                                                        const cv::Mat& image,
+                                                        const RidgeMaskConfig& config = RidgeMaskConfig());
+
+    /**
+     * @brief Configuração do TileScheduler que pula ladrilhos sem impressão
+     */
+    static TileSchedulerConfig tileConfig(const std::shared_ptr<const RidgeMask>& mask,
+                                          TileSchedulerConfig base = TileSchedulerConfig());
+
+    /**
+     * @brief Recoloca o resultado do envoltório na imagem inteira
+     *
+     * Fora do envoltório usa o nível médio do resultado nos blocos sem
+     * impressão do recorte, para não criar costura visível.
+     */
+    static cv::Mat embed(const cv::Mat& regionResult, const RidgeMask& mask);
+
+    static void invalidate(const QString& entityId);
+    static void clearCache();
+};
+
+#endif // RIDGESEGMENTATION_H
@@ -0,0 +1,257 @@
+#include "Thinning.h"
+#include <opencv2/imgproc.hpp>
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <vector>
+
+namespace {
+
+/**
+ * Vizinhança 8 codificada em um byte, no sentido horário a partir do norte:
+ * bit0=P2(N) bit1=P3(NE) bit2=P4(E) bit3=P5(SE) bit4=P6(S) bit5=P7(SW) bit6=P8(W) bit7=P9(NW)
+ */
+inline int neighbourhoodCode(const uchar* p, int stride) {
+    return  p[-stride]
+         | (p[-stride + 1] << 1)
+         | (p[1]           << 2)
+         | (p[stride + 1]  << 3)
+         | (p[stride]      << 4)
+         | (p[stride - 1]  << 5)
+         | (p[-1]          << 6)
+         | (p[-stride - 1] << 7);
+}
+
+using DeletionTable = std::array<std::array<uchar, 256>, 2>;
+
+DeletionTable buildZhangSuenTable() {
+    DeletionTable table{};
+    for (int code = 0; code < 256; ++code) {
+        int p[8];
+        for (int b = 0; b < 8; ++b) p[b] = (code >> b) & 1;
+        const int P2 = p[0], P4 = p[2], P6 = p[4], P8 = p[6];
+
+        int neighbours = 0;
+        int transitions = 0;
+        for (int b = 0; b < 8; ++b) {
+            neighbours += p[b];
+            if (p[b] == 0 && p[(b + 1) % 8] == 1) transitions++;
+        }
+
+        bool candidate = (neighbours >= 2 && neighbours <= 6 && transitions == 1);
+        table[0][code] = candidate && (P2 * P4 * P6 == 0) && (P4 * P6 * P8 == 0);
+        table[1][code] = candidate && (P2 * P4 * P8 == 0) && (P2 * P6 * P8 == 0);
+    }
+    return table;
+}
+
+DeletionTable buildGuoHallTable() {
+    DeletionTable table{};
+    for (int code = 0; code < 256; ++code) {
+        int p[8];
+        for (int b = 0; b < 8; ++b) p[b] = (code >> b) & 1;
+        const int P2 = p[0], P3 = p[1], P4 = p[2], P5 = p[3];
+        const int P6 = p[4], P7 = p[5], P8 = p[6], P9 = p[7];
+
+        int C = (!P2 & (P3 | P4)) + (!P4 & (P5 | P6)) +
+                (!P6 & (P7 | P8)) + (!P8 & (P9 | P2));
+        int N1 = (P9 | P2) + (P3 | P4) + (P5 | P6) + (P7 | P8);
+        int N2 = (P2 | P3) + (P4 | P5) + (P6 | P7) + (P8 | P9);
+        int N = std::min(N1, N2);
+
+        bool candidate = (C == 1 && N >= 2 && N <= 3);
+        table[0][code] = candidate && (((P6 | P7 | !P9) & P8) == 0);
+        table[1][code] = candidate && (((P2 | P3 | !P5) & P4) == 0);
+    }
+    return table;
+}
+
+const DeletionTable& deletionTable(ThinningAlgorithm algorithm) {
+    static const DeletionTable zhangSuen = buildZhangSuenTable();
+    static const DeletionTable guoHall = buildGuoHallTable();
+    return (algorithm == ThinningAlgorithm::GuoHall) ? guoHall : zhangSuen;
+}
+
+// Itens da lista de trabalho por tarefa paralela (faixas de linhas equivalentes)
+const int kWorkChunk = 4096;
+
+} // namespace
+
+cv::Mat Thinning::thin(const cv::Mat& binary, ThinningAlgorithm algorithm,
+                       const ThinningProgressCallback& progress) {
+    CV_Assert(!binary.empty());
+
+    cv::Mat gray;
+    if (binary.channels() > 1) {
+        cv::cvtColor(binary, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        gray = binary;
+    }
+    if (gray.depth() != CV_8U) {
+        gray.convertTo(gray, CV_8U);
+    }
+
+    // Buffer 0/1 com borda de um pixel: vizinhos sem teste de limites
+    const int rows = gray.rows;
+    const int cols = gray.cols;
+    const int stride = cols + 2;
+    std::vector<uchar> pixels(static_cast<size_t>(stride) * (rows + 2), 0);
+    std::vector<uchar> inList(pixels.size(), 0);
+
+    for (int y = 0; y < rows; ++y) {
+        const uchar* src = gray.ptr<uchar>(y);
+        uchar* dst = pixels.data() + static_cast<size_t>(y + 1) * stride + 1;
+        for (int x = 0; x < cols; ++x) dst[x] = (src[x] != 0);
+    }
+
+    // Lista inicial: pixels de borda, coletados em faixas de linhas paralelas.
+    // Pixels interiores (vizinhança completa) nunca são removíveis e só entram
+    // na lista quando um vizinho é removido.
+    const int stripRows = std::max(1, rows / std::max(1, cv::getNumThreads() * 4));
+    const int stripCount = (rows + stripRows - 1) / stripRows;
+    std::vector<std::vector<int>> stripLists(stripCount);
+
+    cv::parallel_for_(cv::Range(0, stripCount), [&](const cv::Range& range) {
+        for (int s = range.start; s < range.end; ++s) {
+            std::vector<int>& list = stripLists[s];
+            int yEnd = std::min(rows, (s + 1) * stripRows);
+            for (int y = s * stripRows; y < yEnd; ++y) {
+                int rowStart = (y + 1) * stride + 1;
+                for (int x = 0; x < cols; ++x) {
+                    int idx = rowStart + x;
+                    if (pixels[idx] && neighbourhoodCode(&pixels[idx], stride) != 0xFF) {
+                        list.push_back(idx);
+                        inList[idx] = 1;
+                    }
+                }
+            }
+        }
+    });
+
+    std::vector<int> work;
+    for (const auto& list : stripLists) {
+        work.insert(work.end(), list.begin(), list.end());
+    }
+    stripLists.clear();
+
+    const DeletionTable& table = deletionTable(algorithm);
+    const int offsets[8] = {-stride, -stride + 1, 1, stride + 1,
+                            stride, stride - 1, -1, -stride - 1};
+
+    std::vector<uchar> remove;
+    std::vector<int> next;
+    int iteration = 0;
+
+    while (!work.empty()) {
+        int removedInIteration = 0;
+
+        for (int sub = 0; sub < 2; ++sub) {
+            const std::array<uchar, 256>& lut = table[sub];
+            const int count = static_cast<int>(work.size());
+            remove.assign(count, 0);
+
+            // Decisões sobre o estado anterior à subiteração (somente leitura)
+            cv::parallel_for_(cv::Range(0, count), [&](const cv::Range& range) {
+                for (int j = range.start; j < range.end; ++j) {
+                    remove[j] = lut[neighbourhoodCode(&pixels[work[j]], stride)];
+                }
+            }, std::max(1.0, static_cast<double>(count) / kWorkChunk));
+
+            int removed = 0;
+            for (int j = 0; j < count; ++j) {
+                if (remove[j]) {
+                    pixels[work[j]] = 0;
+                    removed++;
+                }
+            }
+            if (removed == 0) continue;
+            removedInIteration += removed;
+
+            // Sobreviventes continuam; vizinhos dos removidos passam a ser borda
+            next.clear();
+            next.reserve(count);
+            for (int j = 0; j < count; ++j) {
+                if (!remove[j]) next.push_back(work[j]);
+                else inList[work[j]] = 0;
+            }
+            for (int j = 0; j < count; ++j) {
+                if (!remove[j]) continue;
+                for (int offset : offsets) {
+                    int n = work[j] + offset;
+                    if (pixels[n] && !inList[n]) {
+                        inList[n] = 1;
+                        next.push_back(n);
+                    }
+                }
+            }
+            work.swap(next);
+        }
+
+        iteration++;
+        if (progress && !progress(iteration, removedInIteration)) break;
+        if (removedInIteration == 0) break;
+    }
+
+    cv::Mat skeleton(rows, cols, CV_8UC1);
+    for (int y = 0; y < rows; ++y) {
+        const uchar* src = pixels.data() + static_cast<size_t>(y + 1) * stride + 1;
+        uchar* dst = skeleton.ptr<uchar>(y);
+        for (int x = 0; x < cols; ++x) dst[x] = src[x] ? 255 : 0;
+    }
+
+    return skeleton;
+}
+
+cv::Mat Thinning::morphologicalSkeleton(const cv::Mat& binary) {
+    cv::Mat processed;
+    if (binary.channels() > 1) {
+        cv::cvtColor(binary, processed, cv::COLOR_BGR2GRAY);
+    } else {
+        processed = binary.clone();
+    }
+
+    cv::Mat skeleton = cv::Mat::zeros(processed.size(), CV_8UC1);
+    cv::Mat element = cv::getStructuringElement(cv::MORPH_CROSS, cv::Size(3, 3));
+    cv::Mat temp;
+    cv::Mat eroded;
+
+    bool done = false;
+    while (!done) {
+        cv::erode(processed, eroded, element);
+        cv::dilate(eroded, temp, element);
+        cv::subtract(processed, temp, temp);
+        cv::bitwise_or(skeleton, temp, skeleton);
+        eroded.copyTo(processed);
+        done = (cv::countNonZero(processed) == 0);
+    }
+
+    return skeleton;
+}
+
+ThinningBenchmark Thinning::benchmark(const cv::Mat& binary, int repetitions) {
+    ThinningBenchmark result;
+    result.size = binary.size();
+    repetitions = std::max(1, repetitions);
+
+    auto bestOf = [&](const std::function<cv::Mat()>& run, int& pixels) {
+        double best = std::numeric_limits<double>::max();
+        for (int r = 0; r < repetitions; ++r) {
+            cv::TickMeter timer;
+            timer.start();
+            cv::Mat skeleton = run();
+            timer.stop();
+            best = std::min(best, timer.getTimeMilli());
+            pixels = cv::countNonZero(skeleton);
+        }
+        return best;
+    };
+
+    result.morphologicalMs = bestOf([&] { return morphologicalSkeleton(binary); },
+                                    result.morphologicalPixels);
+    result.zhangSuenMs = bestOf([&] { return thin(binary, ThinningAlgorithm::ZhangSuen); },
+                                result.zhangSuenPixels);
+    result.guoHallMs = bestOf([&] { return thin(binary, ThinningAlgorithm::GuoHall); },
+                              result.guoHallPixels);
+
+    return result;
+}
@@ -0,0 +1,67 @@
+#ifndef THINNING_H
+#define THINNING_H
+
+#include <opencv2/core.hpp>
+#include <functional>
+
+/**
+ * @brief Algoritmo de afinamento (thinning)
+ */
+enum class ThinningAlgorithm {
+    ZhangSuen,   // Zhang & Suen (1984)
+    GuoHall      // Guo & Hall (1989) - esqueletos com menos serrilhado diagonal
+};
+
+/**
+ * @brief Callback de progresso: (iteração, pixels removidos na iteração).
+ * Retornar false interrompe o afinamento (o resultado parcial é devolvido).
+ */
+using ThinningProgressCallback = std::function<bool(int iteration, int removedPixels)>;
+
+/**
+ * @brief Medição comparativa entre o laço morfológico antigo e o afinamento
+ */
+struct ThinningBenchmark {
+    cv::Size size;
+    double morphologicalMs = 0.0;
+    double zhangSuenMs = 0.0;
+    double guoHallMs = 0.0;
+    int morphologicalPixels = 0;
+    int zhangSuenPixels = 0;
+    int guoHallPixels = 0;
+};
+
+/**
+ * @brief Esqueletização compartilhada por AFISMatcher, ProcessingWorker e MainWindow
+ *
+ * Afinamento em duas subiterações com:
+ * - tabela de 256 entradas indexada pela vizinhança 8 (decisão O(1) por pixel)
+ * - lista de trabalho com os pixels de borda: cada iteração só visita
+ *   pixels cuja vizinhança pode ter mudado, em vez da imagem inteira
+ * - avaliação paralela em faixas de linhas (cv::parallel_for_)
+ *
+ * Produz esqueletos 8-conexos de um pixel de largura, ao contrário do
+ * esqueleto morfológico (erosão/dilatação iteradas).
+ */
+class Thinning {
+public:
+    /**
+     * @brief Afina uma imagem binária (pixels não nulos = primeiro plano)
+     * @return Esqueleto CV_8UC1 com 0/255, do mesmo tamanho da entrada
+     */
+    static cv::Mat thin(const cv::Mat& binary,
+                        ThinningAlgorithm algorithm = ThinningAlgorithm::ZhangSuen,
+                        const ThinningProgressCallback& progress = nullptr);
+
+    /**
+     * @brief Esqueleto morfológico antigo, mantido apenas como referência de benchmark
+     */
+    static cv::Mat morphologicalSkeleton(const cv::Mat& binary);
+
+    /**
+     * @brief Mede os três métodos na mesma imagem (melhor de N repetições)
+     */
+    static ThinningBenchmark benchmark(const cv::Mat& binary, int repetitions = 3);
+};
+
+#endif // THINNING_H
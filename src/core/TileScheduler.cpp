@@ -0,0 +1,95 @@
+#include "TileScheduler.h"
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+cv::Mat TileScheduler::apply(const cv::Mat& input, int halo, const TileFilter& filter,
+                             int outputType, const TileProgressCallback& progress,
+                             const TileSchedulerConfig& config) {
+    CV_Assert(!input.empty() && halo >= 0);
+
+    const int type = (outputType < 0) ? input.type() : outputType;
+
+    // Imagens pequenas: o custo de recorte e cópia não compensa
+    if (static_cast<long long>(input.total()) < config.minPixelsForTiling) {
+        cv::Mat result;
+        filter(input, result);
+        CV_Assert(result.size() == input.size() && result.type() == type);
+        if (progress && !progress(1, 1)) return cv::Mat();
+        return result;
+    }
+
+    const int tileSize = std::max(16, config.tileSize);
+    std::vector<cv::Rect> tiles;
+    for (int y = 0; y < input.rows; y += tileSize) {
+        for (int x = 0; x < input.cols; x += tileSize) {
+            tiles.emplace_back(x, y, std::min(tileSize, input.cols - x),
+                               std::min(tileSize, input.rows - y));
+        }
+    }
+
+    const int total = static_cast<int>(tiles.size());
+    const cv::Rect bounds(0, 0, input.cols, input.rows);
+    cv::Mat output(input.size(), type);
+
+    std::atomic<int> done{0};
+    std::atomic<bool> cancelled{false};
+
+    cv::parallel_for_(cv::Range(0, total), [&](const cv::Range& range) {
+        for (int t = range.start; t < range.end; ++t) {
+            if (cancelled.load()) return;
+
+            const cv::Rect& core = tiles[t];
+            if (config.tileActive && type == input.type() && !config.tileActive(core)) {
+                input(core).copyTo(output(core));
+                int finished = ++done;
+                if (progress && !progress(finished, total)) cancelled = true;
+                continue;
+            }
+
+            cv::Rect outer(core.x - halo, core.y - halo,
+                           core.width + 2 * halo, core.height + 2 * halo);
+            outer &= bounds;
+
+            cv::Mat source = input(outer).clone();
+            cv::Mat filtered;
+            filter(source, filtered);
+            CV_Assert(filtered.size() == source.size() && filtered.type() == type);
+
+            filtered(core - outer.tl()).copyTo(output(core));
+
+            int finished = ++done;
+            if (progress && !progress(finished, total)) {
+                cancelled = true;
+            }
+        }
+    }, total);
+
+    if (cancelled.load()) return cv::Mat();
+    return output;
+}
+
+int TileScheduler::gaussianRadius(double sigma, int depth) {
+    // Mesma regra de cv::getGaussianKernel/createGaussianKernels
+    int ksize = cvRound(sigma * (depth == CV_8U ? 3 : 4) * 2 + 1) | 1;
+    return ksize / 2;
+}
+
+bool TileScheduler::verifyAgainstFullImage(const cv::Mat& input, int halo, const TileFilter& filter,
+                                           int outputType, const TileSchedulerConfig& config) {
+    cv::Mat reference;
+    filter(input, reference);
+
+    // Força o caminho em ladrilhos mesmo para imagens pequenas
+    TileSchedulerConfig tiledConfig = config;
+    tiledConfig.minPixelsForTiling = 0;
+    cv::Mat tiled = apply(input, halo, filter, outputType, nullptr, tiledConfig);
+
+    if (tiled.size() != reference.size() || tiled.type() != reference.type()) {
+        return false;
+    }
+
+    cv::Mat difference;
+    cv::absdiff(tiled, reference, difference);
+    return cv::countNonZero(difference.reshape(1)) == 0;
+}
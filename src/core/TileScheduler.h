@@ -0,0 +1,68 @@
+#ifndef TILESCHEDULER_H
+#define TILESCHEDULER_H
+
+#include <opencv2/core.hpp>
+#include <functional>
+
+/**
+ * @brief Filtro aplicado a um ladrilho (entrada já inclui o halo)
+ *
+ * Deve produzir dst do mesmo tamanho de src. Pode ser chamado em paralelo.
+ */
+using TileFilter = std::function<void(const cv::Mat& src, cv::Mat& dst)>;
+
+/**
+ * @brief Progresso por ladrilho: (concluídos, total). Retornar false cancela.
+ * Chamado a partir das threads de trabalho.
+ */
+using TileProgressCallback = std::function<bool(int done, int total)>;
+
+/**
+ * @brief Parâmetros do particionamento em ladrilhos
+ */
+struct TileSchedulerConfig {
+    int tileSize = 512;                 // Lado do núcleo de cada ladrilho (pixels)
+    int minPixelsForTiling = 1 << 20;   // Abaixo disso, uma única chamada na imagem inteira
+
+    // Se definido, ladrilhos para os quais retorna false não são filtrados:
+    // recebem a entrada como está (só quando o tipo de saída é o mesmo)
+    std::function<bool(const cv::Rect& core)> tileActive;
+};
+
+/**
+ * @brief Execução paralela de filtros de vizinhança em ladrilhos com halo
+ *
+ * Cada ladrilho é recortado com `halo` pixels extras de cada lado (limitados
+ * à imagem) e copiado antes do filtro: os filtros do OpenCV leem além de um
+ * ROI quando a matriz-mãe existe, e a cópia garante que as bordas da imagem
+ * recebam a mesma extrapolação da chamada na imagem inteira. Com halo maior
+ * ou igual ao raio efetivo do filtro, o resultado costurado é idêntico.
+ */
+class TileScheduler {
+public:
+    /**
+     * @brief Aplica o filtro em ladrilhos paralelos e costura o resultado
+     * @param halo Raio de dependência do filtro (0 para operações pontuais)
+     * @param outputType Tipo do resultado (-1 = mesmo da entrada)
+     * @return Imagem filtrada, ou vazia se cancelada pelo callback
+     */
+    static cv::Mat apply(const cv::Mat& input, int halo, const TileFilter& filter,
+                         int outputType = -1,
+                         const TileProgressCallback& progress = nullptr,
+                         const TileSchedulerConfig& config = TileSchedulerConfig());
+
+    /**
+     * @brief Raio do kernel que cv::GaussianBlur usa para ksize=(0,0)
+     */
+    static int gaussianRadius(double sigma, int depth);
+
+    /**
+     * @brief Confere apply() contra a chamada do filtro na imagem inteira
+     * @return true se os resultados forem idênticos
+     */
+    static bool verifyAgainstFullImage(const cv::Mat& input, int halo, const TileFilter& filter,
+                                       int outputType = -1,
+                                       const TileSchedulerConfig& config = TileSchedulerConfig());
+};
+
+#endif // TILESCHEDULER_H
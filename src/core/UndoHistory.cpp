@@ -0,0 +1,306 @@
+#include "UndoHistory.h"
+#include "RidgeGeometry.h"
+#include <opencv2/imgcodecs.hpp>
+#include <QHash>
+#include <QMutex>
+#include <QDebug>
+#include <vector>
+
+namespace {
+
+constexpr int kTileSize = 128;
+constexpr int kUncompressedEntries = 2;     // Entradas do topo mantidas sem compressão
+
+struct UndoTile {
+    cv::Rect rect;
+    cv::Mat raw;                    // Conteúdo sem compressão (vazio se comprimido)
+    std::vector<uchar> encoded;     // PNG sem perdas
+
+    size_t bytes() const { return raw.empty() ? encoded.size() : raw.total() * raw.elemSize(); }
+};
+
+struct UndoEntry {
+    QString description;
+    quint64 targetHash = 0;         // Imagem sobre a qual a entrada se aplica
+    quint64 resultHash = 0;         // Imagem depois de aplicá-la
+    bool whole = false;             // Imagem inteira (tamanho ou tipo mudaram)
+    bool compressed = false;
+    std::vector<UndoTile> tiles;
+    size_t bytes = 0;
+    quint64 serial = 0;
+};
+
+struct EntityHistory {
+    std::vector<UndoEntry> undo;    // back() = mais recente
+    std::vector<UndoEntry> redo;
+};
+
+QMutex historyMutex;
+QHash<QString, EntityHistory> histories;
+size_t usedBytes = 0;
+size_t memoryBudget = size_t(256) << 20;
+quint64 serialCounter = 0;
+
+size_t entryBytes(const UndoEntry& entry) {
+    size_t total = 0;
+    for (const UndoTile& tile : entry.tiles) total += tile.bytes();
+    return total;
+}
+
+bool canEncode(const cv::Mat& image) {
+    const int depth = image.depth();
+    const int channels = image.channels();
+    return (depth == CV_8U || depth == CV_16U) && (channels == 1 || channels == 3 || channels == 4);
+}
+
+cv::Mat decodeTile(const UndoTile& tile) {
+    if (!tile.raw.empty()) return tile.raw;
+    return cv::imdecode(tile.encoded, cv::IMREAD_UNCHANGED);
+}
+
+// Ladrilhos que diferem entre before e after, com o conteúdo de before
+UndoEntry makeEntry(const cv::Mat& before, const cv::Mat& after) {
+    UndoEntry entry;
+
+    if (before.size() != after.size() || before.type() != after.type()) {
+        entry.whole = true;
+        UndoTile tile;
+        tile.rect = cv::Rect(0, 0, before.cols, before.rows);
+        tile.raw = before.clone();
+        entry.tiles.push_back(std::move(tile));
+        entry.bytes = entryBytes(entry);
+        return entry;
+    }
+
+    const int tilesX = (before.cols + kTileSize - 1) / kTileSize;
+    const int tilesY = (before.rows + kTileSize - 1) / kTileSize;
+    std::vector<cv::Rect> rects;
+    rects.reserve(static_cast<size_t>(tilesX) * tilesY);
+    for (int ty = 0; ty < tilesY; ++ty) {
+        for (int tx = 0; tx < tilesX; ++tx) {
+            rects.emplace_back(tx * kTileSize, ty * kTileSize,
+                               std::min(kTileSize, before.cols - tx * kTileSize),
+                               std::min(kTileSize, before.rows - ty * kTileSize));
+        }
+    }
+
+    std::vector<char> changed(rects.size(), 0);
+    cv::parallel_for_(cv::Range(0, static_cast<int>(rects.size())), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            changed[i] = cv::norm(before(rects[i]), after(rects[i]), cv::NORM_INF) > 0;
+        }
+    });
+
+    for (size_t i = 0; i < rects.size(); ++i) {
+        if (!changed[i]) continue;
+        UndoTile tile;
+        tile.rect = rects[i];
+        tile.raw = before(rects[i]).clone();
+        entry.tiles.push_back(std::move(tile));
+    }
+    entry.bytes = entryBytes(entry);
+    return entry;
+}
+
+// Comprime os ladrilhos (PNG nível 1: rápido e sem perdas) e atualiza o total
+void compressEntry(UndoEntry& entry) {
+    if (entry.compressed) return;
+
+    cv::parallel_for_(cv::Range(0, static_cast<int>(entry.tiles.size())), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            UndoTile& tile = entry.tiles[i];
+            if (tile.raw.empty() || !canEncode(tile.raw)) continue;
+
+            std::vector<uchar> buffer;
+            if (cv::imencode(".png", tile.raw, buffer, {cv::IMWRITE_PNG_COMPRESSION, 1}) &&
+                buffer.size() < tile.bytes()) {
+                tile.encoded.swap(buffer);
+                tile.raw.release();
+            }
+        }
+    });
+
+    usedBytes -= entry.bytes;
+    entry.bytes = entryBytes(entry);
+    usedBytes += entry.bytes;
+    entry.compressed = true;
+}
+
+void compressOlder(std::vector<UndoEntry>& stack) {
+    for (int i = 0; i + kUncompressedEntries < static_cast<int>(stack.size()); ++i) {
+        compressEntry(stack[i]);
+    }
+}
+
+// Troca os ladrilhos guardados pelos atuais: a entrada vira a inversa
+void swapEntry(UndoEntry& entry, cv::Mat& image) {
+    if (entry.whole) {
+        UndoTile& tile = entry.tiles.front();
+        cv::Mat previous = decodeTile(tile);
+        tile.rect = cv::Rect(0, 0, image.cols, image.rows);
+        tile.raw = image.clone();
+        tile.encoded.clear();
+        image = previous;
+    } else {
+        cv::parallel_for_(cv::Range(0, static_cast<int>(entry.tiles.size())), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; ++i) {
+                UndoTile& tile = entry.tiles[i];
+                cv::Mat roi = image(tile.rect);
+                cv::Mat stored = decodeTile(tile);
+                cv::Mat current = roi.clone();
+                stored.copyTo(roi);
+                tile.raw = current;
+                tile.encoded.clear();
+                tile.encoded.shrink_to_fit();
+            }
+        });
+    }
+
+    std::swap(entry.targetHash, entry.resultHash);
+    entry.compressed = false;
+    usedBytes -= entry.bytes;
+    entry.bytes = entryBytes(entry);
+    usedBytes += entry.bytes;
+}
+
+void dropStack(std::vector<UndoEntry>& stack) {
+    for (const UndoEntry& entry : stack) usedBytes -= entry.bytes;
+    stack.clear();
+}
+
+void dropEntity(const QString& entityId) {
+    auto it = histories.find(entityId);
+    if (it == histories.end()) return;
+    dropStack(it->undo);
+    dropStack(it->redo);
+    histories.erase(it);
+}
+
+// Descarta as entradas mais antigas (de qualquer entidade) até caber no orçamento
+void evictToBudget() {
+    while (usedBytes > memoryBudget) {
+        std::vector<UndoEntry>* victim = nullptr;
+        for (auto it = histories.begin(); it != histories.end(); ++it) {
+            for (std::vector<UndoEntry>* stack : {&it->undo, &it->redo}) {
+                if (!stack->empty() && (!victim || stack->front().serial < victim->front().serial)) {
+                    victim = stack;
+                }
+            }
+        }
+        if (!victim) break;
+
+        usedBytes -= victim->front().bytes;
+        victim->erase(victim->begin());
+    }
+
+    for (auto it = histories.begin(); it != histories.end();) {
+        if (it->undo.empty() && it->redo.empty()) it = histories.erase(it);
+        else ++it;
+    }
+}
+
+bool moveEntry(const QString& entityId, cv::Mat& image, QString* description, bool undo) {
+    if (image.empty()) return false;
+
+    QMutexLocker locker(&historyMutex);
+    auto it = histories.find(entityId);
+    if (it == histories.end()) return false;
+
+    std::vector<UndoEntry>& from = undo ? it->undo : it->redo;
+    std::vector<UndoEntry>& to = undo ? it->redo : it->undo;
+    if (from.empty()) return false;
+
+    if (from.back().targetHash != RidgeGeometry::contentHash(image)) {
+        qDebug() << QString("[UndoHistory] Imagem de %1 alterada sem registro; histórico descartado").arg(entityId);
+        dropEntity(entityId);
+        return false;
+    }
+
+    UndoEntry entry = std::move(from.back());
+    from.pop_back();
+    swapEntry(entry, image);
+    if (description) *description = entry.description;
+
+    entry.serial = ++serialCounter;
+    to.push_back(std::move(entry));
+    compressOlder(to);
+    evictToBudget();
+    return true;
+}
+
+} // namespace
+
+void UndoHistory::record(const QString& entityId, const cv::Mat& before, const cv::Mat& after,
+                         const QString& description) {
+    if (entityId.isEmpty() || before.empty() || after.empty()) return;
+
+    UndoEntry entry = makeEntry(before, after);
+    if (entry.tiles.empty()) return;     // Nada mudou
+    entry.description = description;
+    entry.targetHash = RidgeGeometry::contentHash(after);
+    entry.resultHash = RidgeGeometry::contentHash(before);
+
+    QMutexLocker locker(&historyMutex);
+    EntityHistory& history = histories[entityId];
+    dropStack(history.redo);
+
+    usedBytes += entry.bytes;
+    if (entry.bytes > memoryBudget) {
+        compressEntry(entry);
+    }
+    if (entry.bytes > memoryBudget) {
+        // Maior que todo o orçamento: sem esta entrada, as anteriores não se aplicam mais
+        qDebug() << QString("[UndoHistory] Edição \"%1\" excede o orçamento (%2 MB); histórico de %3 descartado")
+                    .arg(description).arg(entry.bytes / double(1 << 20), 0, 'f', 1).arg(entityId);
+        usedBytes -= entry.bytes;
+        dropEntity(entityId);
+        return;
+    }
+
+    entry.serial = ++serialCounter;
+    history.undo.push_back(std::move(entry));
+    compressOlder(history.undo);
+    evictToBudget();
+}
+
+bool UndoHistory::undo(const QString& entityId, cv::Mat& image, QString* description) {
+    return moveEntry(entityId, image, description, true);
+}
+
+bool UndoHistory::redo(const QString& entityId, cv::Mat& image, QString* description) {
+    return moveEntry(entityId, image, description, false);
+}
+
+int UndoHistory::undoCount(const QString& entityId) {
+    QMutexLocker locker(&historyMutex);
+    auto it = histories.constFind(entityId);
+    return it == histories.constEnd() ? 0 : static_cast<int>(it->undo.size());
+}
+
+int UndoHistory::redoCount(const QString& entityId) {
+    QMutexLocker locker(&historyMutex);
+    auto it = histories.constFind(entityId);
+    return it == histories.constEnd() ? 0 : static_cast<int>(it->redo.size());
+}
+
+void UndoHistory::clear(const QString& entityId) {
+    QMutexLocker locker(&historyMutex);
+    dropEntity(entityId);
+}
+
+void UndoHistory::clearAll() {
+    QMutexLocker locker(&historyMutex);
+    histories.clear();
+    usedBytes = 0;
+}
+
+void UndoHistory::setMemoryBudget(size_t bytes) {
+    QMutexLocker locker(&historyMutex);
+    memoryBudget = bytes;
+    evictToBudget();
+}
+
+size_t UndoHistory::memoryUsage() {
+    QMutexLocker locker(&historyMutex);
+    return usedBytes;
+}
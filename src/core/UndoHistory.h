@@ -0,0 +1,57 @@
+#ifndef UNDOHISTORY_H
+#define UNDOHISTORY_H
+
+#include <opencv2/core.hpp>
+#include <QString>
+
+/**
+ * @brief Desfazer/refazer por entidade com deltas de ladrilhos e orçamento de memória
+ *
+ * Cada edição guarda apenas os ladrilhos (128x128) que mudaram, com o
+ * conteúdo anterior; operações que mudam o tamanho ou o tipo (rotação,
+ * conversões) guardam a imagem anterior inteira. Desfazer troca os
+ * ladrilhos guardados pelos atuais, que passam a formar a entrada de refazer.
+ *
+ * - As entradas mais recentes ficam sem compressão (desfazer imediato); as
+ *   mais antigas são comprimidas sem perdas (PNG) ao serem empurradas para
+ *   baixo na pilha.
+ * - Todas as entidades dividem um orçamento de memória; ao estourar, as
+ *   entradas mais antigas são descartadas.
+ * - Cada entrada guarda a assinatura da imagem sobre a qual deve ser
+ *   aplicada: se a imagem foi alterada por um caminho sem registro, o
+ *   histórico da entidade é descartado em vez de aplicar deltas inválidos.
+ */
+class UndoHistory {
+public:
+    /**
+     * @brief Registra uma edição (before → after) e descarta o refazer da entidade
+     */
+    static void record(const QString& entityId, const cv::Mat& before, const cv::Mat& after,
+                       const QString& description);
+
+    /**
+     * @brief Desfaz a última edição da entidade sobre a imagem (alterada no lugar)
+     * @param description Descrição da edição desfeita (opcional)
+     * @return false se não há o que desfazer ou o histórico não corresponde à imagem
+     */
+    static bool undo(const QString& entityId, cv::Mat& image, QString* description = nullptr);
+
+    /**
+     * @brief Refaz a última edição desfeita
+     */
+    static bool redo(const QString& entityId, cv::Mat& image, QString* description = nullptr);
+
+    static int undoCount(const QString& entityId);
+    static int redoCount(const QString& entityId);
+
+    static void clear(const QString& entityId);
+    static void clearAll();
+
+    /**
+     * @brief Limite de memória de todo o histórico (padrão 256 MB)
+     */
+    static void setMemoryBudget(size_t bytes);
+    static size_t memoryUsage();
+};
+
+#endif // UNDOHISTORY_H
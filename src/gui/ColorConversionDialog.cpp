@@ -1,5 +1,6 @@
 #include "ColorConversionDialog.h"
 #include "ImageViewer.h"
+#include "../core/PointLUT.h"
 #include <QSplitter>
 
 ColorConversionDialog::ColorConversionDialog(const cv::Mat &image, ColorSpaceType targetSpace, QWidget *parent)
@@ -267,11 +268,11 @@ void ColorConversionDialog::onResetChannels() {
 }
 
 void ColorConversionDialog::updatePreview() {
-    convertedImage = workingImage.clone();
-
-    // Aplicar ajustes nos canais
+    // Aplicar ajustes nos canais (workingImage → convertedImage)
     if (channel1Adjust != 0 || channel2Adjust != 0 || channel3Adjust != 0) {
         applyChannelAdjustments();
+    } else {
+        convertedImage = workingImage.clone();
     }
 
     // Converter de volta para BGR para visualização
@@ -299,28 +300,12 @@ void ColorConversionDialog::updatePreview() {
 }
 
 void ColorConversionDialog::applyChannelAdjustments() {
-    std::vector<cv::Mat> channels;
-    cv::split(convertedImage, channels);
-
-    // Aplicar ajustes com saturação
-    for (int i = 0; i < convertedImage.rows; i++) {
-        for (int j = 0; j < convertedImage.cols; j++) {
-            if (channel1Adjust != 0) {
-                int val = channels[0].at<uchar>(i, j) + channel1Adjust;
-                channels[0].at<uchar>(i, j) = cv::saturate_cast<uchar>(val);
-            }
-            if (channel2Adjust != 0) {
-                int val = channels[1].at<uchar>(i, j) + channel2Adjust;
-                channels[1].at<uchar>(i, j) = cv::saturate_cast<uchar>(val);
-            }
-            if (channel3Adjust != 0) {
-                int val = channels[2].at<uchar>(i, j) + channel3Adjust;
-                channels[2].at<uchar>(i, j) = cv::saturate_cast<uchar>(val);
-            }
-        }
+    // Deslocamentos por canal como tabela: uma única passada vetorizada (cv::LUT)
+    if (PointLUT::supports(workingImage)) {
+        PointLUT::channelOffsets(channel1Adjust, channel2Adjust, channel3Adjust).apply(workingImage, convertedImage);
+    } else {
+        cv::add(workingImage, cv::Scalar(channel1Adjust, channel2Adjust, channel3Adjust), convertedImage);
     }
-
-    cv::merge(channels, convertedImage);
 }
 
 QString ColorConversionDialog::getColorSpaceName() const {
@@ -1,9 +1,22 @@
 #include "FFTFilterDialog.h"
 #include "ImageViewer.h"
+#include "../core/FrequencyFilter.h"
+#include "../core/FFTService.h"
+#include "../core/NotchDetector.h"
 #include <QGroupBox>
 #include <QSplitter>
 #include <QPainter>
+#include <QtConcurrent>
 #include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Lado maior da imagem usada no preview imediato
+const int kPreviewMaxSide = 512;
+
+} // namespace
 
 // ==================== FFTSpectrumLabel ====================
 
@@ -40,6 +53,12 @@ void FFTSpectrumLabel::addMaskRect(const QRect &rect) {
     emit maskChanged();
 }
 
+void FFTSpectrumLabel::setMaskRects(const QVector<QRect> &rects) {
+    maskRects = rects;
+    update();
+    emit maskChanged();
+}
+
 void FFTSpectrumLabel::clearMasks() {
     maskRects.clear();
     update();
@@ -123,8 +142,10 @@ void FFTSpectrumLabel::mouseReleaseEvent(QMouseEvent *event) {
 
 // ==================== FFTFilterDialog ====================
 
-FFTFilterDialog::FFTFilterDialog(const cv::Mat &image, QWidget *parent)
-    : QDialog(parent), originalImage(image.clone()), accepted(false), invertMask(false) {
+FFTFilterDialog::FFTFilterDialog(const cv::Mat &image, QWidget *parent, const QString &cacheKey)
+    : QDialog(parent), originalImage(image.clone()), cacheKey(cacheKey), previewScale(1.0),
+      fullWatcher(nullptr), hasPendingRequest(false), requestSerial(0), displayedSerial(0),
+      notchWatcher(nullptr), accepted(false), invertMask(false) {
 
     setWindowTitle("Filtro FFT Interativo");
     setMinimumSize(1000, 600);
@@ -173,6 +194,15 @@ FFTFilterDialog::FFTFilterDialog(const cv::Mat &image, QWidget *parent)
 
     controlLayout->addStretch();
 
+    statusLabel = new QLabel();
+    statusLabel->setStyleSheet("QLabel { color: gray; }");
+    controlLayout->addWidget(statusLabel);
+
+    detectButton = new QPushButton("Detectar Padrões Periódicos");
+    detectButton->setToolTip("Propõe máscaras para picos isolados do espectro (tramas, notas, tecidos),\n"
+                             "preservando a faixa de frequência das cristas.");
+    controlLayout->addWidget(detectButton);
+
     clearButton = new QPushButton("Limpar Máscaras");
     controlLayout->addWidget(clearButton);
 
@@ -189,80 +219,64 @@ FFTFilterDialog::FFTFilterDialog(const cv::Mat &image, QWidget *parent)
     connect(spectrumLabel, &FFTSpectrumLabel::maskChanged, this, &FFTFilterDialog::onMaskChanged);
     connect(invertMaskCheckbox, &QCheckBox::stateChanged, this, &FFTFilterDialog::onInvertMaskChanged);
     connect(clearButton, &QPushButton::clicked, this, &FFTFilterDialog::onClearMasks);
+    connect(detectButton, &QPushButton::clicked, this, &FFTFilterDialog::onDetectNotches);
     connect(acceptButton, &QPushButton::clicked, this, &FFTFilterDialog::onAccept);
     connect(cancelButton, &QPushButton::clicked, this, &FFTFilterDialog::onReject);
 
+    // Transformada inversa em resolução total roda fora da thread da interface
+    fullWatcher = new QFutureWatcher<cv::Mat>(this);
+    connect(fullWatcher, &QFutureWatcher<cv::Mat>::finished,
+            this, &FFTFilterDialog::onFullResolutionFinished);
+
     // Preview inicial
     filteredImage = originalImage.clone();
+
+    // Propor máscaras para padrões periódicos de fundo, sem bloquear a abertura
+    notchWatcher = new QFutureWatcher<std::vector<SpectralNotch>>(this);
+    connect(notchWatcher, &QFutureWatcher<std::vector<SpectralNotch>>::finished,
+            this, &FFTFilterDialog::onNotchDetectionFinished);
+    startNotchDetection();
 }
 
-FFTFilterDialog::~FFTFilterDialog() = default;
+FFTFilterDialog::~FFTFilterDialog() {
+    if (fullWatcher && fullWatcher->isRunning()) {
+        fullWatcher->waitForFinished();
+    }
+    if (notchWatcher && notchWatcher->isRunning()) {
+        notchWatcher->waitForFinished();
+    }
+}
 
 void FFTFilterDialog::computeFFT() {
-    cv::Mat gray;
-    if (originalImage.channels() > 1) {
-        cv::cvtColor(originalImage, gray, cv::COLOR_BGR2GRAY);
+    cv::Mat gray = FrequencyFilter::toGray(originalImage);
+
+    // Espectro empacotado (CCS) da imagem expandida ao tamanho ótimo;
+    // reaberturas na mesma entidade sem edição reaproveitam o cache
+    spectrumCCS = cacheKey.isEmpty() ? FrequencyFilter::forward(gray)
+                                     : *FFTService::spectrum(cacheKey, gray);
+
+    // Versão reduzida para o preview imediato
+    previewScale = std::min(1.0, static_cast<double>(kPreviewMaxSide) / std::max(gray.cols, gray.rows));
+    if (previewScale < 1.0) {
+        previewSize = cv::Size(std::max(1, cvRound(gray.cols * previewScale)),
+                               std::max(1, cvRound(gray.rows * previewScale)));
+        cv::Mat small;
+        cv::resize(gray, small, previewSize, 0, 0, cv::INTER_AREA);
+        previewSpectrumCCS = cacheKey.isEmpty() ? FrequencyFilter::forward(small)
+                                                : *FFTService::spectrum(cacheKey + "#preview", small);
     } else {
-        gray = originalImage.clone();
+        // Imagem já pequena: a resolução total é rápida o bastante
+        previewSize = gray.size();
+        previewSpectrumCCS.release();
     }
-
-    // Expandir para tamanho ótimo
-    int m = cv::getOptimalDFTSize(gray.rows);
-    int n = cv::getOptimalDFTSize(gray.cols);
-    cv::Mat padded;
-    cv::copyMakeBorder(gray, padded, 0, m - gray.rows, 0, n - gray.cols, cv::BORDER_CONSTANT, cv::Scalar::all(0));
-
-    // Preparar planos complexos
-    padded.convertTo(padded, CV_32F);
-    cv::Mat planes[] = {padded, cv::Mat::zeros(padded.size(), CV_32F)};
-    cv::merge(planes, 2, complexFFT);
-
-    // Calcular DFT
-    cv::dft(complexFFT, complexFFT);
 }
 
 void FFTFilterDialog::computeMagnitudeSpectrum() {
-    std::vector<cv::Mat> planes;
-    cv::split(complexFFT, planes);
-
-    // Calcular magnitude
-    cv::Mat magnitude;
-    cv::magnitude(planes[0], planes[1], magnitude);
-
-    // Escala logarítmica para melhor visualização
-    magnitude += cv::Scalar::all(1);
-    cv::log(magnitude, magnitude);
-
-    // Centralizar espectro (trocar quadrantes)
-    magnitude = shiftFFT(magnitude);
-
-    // Normalizar para 0-255
-    cv::normalize(magnitude, magnitudeSpectrum, 0, 255, cv::NORM_MINMAX);
+    // Escala logarítmica e espectro centralizado, normalizado para 0-255
+    cv::normalize(FrequencyFilter::centeredLogMagnitude(spectrumCCS), magnitudeSpectrum, 0, 255, cv::NORM_MINMAX);
     magnitudeSpectrum.convertTo(magnitudeSpectrum, CV_8U);
 }
 
-cv::Mat FFTFilterDialog::shiftFFT(const cv::Mat &img) {
-    cv::Mat result = img.clone();
-    int cx = result.cols / 2;
-    int cy = result.rows / 2;
-
-    cv::Mat q0(result, cv::Rect(0, 0, cx, cy));   // Top-Left
-    cv::Mat q1(result, cv::Rect(cx, 0, cx, cy));  // Top-Right
-    cv::Mat q2(result, cv::Rect(0, cy, cx, cy));  // Bottom-Left
-    cv::Mat q3(result, cv::Rect(cx, cy, cx, cy)); // Bottom-Right
-
-    cv::Mat tmp;
-    q0.copyTo(tmp);
-    q3.copyTo(q0);
-    tmp.copyTo(q3);
-
-    q1.copyTo(tmp);
-    q2.copyTo(q1);
-    tmp.copyTo(q2);
-
-    return result;
-}
-
 void FFTFilterDialog::onMaskChanged() {
     updatePreview();
 }
@@ -274,140 +288,147 @@ void FFTFilterDialog::onInvertMaskChanged(int state) {
 }
 
 void FFTFilterDialog::onClearMasks() {
+    // maskChanged → updatePreview restaura a imagem original
     spectrumLabel->clearMasks();
-    filteredImage = originalImage.clone();
-    previewViewer->setImage(filteredImage);
 }
 
-void FFTFilterDialog::updatePreview() {
-    QVector<QRect> rects = spectrumLabel->getMaskRects();
+void FFTFilterDialog::onDetectNotches() {
+    startNotchDetection();
+}
 
-    if (rects.isEmpty()) {
-        filteredImage = originalImage.clone();
-    } else {
-        // Criar máscara
-        cv::Mat mask = createMaskFromRects(rects, complexFFT.size());
+void FFTFilterDialog::startNotchDetection() {
+    if (notchWatcher->isRunning()) return;
 
-        // Aplicar máscara na FFT
-        cv::Mat filteredFFT = applyFFTMask(complexFFT, mask);
+    detectButton->setEnabled(false);
+    statusLabel->setText("Detectando padrões periódicos...");
 
-        // IFFT
-        cv::Mat ifft;
-        cv::idft(filteredFFT, ifft, cv::DFT_SCALE | cv::DFT_REAL_OUTPUT);
+    // Cópias rasas: espectro e imagem não são alterados enquanto o diálogo existe
+    cv::Mat ccs = spectrumCCS;
+    cv::Mat image = originalImage;
+    notchWatcher->setFuture(QtConcurrent::run([ccs, image]() {
+        return NotchDetector::detect(ccs, image.size(), FrequencyFilter::toGray(image));
+    }));
+}
 
-        // Extrair parte real e cortar ao tamanho original
-        ifft = ifft(cv::Rect(0, 0, originalImage.cols, originalImage.rows));
+void FFTFilterDialog::onNotchDetectionFinished() {
+    detectButton->setEnabled(true);
+    std::vector<SpectralNotch> notches = notchWatcher->result();
 
-        // Normalizar e converter
-        cv::normalize(ifft, filteredImage, 0, 255, cv::NORM_MINMAX);
-        filteredImage.convertTo(filteredImage, CV_8U);
+    qDebug() << QString("FFT: %1 picos periódicos detectados").arg(notches.size());
+    if (notches.empty()) {
+        statusLabel->setText("Nenhum pico periódico detectado");
+        return;
+    }
 
-        // Se original era colorido, converter de volta
-        if (originalImage.channels() == 3) {
-            cv::cvtColor(filteredImage, filteredImage, cv::COLOR_GRAY2BGR);
+    // Acrescentar às máscaras existentes, sem duplicar
+    QVector<QRect> rects = spectrumLabel->getMaskRects();
+    for (const QRect &rect : NotchDetector::toRects(notches)) {
+        if (!rects.contains(rect)) {
+            rects.append(rect);
         }
     }
-
-    previewViewer->setImage(filteredImage);
+    spectrumLabel->setMaskRects(rects);
+    statusLabel->setText(QString("%1 picos periódicos detectados").arg(notches.size()));
 }
 
-cv::Mat FFTFilterDialog::createMaskFromRects(const QVector<QRect> &rects, const cv::Size &size) {
-    // Criar máscara com todos 1s
-    cv::Mat mask = cv::Mat::ones(size, CV_32F);
-
-    // Descentrar os retângulos (inverter shift)
-    int cx = size.width / 2;
-    int cy = size.height / 2;
-
-    for (const QRect &rect : rects) {
-        // Converter coordenadas de centralizado para normal
-        cv::Rect shiftedRect = cv::Rect(rect.x(), rect.y(), rect.width(), rect.height());
-
-        // Aplicar shift reverso (4 quadrantes)
-        std::vector<cv::Rect> quadrants;
+FFTFilterDialog::FilterRequest FFTFilterDialog::currentRequest() {
+    FilterRequest request;
+    request.rects = spectrumLabel->getMaskRects();
+    request.invert = invertMask;
+    request.serial = ++requestSerial;
+    return request;
+}
 
-        // Quadrante onde o retângulo está
-        if (shiftedRect.x < cx && shiftedRect.y < cy) {
-            // Top-Left -> Bottom-Right
-            quadrants.push_back(cv::Rect(shiftedRect.x + cx, shiftedRect.y + cy, shiftedRect.width, shiftedRect.height));
-        }
-        if (shiftedRect.x >= cx && shiftedRect.y < cy) {
-            // Top-Right -> Bottom-Left
-            quadrants.push_back(cv::Rect(shiftedRect.x - cx, shiftedRect.y + cy, shiftedRect.width, shiftedRect.height));
-        }
-        if (shiftedRect.x < cx && shiftedRect.y >= cy) {
-            // Bottom-Left -> Top-Right
-            quadrants.push_back(cv::Rect(shiftedRect.x + cx, shiftedRect.y - cy, shiftedRect.width, shiftedRect.height));
-        }
-        if (shiftedRect.x >= cx && shiftedRect.y >= cy) {
-            // Bottom-Right -> Top-Left
-            quadrants.push_back(cv::Rect(shiftedRect.x - cx, shiftedRect.y - cy, shiftedRect.width, shiftedRect.height));
-        }
+void FFTFilterDialog::updatePreview() {
+    FilterRequest request = currentRequest();
 
-        // Zerar (remover) ou manter as regiões
-        for (const cv::Rect &qr : quadrants) {
-            cv::Rect clipped = qr & cv::Rect(0, 0, size.width, size.height);
-            if (clipped.area() > 0) {
-                if (invertMask) {
-                    // Inverter: começar com zeros e manter apenas seleção
-                    // Implementação simplificada - na prática precisa de lógica mais complexa
-                    mask(clipped) = 1.0;
-                } else {
-                    mask(clipped) = 0.0;
-                }
-            }
-        }
+    if (request.rects.isEmpty()) {
+        // Sem máscara: nada a calcular; resultado em andamento fica obsoleto
+        hasPendingRequest = false;
+        filteredImage = originalImage.clone();
+        displayedSerial = request.serial;
+        statusLabel->clear();
+        previewViewer->setImage(filteredImage);
+        return;
     }
 
-    // Se invertMask, precisamos inverter toda a máscara
-    if (invertMask && !rects.isEmpty()) {
-        cv::Mat tempMask = cv::Mat::zeros(size, CV_32F);
-        for (const QRect &rect : rects) {
-            cv::Rect shiftedRect(rect.x(), rect.y(), rect.width(), rect.height());
-            // Aplicar lógica similar mas setando 1 na seleção
-            std::vector<cv::Rect> quadrants;
-
-            if (shiftedRect.x < cx && shiftedRect.y < cy) {
-                quadrants.push_back(cv::Rect(shiftedRect.x + cx, shiftedRect.y + cy, shiftedRect.width, shiftedRect.height));
-            }
-            if (shiftedRect.x >= cx && shiftedRect.y < cy) {
-                quadrants.push_back(cv::Rect(shiftedRect.x - cx, shiftedRect.y + cy, shiftedRect.width, shiftedRect.height));
-            }
-            if (shiftedRect.x < cx && shiftedRect.y >= cy) {
-                quadrants.push_back(cv::Rect(shiftedRect.x + cx, shiftedRect.y - cy, shiftedRect.width, shiftedRect.height));
-            }
-            if (shiftedRect.x >= cx && shiftedRect.y >= cy) {
-                quadrants.push_back(cv::Rect(shiftedRect.x - cx, shiftedRect.y - cy, shiftedRect.width, shiftedRect.height));
-            }
-
-            for (const cv::Rect &qr : quadrants) {
-                cv::Rect clipped = qr & cv::Rect(0, 0, size.width, size.height);
-                if (clipped.area() > 0) {
-                    tempMask(clipped) = 1.0;
-                }
-            }
-        }
-        mask = tempMask;
+    // Preview imediato a partir do espectro reduzido
+    if (!previewSpectrumCCS.empty()) {
+        cv::Mat small = FrequencyFilter::apply(previewSpectrumCCS, mapRectsToPreview(request.rects),
+                                       request.invert, previewSize, originalImage.channels());
+        cv::Mat preview;
+        cv::resize(small, preview, originalImage.size(), 0, 0, cv::INTER_LINEAR);
+        previewViewer->setImage(preview);
+        statusLabel->setText("Preview reduzido — calculando resolução total...");
     }
 
-    return mask;
+    // Resolução total: se já houver cálculo em andamento, guardar apenas o pedido mais recente
+    if (fullWatcher->isRunning()) {
+        pendingRequest = request;
+        hasPendingRequest = true;
+    } else {
+        startFullResolution(request);
+    }
 }
 
-cv::Mat FFTFilterDialog::applyFFTMask(const cv::Mat &complexImg, const cv::Mat &mask) {
-    std::vector<cv::Mat> planes;
-    cv::split(complexImg, planes);
+void FFTFilterDialog::startFullResolution(const FilterRequest &request) {
+    runningRequest = request;
 
-    // Aplicar máscara nos canais real e imaginário
-    planes[0] = planes[0].mul(mask);
-    planes[1] = planes[1].mul(mask);
+    // Cópias rasas: o espectro não é alterado enquanto o diálogo existe
+    cv::Mat ccs = spectrumCCS;
+    cv::Size outputSize = originalImage.size();
+    int channels = originalImage.channels();
+    QVector<QRect> rects = request.rects;
+    bool invert = request.invert;
 
-    cv::Mat result;
-    cv::merge(planes, result);
+    fullFuture = QtConcurrent::run([ccs, rects, invert, outputSize, channels]() {
+        return FrequencyFilter::apply(ccs, rects, invert, outputSize, channels);
+    });
+    fullWatcher->setFuture(fullFuture);
+}
 
-    return result;
+void FFTFilterDialog::onFullResolutionFinished() {
+    // Descartar resultados de máscaras já substituídas
+    if (runningRequest.serial == requestSerial && displayedSerial != requestSerial) {
+        filteredImage = fullFuture.result();
+        displayedSerial = runningRequest.serial;
+        statusLabel->clear();
+        previewViewer->setImage(filteredImage);
+    }
+
+    if (hasPendingRequest) {
+        hasPendingRequest = false;
+        startFullResolution(pendingRequest);
+    }
+}
+
+QVector<QRect> FFTFilterDialog::mapRectsToPreview(const QVector<QRect> &rects) const {
+    // Mesma frequência física: o deslocamento em relação ao centro do espectro
+    // escala por (tamanho DFT reduzido) / (tamanho DFT total · escala da imagem)
+    const double fx = previewSpectrumCCS.cols /
+        (static_cast<double>(spectrumCCS.cols) * previewSize.width / originalImage.cols);
+    const double fy = previewSpectrumCCS.rows /
+        (static_cast<double>(spectrumCCS.rows) * previewSize.height / originalImage.rows);
+    const int cx = spectrumCCS.cols / 2;
+    const int cy = spectrumCCS.rows / 2;
+    const int pcx = previewSpectrumCCS.cols / 2;
+    const int pcy = previewSpectrumCCS.rows / 2;
+
+    QVector<QRect> mapped;
+    mapped.reserve(rects.size());
+    for (const QRect &rect : rects) {
+        int x0 = static_cast<int>(std::floor(pcx + (rect.x() - cx) * fx));
+        int y0 = static_cast<int>(std::floor(pcy + (rect.y() - cy) * fy));
+        int x1 = static_cast<int>(std::ceil(pcx + (rect.x() + rect.width() - cx) * fx));
+        int y1 = static_cast<int>(std::ceil(pcy + (rect.y() + rect.height() - cy) * fy));
+        mapped.append(QRect(x0, y0, std::max(1, x1 - x0), std::max(1, y1 - y0)));
+    }
+    return mapped;
 }
 
 void FFTFilterDialog::onAccept() {
+    // A imagem final é calculada fora do diálogo; o pedido pendente do preview é descartado
+    hasPendingRequest = false;
     accepted = true;
     accept();
 }
@@ -10,7 +10,11 @@
 #include <QVector>
 #include <QRect>
 #include <QMouseEvent>
+#include <QFuture>
+#include <QFutureWatcher>
 #include <opencv2/opencv.hpp>
+#include <vector>
+#include "../core/NotchDetector.h"
 
 class ImageViewer;
 
@@ -25,6 +29,7 @@ public:
 
     void setSpectrum(const cv::Mat &spectrum);
     void addMaskRect(const QRect &rect);
+    void setMaskRects(const QVector<QRect> &rects);
     void clearMasks();
     QVector<QRect> getMaskRects() const { return maskRects; }
     void setInvertMask(bool invert) { invertMask = invert; update(); }
@@ -52,31 +57,82 @@ private:
  *
  * Permite visualizar o espectro de frequências e selecionar
  * regiões para remover (ou manter) frequências indesejadas.
+ *
+ * O espectro direto é calculado uma vez e guardado no formato empacotado
+ * real→complexo (CCS), com metade da memória do espectro complexo. A cada
+ * alteração da máscara, uma versão reduzida da imagem é filtrada na hora
+ * para resposta imediata, e a transformada inversa em resolução total roda
+ * numa thread separada; pedidos feitos durante o cálculo são agrupados e só
+ * o mais recente é executado.
+ *
+ * Ao abrir, picos de padrões periódicos de fundo são detectados
+ * automaticamente (NotchDetector, numa thread separada: inclui o campo de
+ * orientação em resolução total) e propostos como máscaras de remoção
+ * quando a detecção termina.
+ *
+ * Ao aceitar, só a máscara é devolvida: o resultado aplicado à imagem é
+ * calculado pelo ProcessingWorker (FFT_FILTER), com o mesmo espectro em cache.
  */
 class FFTFilterDialog : public QDialog {
     Q_OBJECT
 
 public:
-    explicit FFTFilterDialog(const cv::Mat &image, QWidget *parent = nullptr);
+    /**
+     * @param cacheKey Entidade da imagem: reaproveita o espectro em cache (FFTService)
+     */
+    explicit FFTFilterDialog(const cv::Mat &image, QWidget *parent = nullptr,
+                             const QString &cacheKey = QString());
     ~FFTFilterDialog();
 
-    cv::Mat getFilteredImage() const { return filteredImage; }
+    // Máscara final, em coordenadas do espectro centralizado (ProcessingWorker::setFrequencyMask)
+    QVector<QRect> getMaskRects() const { return spectrumLabel->getMaskRects(); }
+    bool isMaskInverted() const { return invertMask; }
     bool wasAccepted() const { return accepted; }
 
 private slots:
     void onMaskChanged();
     void onInvertMaskChanged(int state);
     void onClearMasks();
+    void onDetectNotches();
     void onAccept();
     void onReject();
+    void onFullResolutionFinished();
+    void onNotchDetectionFinished();
 
 private:
+    /**
+     * @brief Pedido de filtragem: máscara no espaço do espectro centralizado
+     */
+    struct FilterRequest {
+        QVector<QRect> rects;
+        bool invert = false;
+        quint64 serial = 0;
+    };
+
     // Imagens
     cv::Mat originalImage;
+    QString cacheKey;
     cv::Mat filteredImage;
-    cv::Mat complexFFT;
+    cv::Mat spectrumCCS;         // DFT direta da imagem expandida (CCS, CV_32F)
     cv::Mat magnitudeSpectrum;
 
+    // Versão reduzida para preview imediato
+    cv::Mat previewSpectrumCCS;
+    cv::Size previewSize;        // Tamanho da imagem reduzida (sem expansão)
+    double previewScale;         // previewSize / tamanho original
+
+    // Transformada inversa em resolução total (thread separada)
+    QFuture<cv::Mat> fullFuture;
+    QFutureWatcher<cv::Mat> *fullWatcher;
+    FilterRequest runningRequest;
+    FilterRequest pendingRequest;
+    bool hasPendingRequest;
+    quint64 requestSerial;
+    quint64 displayedSerial;     // Pedido cuja resolução total está em filteredImage
+
+    // Detecção de picos periódicos (thread separada)
+    QFutureWatcher<std::vector<SpectralNotch>> *notchWatcher;
+
     // Estado
     bool accepted;
     bool invertMask;
@@ -85,7 +141,9 @@ private:
     FFTSpectrumLabel *spectrumLabel;
     ImageViewer *previewViewer;
     QCheckBox *invertMaskCheckbox;
+    QLabel *statusLabel;
     QPushButton *clearButton;
+    QPushButton *detectButton;
     QPushButton *acceptButton;
     QPushButton *cancelButton;
 
@@ -93,9 +151,11 @@ private:
     void computeFFT();
     void computeMagnitudeSpectrum();
     void updatePreview();
-    cv::Mat createMaskFromRects(const QVector<QRect> &rects, const cv::Size &size);
-    cv::Mat applyFFTMask(const cv::Mat &complexImg, const cv::Mat &mask);
-    cv::Mat shiftFFT(const cv::Mat &img);
+    void startNotchDetection();
+    void startFullResolution(const FilterRequest &request);
+    FilterRequest currentRequest();
+    QVector<QRect> mapRectsToPreview(const QVector<QRect> &rects) const;
+
 };
 
 #endif // FFTFILTERDIALOG_H
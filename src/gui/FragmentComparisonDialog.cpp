@@ -272,6 +272,38 @@ void FragmentComparisonDialog::setupUI() {
                                  "Usado para ajustar raridade populacional");
     lrLayout->addRow("Padrão (opcional):", patternLineEdit);
     
+    // Distorção intra-fonte estimada por simulação
+    simulateDistortionCheckBox = new QCheckBox("Simular distorção (TPS)");
+    simulateDistortionCheckBox->setChecked(false);
+    simulateDistortionCheckBox->setToolTip("Estima σ/κ do numerador (Hp) a partir de variantes elasticamente\n"
+                                           "distorcidas da configuração de referência, em vez do σ fixo de 2 px.\n"
+                                           "Usa a escala (px/mm) do fragmento 2 quando definida.");
+    lrLayout->addRow(simulateDistortionCheckBox);
+    
+    // Exploração de subconjuntos k-de-n
+    exploreSubsetsCheckBox = new QCheckBox("Explorar subconjuntos k-de-n");
+    exploreSubsetsCheckBox->setChecked(false);
+    exploreSubsetsCheckBox->setToolTip("Avalia o LR em todos os subconjuntos de k pares correspondentes\n"
+                                       "(independente da ordem de marcação) e informa a distribuição\n"
+                                       "e o subconjunto que determina o valor máximo.\n"
+                                       "O pareamento das minúcias é o do alinhamento, sem alternativas");
+    lrLayout->addRow(exploreSubsetsCheckBox);
+    
+    subsetSizeSpinBox = new QSpinBox();
+    subsetSizeSpinBox->setRange(0, 100);
+    subsetSizeSpinBox->setValue(0);
+    subsetSizeSpinBox->setSpecialValueText("todos os pares");
+    subsetSizeSpinBox->setToolTip("Tamanho k dos subconjuntos (0 = todos os pares correspondentes)");
+    lrLayout->addRow("k (subconjunto):", subsetSizeSpinBox);
+    
+    explorationBudgetSpinBox = new QSpinBox();
+    explorationBudgetSpinBox->setRange(100, 600000);
+    explorationBudgetSpinBox->setValue(3000);
+    explorationBudgetSpinBox->setSingleStep(500);
+    explorationBudgetSpinBox->setSuffix(" ms");
+    explorationBudgetSpinBox->setToolTip("Orçamento de tempo da exploração");
+    lrLayout->addRow("Orçamento:", explorationBudgetSpinBox);
+    
     controlLayout->addWidget(lrGroup);
     
     // Botão de comparar
@@ -350,21 +382,25 @@ void FragmentComparisonDialog::setupUI() {
     resultLRDirectionLabel = new QLabel("LR_direction: -");
     resultLRTypeLabel = new QLabel("LR_type: -");
     resultRarityLabel = new QLabel("p(v=1|Hd): -");
+    resultExplorationLabel = new QLabel("Exploração k-de-n: -");
     
     resultLRShapeLabel->setFont(resultFont);
     resultLRDirectionLabel->setFont(resultFont);
     resultLRTypeLabel->setFont(resultFont);
     resultRarityLabel->setFont(resultFont);
+    resultExplorationLabel->setFont(resultFont);
     
     resultLRShapeLabel->setWordWrap(true);
     resultLRDirectionLabel->setWordWrap(true);
     resultLRTypeLabel->setWordWrap(true);
     resultRarityLabel->setWordWrap(true);
+    resultExplorationLabel->setWordWrap(true);
     
     resultsLayout->addWidget(resultLRShapeLabel);
     resultsLayout->addWidget(resultLRDirectionLabel);
     resultsLayout->addWidget(resultLRTypeLabel);
     resultsLayout->addWidget(resultRarityLabel);
+    resultsLayout->addWidget(resultExplorationLabel);
     
     rightLayout->addWidget(resultsGroup);
     
@@ -778,6 +814,7 @@ void FragmentComparisonDialog::clearResults() {
     resultMatchedLabel->setText("Minúcias Correspondentes: -");
     resultInterpretationLabel->setText("Interpretação: -");
     resultTimeLabel->setText("Tempo de Cálculo: -");
+    resultExplorationLabel->setText("Exploração k-de-n: -");
     visualizeButton->setEnabled(false);
 }
 
@@ -887,6 +924,18 @@ void FragmentComparisonDialog::onCompareClicked() {
     fprintf(stderr, "[COMPARISON]   - Padrão: %s\n", pattern.isEmpty() ? "não especificado" : pattern.toStdString().c_str());
     fprintf(stderr, "[COMPARISON] ==============================================\n\n");
     
+    bool simulateDistortion = simulateDistortionCheckBox->isChecked();
+    bool exploreSubsets = exploreSubsetsCheckBox->isChecked();
+    FingerprintEnhancer::LRExplorationConfig explorationConfig;
+    explorationConfig.subsetSize = subsetSizeSpinBox->value();
+    explorationConfig.timeBudgetMs = explorationBudgetSpinBox->value();
+    
+    // Associações manuais, quando ativadas, definem os pares explorados
+    QVector<QPair<int, int>> explorationPairs;
+    if (useManualMatchesCheckBox->isChecked()) {
+        explorationPairs = manualMatches;
+    }
+    
     // Executar comparação em thread separada
     QVector<FingerprintEnhancer::Minutia> minutiae1 = frag1->minutiae;
     QVector<FingerprintEnhancer::Minutia> minutiae2 = frag2->minutiae;
@@ -895,12 +944,14 @@ void FragmentComparisonDialog::onCompareClicked() {
     FingerprintEnhancer::Fragment* frag1Ptr = frag1;
     FingerprintEnhancer::Fragment* frag2Ptr = frag2;
     
-    comparisonFuture = QtConcurrent::run([minutiae1, minutiae2, config, frag1Ptr, frag2Ptr, lrMode, rarity, pattern]() {
+    comparisonFuture = QtConcurrent::run([minutiae1, minutiae2, config, frag1Ptr, frag2Ptr, lrMode, rarity, pattern,
+                                          simulateDistortion, exploreSubsets, explorationConfig, explorationPairs]() {
         // Primeiro calcular matching AFIS
         FragmentComparisonResult result = compareFragments(minutiae1, minutiae2, config);
         
         // Depois calcular LR usando Neumann et al.
         FingerprintEnhancer::FingerprintLRCalculator lrCalc;
+        lrCalc.setUseSimulatedDistortion(simulateDistortion);
         result.lrDetails = lrCalc.calculateLR(frag1Ptr, frag2Ptr, lrMode, pattern, rarity);
         
         // Atualizar resultado com valores do LR
@@ -908,6 +959,15 @@ void FragmentComparisonDialog::onCompareClicked() {
         result.logLR = result.lrDetails.log10_lr_total;
         result.interpretationText = result.lrDetails.interpretation;
         
+        // Exploração k-de-n sobre os pares correspondentes
+        if (exploreSubsets) {
+            QVector<QPair<int, int>> pairs = explorationPairs.isEmpty()
+                ? result.correspondences : explorationPairs;
+            result.lrExploration = lrCalc.exploreSubsets(
+                frag1Ptr, frag2Ptr, pairs, lrMode, pattern, rarity, explorationConfig);
+            result.explorationPerformed = true;
+        }
+        
         return result;
     });
     
@@ -971,8 +1031,14 @@ void FragmentComparisonDialog::displayResults(const FragmentComparisonResult& re
     
     // Componentes detalhados do LR (Neumann et al.)
     if (result.lrDetails.k_minutiae > 0) {
-        resultLRShapeLabel->setText(QString("LR_shape: %1 (configuração espacial)")
-            .arg(result.lrDetails.lr_shape, 0, 'e', 2));
+        QString shapeText = QString("LR_shape: %1 (configuração espacial)")
+            .arg(result.lrDetails.lr_shape, 0, 'e', 2);
+        if (result.lrDetails.distortionSimulated) {
+            shapeText += QString(" [TPS: σ=%1 px, κ=%2]")
+                .arg(result.lrDetails.sigma_hp, 0, 'f', 2)
+                .arg(result.lrDetails.kappa_hp, 0, 'f', 1);
+        }
+        resultLRShapeLabel->setText(shapeText);
         
         resultLRDirectionLabel->setText(QString("LR_direction: %1 (ângulos)")
             .arg(result.lrDetails.lr_direction, 0, 'e', 2));
@@ -989,6 +1055,59 @@ void FragmentComparisonDialog::displayResults(const FragmentComparisonResult& re
         resultRarityLabel->setText("p(v=1|Hd): -");
     }
     
+    // Exploração de subconjuntos k-de-n
+    const auto& exploration = result.lrExploration;
+    if (result.explorationPerformed && exploration.evaluatedSubsets > 0) {
+        QStringList driving;
+        for (const auto& pair : exploration.drivingSubset) {
+            driving << QString("%1↔%2").arg(pair.first + 1).arg(pair.second + 1);
+        }
+        
+        // Par de maior influência na distribuição
+        int topPair = -1;
+        for (int i = 0; i < exploration.pairInfluence.size(); ++i) {
+            if (topPair < 0 || std::abs(exploration.pairInfluence[i]) >
+                               std::abs(exploration.pairInfluence[topPair])) {
+                topPair = i;
+            }
+        }
+        
+        QString distributionSource = exploration.distributionSampled
+            ? QString("amostra uniforme de %1 subconjuntos").arg(exploration.distributionSubsets)
+            : QString("%1 subconjuntos, sem poda").arg(exploration.distributionSubsets);
+        
+        QString text = QString("Exploração k-de-n (k=%1 de %2 pares): %3 de %4 subconjuntos avaliados, %5 podados%6\n"
+                               "Log₁₀(LR) (%13): mín %7 | P5 %8 | mediana %9 | P95 %10\n"
+                               "Log₁₀(LR) máximo (busca): %11\n"
+                               "Subconjunto determinante: %12")
+            .arg(exploration.k_minutiae)
+            .arg(exploration.n_pairs)
+            .arg(exploration.evaluatedSubsets)
+            .arg(exploration.totalSubsets, 0, 'g', 6)
+            .arg(exploration.prunedSubsets)
+            .arg(exploration.completed ? "" : " (orçamento de tempo esgotado)")
+            .arg(exploration.minLog10, 0, 'f', 2)
+            .arg(exploration.p05Log10, 0, 'f', 2)
+            .arg(exploration.medianLog10, 0, 'f', 2)
+            .arg(exploration.p95Log10, 0, 'f', 2)
+            .arg(exploration.maxLog10, 0, 'f', 2)
+            .arg(driving.join(", "))
+            .arg(distributionSource);
+        
+        if (topPair >= 0 && topPair < exploration.pairs.size()) {
+            text += QString("\nPar mais influente: %1↔%2 (%3 em log₁₀)")
+                .arg(exploration.pairs[topPair].first + 1)
+                .arg(exploration.pairs[topPair].second + 1)
+                .arg(exploration.pairInfluence[topPair], 0, 'f', 2);
+        }
+        
+        resultExplorationLabel->setText(text);
+    } else if (result.explorationPerformed) {
+        resultExplorationLabel->setText("Exploração k-de-n: nenhum subconjunto avaliado");
+    } else {
+        resultExplorationLabel->setText("Exploração k-de-n: -");
+    }
+    
     // Habilitar botão de visualização se houver correspondências
     visualizeButton->setEnabled(result.matchedMinutiae > 0);
 }
@@ -1032,8 +1151,9 @@ FragmentComparisonResult FragmentComparisonDialog::compareFragments(
     result.totalMinutiaeFragment1 = minutiae1.size();
     result.totalMinutiaeFragment2 = minutiae2.size();
     
-    // Criar calculadora com configuração
+    // Criar calculadora com configuração (e calibração score → LR, se houver)
     AFISLikelihoodCalculator calculator(config);
+    calculator.setCalibrationTable(FingerprintEnhancer::ScoreCalibrationTable::loadDefault());
     
     // 1. Encontrar correspondências entre minúcias
     result.correspondences = calculator.findCorrespondences(minutiae1, minutiae2);
@@ -45,10 +45,15 @@ struct FragmentComparisonResult {
     // Componentes detalhados do LR (Neumann et al.)
     FingerprintEnhancer::LRResult lrDetails;
     
+    // Exploração de subconjuntos k-de-n (opcional)
+    bool explorationPerformed;
+    FingerprintEnhancer::LRExplorationResult lrExploration;
+    
     FragmentComparisonResult()
         : likelihoodRatio(0.0), logLR(0.0), similarityScore(0.0),
           matchedMinutiae(0), totalMinutiaeFragment1(0),
-          totalMinutiaeFragment2(0), executionTimeMs(0.0) {}
+          totalMinutiaeFragment2(0), executionTimeMs(0.0),
+          explorationPerformed(false) {}
 };
 
 /**
@@ -128,6 +133,10 @@ private:
     QComboBox* lrModeComboBox;
     QDoubleSpinBox* raritySpinBox;
     QLineEdit* patternLineEdit;
+    QCheckBox* simulateDistortionCheckBox;
+    QCheckBox* exploreSubsetsCheckBox;
+    QSpinBox* subsetSizeSpinBox;
+    QSpinBox* explorationBudgetSpinBox;
     
     // Viewers para exibição lado a lado
     ImageViewer* viewer1;
@@ -149,6 +158,7 @@ private:
     QLabel* resultLRDirectionLabel;
     QLabel* resultLRTypeLabel;
     QLabel* resultRarityLabel;
+    QLabel* resultExplorationLabel;
     
     // Painel de associação manual
     QGroupBox* manualMatchGroup;
@@ -23,6 +23,11 @@
 // 4. Aplica scaleFactor e offsets (zoom e scroll) do ImageViewer
 // 5. Desenha o polígono/retângulo na tela
 //
+// Rotações e espelhamentos feitos pela TransformStack registram a transformação
+// original → workingImage; quando ela confere com os tamanhos, os cantos saem
+// dela (exatos para qualquer ângulo). O cálculo por ângulo abaixo fica para
+// imagens cuja geometria não está registrada.
+//
 // TODO: calcular posições dos fragmentos
 // PROBLEMA ATUAL: A transformação de coordenadas (original → rotacionada) não está correta para ângulos arbitrários.
 // Os retângulos aparecem em posições erradas quando a imagem tem rotação livre (ex: 13°).
@@ -103,6 +108,10 @@ void FragmentRegionsOverlay::paintEvent(QPaintEvent *event) {
     QPainter painter(this);
     painter.setRenderHint(QPainter::Antialiasing);
 
+    // Uma verificação por pintura, não por fragmento
+    workingGeometry = previewTransform.isValid()
+        ? GeometricTransform() : TransformStack::current(currentImage->id, currentImage->workingImage);
+
     // Desenhar cada fragmento
     for (int i = 0; i < currentImage->fragments.size(); ++i) {
         const auto& fragment = currentImage->fragments[i];
@@ -133,6 +142,27 @@ void FragmentRegionsOverlay::drawFragmentRegion(QPainter& painter,
 
     // sourceRect está SEMPRE em coordenadas da imagem ORIGINAL
     QRect originalSpaceRect = fragment->sourceRect;
+
+    // Geometria composta registrada (ou a da prévia): mapear os cantos diretamente
+    const cv::Size originalSize = currentImage->originalImage.size();
+    const GeometricTransform geometry = previewTransform.isValid() ? previewTransform : workingGeometry;
+    if (geometry.sourceSize() == originalSize &&
+        (previewTransform.isValid() || geometry.outputSize() == currentImage->workingImage.size())) {
+        const std::vector<cv::Point2d> corners = geometry.mapRect(
+            cv::Rect(originalSpaceRect.x(), originalSpaceRect.y(),
+                     originalSpaceRect.width(), originalSpaceRect.height()));
+
+        QPolygonF scaledPoly;
+        for (const cv::Point2d& pt : corners) {
+            scaledPoly << QPointF(
+                pt.x * scaleFactor + imageOffset.x() - scrollOffset.x(),
+                pt.y * scaleFactor + imageOffset.y() - scrollOffset.y()
+            );
+        }
+
+        drawPolygonAndLabel(painter, scaledPoly, index);
+        return;
+    }
     
     // Usar previewRotationAngle se em modo de preview (rotação interativa), senão usar ângulo da imagem
     double angle = (previewRotationAngle >= 0.0) ? previewRotationAngle : currentImage->currentRotationAngle;
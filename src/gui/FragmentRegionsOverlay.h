@@ -5,6 +5,7 @@
 #include <QPainter>
 #include <QList>
 #include <QPolygonF>
+#include "../core/GeometricTransform.h"
 
 namespace FingerprintEnhancer {
     struct Fragment;
@@ -31,7 +32,8 @@ public:
     
     // Para preview de rotação interativa
     void setPreviewRotationAngle(double angle) { previewRotationAngle = angle; update(); }
-    void clearPreviewRotationAngle() { previewRotationAngle = -1.0; update(); }
+    void setPreviewTransform(const GeometricTransform& transform) { previewTransform = transform; update(); }
+    void clearPreviewRotationAngle() { previewRotationAngle = -1.0; previewTransform = GeometricTransform(); update(); }
 
 protected:
     void paintEvent(QPaintEvent *event) override;
@@ -45,6 +47,10 @@ private:
     
     // Ângulo de preview para rotação interativa (sobrescreve currentRotationAngle se >= 0)
     double previewRotationAngle;
+    // Geometria composta de preview (original → prévia); inválida fora da rotação interativa
+    GeometricTransform previewTransform;
+    // Geometria registrada da imagem de trabalho, conferida pelo conteúdo a cada pintura
+    GeometricTransform workingGeometry;
     
     void drawFragmentRegion(QPainter& painter, const FingerprintEnhancer::Fragment* fragment, int index);
     void drawRectAndLabel(QPainter& painter, const QRectF& rect, int index);
@@ -37,6 +37,28 @@ void CropOverlayLabel::paintEvent(QPaintEvent *event) {
     // Primeiro desenha a imagem normalmente
     QLabel::paintEvent(event);
 
+    // Prévia em resolução reduzida sobre a região correspondente
+    if (imageViewer && !imageViewer->getPreviewPatch().isNull()) {
+        QPainter painter(this);
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        double scaleFactor = imageViewer->getScaleFactor();
+        QRect previewRect = imageViewer->getPreviewRect();
+        QRectF target(previewRect.x() * scaleFactor, previewRect.y() * scaleFactor,
+                      previewRect.width() * scaleFactor, previewRect.height() * scaleFactor);
+        painter.drawImage(target, imageViewer->getPreviewPatch());
+    }
+
+    // Sobreposição por bloco, ampliada sem suavização e limitada à imagem
+    if (imageViewer && !imageViewer->getBlockOverlay().isNull()) {
+        QPainter painter(this);
+        double scaleFactor = imageViewer->getScaleFactor();
+        const QImage &overlay = imageViewer->getBlockOverlay();
+        const double side = imageViewer->getBlockOverlaySize() * scaleFactor;
+        QSize imageSize = imageViewer->getImageSize();
+        painter.setClipRect(QRectF(0, 0, imageSize.width() * scaleFactor, imageSize.height() * scaleFactor));
+        painter.drawImage(QRectF(0, 0, overlay.width() * side, overlay.height() * side), overlay);
+    }
+
     // Depois desenha o overlay se estiver habilitado
     if (overlayEnabled && imageViewer) {
         QPainter painter(this);
@@ -161,7 +183,7 @@ const double ImageViewer::ZOOM_STEP = 1.2;
 ImageViewer::ImageViewer(QWidget *parent)
     : QScrollArea(parent), scaleFactor(1.0), panning(false), syncViewer(nullptr), syncEnabled(true),
       cropModeEnabled(false), isSelecting(false), isMovingSelection(false), isResizingEdge(false),
-      activeEdgeHandle(EDGE_NONE) {
+      activeEdgeHandle(EDGE_NONE), blockOverlaySize(16.0) {
     imageLabel = new CropOverlayLabel(this);
     setFocusPolicy(Qt::StrongFocus);  // Permitir receber eventos de teclado
     imageLabel->setBackgroundRole(QPalette::Base);
@@ -188,15 +210,21 @@ void ImageViewer::setImage(const cv::Mat &image) {
     
     currentImage = image.clone();
     currentPixmap = matToQPixmap(image);
+    previewPatch = QImage();
+    blockOverlay = QImage();
     updateImageDisplay();
 }
 
 void ImageViewer::setPixmap(const QPixmap &pixmap) {
     currentPixmap = pixmap;
+    previewPatch = QImage();
+    blockOverlay = QImage();
     updateImageDisplay();
 }
 
 void ImageViewer::clearImage() {
+    previewPatch = QImage();
+    blockOverlay = QImage();
     currentImage = cv::Mat();
     currentPixmap = QPixmap();
     imageLabel->clear();
@@ -737,3 +765,58 @@ bool ImageViewer::isPointInDiamondHandle(const QPoint &widgetPos, const QPoint &
     return (dx + dy) <= half + 2;  // +2 para tolerância
 }
 
+QRect ImageViewer::visibleImageRect() const {
+    if (currentPixmap.isNull() || scaleFactor <= 0) {
+        return QRect();
+    }
+
+    // Viewport em coordenadas do label (escaladas) → coordenadas da imagem
+    QPoint topLeft = imageLabel->mapFrom(viewport(), QPoint(0, 0));
+    QRectF visible(topLeft.x() / scaleFactor, topLeft.y() / scaleFactor,
+                   viewport()->width() / scaleFactor, viewport()->height() / scaleFactor);
+
+    return visible.toAlignedRect().intersected(QRect(QPoint(0, 0), currentPixmap.size()));
+}
+
+void ImageViewer::setPreviewPatch(const cv::Mat &patch, const QRect &imageRect) {
+    if (patch.empty() || imageRect.isEmpty()) {
+        clearPreviewPatch();
+        return;
+    }
+
+    // Conversão direta do trecho reduzido, sem passar pelo QPixmap da imagem inteira
+    cv::Mat rgb;
+    if (patch.channels() == 1) {
+        previewPatch = QImage(patch.data, patch.cols, patch.rows, patch.step, QImage::Format_Grayscale8).copy();
+    } else {
+        cv::cvtColor(patch, rgb, patch.channels() == 4 ? cv::COLOR_BGRA2RGB : cv::COLOR_BGR2RGB);
+        previewPatch = QImage(rgb.data, rgb.cols, rgb.rows, rgb.step, QImage::Format_RGB888).copy();
+    }
+    previewRect = imageRect;
+    imageLabel->update();
+}
+
+void ImageViewer::clearPreviewPatch() {
+    if (previewPatch.isNull()) return;
+    previewPatch = QImage();
+    imageLabel->update();
+}
+
+void ImageViewer::setBlockOverlay(const cv::Mat &overlay, double blockSize) {
+    if (overlay.empty() || overlay.type() != CV_8UC4 || blockSize <= 0) {
+        clearBlockOverlay();
+        return;
+    }
+
+    cv::Mat rgba;
+    cv::cvtColor(overlay, rgba, cv::COLOR_BGRA2RGBA);
+    blockOverlay = QImage(rgba.data, rgba.cols, rgba.rows, rgba.step, QImage::Format_RGBA8888).copy();
+    blockOverlaySize = blockSize;
+    imageLabel->update();
+}
+
+void ImageViewer::clearBlockOverlay() {
+    if (blockOverlay.isNull()) return;
+    blockOverlay = QImage();
+    imageLabel->update();
+}
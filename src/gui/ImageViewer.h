@@ -95,6 +95,34 @@ public:
     // Calcular offset de centralização da imagem
     QPoint getImageOffset() const;
 
+    /**
+     * @brief Região da imagem (coordenadas originais) visível no viewport
+     */
+    QRect visibleImageRect() const;
+
+    /**
+     * @brief Prévia em resolução reduzida desenhada sobre uma região da imagem
+     *
+     * Usada pelos controles deslizantes: só o trecho visível, na resolução da
+     * tela, é processado e convertido a cada mudança. A prévia some quando uma
+     * nova imagem é definida.
+     */
+    void setPreviewPatch(const cv::Mat &patch, const QRect &imageRect);
+    void clearPreviewPatch();
+    const QImage& getPreviewPatch() const { return previewPatch; }
+    QRect getPreviewRect() const { return previewRect; }
+
+    /**
+     * @brief Sobreposição por bloco (p.ex. mapa de qualidade)
+     * @param overlay BGRA com uma entrada por bloco de blockSize pixels (pode ser fracionário)
+     *
+     * Ampliada sem suavização sobre a imagem; some quando uma nova imagem é definida.
+     */
+    void setBlockOverlay(const cv::Mat &overlay, double blockSize);
+    void clearBlockOverlay();
+    const QImage& getBlockOverlay() const { return blockOverlay; }
+    double getBlockOverlaySize() const { return blockOverlaySize; }
+
 signals:
     void imageClicked(QPoint imagePosition);
     void mouseMoved(QPoint imagePosition);
@@ -125,6 +153,14 @@ private:
     QPixmap currentPixmap;
     double scaleFactor;
 
+    // Prévia sobreposta (coordenadas da imagem)
+    QImage previewPatch;
+    QRect previewRect;
+
+    // Sobreposição por bloco (uma entrada por bloco)
+    QImage blockOverlay;
+    double blockOverlaySize;
+
     // Controle de pan
     bool panning;
     QPoint lastPanPoint;
@@ -19,9 +19,22 @@ Q_LOGGING_CATEGORY(mainwindow, "mainwindow")
 #include "AboutDialog.h"
 #include "MinutiaeQueryDialog.h"
 #include "PopulationStatsDialog.h"
+#include "ProcessingPipelineDialog.h"
 #include "../knolegment/MinutiaeCatalog.h"
 #include "../core/TranslationManager_Simple.h"
 #include "../core/ImageState.h"
+#include "../core/Thinning.h"
+#include "../core/CrossingNumber.h"
+#include "../core/GaborEnhancer.h"
+#include "../core/RidgeGeometry.h"
+#include "../core/UndoHistory.h"
+#include "../core/BackgroundEstimator.h"
+#include "../core/RidgeSegmentation.h"
+#include "../core/RidgeQuality.h"
+#include "../core/AdaptiveThreshold.h"
+#include "../core/CoherenceDiffusion.h"
+#include "../core/ResolutionPyramid.h"
+#include "../core/GeometricTransform.h"
 #include <QtWidgets/QApplication>
 #include <QtWidgets/QFileDialog>
 #include <QtWidgets/QMessageBox>
@@ -40,6 +53,7 @@ Q_LOGGING_CATEGORY(mainwindow, "mainwindow")
 #include <QtCore/QFile>
 #include <QtCore/QThread>
 #include <QtCore/QTimer>
+#include <QtCore/QSettings>
 #include <QtCore/QUuid>
 #include <QtCore/QJsonObject>
 #include <QtCore/QJsonArray>
@@ -50,6 +64,7 @@ Q_LOGGING_CATEGORY(mainwindow, "mainwindow")
 #include <QtGui/QTextDocument>
 #include <QtGui/QPageSize>
 #include <cmath>
+#include <algorithm>
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
@@ -86,6 +101,9 @@ MainWindow::MainWindow(QWidget *parent)
     , processingThread(nullptr)
     , processingWorker(nullptr)
     , isProcessing(false)
+    , hasPendingHistory(false)
+    , pendingHistorySyncEntries(-1)
+    , previewCommitTimer(new QTimer(this))
     , imageLoaderWorker(nullptr)
     , isLoadingImages(false)
     , projectSaverWorker(nullptr)
@@ -103,11 +121,16 @@ MainWindow::MainWindow(QWidget *parent)
     
     // Carregar configurações globais de visualização ao iniciar
     applyGlobalDisplaySettings();
+    applyMemoryBudgets();
 
     // Timer para atualizações periódicas da interface
     updateTimer->setSingleShot(false);
     updateTimer->setInterval(100); // 100ms
     connect(updateTimer, &QTimer::timeout, this, &MainWindow::updateStatusBar);
+
+    // Debounce da renderização em resolução total dos controles deslizantes
+    previewCommitTimer->setSingleShot(true);
+    connect(previewCommitTimer, &QTimer::timeout, this, &MainWindow::commitLivePreview);
 }
 
 MainWindow::~MainWindow() {
@@ -157,6 +180,10 @@ void MainWindow::createMenus() {
     QMenu *editMenu = menuBar()->addMenu("&Editar");
     editMenu->addAction("&Restaurar Original", this, &MainWindow::resetToOriginal, QKeySequence("Ctrl+Shift+Z"));
     editMenu->addAction("&Desfazer Última Operação", this, &MainWindow::undoLastOperation, QKeySequence::Undo);
+    editMenu->addAction("Re&fazer Operação", this, &MainWindow::redoLastOperation, QKeySequence("Ctrl+Y"));
+    editMenu->addAction("&Pipeline de Processamento...", this, &MainWindow::editProcessingPipeline, QKeySequence("Ctrl+Alt+P"));
+    editMenu->addSeparator();
+    editMenu->addAction("&Limites de Memória...", this, &MainWindow::configureMemoryBudgets);
 
     // Menu Realce
     QMenu *enhanceMenu = menuBar()->addMenu("&Realce");
@@ -165,6 +192,8 @@ void MainWindow::createMenus() {
     enhanceMenu->addSeparator();
     enhanceMenu->addAction("&Desfoque Gaussiano...", this, &MainWindow::applyGaussianBlur);
     enhanceMenu->addAction("Filtro de &Nitidez...", this, &MainWindow::applySharpenFilter);
+    enhanceMenu->addAction("Realce &Gabor (contextual)", this, &MainWindow::applyGaborEnhancement);
+    enhanceMenu->addAction("Difusão &Coerente...", this, &MainWindow::applyCoherenceDiffusion);
     enhanceMenu->addSeparator();
     enhanceMenu->addAction("Brilho/&Contraste...", this, &MainWindow::adjustBrightnessContrast);
     enhanceMenu->addAction("&Equalizar Histograma", this, &MainWindow::equalizeHistogram);
@@ -172,6 +201,15 @@ void MainWindow::createMenus() {
     enhanceMenu->addSeparator();
     enhanceMenu->addAction("&Binarizar Imagem", this, &MainWindow::binarizeImage, QKeySequence("Ctrl+T"));
     enhanceMenu->addAction("&Esqueletizar", this, &MainWindow::skeletonizeImage, QKeySequence("Ctrl+K"));
+    enhanceMenu->addSeparator();
+    restrictToPrintAction = enhanceMenu->addAction("Processar só a área da &impressão");
+    restrictToPrintAction->setCheckable(true);
+    restrictToPrintAction->setChecked(false);
+    restrictToPrintAction->setToolTip("Filtros em ladrilhos, Gabor e FFT atuam apenas no envoltório da impressão segmentada");
+    canonicalResolutionAction = enhanceMenu->addAction("Processar em resolução &canônica (500 ppi)");
+    canonicalResolutionAction->setCheckable(true);
+    canonicalResolutionAction->setChecked(false);
+    canonicalResolutionAction->setToolTip("Gabor, difusão, mapa de qualidade e AFIS rodam a 500 ppi em imagens de escala calibrada maior");
 
     // Menu Análise
     QMenu *analysisMenu = menuBar()->addMenu("&Análise");
@@ -189,6 +227,9 @@ void MainWindow::createMenus() {
     viewMenu->addAction("Lado a &Lado", this, &MainWindow::toggleSideBySide, QKeySequence("Ctrl+2"));
     viewMenu->addSeparator();
     viewMenu->addAction("&Mostrar/Ocultar Painel Direito", this, &MainWindow::toggleRightPanel, QKeySequence("Ctrl+Shift+P"));
+    qualityMapAction = viewMenu->addAction("Mapa de &Qualidade", this, &MainWindow::toggleQualityMap, QKeySequence("Ctrl+Shift+Q"));
+    qualityMapAction->setCheckable(true);
+    qualityMapAction->setChecked(false);
     viewMenu->addSeparator();
     viewMenu->addAction("&Configurar Visualização de Minúcias...", this, &MainWindow::configureMinutiaeDisplay, QKeySequence("Ctrl+Shift+M"));
 
@@ -358,11 +399,17 @@ void MainWindow::createStatusBar() {
     scaleLabel = new QLabel("Escala: 1:1");
     progressBar = new QProgressBar();
     progressBar->setVisible(false);
+    cancelProcessingButton = new QPushButton("Cancelar");
+    cancelProcessingButton->setToolTip("Interromper o processamento em andamento (Esc)");
+    cancelProcessingButton->setShortcut(QKeySequence(Qt::Key_Escape));
+    cancelProcessingButton->setVisible(false);
+    connect(cancelProcessingButton, &QPushButton::clicked, this, &MainWindow::cancelProcessing);
     
     statusBar()->addWidget(statusLabel, 1);
     statusBar()->addPermanentWidget(imageInfoLabel);
     statusBar()->addPermanentWidget(scaleLabel);
     statusBar()->addPermanentWidget(progressBar);
+    statusBar()->addPermanentWidget(cancelProcessingButton);
 }
 
 QWidget* MainWindow::createViewerContainer(ImageViewer* viewer, FingerprintEnhancer::MinutiaeOverlay* overlay, FragmentRegionsOverlay* fragmentOverlay) {
@@ -637,6 +684,8 @@ void MainWindow::connectSignals() {
     // Conectar controles de processamento
     connect(brightnessSlider, &QSlider::valueChanged, this, &MainWindow::onBrightnessChanged);
     connect(contrastSlider, &QSlider::valueChanged, this, &MainWindow::onContrastChanged);
+    connect(brightnessSlider, &QSlider::sliderReleased, this, &MainWindow::commitLivePreview);
+    connect(contrastSlider, &QSlider::sliderReleased, this, &MainWindow::commitLivePreview);
     connect(gaussianSigma, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
             this, &MainWindow::onGaussianSigmaChanged);
     connect(sharpenStrength, QOverload<double>::of(&QDoubleSpinBox::valueChanged),
@@ -892,6 +941,9 @@ void MainWindow::newProject() {
         
         // Fechar projeto anterior
         PM::instance().closeProject();
+        entityPipelines.clear();
+        UndoHistory::clearAll();
+        TransformStack::clearCache();
         
         statusLabel->setText("Projeto anterior fechado");
         updateWindowTitle();
@@ -909,6 +961,9 @@ void MainWindow::newProject() {
         int closeAttempts = 5;
         for (int i = 0; i < closeAttempts && PM::instance().hasOpenProject(); i++) {
             PM::instance().closeProject();
+            entityPipelines.clear();
+            UndoHistory::clearAll();
+            TransformStack::clearCache();
         }
         
         bool projectCreated = false;
@@ -932,6 +987,9 @@ void MainWindow::newProject() {
                 // Hack: openProject() fecha o anterior automaticamente
                 PM::instance().openProject(tempFile);
                 PM::instance().closeProject();
+                entityPipelines.clear();
+                UndoHistory::clearAll();
+                TransformStack::clearCache();
                 QFile::remove(tempFile);
             }
         }
@@ -1068,6 +1126,9 @@ void MainWindow::openProject() {
         
         // SEMPRE fechar projeto anterior (modificado ou não)
         PM::instance().closeProject();
+        entityPipelines.clear();
+        UndoHistory::clearAll();
+        TransformStack::clearCache();
     }
 
     QString fileName = QFileDialog::getOpenFileName(this,
@@ -1404,6 +1465,9 @@ void MainWindow::clearProject() {
 
         // Fechar projeto atual
         PM::instance().closeProject();
+        entityPipelines.clear();
+        UndoHistory::clearAll();
+        TransformStack::clearCache();
 
         // Criar novo projeto vazio
         if (PM::instance().createNewProject("Projeto sem título", "")) {
@@ -1543,27 +1607,106 @@ void MainWindow::resetToOriginal() {
 }
 
 void MainWindow::undoLastOperation() {
+    undoRedoCurrentEntity(true);
+}
+
+void MainWindow::redoLastOperation() {
+    undoRedoCurrentEntity(false);
+}
+
+void MainWindow::undoRedoCurrentEntity(bool undo) {
     /**
-     * Desfazer última operação
-     * 
-     * Sistema de undo/redo requer:
-     * - Pilha de comandos executados
-     * - Armazenar estado anterior de cada operação
-     * - Possibilidade de reverter transformações
-     * 
-     * Implementação sugerida:
-     * - Padrão Command para cada operação
-     * - QUndoStack do Qt
-     * - Limite de histórico (ex: 50 operações)
-     * 
-     * Nota: Atualmente use "Resetar Realces" para voltar ao estado original
+     * Desfazer/refazer com deltas de ladrilhos (UndoHistory): só as regiões
+     * alteradas ficam guardadas, dentro de um orçamento de memória comum a
+     * todas as entidades. O pipeline de processamento acompanha: desfazer
+     * retira o passo correspondente e refazer o recoloca com a saída restaurada.
      */
-    QMessageBox::information(this, "Desfazer",
-        "Sistema de Undo/Redo em desenvolvimento.\n\n"
-        "Por enquanto, use:\n"
-        "• 'Resetar Realces' para remover processamentos\n"
-        "• 'Resetar Tudo' para voltar ao estado original");
-    statusLabel->setText("Undo/Redo não disponível - use 'Resetar Realces'");
+    const QString actionName = undo ? "Desfazer" : "Refazer";
+    if (currentEntityType == ENTITY_NONE || currentEntityId.isEmpty()) {
+        QMessageBox::warning(this, actionName, "Nenhuma imagem ou fragmento selecionado");
+        return;
+    }
+    if (isProcessing) {
+        QMessageBox::warning(this, "Processing",
+            "Another processing operation is already running. Please wait.");
+        return;
+    }
+
+    cv::Mat& workingImage = getCurrentWorkingImage();
+    QString description;
+    bool applied = undo ? UndoHistory::undo(currentEntityId, workingImage, &description)
+                        : UndoHistory::redo(currentEntityId, workingImage, &description);
+    if (!applied) {
+        statusLabel->setText(undo ? "Nada a desfazer" : "Nada a refazer");
+        return;
+    }
+    TransformStack::touch(currentEntityId);
+
+    if (std::shared_ptr<ProcessingPipeline> pipeline = entityPipelines.value(currentEntityId)) {
+        quint64 hash = RidgeGeometry::contentHash(workingImage);
+        const int historyEntries = pipeline->historyEntryCount();
+        if (undo ? pipeline->rewindTo(hash) : pipeline->replay(workingImage, hash)) {
+            syncProcessingHistory(pipeline.get(), historyEntries);
+        }
+    }
+
+    loadCurrentEntityToView();
+    using PM = FingerprintEnhancer::ProjectManager;
+    PM::instance().getCurrentProject()->setModified();
+
+    fprintf(stderr, "[MAINWINDOW] %s: %s (histórico: %.1f MB)\n", actionName.toUtf8().constData(),
+            description.toUtf8().constData(), UndoHistory::memoryUsage() / double(1 << 20));
+    statusLabel->setText(QString("%1: %2 (%3 restante(s))").arg(actionName)
+                         .arg(description.isEmpty() ? "operação" : description)
+                         .arg(undo ? UndoHistory::undoCount(currentEntityId)
+                                   : UndoHistory::redoCount(currentEntityId)));
+}
+
+void MainWindow::applyMemoryBudgets() {
+    QSettings settings("FingerprintEnhancer", "FingerprintEnhancer");
+    const int undoMB = settings.value("memory/undoBudgetMB", 256).toInt();
+    UndoHistory::setMemoryBudget(size_t(std::max(16, undoMB)) << 20);
+    const int pipelineMB = settings.value("memory/pipelineBudgetMB", 192).toInt();
+    ProcessingPipeline::setMemoryBudget(size_t(std::max(16, pipelineMB)) << 20);
+}
+
+void MainWindow::configureMemoryBudgets() {
+    QSettings settings("FingerprintEnhancer", "FingerprintEnhancer");
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Limites de Memória");
+    QFormLayout* layout = new QFormLayout(&dialog);
+
+    QSpinBox* undoSpinBox = new QSpinBox();
+    undoSpinBox->setRange(16, 8192);
+    undoSpinBox->setSingleStep(64);
+    undoSpinBox->setSuffix(" MB");
+    undoSpinBox->setValue(settings.value("memory/undoBudgetMB", 256).toInt());
+    undoSpinBox->setToolTip("Memória total do desfazer/refazer, somando todas as imagens e fragmentos");
+    layout->addRow("Histórico de desfazer:", undoSpinBox);
+
+    QSpinBox* pipelineSpinBox = new QSpinBox();
+    pipelineSpinBox->setRange(16, 8192);
+    pipelineSpinBox->setSingleStep(64);
+    pipelineSpinBox->setSuffix(" MB");
+    pipelineSpinBox->setValue(settings.value("memory/pipelineBudgetMB", 192).toInt());
+    pipelineSpinBox->setToolTip("Resultados intermediários guardados pelos pipelines de processamento\n"
+                                "(editar um passo recalcula a partir do resultado anterior guardado)");
+    layout->addRow("Pipeline de processamento:", pipelineSpinBox);
+
+    QDialogButtonBox* buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(buttonBox, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    layout->addRow(buttonBox);
+
+    if (dialog.exec() != QDialog::Accepted) return;
+
+    settings.setValue("memory/undoBudgetMB", undoSpinBox->value());
+    settings.setValue("memory/pipelineBudgetMB", pipelineSpinBox->value());
+    applyMemoryBudgets();
+    statusLabel->setText(QString("Memória em uso: desfazer %1 MB, pipeline %2 MB")
+                         .arg(UndoHistory::memoryUsage() / double(1 << 20), 0, 'f', 1)
+                         .arg(ProcessingPipeline::totalCachedBytes() / double(1 << 20), 0, 'f', 1));
 }
 
 void MainWindow::updateImageDisplay() {
@@ -1592,7 +1735,7 @@ void MainWindow::updateProcessingHistory() {
 
 void MainWindow::updateMinutiaeList() {
     minutiaeList->clear();
-    auto minutiae = minutiaeExtractor->getMinutiae();
+    auto minutiae = minutiaeEditor->getMinutiae();
 
     for (const auto& m : minutiae) {
         QString typeStr = (m.type == 0) ? "Termination" : "Bifurcation";
@@ -1691,49 +1834,56 @@ void MainWindow::onGaussianSigmaChanged(double value) {
     if (isProcessing) return;
     if (currentEntityType == ENTITY_NONE || currentEntityId.isEmpty()) return;
 
-    runProcessingInThread([value](const cv::Mat& input, int& progress) -> cv::Mat {
-        progress = 50;
-        cv::Mat result;
-        cv::GaussianBlur(input, result, cv::Size(0, 0), value, value);
-        progress = 100;
-        return result;
-    });
+    // Prévia no proxy (sigma na escala do proxy); resolução total só após a pausa
+    showLivePreview([value](const cv::Mat& proxy, double scale) {
+        cv::Mat out;
+        double sigma = value * scale;
+        if (sigma < 0.1) return proxy.clone();
+        cv::GaussianBlur(proxy, out, cv::Size(0, 0), sigma, sigma);
+        return out;
+    }, [this, value]() {
+        int halo = TileScheduler::gaussianRadius(value, getCurrentWorkingImage().depth());
+        runTiledOperation(halo, [value](const cv::Mat& src, cv::Mat& dst) {
+            cv::GaussianBlur(src, dst, cv::Size(0, 0), value, value);
+        }, -1, QString("Desfoque Gaussiano (sigma: %1)").arg(value));
+    }, 600);
 }
 
 void MainWindow::onSharpenStrengthChanged(double value) {
     if (isProcessing) return;
     if (currentEntityType == ENTITY_NONE || currentEntityId.isEmpty()) return;
 
-    runProcessingInThread([value](const cv::Mat& input, int& progress) -> cv::Mat {
-        progress = 50;
-        double strength = value;
-        cv::Mat kernel = (cv::Mat_<float>(3, 3) <<
-            0, -1 * strength, 0,
-            -1 * strength, 1 + 4 * strength, -1 * strength,
-            0, -1 * strength, 0);
-        cv::Mat result;
-        cv::filter2D(input, result, -1, kernel);
-        progress = 100;
-        return result;
-    });
+    double strength = value;
+    cv::Mat kernel = (cv::Mat_<float>(3, 3) <<
+        0, -1 * strength, 0,
+        -1 * strength, 1 + 4 * strength, -1 * strength,
+        0, -1 * strength, 0);
+    showLivePreview([kernel](const cv::Mat& proxy, double) {
+        cv::Mat out;
+        cv::filter2D(proxy, out, -1, kernel);
+        return out;
+    }, [this, kernel, value]() {
+        runTiledOperation(1, [kernel](const cv::Mat& src, cv::Mat& dst) {
+            cv::filter2D(src, dst, -1, kernel);
+        }, -1, QString("Nitidez (intensidade: %1)").arg(value));
+    }, 600);
 }
 
 void MainWindow::onThresholdChanged(int value) {
     if (!imageProcessor->isImageLoaded() || isProcessing) return;
 
-    runProcessingInThread([value](const cv::Mat& input, int& progress) -> cv::Mat {
-        progress = 50;
-        cv::Mat result;
-        cv::threshold(input, result, value, 255, cv::THRESH_BINARY);
-        progress = 100;
-        return result;
-    });
+    PointLUT lut = PointLUT::threshold(value);
+    runTiledOperation(0, [value, lut](const cv::Mat& src, cv::Mat& dst) {
+        if (PointLUT::supports(src)) {
+            lut.apply(src, dst);
+        } else {
+            cv::threshold(src, dst, value, 255, cv::THRESH_BINARY);
+        }
+    }, -1, QString("Limiar aplicado: %1").arg(value));
 }
 
 // Implementações básicas dos outros slots (a serem expandidas)
 void MainWindow::openFFTDialog() {
-    using PM = FingerprintEnhancer::ProjectManager;
-
     if (currentEntityType == ENTITY_NONE || currentEntityId.isEmpty()) {
         QMessageBox::warning(this, "Filtro FFT", "Nenhuma imagem ou fragmento selecionado");
         return;
@@ -1745,42 +1895,128 @@ void MainWindow::openFFTDialog() {
         return;
     }
 
+    // Área da impressão: espectro e filtragem só no envoltório (DFT menor, sem o fundo vazio)
+    std::shared_ptr<const RidgeMask> print = restrictToPrintAction->isChecked()
+        ? RidgeSegmentation::restricting(currentEntityId, workingImg) : nullptr;
+    cv::Mat dialogImage = print ? workingImg(print->boundingBox) : workingImg;
+
     // Abrir diálogo interativo de FFT
-    FFTFilterDialog dialog(workingImg, this);
+    FFTFilterDialog dialog(dialogImage, this, print ? currentEntityId + "#print" : currentEntityId);
     if (dialog.exec() == QDialog::Accepted && dialog.wasAccepted()) {
-        cv::Mat filtered = dialog.getFilteredImage();
-
-        // Aplicar imagem filtrada
-        filtered.copyTo(workingImg);
-
-        // Recarregar visualização
-        loadCurrentEntityToView();
-
-        statusLabel->setText("Filtro FFT interativo aplicado");
-        PM::instance().getCurrentProject()->setModified();
+        // Resultado em resolução total pelo worker, com o espectro já em cache do diálogo
+        ProcessingWorker *worker = new ProcessingWorker();
+        worker->setOperation(ProcessingWorker::FFT_FILTER);
+        worker->setFrequencyMask(dialog.getMaskRects(), dialog.isMaskInverted());
+
+        if (startProcessingWorker(worker)) {
+            hasPendingHistory = false;
+            pendingPipelineFunction = nullptr;
+            pendingStatusText = "Filtro FFT interativo aplicado";
+        }
     } else {
         statusLabel->setText("Filtro FFT cancelado");
     }
 }
 
 void MainWindow::subtractBackground() {
-    applyOperationToCurrentEntity([](cv::Mat& img) {
-        cv::Mat gray;
-        if (img.channels() > 1) {
-            cv::cvtColor(img, gray, cv::COLOR_BGR2GRAY);
-        } else {
-            gray = img.clone();
-        }
+    if (currentEntityType == ENTITY_NONE || currentEntityId.isEmpty()) {
+        QMessageBox::warning(this, "Erro", "Nenhuma imagem ou fragmento selecionado");
+        return;
+    }
+    if (isProcessing) {
+        QMessageBox::warning(this, "Processing",
+            "Another processing operation is already running. Please wait.");
+        return;
+    }
 
-        // Estimar fundo com filtro morfológico
-        cv::Mat background;
-        cv::Mat kernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(51, 51));
-        cv::morphologyEx(gray, background, cv::MORPH_CLOSE, kernel);
+    // Núcleo definido em milímetros: o mesmo ajuste vale para qualquer resolução
+    bool scaleKnown = false;
+    const double pixelsPerMM = currentPixelsPerMM(&scaleKnown);
 
-        // Subtrair fundo
-        cv::subtract(background, gray, img);
-    });
-    statusLabel->setText("Fundo subtraído");
+    QDialog dialog(this);
+    dialog.setWindowTitle("Subtrair Fundo");
+    QFormLayout* layout = new QFormLayout(&dialog);
+
+    QComboBox* methodCombo = new QComboBox();
+    methodCombo->addItem("Retangular rápido (van Herk)", static_cast<int>(BackgroundMethod::VanHerk));
+    methodCombo->addItem("Pirâmide (elíptico, reduzido)", static_cast<int>(BackgroundMethod::Pyramid));
+    methodCombo->addItem("Elíptico exato (lento)", static_cast<int>(BackgroundMethod::Exact));
+    layout->addRow("Método:", methodCombo);
+
+    QDoubleSpinBox* sizeSpinBox = new QDoubleSpinBox();
+    sizeSpinBox->setRange(0.2, 20.0);
+    sizeSpinBox->setDecimals(2);
+    sizeSpinBox->setSingleStep(0.25);
+    sizeSpinBox->setSuffix(" mm");
+    sizeSpinBox->setValue(2.6);     // ≈ 51 px a 500 ppi, o núcleo fixo anterior
+    layout->addRow("Tamanho do núcleo:", sizeSpinBox);
+
+    QLabel* pixelsLabel = new QLabel();
+    auto updatePixels = [pixelsLabel, sizeSpinBox, pixelsPerMM, scaleKnown]() {
+        pixelsLabel->setText(QString("%1 px (%2 px/mm%3)")
+            .arg(BackgroundEstimator::kernelFromMillimetres(sizeSpinBox->value(), pixelsPerMM))
+            .arg(pixelsPerMM, 0, 'f', 2)
+            .arg(scaleKnown ? "" : ", escala não calibrada: 500 ppi"));
+    };
+    connect(sizeSpinBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), &dialog, updatePixels);
+    updatePixels();
+    layout->addRow("Equivale a:", pixelsLabel);
+
+    QDialogButtonBox* buttonBox = new QDialogButtonBox(
+        QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(buttonBox, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    layout->addRow(buttonBox);
+
+    if (dialog.exec() != QDialog::Accepted) return;
+
+    BackgroundConfig config;
+    config.method = static_cast<BackgroundMethod>(methodCombo->currentData().toInt());
+    config.kernelSize = BackgroundEstimator::kernelFromMillimetres(sizeSpinBox->value(), pixelsPerMM);
+
+    ProcessingWorker *worker = new ProcessingWorker();
+    worker->setOperation(ProcessingWorker::SUBTRACT_BACKGROUND);
+    worker->setParameter("method", static_cast<int>(config.method));
+    worker->setParameter("kernelSize", config.kernelSize);
+
+    if (startProcessingWorker(worker)) {
+        hasPendingHistory = true;
+        pendingHistoryType = FingerprintEnhancer::ProcessingOperationType::SUBTRACT_BACKGROUND;
+        pendingHistoryParams = QString("%1, %2mm").arg(config.toString()).arg(sizeSpinBox->value(), 0, 'f', 2);
+        pendingStatusText = QString("Fundo subtraído (núcleo %1 px)").arg(config.kernelSize);
+        pendingPipelineFunction = [](const cv::Mat& input, const QMap<QString, double>& values) {
+            BackgroundConfig stepConfig;
+            stepConfig.method = static_cast<BackgroundMethod>(static_cast<int>(values.value("method", 0)));
+            stepConfig.kernelSize = static_cast<int>(values.value("kernelSize", stepConfig.kernelSize));
+            return BackgroundEstimator::subtract(input, stepConfig);
+        };
+        pendingPipelineValues = {{"method", static_cast<int>(config.method)}, {"kernelSize", config.kernelSize}};
+    }
+}
+
+double MainWindow::currentPixelsPerMM(bool* known) {
+    using PM = FingerprintEnhancer::ProjectManager;
+
+    double scale = 0.0;
+    if (currentEntityType == ENTITY_FRAGMENT && PM::instance().hasOpenProject()) {
+        FingerprintEnhancer::Fragment* fragment = PM::instance().getCurrentProject()->findFragment(currentEntityId);
+        if (fragment) scale = fragment->pixelsPerMM;
+    }
+    if (scale <= 0.0) {
+        scale = imageProcessor->getScale();
+    }
+
+    if (known) *known = scale > 0.0;
+    return scale > 0.0 ? scale : 500.0 / 25.4;
+}
+
+double MainWindow::canonicalScaleForCurrentEntity() {
+    if (!canonicalResolutionAction->isChecked()) return 1.0;
+
+    // Sem calibração não há como saber a resolução real: processar na nativa
+    bool scaleKnown = false;
+    const double pixelsPerMM = currentPixelsPerMM(&scaleKnown);
+    return scaleKnown ? ResolutionPyramid::canonicalScale(pixelsPerMM) : 1.0;
 }
 
 void MainWindow::applyGaussianBlur() {
@@ -1794,22 +2030,146 @@ void MainWindow::applyGaussianBlur() {
      * - Valor de sigma (desvio padrão)
      * - Preview em tempo real
      */
-    applyOperationToCurrentEntity([](cv::Mat& img) {
-        cv::GaussianBlur(img, img, cv::Size(5, 5), 1.5);
-    }, FingerprintEnhancer::ProcessingOperationType::GAUSSIAN_BLUR, "kernel=5x5, sigma=1.5");
-    statusLabel->setText("Filtro Gaussiano aplicado (kernel: 5x5, sigma: 1.5)");
+    // Parâmetros editáveis depois pelo pipeline de processamento
+    runPipelineStep([](const cv::Mat& input, const QMap<QString, double>& values) {
+        int kernel = std::max(1, static_cast<int>(values.value("kernel", 5)) | 1);
+        double sigma = values.value("sigma", 1.5);
+        return TileScheduler::apply(input, kernel / 2, [kernel, sigma](const cv::Mat& src, cv::Mat& dst) {
+            cv::GaussianBlur(src, dst, cv::Size(kernel, kernel), sigma);
+        });
+    }, {{"kernel", 5}, {"sigma", 1.5}},
+       FingerprintEnhancer::ProcessingOperationType::GAUSSIAN_BLUR, "kernel=5x5, sigma=1.5",
+       "Filtro Gaussiano aplicado (kernel: 5x5, sigma: 1.5)");
 }
 
 void MainWindow::applySharpenFilter() {
-    applyOperationToCurrentEntity([](cv::Mat& img) {
-        cv::Mat kernel = (cv::Mat_<float>(3, 3) <<
-            0, -1, 0,
-            -1, 5, -1,
-            0, -1, 0);
-        cv::filter2D(img, img, -1, kernel);
-    }, FingerprintEnhancer::ProcessingOperationType::SHARPEN, "kernel=3x3, strength=default");
-    statusLabel->setText("Filtro de nitidez aplicado");
+    cv::Mat kernel = (cv::Mat_<float>(3, 3) <<
+        0, -1, 0,
+        -1, 5, -1,
+        0, -1, 0);
+    runTiledOperation(1, [kernel](const cv::Mat& src, cv::Mat& dst) {
+        cv::filter2D(src, dst, -1, kernel);
+    }, -1, FingerprintEnhancer::ProcessingOperationType::SHARPEN, "kernel=3x3, strength=default",
+       "Filtro de nitidez aplicado");
+}
+void MainWindow::applyGaborEnhancement() {
+    // Banco de Gabor guiado pelo campo de orientação/frequência da entidade
+    GaborConfig config;
+
+    ProcessingWorker *worker = new ProcessingWorker();
+    worker->setOperation(ProcessingWorker::GABOR_ENHANCE);
+    worker->setParameter("orientations", config.orientationBins);
+    worker->setParameter("frequencies", config.frequencyBins);
+    worker->setParameter("kx", config.kx);
+    worker->setParameter("ky", config.ky);
+
+    if (startProcessingWorker(worker)) {
+        hasPendingHistory = true;
+        pendingHistoryType = FingerprintEnhancer::ProcessingOperationType::GABOR_ENHANCE;
+        pendingHistoryParams = config.toString();
+        pendingStatusText = "Realce Gabor aplicado";
+        const bool restrictToPrint = restrictToPrintAction->isChecked();
+        const double scale = canonicalScaleForCurrentEntity();
+        pendingPipelineFunction = [restrictToPrint, scale](const cv::Mat& input, const QMap<QString, double>& values) {
+            GaborConfig stepConfig;
+            stepConfig.orientationBins = static_cast<int>(values.value("orientations", stepConfig.orientationBins));
+            stepConfig.frequencyBins = static_cast<int>(values.value("frequencies", stepConfig.frequencyBins));
+            stepConfig.kx = values.value("kx", stepConfig.kx);
+            stepConfig.ky = values.value("ky", stepConfig.ky);
+
+            // Mesma resolução e restrição do worker, com a máscara recalculada sobre a entrada do passo
+            return ResolutionPyramid::process(input, scale, [&](const cv::Mat& level) {
+                std::shared_ptr<const RidgeMask> print = restrictToPrint
+                    ? RidgeSegmentation::restricting(QString(), level) : nullptr;
+                if (!print) return GaborEnhancer::enhance(level, RidgeGeometry::compute(level), stepConfig);
+
+                cv::Mat region = level(print->boundingBox);
+                return RidgeSegmentation::embed(
+                    GaborEnhancer::enhance(region, RidgeGeometry::compute(region), stepConfig, nullptr,
+                                           print->blocksIn(print->boundingBox)), *print);
+            });
+        };
+        pendingPipelineValues = {{"orientations", config.orientationBins}, {"frequencies", config.frequencyBins},
+                                 {"kx", config.kx}, {"ky", config.ky}};
+    }
 }
+
+void MainWindow::applyCoherenceDiffusion() {
+    if (currentEntityType == ENTITY_NONE || currentEntityId.isEmpty()) {
+        QMessageBox::warning(this, "Erro", "Nenhuma imagem ou fragmento selecionado");
+        return;
+    }
+    if (isProcessing) {
+        QMessageBox::warning(this, "Processing",
+            "Another processing operation is already running. Please wait.");
+        return;
+    }
+
+    CoherenceDiffusionConfig config;
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Difusão Coerente");
+    QFormLayout* layout = new QFormLayout(&dialog);
+
+    QSpinBox* iterationsSpinBox = new QSpinBox();
+    iterationsSpinBox->setRange(1, 200);
+    iterationsSpinBox->setValue(config.iterations);
+    iterationsSpinBox->setToolTip("Máximo de passos; para antes se a imagem deixar de mudar");
+    layout->addRow("Iterações (máx.):", iterationsSpinBox);
+
+    QDoubleSpinBox* sigmaSpinBox = new QDoubleSpinBox();
+    sigmaSpinBox->setRange(0.3, 5.0);
+    sigmaSpinBox->setSingleStep(0.1);
+    sigmaSpinBox->setSuffix(" px");
+    sigmaSpinBox->setValue(config.gradientSigma);
+    layout->addRow("Escala do ruído (σ):", sigmaSpinBox);
+
+    QDoubleSpinBox* rhoSpinBox = new QDoubleSpinBox();
+    rhoSpinBox->setRange(1.0, 20.0);
+    rhoSpinBox->setSingleStep(0.5);
+    rhoSpinBox->setSuffix(" px");
+    rhoSpinBox->setValue(config.integrationSigma);
+    rhoSpinBox->setToolTip("Janela da orientação; valores maiores atravessam falhas mais longas");
+    layout->addRow("Escala da orientação (ρ):", rhoSpinBox);
+
+    QDialogButtonBox* buttonBox = new QDialogButtonBox(
+        QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(buttonBox, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    layout->addRow(buttonBox);
+
+    if (dialog.exec() != QDialog::Accepted) return;
+
+    config.iterations = iterationsSpinBox->value();
+    config.gradientSigma = sigmaSpinBox->value();
+    config.integrationSigma = rhoSpinBox->value();
+
+    ProcessingWorker *worker = new ProcessingWorker();
+    worker->setOperation(ProcessingWorker::COHERENCE_DIFFUSION);
+    worker->setParameter("iterations", config.iterations);
+    worker->setParameter("sigma", config.gradientSigma);
+    worker->setParameter("rho", config.integrationSigma);
+
+    if (startProcessingWorker(worker)) {
+        hasPendingHistory = true;
+        pendingHistoryType = FingerprintEnhancer::ProcessingOperationType::COHERENCE_DIFFUSION;
+        pendingHistoryParams = config.toString();
+        pendingStatusText = "Difusão coerente aplicada";
+        const double scale = canonicalScaleForCurrentEntity();
+        pendingPipelineFunction = [scale](const cv::Mat& input, const QMap<QString, double>& values) {
+            CoherenceDiffusionConfig stepConfig;
+            stepConfig.iterations = static_cast<int>(values.value("iterations", stepConfig.iterations));
+            stepConfig.gradientSigma = values.value("sigma", stepConfig.gradientSigma);
+            stepConfig.integrationSigma = values.value("rho", stepConfig.integrationSigma);
+            return ResolutionPyramid::process(input, scale, [&](const cv::Mat& level) {
+                return CoherenceDiffusion::apply(level, stepConfig);
+            });
+        };
+        pendingPipelineValues = {{"iterations", config.iterations}, {"sigma", config.gradientSigma},
+                                 {"rho", config.integrationSigma}};
+    }
+}
+
 void MainWindow::adjustBrightnessContrast() {
     /**
      * Ajustar brilho e contraste com valores fixos
@@ -1820,8 +2180,12 @@ void MainWindow::adjustBrightnessContrast() {
     applyOperationToCurrentEntity([](cv::Mat& img) {
         double alpha = 1.2; // contraste: 1.0 = sem mudança
         double beta = 10;   // brilho: 0 = sem mudança
-        img.convertTo(img, -1, alpha, beta);
-    });
+        if (PointLUT::supports(img)) {
+            PointLUT::linear(alpha, beta).apply(img, img);
+        } else {
+            img.convertTo(img, -1, alpha, beta);
+        }
+    }, "Brilho/contraste rápido");
     statusLabel->setText("Brilho/Contraste ajustados (alpha: 1.2, beta: +10)");
 }
 
@@ -1830,15 +2194,21 @@ void MainWindow::applyBrightnessContrast() {
     int brightness = brightnessSlider->value();  // -100 a 100
     int contrast = contrastSlider->value();       // 50 a 300
     
-    applyOperationToCurrentEntity([brightness, contrast](cv::Mat& img) {
+    applyPipelineOperation([](const cv::Mat& input, const QMap<QString, double>& values) {
         // Converter contraste de 50-300 para 0.5-3.0 (alpha)
-        double alpha = contrast / 100.0;
+        double alpha = values.value("contraste", 100) / 100.0;
         // Brightness já está em -100 a 100 (beta)
-        double beta = static_cast<double>(brightness);
+        double beta = values.value("brilho", 0);
         
-        img.convertTo(img, -1, alpha, beta);
-    }, FingerprintEnhancer::ProcessingOperationType::BRIGHTNESS_CONTRAST, 
-       QString("brilho=%1, contraste=%2%").arg(brightness).arg(contrast));
+        cv::Mat output;
+        input.convertTo(output, -1, alpha, beta);
+        return output;
+    }, {{"brilho", brightness}, {"contraste", contrast}},
+       FingerprintEnhancer::ProcessingOperationType::BRIGHTNESS_CONTRAST, 
+       QString("brilho=%1, contraste=%2%").arg(brightness).arg(contrast),
+       [](const QMap<QString, double>& values) {
+        return PointLUT::linear(values.value("contraste", 100) / 100.0, values.value("brilho", 0));
+    });
     
     statusLabel->setText(QString("✅ Brilho: %1 | Contraste: %2% aplicados")
                         .arg(brightness)
@@ -1863,27 +2233,35 @@ void MainWindow::equalizeHistogram() {
 }
 
 void MainWindow::applyCLAHE() {
-    applyOperationToCurrentEntity([](cv::Mat& img) {
-        cv::Ptr<cv::CLAHE> clahe = cv::createCLAHE(2.0, cv::Size(8, 8));
-        if (img.channels() == 1) {
-            clahe->apply(img, img);
+    // As regiões contextuais do CLAHE cobrem a imagem inteira (grade 8x8), então
+    // não há halo local: roda inteiro no worker (o OpenCV já o paraleliza)
+    runPipelineStep([](const cv::Mat& input, const QMap<QString, double>& values) -> cv::Mat {
+        int tiles = std::max(1, static_cast<int>(values.value("tileSize", 8)));
+        cv::Ptr<cv::CLAHE> clahe = cv::createCLAHE(values.value("clipLimit", 2.0), cv::Size(tiles, tiles));
+        cv::Mat result;
+        if (input.channels() == 1) {
+            clahe->apply(input, result);
         } else {
             cv::Mat lab;
-            cv::cvtColor(img, lab, cv::COLOR_BGR2Lab);
+            cv::cvtColor(input, lab, cv::COLOR_BGR2Lab);
             std::vector<cv::Mat> channels;
             cv::split(lab, channels);
             clahe->apply(channels[0], channels[0]);
             cv::merge(channels, lab);
-            cv::cvtColor(lab, img, cv::COLOR_Lab2BGR);
+            cv::cvtColor(lab, result, cv::COLOR_Lab2BGR);
         }
-    }, FingerprintEnhancer::ProcessingOperationType::CLAHE, "clipLimit=2.0, tileSize=8x8");
-    statusLabel->setText("CLAHE aplicado");
+        return result;
+    }, {{"clipLimit", 2.0}, {"tileSize", 8}},
+       FingerprintEnhancer::ProcessingOperationType::CLAHE, "clipLimit=2.0, tileSize=8x8", "CLAHE aplicado");
 }
 
 void MainWindow::invertColors() {
-    applyOperationToCurrentEntity([](cv::Mat& img) {
-        cv::bitwise_not(img, img);
-    }, FingerprintEnhancer::ProcessingOperationType::INVERT_COLORS, "");
+    applyPipelineOperation([](const cv::Mat& input, const QMap<QString, double>&) {
+        cv::Mat output;
+        cv::bitwise_not(input, output);
+        return output;
+    }, QMap<QString, double>(), FingerprintEnhancer::ProcessingOperationType::INVERT_COLORS, "",
+       [](const QMap<QString, double>&) { return PointLUT::invert(); });
     statusLabel->setText("Cores invertidas");
 }
 
@@ -1892,13 +2270,114 @@ void MainWindow::rotateImage() {
 }
 
 void MainWindow::binarizeImage() {
-    applyOperationToCurrentEntity([](cv::Mat& img) {
-        if (img.channels() > 1) {
-            cv::cvtColor(img, img, cv::COLOR_BGR2GRAY);
+    if (currentEntityType == ENTITY_NONE || currentEntityId.isEmpty()) {
+        QMessageBox::warning(this, "Erro", "Nenhuma imagem ou fragmento selecionado");
+        return;
+    }
+    if (isProcessing) {
+        QMessageBox::warning(this, "Processing",
+            "Another processing operation is already running. Please wait.");
+        return;
+    }
+
+    // Janela local em milímetros: cobre poucos períodos de crista em qualquer resolução
+    bool scaleKnown = false;
+    const double pixelsPerMM = currentPixelsPerMM(&scaleKnown);
+
+    QDialog dialog(this);
+    dialog.setWindowTitle("Binarizar Imagem");
+    QFormLayout* layout = new QFormLayout(&dialog);
+
+    const int otsu = -1;
+    QComboBox* methodCombo = new QComboBox();
+    methodCombo->addItem("Otsu (limiar global)", otsu);
+    methodCombo->addItem("Sauvola (adaptativo)", static_cast<int>(LocalThresholdMethod::Sauvola));
+    methodCombo->addItem("Niblack (adaptativo)", static_cast<int>(LocalThresholdMethod::Niblack));
+    methodCombo->setCurrentIndex(1);
+    layout->addRow("Método:", methodCombo);
+
+    QDoubleSpinBox* windowSpinBox = new QDoubleSpinBox();
+    windowSpinBox->setRange(0.2, 10.0);
+    windowSpinBox->setDecimals(2);
+    windowSpinBox->setSingleStep(0.1);
+    windowSpinBox->setSuffix(" mm");
+    windowSpinBox->setValue(1.0);   // ≈ 2 períodos de crista
+    layout->addRow("Janela:", windowSpinBox);
+
+    QLabel* pixelsLabel = new QLabel();
+    layout->addRow("Equivale a:", pixelsLabel);
+
+    QDoubleSpinBox* kSpinBox = new QDoubleSpinBox();
+    kSpinBox->setRange(-1.0, 1.0);
+    kSpinBox->setDecimals(2);
+    kSpinBox->setSingleStep(0.02);
+    kSpinBox->setValue(LocalThresholdConfig::defaultK(LocalThresholdMethod::Sauvola));
+    layout->addRow("k:", kSpinBox);
+
+    auto updateControls = [=]() {
+        const int method = methodCombo->currentData().toInt();
+        windowSpinBox->setEnabled(method != otsu);
+        kSpinBox->setEnabled(method != otsu);
+        pixelsLabel->setText(QString("%1 px (%2 px/mm%3)")
+            .arg(AdaptiveThreshold::windowFromMillimetres(windowSpinBox->value(), pixelsPerMM))
+            .arg(pixelsPerMM, 0, 'f', 2)
+            .arg(scaleKnown ? "" : ", escala não calibrada: 500 ppi"));
+    };
+    connect(methodCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), &dialog, [=]() {
+        const int method = methodCombo->currentData().toInt();
+        if (method != otsu) {
+            kSpinBox->setValue(LocalThresholdConfig::defaultK(static_cast<LocalThresholdMethod>(method)));
         }
-        cv::threshold(img, img, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
-    }, FingerprintEnhancer::ProcessingOperationType::BINARIZE, "method=Otsu");
-    statusLabel->setText("Imagem binarizada (Otsu)");
+        updateControls();
+    });
+    connect(windowSpinBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), &dialog, updateControls);
+    updateControls();
+
+    QDialogButtonBox* buttonBox = new QDialogButtonBox(
+        QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    connect(buttonBox, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
+    connect(buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+    layout->addRow(buttonBox);
+
+    if (dialog.exec() != QDialog::Accepted) return;
+
+    if (methodCombo->currentData().toInt() == otsu) {
+        applyOperationToCurrentEntity([](cv::Mat& img) {
+            if (img.channels() > 1) {
+                cv::cvtColor(img, img, cv::COLOR_BGR2GRAY);
+            }
+            cv::threshold(img, img, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+        }, FingerprintEnhancer::ProcessingOperationType::BINARIZE, "method=Otsu");
+        statusLabel->setText("Imagem binarizada (Otsu)");
+        return;
+    }
+
+    LocalThresholdConfig config;
+    config.method = static_cast<LocalThresholdMethod>(methodCombo->currentData().toInt());
+    config.windowSize = AdaptiveThreshold::windowFromMillimetres(windowSpinBox->value(), pixelsPerMM);
+    config.k = kSpinBox->value();
+
+    ProcessingWorker *worker = new ProcessingWorker();
+    worker->setOperation(ProcessingWorker::ADAPTIVE_THRESHOLD);
+    worker->setParameter("method", static_cast<int>(config.method));
+    worker->setParameter("windowSize", config.windowSize);
+    worker->setParameter("k", config.k);
+
+    if (startProcessingWorker(worker)) {
+        hasPendingHistory = true;
+        pendingHistoryType = FingerprintEnhancer::ProcessingOperationType::ADAPTIVE_THRESHOLD;
+        pendingHistoryParams = QString("%1, %2mm").arg(config.toString()).arg(windowSpinBox->value(), 0, 'f', 2);
+        pendingStatusText = QString("Imagem binarizada (%1)").arg(methodCombo->currentText());
+        pendingPipelineFunction = [](const cv::Mat& input, const QMap<QString, double>& values) {
+            LocalThresholdConfig stepConfig;
+            stepConfig.method = static_cast<LocalThresholdMethod>(static_cast<int>(values.value("method", 0)));
+            stepConfig.windowSize = static_cast<int>(values.value("windowSize", stepConfig.windowSize));
+            stepConfig.k = values.value("k", LocalThresholdConfig::defaultK(stepConfig.method));
+            return AdaptiveThreshold::apply(input, stepConfig);
+        };
+        pendingPipelineValues = {{"method", static_cast<int>(config.method)},
+                                 {"windowSize", config.windowSize}, {"k", config.k}};
+    }
 }
 
 void MainWindow::skeletonizeImage() {
@@ -1909,33 +2388,21 @@ void MainWindow::skeletonizeImage() {
         }
         cv::threshold(img, img, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
 
-        // Algoritmo de esqueletização
-        cv::Mat skeleton = cv::Mat::zeros(img.size(), CV_8UC1);
-        cv::Mat temp, eroded;
-        cv::Mat element = cv::getStructuringElement(cv::MORPH_CROSS, cv::Size(3, 3));
-        cv::Mat working = img.clone();
-
-        bool done = false;
-        while (!done) {
-            cv::erode(working, eroded, element);
-            cv::dilate(eroded, temp, element);
-            cv::subtract(working, temp, temp);
-            cv::bitwise_or(skeleton, temp, skeleton);
-            eroded.copyTo(working);
-            done = (cv::countNonZero(working) == 0);
-        }
-
-        skeleton.copyTo(img);
-    });
+        // Afinamento (Zhang-Suen) para esqueleto de um pixel
+        Thinning::thin(img).copyTo(img);
+    }, "Esqueletização");
     statusLabel->setText("Imagem esqueletizada");
 }
 
 void MainWindow::extractMinutiae() {
     if (!imageProcessor->isImageLoaded()) return;
 
-    // Verificar se imagem está esqueletizada
+    // Imagem atual já esqueletizada; mesmo extrator por tabela do AFIS
     cv::Mat current = imageProcessor->getCurrentImage();
-    std::vector<Minutia> minutiae = minutiaeExtractor->extractMinutiae(current);
+    std::vector<Minutia> minutiae;
+    for (const SkeletonMinutia& m : CrossingNumber::extract(current)) {
+        minutiae.emplace_back(m.position, m.angle, m.type, m.quality, m.id);
+    }
 
     minutiaeEditor->setMinutiae(minutiae);
     updateMinutiaeList();
@@ -1958,6 +2425,37 @@ void MainWindow::toggleRightPanel() {
     }
 }
 
+void MainWindow::toggleQualityMap() {
+    updateQualityOverlay();
+}
+
+void MainWindow::updateQualityOverlay() {
+    ImageViewer* viewer = getActiveViewer();
+    if (!qualityMapAction->isChecked() || currentEntityType == ENTITY_NONE || currentEntityId.isEmpty()) {
+        viewer->clearBlockOverlay();
+        return;
+    }
+
+    cv::Mat& workingImage = getCurrentWorkingImage();
+    if (workingImage.empty()) {
+        viewer->clearBlockOverlay();
+        return;
+    }
+
+    // Campo, máscara e mapa vêm dos caches da entidade: só recalcula se a imagem mudou.
+    // Na resolução canônica os blocos cobrem blockSize / scale pixels nativos
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    const double scale = canonicalScaleForCurrentEntity();
+    std::shared_ptr<const QualityMap> map = scale < 1.0
+        ? RidgeQuality::cached(currentEntityId + "#canonical",
+                               *ResolutionPyramid::level(currentEntityId, workingImage, scale))
+        : RidgeQuality::cached(currentEntityId, workingImage);
+    viewer->setBlockOverlay(RidgeQuality::overlay(*map), map->blockSize / scale);
+    QApplication::restoreOverrideCursor();
+
+    statusLabel->setText(QString("Qualidade média da impressão: %1").arg(map->meanQuality(), 0, 'f', 2));
+}
+
 void MainWindow::configureMinutiaeDisplay() {
     using namespace FingerprintEnhancer;
 
@@ -2371,9 +2869,12 @@ void MainWindow::showProcessingProgress(const QString &operation) {
     Q_UNUSED(operation);
     progressBar->setVisible(true);
     progressBar->setValue(0);
+    cancelProcessingButton->setEnabled(true);
+    cancelProcessingButton->setVisible(true);
 }
 void MainWindow::hideProcessingProgress() {
     progressBar->setVisible(false);
+    cancelProcessingButton->setVisible(false);
 }
 
 // ========== NOVAS IMPLEMENTAÇÕES ==========
@@ -2422,63 +2923,210 @@ void MainWindow::applyBrightnessContrastRealtime() {
     double brightness = brightnessSlider->value();
     double contrast = contrastSlider->value() / 100.0;
 
-    // Obter a imagem de trabalho da entidade atual (imagem ou fragmento)
+    // Durante o arraste só o proxy é recalculado; a imagem inteira é
+    // convertida (sem modificar o workingImage) ao soltar ou após a pausa
+    // A mesma tabela serve à prévia e à renderização final
+    PointLUT lut = PointLUT::linear(contrast, brightness);
+    auto render = [lut, brightness, contrast](const cv::Mat& input) {
+        cv::Mat out;
+        if (PointLUT::supports(input)) {
+            lut.apply(input, out);
+        } else {
+            input.convertTo(out, -1, contrast, brightness);
+        }
+        return out;
+    };
+    showLivePreview([render](const cv::Mat& proxy, double) {
+        return render(proxy);
+    }, [this, render]() {
+        cv::Mat& workingImage = getCurrentWorkingImage();
+        if (workingImage.empty()) return;
+        getActiveViewer()->setImage(render(workingImage));
+    }, 300);
+}
+
+void MainWindow::showLivePreview(std::function<cv::Mat(const cv::Mat&, double)> operation,
+                                 std::function<void()> commit, int debounceMs) {
+    ImageViewer* viewer = getActiveViewer();
     cv::Mat& workingImage = getCurrentWorkingImage();
-    if (workingImage.empty()) return;
+    if (!viewer || workingImage.empty()) return;
+
+    QRect visible = viewer->visibleImageRect().intersected(QRect(0, 0, workingImage.cols, workingImage.rows));
+    if (visible.isEmpty()) return;
+
+    // Proxy do trecho visível na resolução do viewport (refeito ao rolar/trocar de entidade)
+    if (previewProxy.empty() || visible != previewProxyRect || previewEntityId != currentEntityId) {
+        cv::Mat region = workingImage(cv::Rect(visible.x(), visible.y(), visible.width(), visible.height()));
+        QSize target = viewer->viewport()->size() * viewer->devicePixelRatioF();
+        double scale = std::min({1.0, target.width() / double(region.cols), target.height() / double(region.rows)});
+        if (scale < 1.0) {
+            cv::resize(region, previewProxy, cv::Size(), scale, scale, cv::INTER_AREA);
+        } else {
+            previewProxy = region.clone();
+        }
+        previewProxyRect = visible;
+        previewEntityId = currentEntityId;
+    }
 
-    // Aplicar temporariamente sem modificar o workingImage
-    cv::Mat result;
-    workingImage.convertTo(result, -1, contrast, brightness);
+    const double scale = previewProxy.cols / double(visible.width());
+    viewer->setPreviewPatch(operation(previewProxy, scale), visible);
 
-    processedImageViewer->setImage(result);
+    pendingPreviewCommit = std::move(commit);
+    previewCommitTimer->start(debounceMs);
+}
+
+void MainWindow::commitLivePreview() {
+    // Pausa no meio de um arraste: espera soltar (sliderReleased chama de novo)
+    if (brightnessSlider->isSliderDown() || contrastSlider->isSliderDown()) return;
+
+    previewCommitTimer->stop();
+    std::function<void()> commit = std::move(pendingPreviewCommit);
+    pendingPreviewCommit = nullptr;
+
+    // Entidade trocada antes da pausa: a prévia pertence à anterior
+    if (!commit || previewEntityId != currentEntityId || isProcessing) return;
+    commit();
 }
 
 void MainWindow::runProcessingInThread(std::function<cv::Mat(const cv::Mat&, int&)> processingFunc) {
+    ProcessingWorker *worker = new ProcessingWorker();
+    worker->setCustomOperation(processingFunc);
+
+    hasPendingHistory = false;
+    pendingPipelineFunction = nullptr;
+    pendingStatusText.clear();
+    pendingHistorySyncEntries = -1;
+    startProcessingWorker(worker);
+}
+
+void MainWindow::runProcessingInThread(std::function<cv::Mat(const cv::Mat&, int&)> processingFunc,
+                                       FingerprintEnhancer::ProcessingOperationType opType,
+                                       const QString& params, const QString& statusText) {
+    ProcessingWorker *worker = new ProcessingWorker();
+    worker->setCustomOperation(processingFunc);
+
+    if (startProcessingWorker(worker)) {
+        hasPendingHistory = true;
+        pendingHistoryType = opType;
+        pendingHistoryParams = params;
+        pendingStatusText = statusText;
+        pendingPipelineFunction = [processingFunc](const cv::Mat& input, const QMap<QString, double>&) {
+            int progress = 0;
+            return processingFunc(input, progress);
+        };
+        pendingPipelineValues.clear();
+    }
+}
+
+void MainWindow::runTiledOperation(int halo, TileFilter filter, int outputType,
+                                   FingerprintEnhancer::ProcessingOperationType opType,
+                                   const QString& params, const QString& statusText) {
+    ProcessingWorker *worker = new ProcessingWorker();
+    worker->setTiledOperation(halo, filter, outputType);
+
+    if (startProcessingWorker(worker)) {
+        hasPendingHistory = true;
+        pendingHistoryType = opType;
+        pendingHistoryParams = params;
+        pendingStatusText = statusText;
+        const bool restrictToPrint = restrictToPrintAction->isChecked();
+        pendingPipelineFunction = [halo, filter, outputType, restrictToPrint](const cv::Mat& input,
+                                                                              const QMap<QString, double>&) {
+            TileSchedulerConfig config = restrictToPrint
+                ? RidgeSegmentation::tileConfig(RidgeSegmentation::restricting(QString(), input))
+                : TileSchedulerConfig();
+            return TileScheduler::apply(input, halo, filter, outputType, nullptr, config);
+        };
+        pendingPipelineValues.clear();
+    }
+}
+
+void MainWindow::runTiledOperation(int halo, TileFilter filter, int outputType, const QString& statusText) {
+    ProcessingWorker *worker = new ProcessingWorker();
+    worker->setTiledOperation(halo, filter, outputType);
+
+    if (startProcessingWorker(worker)) {
+        hasPendingHistory = false;
+        pendingPipelineFunction = nullptr;
+        pendingStatusText = statusText;
+    }
+}
+
+void MainWindow::runPipelineStep(PipelineStepFunction stepFunction, const QMap<QString, double>& values,
+                                 FingerprintEnhancer::ProcessingOperationType opType,
+                                 const QString& params, const QString& statusText) {
+    // Mesma função no worker e no pipeline: recalcular com outros parâmetros reproduz a operação
+    ProcessingWorker *worker = new ProcessingWorker();
+    worker->setCustomOperation([stepFunction, values](const cv::Mat& input, int& progress) {
+        cv::Mat result = stepFunction(input, values);
+        progress = 100;
+        return result;
+    });
+
+    if (startProcessingWorker(worker)) {
+        hasPendingHistory = true;
+        pendingHistoryType = opType;
+        pendingHistoryParams = params;
+        pendingStatusText = statusText;
+        pendingPipelineFunction = stepFunction;
+        pendingPipelineValues = values;
+    }
+}
+
+bool MainWindow::startProcessingWorker(ProcessingWorker *worker) {
     if (isProcessing) {
         QMessageBox::warning(this, "Processing",
             "Another processing operation is already running. Please wait.");
-        return;
+        delete worker;
+        return false;
     }
 
     // Verificar se há uma entidade selecionada
     if (currentEntityType == ENTITY_NONE || currentEntityId.isEmpty()) {
         QMessageBox::warning(this, "No Image", "Please select an image or fragment first.");
-        return;
+        delete worker;
+        return false;
     }
 
     cv::Mat& workingImage = getCurrentWorkingImage();
     if (workingImage.empty()) {
         QMessageBox::warning(this, "No Image", "Working image is empty.");
-        return;
+        delete worker;
+        return false;
     }
 
     isProcessing = true;
     showProcessingProgress("Processing");
 
-    // Criar thread e worker
+    // Criar thread e mover o worker já configurado
     processingThread = new QThread();
-    processingWorker = new ProcessingWorker();
+    processingWorker = worker;
     processingWorker->moveToThread(processingThread);
 
-    // Configurar worker - usar a imagem de trabalho da entidade atual
-    processingWorker->setCustomOperation(processingFunc);
+    // Usar a imagem de trabalho da entidade atual
     processingWorker->setInputImage(workingImage);
+    processingWorker->setCacheKey(currentEntityId);
+    processingWorker->setRestrictToPrint(restrictToPrintAction->isChecked());
+    processingWorker->setCanonicalScale(canonicalScaleForCurrentEntity());
 
     // Conectar sinais
     connect(processingThread, &QThread::started, processingWorker, &ProcessingWorker::process);
     connect(processingWorker, &ProcessingWorker::progressUpdated, this, &MainWindow::onProcessingProgress);
     connect(processingWorker, &ProcessingWorker::operationCompleted, this, &MainWindow::onProcessingCompleted);
     connect(processingWorker, &ProcessingWorker::operationFailed, this, &MainWindow::onProcessingFailed);
+    connect(processingWorker, &ProcessingWorker::operationCancelled, this, &MainWindow::onProcessingCancelled);
     connect(processingWorker, &ProcessingWorker::statusMessage, this, &MainWindow::onProcessingStatus);
 
     // Cleanup quando terminar
     connect(processingWorker, &ProcessingWorker::operationCompleted, processingThread, &QThread::quit);
     connect(processingWorker, &ProcessingWorker::operationFailed, processingThread, &QThread::quit);
+    connect(processingWorker, &ProcessingWorker::operationCancelled, processingThread, &QThread::quit);
     connect(processingThread, &QThread::finished, processingWorker, &QObject::deleteLater);
     connect(processingThread, &QThread::finished, processingThread, &QObject::deleteLater);
 
     // Iniciar thread
     processingThread->start();
+    return true;
 }
 
 void MainWindow::onProcessingProgress(int percentage) {
@@ -2488,20 +3136,58 @@ void MainWindow::onProcessingProgress(int percentage) {
 void MainWindow::onProcessingCompleted(cv::Mat result) {
     // Atualizar imagem processada
     if (!result.empty()) {
+        // Passo reexecutável no pipeline, com o resultado já calculado (antes de alterar a imagem)
+        if (hasPendingHistory && pendingPipelineFunction) {
+            if (ProcessingPipeline *pipeline = currentPipeline()) {
+                const int index = pipeline->appendStep(pipelineStepName(pendingHistoryType, pendingHistoryParams),
+                                                       pendingPipelineValues, pendingPipelineFunction, result);
+                pipeline->setHistoryEntry(index, static_cast<int>(pendingHistoryType), pendingHistoryParams);
+            }
+        }
+
         // Copiar resultado para a workingImage da entidade atual
         cv::Mat& workingImage = getCurrentWorkingImage();
+        UndoHistory::record(currentEntityId, workingImage, result,
+                            hasPendingHistory ? pipelineStepName(pendingHistoryType, pendingHistoryParams)
+                                              : pendingStatusText);
+        TransformStack::carry(currentEntityId, workingImage, result);
         result.copyTo(workingImage);
 
         // Recarregar visualização
         loadCurrentEntityToView();
 
-        // Marcar projeto como modificado
+        // Pipeline editado: o fim do histórico acompanha os passos recalculados
+        if (pendingHistorySyncEntries >= 0) {
+            if (std::shared_ptr<ProcessingPipeline> pipeline = entityPipelines.value(currentEntityId)) {
+                syncProcessingHistory(pipeline.get(), pendingHistorySyncEntries);
+            }
+        }
+
+        // Registrar no histórico da entidade, quando a operação tiver tipo
         using PM = FingerprintEnhancer::ProjectManager;
+        if (hasPendingHistory) {
+            FingerprintEnhancer::ProcessingOperation operation(pendingHistoryType, pendingHistoryParams);
+            if (currentEntityType == ENTITY_IMAGE) {
+                FingerprintEnhancer::FingerprintImage* image = PM::instance().getCurrentProject()->findImage(currentEntityId);
+                if (image) image->processingHistory.append(operation);
+            } else if (currentEntityType == ENTITY_FRAGMENT) {
+                FingerprintEnhancer::Fragment* fragment = PM::instance().getCurrentProject()->findFragment(currentEntityId);
+                if (fragment) fragment->processingHistory.append(operation);
+            }
+        }
+
+        // Marcar projeto como modificado
         PM::instance().getCurrentProject()->setModified();
 
-        statusLabel->setText("Processing completed successfully");
+        statusLabel->setText(pendingStatusText.isEmpty() ? "Processing completed successfully"
+                                                         : pendingStatusText);
     }
 
+    hasPendingHistory = false;
+    pendingPipelineFunction = nullptr;
+    pendingPipelineValues.clear();
+    pendingStatusText.clear();
+    pendingHistorySyncEntries = -1;
     hideProcessingProgress();
     isProcessing = false;
     processingWorker = nullptr;
@@ -2510,10 +3196,36 @@ void MainWindow::onProcessingCompleted(cv::Mat result) {
 
 void MainWindow::onProcessingFailed(QString errorMessage) {
     QMessageBox::critical(this, "Processing Error", errorMessage);
+    hasPendingHistory = false;
+    pendingPipelineFunction = nullptr;
+    pendingPipelineValues.clear();
+    pendingStatusText.clear();
+    pendingHistorySyncEntries = -1;
+    hideProcessingProgress();
+    isProcessing = false;
+    processingWorker = nullptr;
+    processingThread = nullptr;
+}
+
+void MainWindow::cancelProcessing() {
+    if (!isProcessing || !processingWorker) return;
+    // Direto, não por sinal: a thread do worker só volta ao laço de eventos ao terminar
+    processingWorker->cancel();
+    cancelProcessingButton->setEnabled(false);
+    statusLabel->setText("Cancelando processamento...");
+}
+
+void MainWindow::onProcessingCancelled() {
+    hasPendingHistory = false;
+    pendingPipelineFunction = nullptr;
+    pendingPipelineValues.clear();
+    pendingStatusText.clear();
+    pendingHistorySyncEntries = -1;
     hideProcessingProgress();
     isProcessing = false;
     processingWorker = nullptr;
     processingThread = nullptr;
+    statusLabel->setText("Processamento cancelado");
 }
 
 void MainWindow::onProcessingStatus(QString message) {
@@ -2600,12 +3312,21 @@ void MainWindow::applyCrop() {
     }
 
     // CONVERTER seleção (em coords rotacionadas atuais) para coordenadas ORIGINAIS
-    QRect originalSpaceRect = convertRotatedToOriginalCoords(
-        selection, 
-        img->currentRotationAngle,
-        QSize(img->workingImage.cols, img->workingImage.rows),  // Tamanho atual (rotacionado)
-        QSize(img->originalImage.cols, img->originalImage.rows)  // Tamanho original
-    );
+    // Com geometria composta registrada, a inversa é exata para qualquer ângulo e espelhamento
+    QRect originalSpaceRect;
+    const GeometricTransform geometry = TransformStack::current(img->id, img->workingImage);
+    if (geometry.matches(img->originalImage.size(), img->workingImage.size())) {
+        const cv::Rect source = geometry.unmapRect(
+            cv::Rect(selection.x(), selection.y(), selection.width(), selection.height()));
+        originalSpaceRect = QRect(source.x, source.y, source.width, source.height);
+    } else {
+        originalSpaceRect = convertRotatedToOriginalCoords(
+            selection, 
+            img->currentRotationAngle,
+            QSize(img->workingImage.cols, img->workingImage.rows),  // Tamanho atual (rotacionado)
+            QSize(img->originalImage.cols, img->originalImage.rows)  // Tamanho original
+        );
+    }
     
     // Criar fragmento COM coordenadas no espaço ORIGINAL
     // Mas a imagem do fragmento vem do workingImage rotacionado atual
@@ -2693,28 +3414,45 @@ void MainWindow::saveCroppedImage() {
 
 // ==================== FERRAMENTAS DE ROTAÇÃO ====================
 
-// Função auxiliar que faz rotação preservando toda a imagem
-cv::Mat MainWindow::rotateImagePreservingSize(const cv::Mat &image, double angle) {
-    if (image.empty()) return image;
-
-    cv::Point2f center(image.cols / 2.0f, image.rows / 2.0f);
-    cv::Mat rotMatrix = cv::getRotationMatrix2D(center, -angle, 1.0);
+// Base da composição geométrica da entidade atual
+TransformBase MainWindow::currentGeometryBase() {
+    using PM = FingerprintEnhancer::ProjectManager;
 
-    // Calcular novo tamanho da imagem para não cortar
-    double abs_cos = abs(rotMatrix.at<double>(0, 0));
-    double abs_sin = abs(rotMatrix.at<double>(0, 1));
-    int new_w = int(image.rows * abs_sin + image.cols * abs_cos);
-    int new_h = int(image.rows * abs_cos + image.cols * abs_sin);
+    cv::Mat original;
+    double savedAngle = 0.0;
+    if (currentEntityType == ENTITY_FRAGMENT) {
+        FingerprintEnhancer::Fragment* frag = PM::instance().getCurrentProject()->findFragment(currentEntityId);
+        if (frag) {
+            original = frag->originalImage;
+            savedAngle = frag->currentRotationAngle;
+        }
+    } else if (currentEntityType == ENTITY_IMAGE) {
+        FingerprintEnhancer::FingerprintImage* img = PM::instance().getCurrentProject()->findImage(currentEntityId);
+        if (img) {
+            original = img->originalImage;
+            savedAngle = img->currentRotationAngle;
+        }
+    }
 
-    // Ajustar matriz de rotação para o novo tamanho
-    rotMatrix.at<double>(0, 2) += (new_w / 2.0) - center.x;
-    rotMatrix.at<double>(1, 2) += (new_h / 2.0) - center.y;
+    cv::Mat& workingImage = getCurrentWorkingImage();
+    if (original.empty()) original = workingImage;
 
-    cv::Mat rotated;
-    cv::warpAffine(image, rotated, rotMatrix, cv::Size(new_w, new_h),
-                   cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar(255, 255, 255));
+    // Entidade sem pilha (ex.: projeto recém-aberto): assumir o ângulo salvo se o tamanho confere
+    const GeometricTransform seed = GeometricTransform(original.size()).rotated(savedAngle);
+    return TransformStack::base(currentEntityId, workingImage, original, seed);
+}
 
-    return rotated;
+// Compõe a operação com a geometria acumulada e reamostra a base uma única vez
+cv::Mat MainWindow::applyGeometricStep(const TransformStack::Step& step, const QString& description,
+                                       GeometricTransform* applied) {
+    TransformBase base = currentGeometryBase();
+    const GeometricTransform target = step(base.current);
+    cv::Mat output = TransformStack::render(base, target);
+    UndoHistory::record(currentEntityId, getCurrentWorkingImage(), output, description);
+    TransformStack::commit(currentEntityId, base, target, output);
+    // Imagem de trabalho anterior → nova: a mesma matriz leva as minúcias
+    if (applied) *applied = target.relativeTo(base.current);
+    return output;
 }
 
 void MainWindow::rotateRight90() {
@@ -2723,10 +3461,9 @@ void MainWindow::rotateRight90() {
     if (currentEntityType == ENTITY_FRAGMENT && !currentEntityId.isEmpty()) {
         FingerprintEnhancer::Fragment* frag = PM::instance().getCurrentProject()->findFragment(currentEntityId);
         if (frag) {
-            cv::Size oldSize = frag->workingImage.size();
-            cv::rotate(frag->workingImage, frag->workingImage, cv::ROTATE_90_CLOCKWISE);
-            cv::Size newSize = frag->workingImage.size();
-            frag->rotateMinutiae(-90.0, oldSize, newSize); // -90 porque OpenCV rotaciona no sentido horário
+            GeometricTransform applied;
+            frag->workingImage = applyGeometricStep([](const GeometricTransform& t) { return t.rotated(90.0); }, "Rotação 90° à direita", &applied);
+            FingerprintEnhancer::MinutiaeOverlay::transformMinutiae(frag, applied);
             loadCurrentEntityToView();
         }
     } else if (currentEntityType == ENTITY_IMAGE && !currentEntityId.isEmpty()) {
@@ -2734,7 +3471,7 @@ void MainWindow::rotateRight90() {
         FingerprintEnhancer::FingerprintImage* img = PM::instance().getCurrentProject()->findImage(currentEntityId);
         if (img) {
             // Rotacionar imagem
-            cv::rotate(img->workingImage, img->workingImage, cv::ROTATE_90_CLOCKWISE);
+            img->workingImage = applyGeometricStep([](const GeometricTransform& t) { return t.rotated(90.0); }, "Rotação 90° à direita");
             // Incrementar ângulo da imagem (fragmentos mantêm sourceRect em coords originais)
             img->currentRotationAngle = fmod(img->currentRotationAngle + 90.0, 360.0);
             if (img->currentRotationAngle < 0) img->currentRotationAngle += 360.0;
@@ -2744,7 +3481,7 @@ void MainWindow::rotateRight90() {
     } else {
         applyOperationToCurrentEntity([](cv::Mat& img) {
             cv::rotate(img, img, cv::ROTATE_90_CLOCKWISE);
-        });
+        }, "Rotação 90° à direita", true);
     }
     statusLabel->setText("Imagem rotacionada 90° à direita");
 }
@@ -2755,10 +3492,9 @@ void MainWindow::rotateLeft90() {
     if (currentEntityType == ENTITY_FRAGMENT && !currentEntityId.isEmpty()) {
         FingerprintEnhancer::Fragment* frag = PM::instance().getCurrentProject()->findFragment(currentEntityId);
         if (frag) {
-            cv::Size oldSize = frag->workingImage.size();
-            cv::rotate(frag->workingImage, frag->workingImage, cv::ROTATE_90_COUNTERCLOCKWISE);
-            cv::Size newSize = frag->workingImage.size();
-            frag->rotateMinutiae(90.0, oldSize, newSize);
+            GeometricTransform applied;
+            frag->workingImage = applyGeometricStep([](const GeometricTransform& t) { return t.rotated(-90.0); }, "Rotação 90° à esquerda", &applied);
+            FingerprintEnhancer::MinutiaeOverlay::transformMinutiae(frag, applied);
             loadCurrentEntityToView();
         }
     } else if (currentEntityType == ENTITY_IMAGE && !currentEntityId.isEmpty()) {
@@ -2766,7 +3502,7 @@ void MainWindow::rotateLeft90() {
         FingerprintEnhancer::FingerprintImage* img = PM::instance().getCurrentProject()->findImage(currentEntityId);
         if (img) {
             // Rotacionar imagem
-            cv::rotate(img->workingImage, img->workingImage, cv::ROTATE_90_COUNTERCLOCKWISE);
+            img->workingImage = applyGeometricStep([](const GeometricTransform& t) { return t.rotated(-90.0); }, "Rotação 90° à esquerda");
             // Atualizar ângulo acumulado
             img->currentRotationAngle = fmod(img->currentRotationAngle - 90.0, 360.0);
             if (img->currentRotationAngle < 0) img->currentRotationAngle += 360.0;
@@ -2776,7 +3512,7 @@ void MainWindow::rotateLeft90() {
     } else {
         applyOperationToCurrentEntity([](cv::Mat& img) {
             cv::rotate(img, img, cv::ROTATE_90_COUNTERCLOCKWISE);
-        });
+        }, "Rotação 90° à esquerda", true);
     }
     statusLabel->setText("Imagem rotacionada 90° à esquerda");
 }
@@ -2787,10 +3523,9 @@ void MainWindow::rotate180() {
     if (currentEntityType == ENTITY_FRAGMENT && !currentEntityId.isEmpty()) {
         FingerprintEnhancer::Fragment* frag = PM::instance().getCurrentProject()->findFragment(currentEntityId);
         if (frag) {
-            cv::Size oldSize = frag->workingImage.size();
-            cv::rotate(frag->workingImage, frag->workingImage, cv::ROTATE_180);
-            cv::Size newSize = frag->workingImage.size();
-            frag->rotateMinutiae(180.0, oldSize, newSize);
+            GeometricTransform applied;
+            frag->workingImage = applyGeometricStep([](const GeometricTransform& t) { return t.rotated(180.0); }, "Rotação 180°", &applied);
+            FingerprintEnhancer::MinutiaeOverlay::transformMinutiae(frag, applied);
             loadCurrentEntityToView();
         }
     } else if (currentEntityType == ENTITY_IMAGE && !currentEntityId.isEmpty()) {
@@ -2798,7 +3533,7 @@ void MainWindow::rotate180() {
         FingerprintEnhancer::FingerprintImage* img = PM::instance().getCurrentProject()->findImage(currentEntityId);
         if (img) {
             // Rotacionar imagem
-            cv::rotate(img->workingImage, img->workingImage, cv::ROTATE_180);
+            img->workingImage = applyGeometricStep([](const GeometricTransform& t) { return t.rotated(180.0); }, "Rotação 180°");
             // Atualizar ângulo acumulado
             img->currentRotationAngle = fmod(img->currentRotationAngle + 180.0, 360.0);
             if (img->currentRotationAngle < 0) img->currentRotationAngle += 360.0;
@@ -2808,7 +3543,7 @@ void MainWindow::rotate180() {
     } else {
         applyOperationToCurrentEntity([](cv::Mat& img) {
             cv::rotate(img, img, cv::ROTATE_180);
-        });
+        }, "Rotação 180°", true);
     }
     statusLabel->setText("Imagem rotacionada 180°");
 }
@@ -2852,6 +3587,10 @@ void MainWindow::rotateCustomAngle() {
                                                  currentImg, fragmentOverlay, 
                                                  this);
     dialog->setAttribute(Qt::WA_DeleteOnClose);
+
+    // Prévia e resultado compostos com a geometria acumulada da entidade
+    const TransformBase geometryBase = currentGeometryBase();
+    dialog->setTransformBase(geometryBase);
     
     // DESABILITAR navegação durante rotação para evitar troca de imagem
     fprintf(stderr, "[ROTATION] Desabilitando árvore de projeto e controles de painel\n");
@@ -2866,22 +3605,25 @@ void MainWindow::rotateCustomAngle() {
     }
     
     // Conectar sinal de aceitação
-    connect(dialog, &QDialog::accepted, this, [this, dialog]() {
+    connect(dialog, &QDialog::accepted, this, [this, dialog, geometryBase]() {
         if (dialog->wasAccepted()) {
             double angle = dialog->getRotationAngle();
             cv::Mat rotated = dialog->getRotatedImage();
 
             cv::Mat& workingImg = getCurrentWorkingImage();
             using PM = FingerprintEnhancer::ProjectManager;
+            UndoHistory::record(currentEntityId, workingImg, rotated,
+                                QString("Rotação de %1°").arg(angle, 0, 'f', 1));
 
             // Aplicar imagem rotacionada
-            // IMPORTANTE: As minúcias já foram rotacionadas em tempo real pelo dialog!
+            // IMPORTANTE: As minúcias já foram rotacionadas pelo dialog ao aplicar!
             // Não rotacionar novamente aqui
             if (currentEntityType == ENTITY_FRAGMENT) {
                 FingerprintEnhancer::Fragment* frag = PM::instance().getCurrentProject()->findFragment(currentEntityId);
                 if (frag) {
                     rotated.copyTo(frag->workingImage);
-                    // Minúcias já foram rotacionadas em tempo real, não fazer nada aqui
+                    TransformStack::commit(currentEntityId, geometryBase, dialog->getTargetTransform(), rotated);
+                    // Minúcias já foram rotacionadas pelo dialog, não fazer nada aqui
                     fprintf(stderr, "[ROTATION] Fragmento rotacionado %.1f graus\n", angle);
                 }
             } else if (currentEntityType == ENTITY_IMAGE) {
@@ -2892,20 +3634,19 @@ void MainWindow::rotateCustomAngle() {
                     img->currentRotationAngle = fmod(img->currentRotationAngle + angle, 360.0);
                     if (img->currentRotationAngle < 0) img->currentRotationAngle += 360.0;
                     
-                    // Se ângulo acumulado é ~0°, usar imagem original sem borda
+                    // Ângulo acumulado ~0°: a composição já voltou à geometria original, sem borda
                     if (fabs(img->currentRotationAngle) < 0.1 || fabs(img->currentRotationAngle - 360.0) < 0.1) {
-                        fprintf(stderr, "[ROTATION] Ângulo acumulado ~0° - restaurando imagem ORIGINAL (sem borda)\n");
-                        img->originalImage.copyTo(img->workingImage);  // ✅ Restaurar imagem original
                         img->currentRotationAngle = 0.0;  // Zerar ângulo
-                    } else {
-                        rotated.copyTo(img->workingImage);
-                        fprintf(stderr, "[ROTATION] Imagem rotacionada %.1f graus - ângulo acumulado: %.1f\n", 
-                                angle, img->currentRotationAngle);
                     }
+                    rotated.copyTo(img->workingImage);
+                    TransformStack::commit(currentEntityId, geometryBase, dialog->getTargetTransform(), rotated);
+                    fprintf(stderr, "[ROTATION] Imagem rotacionada %.1f graus - ângulo acumulado: %.1f\n", 
+                            angle, img->currentRotationAngle);
                 }
             } else {
                 // Fallback
                 rotated.copyTo(workingImg);
+                TransformStack::invalidate(currentEntityId);
             }
 
             // Recarregar visualização
@@ -3253,6 +3994,8 @@ void MainWindow::convertToRGB() {
     ColorConversionDialog dialog(workingImg, COLOR_SPACE_RGB, this);
     if (dialog.exec() == QDialog::Accepted && dialog.wasAccepted()) {
         cv::Mat converted = dialog.getConvertedImage();
+        UndoHistory::record(currentEntityId, workingImg, converted, "Conversão de espaço de cor");
+        TransformStack::carry(currentEntityId, workingImg, converted);
         converted.copyTo(workingImg);
         loadCurrentEntityToView();
         statusLabel->setText("Convertido para RGB com ajustes aplicados");
@@ -3279,6 +4022,8 @@ void MainWindow::convertToHSV() {
     ColorConversionDialog dialog(workingImg, COLOR_SPACE_HSV, this);
     if (dialog.exec() == QDialog::Accepted && dialog.wasAccepted()) {
         cv::Mat converted = dialog.getConvertedImage();
+        UndoHistory::record(currentEntityId, workingImg, converted, "Conversão de espaço de cor");
+        TransformStack::carry(currentEntityId, workingImg, converted);
         converted.copyTo(workingImg);
         loadCurrentEntityToView();
         statusLabel->setText("Convertido para HSV com ajustes aplicados");
@@ -3305,6 +4050,8 @@ void MainWindow::convertToHSI() {
     ColorConversionDialog dialog(workingImg, COLOR_SPACE_HSI, this);
     if (dialog.exec() == QDialog::Accepted && dialog.wasAccepted()) {
         cv::Mat converted = dialog.getConvertedImage();
+        UndoHistory::record(currentEntityId, workingImg, converted, "Conversão de espaço de cor");
+        TransformStack::carry(currentEntityId, workingImg, converted);
         converted.copyTo(workingImg);
         loadCurrentEntityToView();
         statusLabel->setText("Convertido para HSI com ajustes aplicados");
@@ -3331,6 +4078,8 @@ void MainWindow::convertToLab() {
     ColorConversionDialog dialog(workingImg, COLOR_SPACE_LAB, this);
     if (dialog.exec() == QDialog::Accepted && dialog.wasAccepted()) {
         cv::Mat converted = dialog.getConvertedImage();
+        UndoHistory::record(currentEntityId, workingImg, converted, "Conversão de espaço de cor");
+        TransformStack::carry(currentEntityId, workingImg, converted);
         converted.copyTo(workingImg);
         loadCurrentEntityToView();
         statusLabel->setText("Convertido para Lab com ajustes aplicados");
@@ -3345,7 +4094,7 @@ void MainWindow::convertToGrayscale() {
         if (img.channels() > 1) {
             cv::cvtColor(img, img, cv::COLOR_BGR2GRAY);
         }
-    });
+    }, "Conversão para escala de cinza");
     statusLabel->setText("Convertido para escala de cinza");
 }
 
@@ -3744,7 +4493,9 @@ void MainWindow::identifyFingerprint() {
     progressBar->setRange(0, 0);  // Indeterminado
 
     // Executar identificação (pode demorar)
-    QVector<AFISMatchResult> results = afisMatcher->identifyFingerprintFromImage(queryImage, 10);
+    // Escala calibrada: extração na resolução canônica, minúcias em coordenadas nativas
+    const double queryPixelsPerMM = canonicalResolutionAction->isChecked() ? imageProcessor->getScale() : 0.0;
+    QVector<AFISMatchResult> results = afisMatcher->identifyFingerprintFromImage(queryImage, 10, queryPixelsPerMM);
 
     progressBar->setVisible(false);
 
@@ -4188,6 +4939,9 @@ void MainWindow::setCurrentEntity(const QString& entityId, CurrentEntityType typ
 void MainWindow::loadCurrentEntityToView() {
     using PM = FingerprintEnhancer::ProjectManager;
 
+    // A imagem pode ter mudado no mesmo buffer: o proxy da prévia não vale mais
+    previewProxy.release();
+
     // Usar visualizador e overlay do painel ativo
     ImageViewer* activeViewer = getActiveViewer();
     FingerprintEnhancer::MinutiaeOverlay* activeOverlay = getActiveOverlay();
@@ -4232,6 +4986,7 @@ void MainWindow::loadCurrentEntityToView() {
     }
 
     activeViewer->setPixmap(QPixmap::fromImage(qimg));
+    updateQualityOverlay();
 
     // Configurar overlay se for fragmento
     if (currentEntityType == ENTITY_FRAGMENT && fragment) {
@@ -4307,7 +5062,8 @@ cv::Mat& MainWindow::getCurrentWorkingImage() {
     return emptyMat;
 }
 
-void MainWindow::applyOperationToCurrentEntity(std::function<void(cv::Mat&)> operation) {
+void MainWindow::applyOperationToCurrentEntity(std::function<void(cv::Mat&)> operation,
+                                               const QString& description, bool geometric) {
     if (currentEntityType == ENTITY_NONE || currentEntityId.isEmpty()) {
         QMessageBox::warning(this, "Erro", "Nenhuma imagem ou fragmento selecionado");
         return;
@@ -4319,8 +5075,15 @@ void MainWindow::applyOperationToCurrentEntity(std::function<void(cv::Mat&)> ope
         return;
     }
 
-    // Aplicar operação
+    // Aplicar operação (registrada no desfazer; tamanho/tipo novos viram entrada inteira)
+    cv::Mat before = workingImage.clone();
     operation(workingImage);
+    UndoHistory::record(currentEntityId, before, workingImage, description);
+    if (geometric) {
+        TransformStack::invalidate(currentEntityId);
+    } else {
+        TransformStack::carry(currentEntityId, before, workingImage);
+    }
 
     // Recarregar visualização
     loadCurrentEntityToView();
@@ -4333,19 +5096,51 @@ void MainWindow::applyOperationToCurrentEntity(std::function<void(cv::Mat&)> ope
 void MainWindow::applyOperationToCurrentEntity(std::function<void(cv::Mat&)> operation, 
                                                FingerprintEnhancer::ProcessingOperationType opType,
                                                const QString& params) {
+    // Operação in-place vira um passo fixo (sem parâmetros editáveis) do pipeline
+    applyPipelineOperation([operation](const cv::Mat& input, const QMap<QString, double>&) {
+        cv::Mat output = input.clone();
+        operation(output);
+        return output;
+    }, QMap<QString, double>(), opType, params);
+}
+
+void MainWindow::applyPipelineOperation(PipelineStepFunction stepFunction, const QMap<QString, double>& values,
+                                        FingerprintEnhancer::ProcessingOperationType opType,
+                                        const QString& params, PipelineLutFunction pointLut) {
     if (currentEntityType == ENTITY_NONE || currentEntityId.isEmpty()) {
         QMessageBox::warning(this, "Erro", "Nenhuma imagem ou fragmento selecionado");
         return;
     }
 
+    if (isProcessing) {
+        QMessageBox::warning(this, "Processing",
+            "Another processing operation is already running. Please wait.");
+        return;
+    }
+
     cv::Mat& workingImage = getCurrentWorkingImage();
-    if (workingImage.empty()) {
+    ProcessingPipeline *pipeline = currentPipeline();
+    if (workingImage.empty() || !pipeline) {
         QMessageBox::warning(this, "Erro", "Imagem de trabalho inválida");
         return;
     }
 
-    // Aplicar operação
-    operation(workingImage);
+    // Aplicar operação: só o novo passo é calculado, a partir da saída em cache
+    if (pointLut) {
+        pipeline->appendPointStep(pipelineStepName(opType, params), values, stepFunction, pointLut);
+    } else {
+        pipeline->appendStep(pipelineStepName(opType, params), values, stepFunction);
+    }
+    cv::Mat result = pipeline->evaluate();
+    if (result.empty()) {
+        pipeline->removeStep(pipeline->stepCount() - 1);
+        QMessageBox::warning(this, "Erro", "A operação não produziu resultado");
+        return;
+    }
+    pipeline->setHistoryEntry(pipeline->stepCount() - 1, static_cast<int>(opType), params);
+    UndoHistory::record(currentEntityId, workingImage, result, pipelineStepName(opType, params));
+    TransformStack::carry(currentEntityId, workingImage, result);
+    result.copyTo(workingImage);
 
     // Registrar no histórico
     using PM = FingerprintEnhancer::ProjectManager;
@@ -4368,6 +5163,135 @@ void MainWindow::applyOperationToCurrentEntity(std::function<void(cv::Mat&)> ope
     PM::instance().getCurrentProject()->setModified();
 }
 
+ProcessingPipeline* MainWindow::currentPipeline() {
+    if (currentEntityType == ENTITY_NONE || currentEntityId.isEmpty()) return nullptr;
+
+    cv::Mat& workingImage = getCurrentWorkingImage();
+    if (workingImage.empty()) return nullptr;
+
+    std::shared_ptr<ProcessingPipeline>& pipeline = entityPipelines[currentEntityId];
+    if (!pipeline) {
+        pipeline = std::make_shared<ProcessingPipeline>();
+    }
+
+    // Edições feitas fora do pipeline (rotação, recorte, restauração, diálogos):
+    // os passos anteriores não reproduzem mais a imagem, então ela vira a nova origem
+    if (pipeline->isEmpty() || pipeline->outputHash() != RidgeGeometry::contentHash(workingImage)) {
+        if (pipeline->stepCount() > 0) {
+            fprintf(stderr, "[MAINWINDOW] Imagem alterada fora do pipeline: %d passos consolidados na origem\n",
+                    pipeline->stepCount());
+        }
+        pipeline->reset(workingImage);
+    }
+    return pipeline.get();
+}
+
+QString MainWindow::pipelineStepName(FingerprintEnhancer::ProcessingOperationType opType, const QString& params) {
+    using OT = FingerprintEnhancer::ProcessingOperationType;
+
+    QString name;
+    switch (opType) {
+        case OT::GAUSSIAN_BLUR:       name = "Desfoque gaussiano"; break;
+        case OT::SHARPEN:             name = "Nitidez"; break;
+        case OT::GABOR_ENHANCE:       name = "Realce Gabor"; break;
+        case OT::COHERENCE_DIFFUSION: name = "Difusão coerente"; break;
+        case OT::BRIGHTNESS_CONTRAST: name = "Brilho/Contraste"; break;
+        case OT::EQUALIZE_HISTOGRAM:  name = "Equalizar histograma"; break;
+        case OT::CLAHE:               name = "CLAHE"; break;
+        case OT::INVERT_COLORS:       name = "Inverter cores"; break;
+        case OT::BINARIZE:            name = "Binarizar"; break;
+        case OT::ADAPTIVE_THRESHOLD:  name = "Binarização adaptativa"; break;
+        case OT::SUBTRACT_BACKGROUND: name = "Subtrair fundo"; break;
+        default:                      name = "Operação"; break;
+    }
+    return params.isEmpty() ? name : QString("%1 (%2)").arg(name, params);
+}
+
+void MainWindow::editProcessingPipeline() {
+    if (isProcessing) {
+        QMessageBox::warning(this, "Processing",
+            "Another processing operation is already running. Please wait.");
+        return;
+    }
+
+    ProcessingPipeline *pipeline = currentPipeline();
+    if (!pipeline) {
+        QMessageBox::warning(this, "Pipeline", "Nenhuma imagem ou fragmento selecionado");
+        return;
+    }
+    if (pipeline->stepCount() == 0) {
+        QMessageBox::information(this, "Pipeline",
+            "Nenhuma operação registrada desde a última edição fora do pipeline.");
+        return;
+    }
+
+    ProcessingPipelineDialog dialog(*pipeline, this);
+    if (dialog.exec() != QDialog::Accepted) return;
+    const int historyEntries = pipeline->historyEntryCount();
+
+    // Aplicar parâmetros e ativação; remoções do fim para o início
+    const std::vector<PipelineStepInfo>& edited = dialog.editedSteps();
+    for (int i = 0; i < static_cast<int>(edited.size()); ++i) {
+        const PipelineStepInfo current = pipeline->stepInfo(i);
+        if (current.values != edited[i].values && current.historyType >= 0) {
+            // Parâmetros editados: o texto original da operação não vale mais
+            QStringList params;
+            for (auto it = edited[i].values.constBegin(); it != edited[i].values.constEnd(); ++it) {
+                params << QString("%1=%2").arg(it.key()).arg(it.value());
+            }
+            pipeline->setHistoryEntry(i, current.historyType, params.join(", "));
+        }
+        pipeline->setValues(i, edited[i].values);
+        pipeline->setEnabled(i, edited[i].enabled);
+    }
+    QVector<int> removed = dialog.removedSteps();
+    for (int i = removed.size() - 1; i >= 0; --i) {
+        pipeline->removeStep(removed[i]);
+    }
+
+    const int firstDirty = pipeline->firstDirtyStep();
+    if (firstDirty >= pipeline->stepCount() && removed.isEmpty()) {
+        statusLabel->setText("Pipeline sem alterações");
+        return;
+    }
+
+    // Recalcular a partir do primeiro passo alterado, fora da thread da interface
+    std::shared_ptr<ProcessingPipeline> shared = entityPipelines.value(currentEntityId);
+    const int total = pipeline->stepCount();
+    runProcessingInThread([shared](const cv::Mat&, int& progress) -> cv::Mat {
+        return shared->evaluate([&progress](int done, int steps) {
+            progress = steps > 0 ? 100 * done / steps : 100;
+            return true;
+        });
+    });
+    pendingStatusText = QString("Pipeline recalculado a partir do passo %1 de %2")
+                        .arg(std::min(firstDirty, total - 1) + 1).arg(total);
+    pendingHistorySyncEntries = isProcessing ? historyEntries : -1;
+}
+
+void MainWindow::syncProcessingHistory(ProcessingPipeline *pipeline, int previousEntries) {
+    // O fim do histórico da entidade espelha os passos ativos do pipeline: reescrever esse trecho
+    using PM = FingerprintEnhancer::ProjectManager;
+    auto rewrite = [pipeline, previousEntries](auto& history) {
+        if (history.size() < previousEntries) return;
+        for (int i = 0; i < previousEntries; ++i) history.removeLast();
+        for (int i = 0; i < pipeline->stepCount(); ++i) {
+            const PipelineStepInfo info = pipeline->stepInfo(i);
+            if (!info.enabled || info.historyType < 0) continue;
+            history.append(FingerprintEnhancer::ProcessingOperation(
+                static_cast<FingerprintEnhancer::ProcessingOperationType>(info.historyType), info.historyParams));
+        }
+    };
+
+    if (currentEntityType == ENTITY_IMAGE) {
+        FingerprintEnhancer::FingerprintImage* image = PM::instance().getCurrentProject()->findImage(currentEntityId);
+        if (image) rewrite(image->processingHistory);
+    } else if (currentEntityType == ENTITY_FRAGMENT) {
+        FingerprintEnhancer::Fragment* fragment = PM::instance().getCurrentProject()->findFragment(currentEntityId);
+        if (fragment) rewrite(fragment->processingHistory);
+    }
+}
+
 QRect MainWindow::convertRotatedToOriginalCoords(const QRect& rotatedRect, double currentAngle,
                                                   const QSize& currentSize, const QSize& originalSize) {
     // Se não há rotação, retornar direto
@@ -4480,15 +5404,15 @@ void MainWindow::flipHorizontal() {
     if (currentEntityType == ENTITY_FRAGMENT && !currentEntityId.isEmpty()) {
         FingerprintEnhancer::Fragment* frag = PM::instance().getCurrentProject()->findFragment(currentEntityId);
         if (frag) {
-            int imageWidth = frag->workingImage.cols;
-            cv::flip(frag->workingImage, frag->workingImage, 1); // 1 = horizontal
-            frag->flipMinutiaeHorizontal(imageWidth);
+            GeometricTransform applied;
+            frag->workingImage = applyGeometricStep([](const GeometricTransform& t) { return t.flippedHorizontal(); }, "Espelhamento horizontal", &applied);
+            FingerprintEnhancer::MinutiaeOverlay::transformMinutiae(frag, applied);
             loadCurrentEntityToView();
         }
     } else if (currentEntityType == ENTITY_IMAGE && !currentEntityId.isEmpty()) {
         FingerprintEnhancer::FingerprintImage* img = PM::instance().getCurrentProject()->findImage(currentEntityId);
         if (img) {
-            cv::flip(img->workingImage, img->workingImage, 1); // 1 = horizontal
+            img->workingImage = applyGeometricStep([](const GeometricTransform& t) { return t.flippedHorizontal(); }, "Espelhamento horizontal");
             img->addFlipHorizontal(); // Registrar no histórico
             loadCurrentEntityToView();
             PM::instance().getCurrentProject()->setModified();
@@ -4496,7 +5420,7 @@ void MainWindow::flipHorizontal() {
     } else {
         applyOperationToCurrentEntity([](cv::Mat& img) {
             cv::flip(img, img, 1); // 1 = horizontal
-        });
+        }, "Espelhamento horizontal", true);
     }
     statusLabel->setText("Espelhamento horizontal aplicado");
 }
@@ -4507,15 +5431,15 @@ void MainWindow::flipVertical() {
     if (currentEntityType == ENTITY_FRAGMENT && !currentEntityId.isEmpty()) {
         FingerprintEnhancer::Fragment* frag = PM::instance().getCurrentProject()->findFragment(currentEntityId);
         if (frag) {
-            int imageHeight = frag->workingImage.rows;
-            cv::flip(frag->workingImage, frag->workingImage, 0); // 0 = vertical
-            frag->flipMinutiaeVertical(imageHeight);
+            GeometricTransform applied;
+            frag->workingImage = applyGeometricStep([](const GeometricTransform& t) { return t.flippedVertical(); }, "Espelhamento vertical", &applied);
+            FingerprintEnhancer::MinutiaeOverlay::transformMinutiae(frag, applied);
             loadCurrentEntityToView();
         }
     } else if (currentEntityType == ENTITY_IMAGE && !currentEntityId.isEmpty()) {
         FingerprintEnhancer::FingerprintImage* img = PM::instance().getCurrentProject()->findImage(currentEntityId);
         if (img) {
-            cv::flip(img->workingImage, img->workingImage, 0); // 0 = vertical
+            img->workingImage = applyGeometricStep([](const GeometricTransform& t) { return t.flippedVertical(); }, "Espelhamento vertical");
             img->addFlipVertical(); // Registrar no histórico
             loadCurrentEntityToView();
             PM::instance().getCurrentProject()->setModified();
@@ -4523,7 +5447,7 @@ void MainWindow::flipVertical() {
     } else {
         applyOperationToCurrentEntity([](cv::Mat& img) {
             cv::flip(img, img, 0); // 0 = vertical
-        });
+        }, "Espelhamento vertical", true);
     }
     statusLabel->setText("Espelhamento vertical aplicado");
 }
@@ -4604,6 +5528,7 @@ void MainWindow::onResetWorkingRequested(const QString& entityId, bool isFragmen
         FingerprintEnhancer::Fragment* frag = PM::instance().getCurrentProject()->findFragment(entityId);
         if (frag) {
             frag->resetWorkingImage();
+            TransformStack::invalidate(entityId);
             PM::instance().getCurrentProject()->setModified();
 
             // Se é a entidade corrente, atualizar visualização
@@ -4619,6 +5544,7 @@ void MainWindow::onResetWorkingRequested(const QString& entityId, bool isFragmen
         FingerprintEnhancer::FingerprintImage* img = PM::instance().getCurrentProject()->findImage(entityId);
         if (img) {
             img->resetWorkingImage();
+            TransformStack::invalidate(entityId);
             PM::instance().getCurrentProject()->setModified();
 
             // Se é a entidade corrente, atualizar visualização
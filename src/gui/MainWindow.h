@@ -27,10 +27,15 @@ Q_DECLARE_LOGGING_CATEGORY(mainwindow)
 #include <QtWidgets/QListWidget>
 #include <QtWidgets/QTabWidget>
 #include <QtCore/QTimer>
+#include <QtCore/QHash>
+#include <memory>
 
 #include "../core/ProjectManager.h"
 #include "../core/ImageProcessor.h"
 #include "../core/MinutiaeExtractor.h"
+#include "../core/TileScheduler.h"
+#include "../core/ProcessingPipeline.h"
+#include "../core/GeometricTransform.h"
 #include "ImageViewer.h"
 #include "MinutiaeEditor.h"
 #include "CropTool.h"
@@ -103,12 +108,17 @@ private slots:
     // Menu Edit
     void resetToOriginal();
     void undoLastOperation();
+    void redoLastOperation();
+    void editProcessingPipeline();
+    void configureMemoryBudgets();
     
     // Menu Enhancement
     void openFFTDialog();
     void subtractBackground();
     void applyGaussianBlur();
     void applySharpenFilter();
+    void applyGaborEnhancement();
+    void applyCoherenceDiffusion();
     void adjustBrightnessContrast();
     void applyBrightnessContrast();  // Aplica valores dos sliders
     void equalizeHistogram();
@@ -130,6 +140,7 @@ private slots:
     void zoomActual();
     void toggleSideBySide();
     void toggleRightPanel();
+    void toggleQualityMap();
     void configureMinutiaeDisplay();
 
     // Menu Tools
@@ -216,14 +227,18 @@ private slots:
     void addMinutiaAtPosition(const QPoint &imagePos);
     void addMinutiaQuickly(const QPoint &imagePos); // Inserção rápida sem diálogo
 
-    // Função auxiliar
-    cv::Mat rotateImagePreservingSize(const cv::Mat &image, double angle);
+    // Rotações e espelhamentos compostos (TransformStack): uma reamostragem a partir da base
+    TransformBase currentGeometryBase();
+    cv::Mat applyGeometricStep(const TransformStack::Step& step, const QString& description,
+                               GeometricTransform* applied = nullptr);
     void updateStatusBar();
 
     // Processing com threading
     void onProcessingProgress(int percentage);
     void onProcessingCompleted(cv::Mat result);
     void onProcessingFailed(QString errorMessage);
+    void onProcessingCancelled();
+    void cancelProcessing();
     void onProcessingStatus(QString message);
 
     // Image loading com threading
@@ -267,10 +282,16 @@ private slots:
     void setCurrentEntity(const QString& entityId, CurrentEntityType type);
     void loadCurrentEntityToView();
     cv::Mat& getCurrentWorkingImage();  // Retorna referência para workingImage da entidade corrente
-    void applyOperationToCurrentEntity(std::function<void(cv::Mat&)> operation);
+    // Operação in-place fora do pipeline; geometric: muda a geometria (invalida a pilha de transformações)
+    void applyOperationToCurrentEntity(std::function<void(cv::Mat&)> operation,
+                                       const QString& description, bool geometric = false);
     void applyOperationToCurrentEntity(std::function<void(cv::Mat&)> operation, 
                                        FingerprintEnhancer::ProcessingOperationType opType,
                                        const QString& params);
+    // pointLut: tabela equivalente de uma operação pontual, para fundir passos consecutivos
+    void applyPipelineOperation(PipelineStepFunction stepFunction, const QMap<QString, double>& values,
+                                FingerprintEnhancer::ProcessingOperationType opType,
+                                const QString& params, PipelineLutFunction pointLut = nullptr);
     
     // Funções auxiliares para conversão de coordenadas com rotação
     QRect convertRotatedToOriginalCoords(const QRect& rotatedRect, double currentAngle, 
@@ -416,6 +437,7 @@ private:
     QAction *switchPanelAction;
     QAction *toggleRightPanelAction;
     QProgressBar *progressBar;
+    QPushButton *cancelProcessingButton;  // Visível enquanto o worker de processamento roda
     
     // Actions para sincronização
     QAction *editModeAction;           // Menu: Modo de Edição Interativa
@@ -425,6 +447,10 @@ private:
     QAction *noneToolAction;           // Ferramenta: Selecionar
     QAction *cropToolAction;           // Ferramenta: Recortar
     QAction *addMinutiaAction;         // Ferramenta: Adicionar Minúcia
+
+    QAction *restrictToPrintAction;    // Realce: processar só a área da impressão
+    QAction *canonicalResolutionAction;  // Realce: processar a 500 ppi
+    QAction *qualityMapAction;         // Visualizar: mapa de qualidade
     
     // Métodos de inicialização
     void setupUI();
@@ -442,9 +468,45 @@ private:
     void showProcessingProgress(const QString &operation);
     void hideProcessingProgress();
     void applyGlobalDisplaySettings();
+    void applyMemoryBudgets();  // Orçamentos de memória salvos (QSettings)
     QString formatImageInfo(const cv::Size &size, double scale);
+    void syncProcessingHistory(ProcessingPipeline *pipeline, int previousEntries);
     void runProcessingInThread(std::function<cv::Mat(const cv::Mat&, int&)> processingFunc);
+    void runProcessingInThread(std::function<cv::Mat(const cv::Mat&, int&)> processingFunc,
+                               FingerprintEnhancer::ProcessingOperationType opType,
+                               const QString& params, const QString& statusText);
+    void runTiledOperation(int halo, TileFilter filter, int outputType,
+                           FingerprintEnhancer::ProcessingOperationType opType,
+                           const QString& params, const QString& statusText);
+    void runTiledOperation(int halo, TileFilter filter, int outputType, const QString& statusText);
+    void runPipelineStep(PipelineStepFunction stepFunction, const QMap<QString, double>& values,
+                         FingerprintEnhancer::ProcessingOperationType opType,
+                         const QString& params, const QString& statusText);
+    bool startProcessingWorker(class ProcessingWorker *worker);
+
+    // Pipeline de processamento não destrutivo por entidade
+    ProcessingPipeline* currentPipeline();
+    static QString pipelineStepName(FingerprintEnhancer::ProcessingOperationType opType, const QString& params);
+
+    // Escala da entidade atual (px/mm); 500 ppi se não calibrada
+    double currentPixelsPerMM(bool* known = nullptr);
+
+    // Fator nativo → 500 ppi da entidade atual; 1 se a opção está desligada ou a escala é desconhecida
+    double canonicalScaleForCurrentEntity();
+
+    // Desfazer/refazer da entidade atual (UndoHistory + pipeline)
+    void undoRedoCurrentEntity(bool undo);
     void applyBrightnessContrastRealtime();
+
+    // Prévia ao vivo dos controles deslizantes: proxy do trecho visível na
+    // resolução da tela; a versão em resolução total só roda ao soltar o
+    // controle ou após debounceMs sem mudanças
+    void showLivePreview(std::function<cv::Mat(const cv::Mat& proxy, double scale)> operation,
+                         std::function<void()> commit, int debounceMs);
+    void commitLivePreview();
+
+    // Mapa de qualidade por bloco sobre o visualizador ativo (se habilitado)
+    void updateQualityOverlay();
     
     // Membros para controle de estado
     bool sideBySideMode;
@@ -457,6 +519,25 @@ private:
     class ProcessingWorker *processingWorker;
     bool isProcessing;
 
+    // Histórico da operação em execução, registrado em onProcessingCompleted
+    bool hasPendingHistory;
+    FingerprintEnhancer::ProcessingOperationType pendingHistoryType;
+    QString pendingHistoryParams;
+    QString pendingStatusText;
+    PipelineStepFunction pendingPipelineFunction;   // Passo reexecutável da operação em execução
+    QMap<QString, double> pendingPipelineValues;
+    int pendingHistorySyncEntries;                  // Edição do pipeline: entradas a reescrever no histórico (-1 = nenhuma)
+
+    // Pipelines por entidade (imagem ou fragmento), com saídas intermediárias em cache
+    QHash<QString, std::shared_ptr<ProcessingPipeline>> entityPipelines;
+
+    // Prévia ao vivo (proxy reaproveitado enquanto o trecho visível não muda)
+    QTimer *previewCommitTimer;
+    cv::Mat previewProxy;
+    QRect previewProxyRect;
+    QString previewEntityId;
+    std::function<void()> pendingPreviewCommit;
+
     // Image loading threading
     class FingerprintEnhancer::ImageLoaderWorker *imageLoaderWorker;
     bool isLoadingImages;
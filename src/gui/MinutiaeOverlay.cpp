@@ -93,7 +93,8 @@ void MinutiaeOverlay::paintEvent(QPaintEvent *event) {
 
     // Desenhar todas as minúcias
     int number = 1;
-    for (const auto& minutia : currentFragment->minutiae) {
+    for (const auto& stored : currentFragment->minutiae) {
+        const Minutia minutia = previewed(stored);
         bool isSelected = (minutia.id == selectedMinutiaId);
         QPoint scaledPos = scalePoint(minutia.position);
         
@@ -117,7 +118,7 @@ void MinutiaeOverlay::paintEvent(QPaintEvent *event) {
     if (editMode && !selectedMinutiaId.isEmpty()) {
         for (const auto& minutia : currentFragment->minutiae) {
             if (minutia.id == selectedMinutiaId) {
-                QPoint scaledPos = scalePoint(minutia.position);
+                QPoint scaledPos = scalePoint(previewed(minutia).position);
                 drawEditStateIndicator(painter, scaledPos);
                 break;
             }
@@ -125,6 +126,27 @@ void MinutiaeOverlay::paintEvent(QPaintEvent *event) {
     }
 }
 
+Minutia MinutiaeOverlay::previewed(const Minutia& minutia) const {
+    if (!previewTransform.isValid()) return minutia;
+    return transformed(minutia, previewTransform);
+}
+
+Minutia MinutiaeOverlay::transformed(const Minutia& minutia, const GeometricTransform& transform) {
+    // Posição e direção pela mesma matriz: prévia e resultado aplicado coincidem
+    Minutia result = minutia;
+    const cv::Point2d p = transform.map(cv::Point2d(minutia.position.x(), minutia.position.y()));
+    result.position = QPoint(cvRound(p.x), cvRound(p.y));
+    result.angle = static_cast<float>(transform.mapAngle(minutia.angle));
+    return result;
+}
+
+void MinutiaeOverlay::transformMinutiae(Fragment* fragment, const GeometricTransform& transform) {
+    if (!fragment || !transform.isValid() || transform.isIdentity()) return;
+    for (auto& minutia : fragment->minutiae) {
+        minutia = transformed(minutia, transform);
+    }
+}
+
 void MinutiaeOverlay::drawMinutia(QPainter& painter, const Minutia& minutia, bool isSelected) {
     QPoint pos = scalePoint(minutia.position);
     
@@ -7,6 +7,7 @@
 #include <QPoint>
 #include "../core/ProjectModel.h"
 #include "MinutiaeDisplayDialog.h"
+#include "../core/GeometricTransform.h"
 
 namespace FingerprintEnhancer {
 
@@ -37,6 +38,20 @@ public:
     void setImageOffset(const QPoint& offset);  // Offset de centralização da imagem
     void clearMinutiae();
 
+    // Prévia de rotação: transformação imagem do fragmento → imagem exibida (minúcias não são alteradas)
+    void setPreviewTransform(const GeometricTransform& transform) { previewTransform = transform; update(); }
+    void clearPreviewTransform() { previewTransform = GeometricTransform(); update(); }
+
+    /**
+     * @brief Minúcia levada pela transformação (posição e direção), como na prévia
+     */
+    static Minutia transformed(const Minutia& minutia, const GeometricTransform& transform);
+
+    /**
+     * @brief Aplica às minúcias do fragmento a transformação imagem anterior → nova imagem
+     */
+    static void transformMinutiae(Fragment* fragment, const GeometricTransform& transform);
+
     // Controle de seleção
     void setSelectedMinutia(const QString& minutiaId);
     QString getSelectedMinutiaId() const { return selectedMinutiaId; }
@@ -137,12 +152,15 @@ private:
     QPointF connectionLineStart;
     QPointF connectionLineEnd;
 
+    GeometricTransform previewTransform;
+
     // Helper functions
     void drawMinutia(QPainter& painter, const Minutia& minutia, bool isSelected);
     void drawMinutiaWithArrow(QPainter& painter, const QPoint& pos, float angle, const QColor& color, bool isSelected);
     void drawMinutiaLabel(QPainter& painter, const Minutia& minutia, const QPoint& pos, int number, const QString& type, bool isSelected);
     void drawEditStateIndicator(QPainter& painter, const QPoint& pos);
 
+    Minutia previewed(const Minutia& minutia) const;
     Minutia* findMinutiaAt(const QPoint& pos);
     QPoint scalePoint(const QPoint& imagePoint) const;
     QPoint unscalePoint(const QPoint& widgetPoint) const;
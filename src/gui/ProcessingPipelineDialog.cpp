@@ -0,0 +1,138 @@
+#include "ProcessingPipelineDialog.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QSplitter>
+#include <QGroupBox>
+#include <QHeaderView>
+#include <QDoubleSpinBox>
+#include <QDialogButtonBox>
+
+ProcessingPipelineDialog::ProcessingPipelineDialog(const ProcessingPipeline &pipeline, QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle("Pipeline de Processamento");
+    resize(700, 420);
+
+    for (int i = 0; i < pipeline.stepCount(); ++i) {
+        steps.push_back(pipeline.stepInfo(i));
+    }
+    removed = QVector<bool>(static_cast<int>(steps.size()), false);
+
+    setupUI();
+}
+
+void ProcessingPipelineDialog::setupUI() {
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    infoLabel = new QLabel(
+        "Passos aplicados à imagem, a partir da origem. Desmarque para desativar um passo;\n"
+        "ao aceitar, apenas os passos a partir do primeiro alterado são recalculados.");
+    infoLabel->setWordWrap(true);
+    mainLayout->addWidget(infoLabel);
+
+    QSplitter *splitter = new QSplitter(Qt::Horizontal);
+
+    // Lista de passos
+    QGroupBox *stepsGroup = new QGroupBox("Passos");
+    QVBoxLayout *stepsLayout = new QVBoxLayout(stepsGroup);
+    stepList = new QListWidget();
+    for (int i = 0; i < static_cast<int>(steps.size()); ++i) {
+        QListWidgetItem *item = new QListWidgetItem(QString("%1. %2").arg(i + 1).arg(steps[i].name));
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(steps[i].enabled ? Qt::Checked : Qt::Unchecked);
+        item->setData(Qt::UserRole, i);
+        stepList->addItem(item);
+    }
+    stepsLayout->addWidget(stepList);
+
+    removeButton = new QPushButton("Remover Passo");
+    removeButton->setEnabled(false);
+    stepsLayout->addWidget(removeButton);
+    splitter->addWidget(stepsGroup);
+
+    // Parâmetros do passo selecionado
+    QGroupBox *paramsGroup = new QGroupBox("Parâmetros");
+    QVBoxLayout *paramsLayout = new QVBoxLayout(paramsGroup);
+    parameterTable = new QTableWidget(0, 2);
+    parameterTable->setHorizontalHeaderLabels({"Parâmetro", "Valor"});
+    parameterTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    parameterTable->verticalHeader()->setVisible(false);
+    paramsLayout->addWidget(parameterTable);
+    splitter->addWidget(paramsGroup);
+
+    mainLayout->addWidget(splitter);
+
+    QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    buttons->button(QDialogButtonBox::Ok)->setText("Recalcular");
+    buttons->button(QDialogButtonBox::Cancel)->setText("Cancelar");
+    mainLayout->addWidget(buttons);
+
+    connect(stepList, &QListWidget::currentRowChanged, this, &ProcessingPipelineDialog::onStepSelected);
+    connect(stepList, &QListWidget::itemChanged, this, &ProcessingPipelineDialog::onStepItemChanged);
+    connect(removeButton, &QPushButton::clicked, this, &ProcessingPipelineDialog::onRemoveStep);
+    connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    if (stepList->count() > 0) {
+        stepList->setCurrentRow(stepList->count() - 1);
+    }
+}
+
+QVector<int> ProcessingPipelineDialog::removedSteps() const {
+    QVector<int> indices;
+    for (int i = 0; i < removed.size(); ++i) {
+        if (removed[i]) indices.append(i);
+    }
+    return indices;
+}
+
+void ProcessingPipelineDialog::onStepSelected(int row) {
+    removeButton->setEnabled(row >= 0);
+    QListWidgetItem *item = stepList->item(row);
+    populateParameters(item ? item->data(Qt::UserRole).toInt() : -1);
+}
+
+void ProcessingPipelineDialog::onStepItemChanged(QListWidgetItem *item) {
+    int index = item->data(Qt::UserRole).toInt();
+    steps[index].enabled = (item->checkState() == Qt::Checked);
+}
+
+void ProcessingPipelineDialog::onRemoveStep() {
+    QListWidgetItem *item = stepList->currentItem();
+    if (!item) return;
+
+    removed[item->data(Qt::UserRole).toInt()] = true;
+    delete stepList->takeItem(stepList->row(item));
+}
+
+void ProcessingPipelineDialog::populateParameters(int stepIndex) {
+    parameterTable->setRowCount(0);
+    if (stepIndex < 0) return;
+
+    const QMap<QString, double> &values = steps[stepIndex].values;
+    if (values.isEmpty()) {
+        parameterTable->setRowCount(1);
+        QTableWidgetItem *note = new QTableWidgetItem("(sem parâmetros editáveis)");
+        note->setFlags(Qt::ItemIsEnabled);
+        parameterTable->setItem(0, 0, note);
+        return;
+    }
+
+    parameterTable->setRowCount(values.size());
+    int row = 0;
+    for (auto it = values.constBegin(); it != values.constEnd(); ++it, ++row) {
+        QTableWidgetItem *name = new QTableWidgetItem(it.key());
+        name->setFlags(Qt::ItemIsEnabled);
+        parameterTable->setItem(row, 0, name);
+
+        QDoubleSpinBox *spin = new QDoubleSpinBox();
+        spin->setRange(-1e6, 1e6);
+        spin->setDecimals(3);
+        spin->setValue(it.value());
+        const QString key = it.key();
+        connect(spin, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, [this, stepIndex, key](double value) {
+            steps[stepIndex].values[key] = value;
+        });
+        parameterTable->setCellWidget(row, 1, spin);
+    }
+}
@@ -0,0 +1,54 @@
+#ifndef PROCESSINGPIPELINEDIALOG_H
+#define PROCESSINGPIPELINEDIALOG_H
+
+#include <QDialog>
+#include <QListWidget>
+#include <QTableWidget>
+#include <QLabel>
+#include <QPushButton>
+#include <QVector>
+#include <vector>
+#include "../core/ProcessingPipeline.h"
+
+/**
+ * @brief Diálogo para editar o pipeline de processamento de uma entidade
+ *
+ * Lista os passos aplicados, permite ativar/desativar, remover e alterar os
+ * parâmetros numéricos. As alterações ficam pendentes até o usuário aceitar;
+ * a MainWindow então recalcula apenas os passos a partir do primeiro alterado.
+ */
+class ProcessingPipelineDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    ProcessingPipelineDialog(const ProcessingPipeline &pipeline, QWidget *parent = nullptr);
+
+    /**
+     * @brief Estado editado de cada passo, na numeração original
+     */
+    const std::vector<PipelineStepInfo>& editedSteps() const { return steps; }
+
+    /**
+     * @brief Índices (numeração original) dos passos removidos
+     */
+    QVector<int> removedSteps() const;
+
+private slots:
+    void onStepSelected(int row);
+    void onStepItemChanged(QListWidgetItem *item);
+    void onRemoveStep();
+
+private:
+    void setupUI();
+    void populateParameters(int stepIndex);
+
+    std::vector<PipelineStepInfo> steps;
+    QVector<bool> removed;
+
+    QListWidget *stepList;
+    QTableWidget *parameterTable;
+    QLabel *infoLabel;
+    QPushButton *removeButton;
+};
+
+#endif // PROCESSINGPIPELINEDIALOG_H
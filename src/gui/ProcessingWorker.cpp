@@ -1,9 +1,21 @@
 #include "ProcessingWorker.h"
+#include "../core/Thinning.h"
+#include "../core/RidgeGeometry.h"
+#include "../core/GaborEnhancer.h"
+#include "../core/FFTService.h"
+#include "../core/FrequencyFilter.h"
+#include "../core/NotchDetector.h"
+#include "../core/BackgroundEstimator.h"
+#include "../core/AdaptiveThreshold.h"
+#include "../core/CoherenceDiffusion.h"
+#include "../core/ResolutionPyramid.h"
 #include <opencv2/imgproc.hpp>
 #include <QDebug>
 
 ProcessingWorker::ProcessingWorker(QObject *parent)
-    : QObject(parent), operationType(CUSTOM), cancelled(false) {
+    : QObject(parent), operationType(CUSTOM), tileHalo(0), tileOutputType(-1),
+      frequencyMaskInverted(false), restrictToPrint(false), canonicalScale(1.0),
+      cancelled(false) {
 }
 
 ProcessingWorker::~ProcessingWorker() {
@@ -18,6 +30,13 @@ void ProcessingWorker::setCustomOperation(ProcessingFunction func) {
     operationType = CUSTOM;
 }
 
+void ProcessingWorker::setTiledOperation(int halo, TileFilter filter, int outputType) {
+    tileFilter = filter;
+    tileHalo = halo;
+    tileOutputType = outputType;
+    operationType = TILED;
+}
+
 void ProcessingWorker::setInputImage(const cv::Mat &image) {
     inputImage = image.clone();
 }
@@ -26,6 +45,36 @@ void ProcessingWorker::setParameter(const QString &key, double value) {
     parameters[key] = value;
 }
 
+void ProcessingWorker::setCacheKey(const QString &key) {
+    cacheKey = key;
+}
+
+void ProcessingWorker::setRestrictToPrint(bool enabled) {
+    restrictToPrint = enabled;
+}
+
+void ProcessingWorker::setCanonicalScale(double scale) {
+    canonicalScale = scale;
+}
+
+void ProcessingWorker::setFrequencyMask(const QVector<QRect> &rects, bool invert) {
+    frequencyMask = rects;
+    frequencyMaskInverted = invert;
+}
+
+std::shared_ptr<const RidgeMask> ProcessingWorker::printMask(int blockSize) {
+    if (!restrictToPrint) return nullptr;
+
+    RidgeMaskConfig config;
+    config.blockSize = blockSize;
+    std::shared_ptr<const RidgeMask> mask = RidgeSegmentation::restricting(cacheKey, inputImage, config);
+    if (mask) {
+        emit statusMessage(QString("Restricting to print area (%1% of image)...")
+                           .arg(100.0 * mask->coverage(), 0, 'f', 0));
+    }
+    return mask;
+}
+
 void ProcessingWorker::cancel() {
     cancelled = true;
 }
@@ -36,10 +85,23 @@ void ProcessingWorker::process() {
         return;
     }
 
-    cancelled = false;
     cv::Mat result;
     int progress = 0;
 
+    // Operações no nível das cristas rodam na resolução canônica; os caches
+    // do nível reduzido usam outra chave para não disputar com a imagem nativa
+    const bool canonical = canonicalScale < 1.0 &&
+                           (operationType == GABOR_ENHANCE || operationType == COHERENCE_DIFFUSION);
+    const cv::Mat nativeInput = inputImage;
+    const QString nativeKey = cacheKey;
+    if (canonical) {
+        inputImage = nativeKey.isEmpty() ? ResolutionPyramid::downscale(nativeInput, canonicalScale)
+                                         : *ResolutionPyramid::level(nativeKey, nativeInput, canonicalScale);
+        if (!nativeKey.isEmpty()) cacheKey = nativeKey + "#canonical";
+        emit statusMessage(QString("Processing at canonical resolution (%1x%2)...")
+                           .arg(inputImage.cols).arg(inputImage.rows));
+    }
+
     try {
         emit statusMessage("Processing started...");
         emit progressUpdated(0);
@@ -69,6 +131,21 @@ void ProcessingWorker::process() {
             case EQUALIZE_HISTOGRAM:
                 result = processEqualizeHistogram(progress);
                 break;
+            case GABOR_ENHANCE:
+                result = processGaborEnhance(progress);
+                break;
+            case SUBTRACT_BACKGROUND:
+                result = processSubtractBackground(progress);
+                break;
+            case ADAPTIVE_THRESHOLD:
+                result = processAdaptiveThreshold(progress);
+                break;
+            case COHERENCE_DIFFUSION:
+                result = processCoherenceDiffusion(progress);
+                break;
+            case TILED:
+                result = processTiled(tileHalo, tileFilter, tileOutputType, progress);
+                break;
             case CUSTOM:
                 if (customFunction) {
                     result = customFunction(inputImage, progress);
@@ -79,12 +156,19 @@ void ProcessingWorker::process() {
                 break;
         }
 
-        if (!cancelled && !result.empty()) {
+        if (canonical) {
+            inputImage = nativeInput;
+            cacheKey = nativeKey;
+            if (!result.empty()) result = ResolutionPyramid::upscale(result, nativeInput.size());
+        }
+
+        if (cancelled) {
+            emit statusMessage("Processing cancelled");
+            emit operationCancelled();
+        } else if (!result.empty()) {
             emit progressUpdated(100);
             emit statusMessage("Processing completed successfully");
             emit operationCompleted(result);
-        } else if (cancelled) {
-            emit statusMessage("Processing cancelled");
         } else {
             emit operationFailed("Processing returned empty result");
         }
@@ -99,31 +183,24 @@ void ProcessingWorker::process() {
 cv::Mat ProcessingWorker::processSkeletonize(int &progress) {
     emit statusMessage("Skeletonizing image...");
 
-    cv::Mat skeleton = cv::Mat::zeros(inputImage.size(), CV_8UC1);
-    cv::Mat temp;
-    cv::Mat eroded;
-    cv::Mat element = cv::getStructuringElement(cv::MORPH_CROSS, cv::Size(3, 3));
-
-    cv::Mat img = inputImage.clone();
-    int maxIterations = 100; // Limite de iterações
-    int iteration = 0;
-
-    bool done = false;
-    while (!done && !cancelled && iteration < maxIterations) {
-        cv::erode(img, eroded, element);
-        cv::dilate(eroded, temp, element);
-        cv::subtract(img, temp, temp);
-        cv::bitwise_or(skeleton, temp, skeleton);
-        eroded.copyTo(img);
+    // Garantir imagem binária
+    cv::Mat binary;
+    if (inputImage.channels() > 1) {
+        cv::cvtColor(inputImage, binary, cv::COLOR_BGR2GRAY);
+    } else {
+        binary = inputImage.clone();
+    }
+    cv::threshold(binary, binary, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
 
-        done = (cv::countNonZero(img) == 0);
+    ThinningAlgorithm algorithm = (parameters.value("algorithm", 0) == 1)
+        ? ThinningAlgorithm::GuoHall : ThinningAlgorithm::ZhangSuen;
 
-        iteration++;
-        progress = std::min(99, (iteration * 100) / maxIterations);
+    // Número de iterações depende da largura das cristas: progresso assintótico
+    return Thinning::thin(binary, algorithm, [&](int iteration, int) {
+        progress = std::min(99, 100 - 100 / (iteration + 1));
         emit progressUpdated(progress);
-    }
-
-    return skeleton;
+        return !cancelled;
+    });
 }
 
 cv::Mat ProcessingWorker::processFFTFilter(int &progress) {
@@ -131,38 +208,36 @@ cv::Mat ProcessingWorker::processFFTFilter(int &progress) {
     progress = 20;
     emit progressUpdated(progress);
 
-    // Implementação básica - pode ser expandida com máscara
-    cv::Mat padded;
-    int m = cv::getOptimalDFTSize(inputImage.rows);
-    int n = cv::getOptimalDFTSize(inputImage.cols);
-    cv::copyMakeBorder(inputImage, padded, 0, m - inputImage.rows, 0, n - inputImage.cols,
-                       cv::BORDER_CONSTANT, cv::Scalar::all(0));
+    // Área da impressão: mesmo envoltório (e mesma chave de espectro) do diálogo de FFT
+    std::shared_ptr<const RidgeMask> print = printMask(RidgeMaskConfig().blockSize);
+    cv::Mat source = print ? inputImage(print->boundingBox) : inputImage;
+    cv::Mat gray = FrequencyFilter::toGray(source);
 
-    progress = 40;
-    emit progressUpdated(progress);
-
-    cv::Mat planes[] = {cv::Mat_<float>(padded), cv::Mat::zeros(padded.size(), CV_32F)};
-    cv::Mat complexImage;
-    cv::merge(planes, 2, complexImage);
+    // Espectro direto: reaproveitado do cache quando a entidade não mudou
+    const QString spectrumKey = print ? cacheKey + "#print" : cacheKey;
+    std::shared_ptr<const cv::Mat> spectrum = cacheKey.isEmpty()
+        ? std::make_shared<const cv::Mat>(FrequencyFilter::forward(gray))
+        : FFTService::spectrum(spectrumKey, gray);
 
     progress = 60;
     emit progressUpdated(progress);
+    if (cancelled) return cv::Mat();
 
-    cv::dft(complexImage, complexImage);
+    // Máscara: retângulos configurados + picos periódicos detectados (autoNotch=1)
+    QVector<QRect> rects = frequencyMask;
+    if (parameters.value("autoNotch", 0) > 0 && !frequencyMaskInverted) {
+        rects += NotchDetector::toRects(NotchDetector::detect(*spectrum, gray.size(), gray));
+    }
 
     progress = 80;
     emit progressUpdated(progress);
 
-    // Aplicar filtro passa-baixa simples (pode ser customizado)
-    // TODO: Adicionar suporte a máscara customizada
-
-    cv::Mat result;
-    cv::dft(complexImage, result, cv::DFT_INVERSE | cv::DFT_REAL_OUTPUT);
-    cv::normalize(result, result, 0, 255, cv::NORM_MINMAX, CV_8UC1);
-
-    // Remover padding
-    result = result(cv::Rect(0, 0, inputImage.cols, inputImage.rows));
-
+    // Sem máscara o resultado é a própria imagem normalizada
+    cv::Mat result = FrequencyFilter::apply(*spectrum, rects, frequencyMaskInverted, gray.size(),
+                                            source.channels() == 3 ? 3 : 1);
+    if (print && !result.empty()) {
+        result = RidgeSegmentation::embed(result, *print);
+    }
     return result;
 }
 
@@ -193,10 +268,12 @@ cv::Mat ProcessingWorker::processBinarize(int &progress) {
     double threshold = parameters.value("threshold", -1.0);
 
     if (threshold < 0) {
-        // Usar Otsu
+        // Usar Otsu (limiar depende do histograma global)
         cv::threshold(inputImage, result, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
     } else {
-        cv::threshold(inputImage, result, threshold, 255, cv::THRESH_BINARY);
+        result = processTiled(0, [threshold](const cv::Mat &src, cv::Mat &dst) {
+            cv::threshold(src, dst, threshold, 255, cv::THRESH_BINARY);
+        }, -1, progress);
     }
 
     progress = 100;
@@ -211,8 +288,10 @@ cv::Mat ProcessingWorker::processGaussianBlur(int &progress) {
     emit progressUpdated(progress);
 
     double sigma = parameters.value("sigma", 1.0);
-    cv::Mat result;
-    cv::GaussianBlur(inputImage, result, cv::Size(0, 0), sigma, sigma);
+    cv::Mat result = processTiled(TileScheduler::gaussianRadius(sigma, inputImage.depth()),
+        [sigma](const cv::Mat &src, cv::Mat &dst) {
+            cv::GaussianBlur(src, dst, cv::Size(0, 0), sigma, sigma);
+        }, -1, progress);
 
     progress = 100;
     emit progressUpdated(progress);
@@ -232,8 +311,9 @@ cv::Mat ProcessingWorker::processSharpen(int &progress) {
         -1 * strength, 1 + 4 * strength, -1 * strength,
         0, -1 * strength, 0);
 
-    cv::Mat result;
-    cv::filter2D(inputImage, result, -1, kernel);
+    cv::Mat result = processTiled(1, [kernel](const cv::Mat &src, cv::Mat &dst) {
+        cv::filter2D(src, dst, -1, kernel);
+    }, -1, progress);
 
     progress = 100;
     emit progressUpdated(progress);
@@ -278,3 +358,118 @@ cv::Mat ProcessingWorker::processEqualizeHistogram(int &progress) {
 
     return result;
 }
+
+cv::Mat ProcessingWorker::processGaborEnhance(int &progress) {
+    emit statusMessage("Estimating ridge orientation and frequency...");
+    progress = 5;
+    emit progressUpdated(progress);
+
+    RidgeFieldConfig fieldConfig;
+    fieldConfig.blockSize = static_cast<int>(parameters.value("blockSize", fieldConfig.blockSize));
+
+    // Área da impressão: campo e filtragem só no envoltório, blocos de fundo pulados
+    std::shared_ptr<const RidgeMask> print = printMask(fieldConfig.blockSize);
+    cv::Mat source = print ? inputImage(print->boundingBox) : inputImage;
+    cv::Mat blockMask = print ? print->blocksIn(print->boundingBox) : cv::Mat();
+
+    // Campo compartilhado com outras etapas da mesma entidade
+    const QString fieldKey = print ? cacheKey + "#print" : cacheKey;
+    std::shared_ptr<const RidgeField> field = cacheKey.isEmpty()
+        ? std::make_shared<const RidgeField>(RidgeGeometry::compute(source, fieldConfig))
+        : RidgeGeometry::cached(fieldKey, source, fieldConfig);
+
+    if (cancelled) return cv::Mat();
+
+    GaborConfig config;
+    config.orientationBins = static_cast<int>(parameters.value("orientations", config.orientationBins));
+    config.frequencyBins = static_cast<int>(parameters.value("frequencies", config.frequencyBins));
+    config.kx = parameters.value("kx", config.kx);
+    config.ky = parameters.value("ky", config.ky);
+
+    emit statusMessage("Applying Gabor filter bank...");
+    progress = 30;
+    emit progressUpdated(progress);
+
+    cv::Mat result = GaborEnhancer::enhance(source, *field, config, [this](int done, int total) {
+        emit progressUpdated(30 + 69 * done / total);
+        return !cancelled;
+    }, blockMask);
+
+    if (print && !result.empty()) {
+        result = RidgeSegmentation::embed(result, *print);
+    }
+    return result;
+}
+
+cv::Mat ProcessingWorker::processSubtractBackground(int &progress) {
+    BackgroundConfig config;
+    config.method = static_cast<BackgroundMethod>(static_cast<int>(
+        parameters.value("method", static_cast<int>(config.method))));
+    config.kernelSize = static_cast<int>(parameters.value("kernelSize", config.kernelSize));
+
+    emit statusMessage(QString("Estimating background (%1)...").arg(config.toString()));
+    progress = 5;
+    emit progressUpdated(progress);
+
+    return BackgroundEstimator::subtract(inputImage, config, [this](int done, int total) {
+        emit progressUpdated(5 + 94 * done / total);
+        return !cancelled;
+    });
+}
+
+cv::Mat ProcessingWorker::processAdaptiveThreshold(int &progress) {
+    LocalThresholdConfig config;
+    config.method = static_cast<LocalThresholdMethod>(static_cast<int>(
+        parameters.value("method", static_cast<int>(config.method))));
+    config.windowSize = static_cast<int>(parameters.value("windowSize", config.windowSize));
+    config.k = parameters.value("k", LocalThresholdConfig::defaultK(config.method));
+
+    emit statusMessage(QString("Adaptive thresholding (%1)...").arg(config.toString()));
+    progress = 5;
+    emit progressUpdated(progress);
+
+    return AdaptiveThreshold::apply(inputImage, config, [this](int done, int total) {
+        emit progressUpdated(5 + 94 * done / total);
+        return !cancelled;
+    });
+}
+
+cv::Mat ProcessingWorker::processCoherenceDiffusion(int &progress) {
+    CoherenceDiffusionConfig config;
+    config.iterations = static_cast<int>(parameters.value("iterations", config.iterations));
+    config.gradientSigma = parameters.value("sigma", config.gradientSigma);
+    config.integrationSigma = parameters.value("rho", config.integrationSigma);
+    config.alpha = parameters.value("alpha", config.alpha);
+    config.contrast = parameters.value("contrast", config.contrast);
+    config.tolerance = parameters.value("tolerance", config.tolerance);
+
+    emit statusMessage(QString("Coherence-enhancing diffusion (%1)...").arg(config.toString()));
+    progress = 5;
+    emit progressUpdated(progress);
+
+    int iterationsRun = 0;
+    cv::Mat result = CoherenceDiffusion::apply(inputImage, config, [this](int done, int total) {
+        emit progressUpdated(5 + 94 * done / total);
+        return !cancelled;
+    }, &iterationsRun);
+
+    if (!result.empty() && iterationsRun < config.iterations) {
+        emit statusMessage(QString("Diffusion converged after %1 of %2 iterations")
+                           .arg(iterationsRun).arg(config.iterations));
+    }
+    return result;
+}
+
+cv::Mat ProcessingWorker::processTiled(int halo, const TileFilter &filter, int outputType, int &progress) {
+    if (!filter) {
+        emit operationFailed("No tile filter defined");
+        return cv::Mat();
+    }
+
+    const int startProgress = progress;
+    return TileScheduler::apply(inputImage, halo, filter, outputType,
+        [this, startProgress](int done, int total) {
+            emit progressUpdated(startProgress + (99 - startProgress) * done / total);
+            return !cancelled;
+        }, RidgeSegmentation::tileConfig(printMask(RidgeMaskConfig().blockSize)));
+}
@@ -5,8 +5,13 @@
 #include <QThread>
 #include <QMap>
 #include <QString>
+#include <QVector>
+#include <QRect>
 #include <functional>
+#include <atomic>
 #include <opencv2/opencv.hpp>
+#include "../core/TileScheduler.h"
+#include "../core/RidgeSegmentation.h"
 
 /**
  * @brief Worker para processar operações pesadas em thread separada
@@ -30,6 +35,11 @@ public:
         SHARPEN,
         CLAHE,
         EQUALIZE_HISTOGRAM,
+        TILED,
+        GABOR_ENHANCE,
+        SUBTRACT_BACKGROUND,
+        ADAPTIVE_THRESHOLD,
+        COHERENCE_DIFFUSION,
         CUSTOM
     };
 
@@ -46,25 +56,61 @@ public:
      */
     void setOperation(OperationType type);
     void setCustomOperation(ProcessingFunction func);
+    void setTiledOperation(int halo, TileFilter filter, int outputType = -1);
     void setInputImage(const cv::Mat &image);
     void setParameter(const QString &key, double value);
+    void setCacheKey(const QString &key);  // Entidade para o cache do campo de orientação e do espectro
+
+    /**
+     * @brief Restringe filtros em ladrilhos e Gabor à área da impressão
+     *
+     * Ladrilhos sem impressão ficam como estavam; o Gabor processa só o
+     * envoltório da máscara e preenche o resto com o fundo.
+     */
+    void setRestrictToPrint(bool enabled);
+
+    /**
+     * @brief Fator nativo → resolução canônica (ResolutionPyramid); 1 = nativa
+     *
+     * Gabor e difusão coerente rodam no nível reduzido e o resultado volta
+     * ampliado ao tamanho nativo.
+     */
+    void setCanonicalScale(double scale);
+
+    /**
+     * @brief Máscara do FFT_FILTER em coordenadas do espectro centralizado
+     * @param invert false = remover os retângulos; true = manter apenas eles
+     */
+    void setFrequencyMask(const QVector<QRect> &rects, bool invert = false);
 
 signals:
     void progressUpdated(int percentage);
     void operationCompleted(cv::Mat result);
     void operationFailed(QString errorMessage);
+    void operationCancelled();  // Emitido no lugar de operationCompleted após cancel()
     void statusMessage(QString message);
 
 public slots:
     void process();
+    // Chamado direto da thread da interface (a thread do worker está ocupada em process())
     void cancel();
 
 private:
     OperationType operationType;
     ProcessingFunction customFunction;
+    TileFilter tileFilter;
+    int tileHalo;
+    int tileOutputType;
     cv::Mat inputImage;
     QMap<QString, double> parameters;
-    bool cancelled;
+    QString cacheKey;
+    QVector<QRect> frequencyMask;
+    bool frequencyMaskInverted;
+    bool restrictToPrint;
+    double canonicalScale;
+    std::atomic<bool> cancelled;  // Lido pelas threads de parallel_for_ e pelos callbacks de progresso
+
+    std::shared_ptr<const RidgeMask> printMask(int blockSize);
 
     // Métodos de processamento específicos
     cv::Mat processSkeletonize(int &progress);
@@ -75,6 +121,11 @@ private:
     cv::Mat processSharpen(int &progress);
     cv::Mat processCLAHE(int &progress);
     cv::Mat processEqualizeHistogram(int &progress);
+    cv::Mat processGaborEnhance(int &progress);
+    cv::Mat processSubtractBackground(int &progress);
+    cv::Mat processAdaptiveThreshold(int &progress);
+    cv::Mat processCoherenceDiffusion(int &progress);
+    cv::Mat processTiled(int halo, const TileFilter &filter, int outputType, int &progress);
 };
 
 #endif // PROCESSINGWORKER_H
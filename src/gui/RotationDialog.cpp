@@ -4,6 +4,15 @@
 #include "FragmentRegionsOverlay.h"
 #include "../core/ProjectModel.h"
 #include <QGroupBox>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+
+// Lado maior mínimo da prévia (a prévia acompanha o tamanho do viewer)
+const int kPreviewMaxSide = 1600;
+
+} // namespace
 
 RotationDialog::RotationDialog(const cv::Mat &image, ImageViewer *viewer, 
                                FingerprintEnhancer::Fragment *fragment,
@@ -18,9 +27,13 @@ RotationDialog::RotationDialog(const cv::Mat &image, ImageViewer *viewer,
       minutiaeOverlay(overlay),
       parentImage(parentImg),
       fragmentRegionsOverlay(fragmentOverlay),
+      proxyScale(1.0),
+      fullWatcher(nullptr),
       finalAngle(0.0), 
       accepted(false), 
-      useTransparentBackground(false) {
+      useTransparentBackground(false),
+      previewFitted(false),
+      initialZoom(viewer ? viewer->getZoomFactor() : 1.0) {
 
     fprintf(stderr, "[ROTATION] Dialog criado - tem fragmentOverlay: %s\n", 
             fragmentOverlay ? "SIM" : "NAO");
@@ -32,11 +45,6 @@ RotationDialog::RotationDialog(const cv::Mat &image, ImageViewer *viewer,
     setModal(false);
     setWindowFlags(windowFlags() | Qt::WindowStaysOnTopHint);
     
-    // Se há fragmento, guardar minúcias originais para restaurar no cancelamento
-    if (currentFragment && !currentFragment->minutiae.isEmpty()) {
-        originalMinutiae = currentFragment->minutiae;
-    }
-
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
 
     // Grupo de controles
@@ -111,11 +119,55 @@ RotationDialog::RotationDialog(const cv::Mat &image, ImageViewer *viewer,
     connect(acceptButton, &QPushButton::clicked, this, &RotationDialog::onAccept);
     connect(cancelButton, &QPushButton::clicked, this, &RotationDialog::onReject);
 
+    // Rotação em resolução total roda fora da thread da interface, ao aplicar
+    fullWatcher = new QFutureWatcher<cv::Mat>(this);
+    connect(fullWatcher, &QFutureWatcher<cv::Mat>::finished,
+            this, &RotationDialog::onFullResolutionFinished);
+
+    // Sem geometria da entidade: compor a partir da própria imagem
+    transformBase.image = originalImage;
+    transformBase.fromOriginal = GeometricTransform(originalImage.size());
+    transformBase.current = transformBase.fromOriginal;
+
     // Preview inicial
+    buildProxy();
     updatePreview(0.0);
 }
 
-RotationDialog::~RotationDialog() = default;
+RotationDialog::~RotationDialog() {
+    if (fullWatcher && fullWatcher->isRunning()) {
+        fullWatcher->waitForFinished();
+    }
+}
+
+void RotationDialog::setTransformBase(const TransformBase &base) {
+    transformBase = base;
+    buildProxy();
+    updatePreview(finalAngle);
+}
+
+void RotationDialog::buildProxy() {
+    // Reduzida uma vez para o tamanho da tela: cada movimento do controle
+    // reamostra só a prévia
+    int displaySide = kPreviewMaxSide;
+    if (imageViewer) {
+        displaySide = std::max(displaySide, std::max(imageViewer->width(), imageViewer->height()));
+    }
+
+    const cv::Size fullSize = transformBase.image.size();
+    proxyScale = std::min(1.0, static_cast<double>(displaySide) / std::max(fullSize.width, fullSize.height));
+
+    if (proxyScale < 1.0) {
+        proxyBase.fromOriginal = transformBase.fromOriginal.scaled(proxyScale);
+        proxyBase.current = transformBase.current.scaled(proxyScale);
+        cv::resize(transformBase.image, proxyBase.image, proxyBase.fromOriginal.outputSize(), 0, 0, cv::INTER_AREA);
+    } else {
+        proxyBase = transformBase;
+    }
+
+    fprintf(stderr, "[ROTATION] Prévia %dx%d (escala %.3f) de %dx%d\n",
+            proxyBase.image.cols, proxyBase.image.rows, proxyScale, fullSize.width, fullSize.height);
+}
 
 void RotationDialog::onSliderChanged(int value) {
     double angle = value / 10.0;
@@ -157,202 +209,91 @@ void RotationDialog::updatePreview(double angle) {
         .arg(angle, 0, 'f', 1)
         .arg(resultAngle, 0, 'f', 1));
     
-    // VERIFICAR: Se rotacionando IMAGEM e o ângulo acumulado é ~0°, usar imagem original
-    if (parentImage) {
-        double accumulatedAngle = fmod(parentImage->currentRotationAngle + angle, 360.0);
-        if (accumulatedAngle < 0) accumulatedAngle += 360.0;
-        
-        fprintf(stderr, "[ROTATION] Rotacionando para %.1f graus (ângulo acumulado: %.1f)\n", angle, accumulatedAngle);
-        
-        // Se ângulo acumulado é ~0°, usar imagem REALMENTE original (sem borda)
-        if (fabs(accumulatedAngle) < 0.1 || fabs(accumulatedAngle - 360.0) < 0.1) {
-            fprintf(stderr, "[ROTATION] Ângulo acumulado ~0° - usando imagem REALMENTE ORIGINAL (sem borda)\n");
-            rotatedImage = parentImage->originalImage.clone();  // ✅ Usar originalImage da entidade, não do dialog
-        } else {
-            rotatedImage = rotateImage(originalImage, angle);
-        }
-    } else {
-        // Rotacionando fragmento: usar delta diretamente
-        fprintf(stderr, "[ROTATION] Rotacionando para %.1f graus\n", angle);
-        rotatedImage = rotateImage(originalImage, angle);
-    }
+    // Rotação composta com a geometria acumulada. Ângulo acumulado ~0° volta
+    // exatamente à base (a original, se não editada), sem borda
+    targetTransform = transformBase.current.rotated(angle);
+    const GeometricTransform previewTransform =
+        proxyScale < 1.0 ? targetTransform.scaled(proxyScale) : targetTransform;
+    previewImage = TransformStack::render(proxyBase, previewTransform, useTransparentBackground);
 
-    // Atualizar viewer em tempo real
+    // Atualizar viewer em tempo real; enquadrar só na primeira prévia
     if (imageViewer) {
-        imageViewer->setImage(rotatedImage);
-        // Ajustar zoom para evitar distorção ao mudar tamanho da imagem
-        imageViewer->zoomToFit();
+        imageViewer->setImage(previewImage);
+        if (!previewFitted) {
+            imageViewer->zoomToFit();
+            previewFitted = true;
+        }
     }
-    
-    // Atualizar overlay de regiões de fragmentos se rotacionando IMAGEM
+
+    // Sobreposições recebem a mesma transformação, sem alterar o projeto
     if (parentImage && fragmentRegionsOverlay) {
-        // Definir ângulo de preview (acumulado com ângulo atual da imagem)
-        // IMPORTANTE: Normalizar para [0, 360) para evitar ângulos negativos
-        double previewAngle = fmod(parentImage->currentRotationAngle + angle, 360.0);
-        if (previewAngle < 0) previewAngle += 360.0;  // Garantir positivo
-        
-        fprintf(stderr, "[ROTATION] Atualizando overlay: currentAngle=%.1f + deltaAngle=%.1f = previewAngle=%.1f\n", 
-                parentImage->currentRotationAngle, angle, previewAngle);
-        fragmentRegionsOverlay->setPreviewRotationAngle(previewAngle);
+        fragmentRegionsOverlay->setPreviewTransform(previewTransform);
     }
-    
-    // Rotacionar minúcias em tempo real se houver fragmento
-    if (currentFragment && !originalMinutiae.isEmpty()) {
-        // Restaurar minúcias originais primeiro
-        currentFragment->minutiae = originalMinutiae;
-        
-        // Aplicar rotação temporária
-        cv::Size oldSize = originalImage.size();
-        cv::Size newSize = rotatedImage.size();
-        currentFragment->rotateMinutiae(angle, oldSize, newSize);
-        
-        // Atualizar overlay visual
-        if (minutiaeOverlay) {
-            minutiaeOverlay->update();
-        }
+    if (currentFragment && minutiaeOverlay) {
+        minutiaeOverlay->setPreviewTransform(previewTransform.relativeTo(transformBase.current));
     }
 }
 
-cv::Mat RotationDialog::rotateImage(const cv::Mat &image, double angle) {
-    if (image.empty()) return image;
+void RotationDialog::onAccept() {
+    if (fullWatcher->isRunning()) return;
 
-    // Normalizar ângulo para range [0, 360)
-    double normalizedAngle = fmod(angle, 360.0);
-    if (normalizedAngle < 0) normalizedAngle += 360.0;
-    
-    // Arredondar para inteiro para verificar múltiplos exatos de 90
-    int roundedAngle = static_cast<int>(std::round(normalizedAngle));
-    roundedAngle = roundedAngle % 360;
-    
-    fprintf(stderr, "[ROTATION] rotateImage: angle=%.2f°, normalized=%.2f°, rounded=%d°\n", 
-            angle, normalizedAngle, roundedAngle);
-    
-    // Para ângulos múltiplos de 90°, usar cv::rotate() (sem bordas brancas)
-    if (roundedAngle == 0) {
-        fprintf(stderr, "[ROTATION] Ângulo ~0° detectado - retornando imagem original\n");
-        return image.clone();
-    } else if (roundedAngle == 90) {
-        cv::Mat rotated;
-        cv::rotate(image, rotated, cv::ROTATE_90_COUNTERCLOCKWISE);
-        fprintf(stderr, "[ROTATION] Ângulo 90° detectado - usando cv::rotate (sem borda)\n");
-        return rotated;
-    } else if (roundedAngle == 180) {
-        cv::Mat rotated;
-        cv::rotate(image, rotated, cv::ROTATE_180);
-        fprintf(stderr, "[ROTATION] Ângulo 180° detectado - usando cv::rotate (sem borda)\n");
-        return rotated;
-    } else if (roundedAngle == 270) {
-        cv::Mat rotated;
-        cv::rotate(image, rotated, cv::ROTATE_90_CLOCKWISE);
-        fprintf(stderr, "[ROTATION] Ângulo 270° detectado - usando cv::rotate (sem borda)\n");
-        return rotated;
-    }
+    angleSlider->setEnabled(false);
+    angleSpinBox->setEnabled(false);
+    transparentBgCheckbox->setEnabled(false);
+    acceptButton->setEnabled(false);
+    cancelButton->setEnabled(false);
+    currentAngleLabel->setText("Aplicando rotação em resolução total...");
 
-    // Ângulo arbitrário - usar warpAffine
-    // Calcular tamanho exato necessário usando senos e cossenos
-    double angleRad = angle * M_PI / 180.0;
-    double absCos = std::abs(std::cos(angleRad));
-    double absSin = std::abs(std::sin(angleRad));
-    
-    int originalW = image.cols;
-    int originalH = image.rows;
-    
-    // Calcular novo tamanho necessário para conter toda a imagem rotacionada
-    int new_w = static_cast<int>(std::ceil(originalW * absCos + originalH * absSin));
-    int new_h = static_cast<int>(std::ceil(originalW * absSin + originalH * absCos));
-    
-    fprintf(stderr, "[ROTATION] Ângulo arbitrário %.2f°\n", angle);
-    fprintf(stderr, "[ROTATION] Original: %dx%d, Novo: %dx%d\n", originalW, originalH, new_w, new_h);
-    fprintf(stderr, "[ROTATION] cos=%.4f, sin=%.4f\n", absCos, absSin);
-    
-    // Criar matriz de rotação em torno do centro
-    cv::Point2f center(originalW / 2.0f, originalH / 2.0f);
-    cv::Mat rotMatrix = cv::getRotationMatrix2D(center, -angle, 1.0);
+    // Cópias rasas: a base não é alterada enquanto o diálogo existe
+    const TransformBase base = transformBase;
+    const GeometricTransform target = targetTransform;
+    const bool transparent = useTransparentBackground;
 
-    // Ajustar translação para centralizar na nova imagem
-    rotMatrix.at<double>(0, 2) += (new_w / 2.0) - center.x;
-    rotMatrix.at<double>(1, 2) += (new_h / 2.0) - center.y;
+    fullFuture = QtConcurrent::run([base, target, transparent]() {
+        return TransformStack::render(base, target, transparent);
+    });
+    fullWatcher->setFuture(fullFuture);
+}
 
-    cv::Mat rotated;
-    
-    fprintf(stderr, "[ROTATION] Canais=%d, transparente=%s\n", 
-            image.channels(), useTransparentBackground ? "SIM" : "NAO");
-
-    if (useTransparentBackground) {
-        // Converter para BGRA se necessário
-        cv::Mat imageWithAlpha;
-        if (image.channels() == 3) {
-            cv::cvtColor(image, imageWithAlpha, cv::COLOR_BGR2BGRA);
-        } else if (image.channels() == 1) {
-            cv::cvtColor(image, imageWithAlpha, cv::COLOR_GRAY2BGRA);
-        } else if (image.channels() == 4) {
-            imageWithAlpha = image.clone();
-        } else {
-            imageWithAlpha = image.clone();
-        }
+void RotationDialog::onFullResolutionFinished() {
+    rotatedImage = fullFuture.result();
+    accepted = true;
 
-        // Rotacionar com fundo transparente
-        cv::warpAffine(imageWithAlpha, rotated, rotMatrix, cv::Size(new_w, new_h),
-                       cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar(0, 0, 0, 0));
-    } else {
-        // Rotacionar com fundo branco
-        // IMPORTANTE: Usar Scalar apropriado para número de canais
-        cv::Scalar borderColor;
-        if (image.channels() == 1) {
-            borderColor = cv::Scalar(255);  // Grayscale
-        } else if (image.channels() == 3) {
-            borderColor = cv::Scalar(255, 255, 255);  // BGR
-        } else if (image.channels() == 4) {
-            borderColor = cv::Scalar(255, 255, 255, 255);  // BGRA (PNG com alpha)
-        } else {
-            borderColor = cv::Scalar(255);
-        }
-        
-        cv::warpAffine(image, rotated, rotMatrix, cv::Size(new_w, new_h),
-                       cv::INTER_LINEAR, cv::BORDER_CONSTANT, borderColor);
+    // Minúcias do fragmento: a mesma transformação da prévia aceita pelo usuário
+    if (currentFragment && !currentFragment->minutiae.isEmpty()) {
+        FingerprintEnhancer::MinutiaeOverlay::transformMinutiae(currentFragment, targetTransform.relativeTo(transformBase.current));
     }
-    
-    fprintf(stderr, "[ROTATION] Imagem rotacionada: canais=%d, tamanho=%dx%d\n",
-            rotated.channels(), rotated.cols, rotated.rows);
-
-    return rotated;
-}
+    clearOverlayPreviews();
 
-void RotationDialog::onAccept() {
-    accepted = true;
-    
-    // Limpar preview de rotação do overlay de fragmentos
-    if (fragmentRegionsOverlay) {
-        fprintf(stderr, "[ROTATION] Limpando preview de rotação do overlay ao aceitar\n");
-        fragmentRegionsOverlay->clearPreviewRotationAngle();
+    if (imageViewer) {
+        imageViewer->setImage(rotatedImage);
+        imageViewer->zoomToFit();
     }
-    
+
+    fprintf(stderr, "[ROTATION] Rotação de %.1f° aplicada: %dx%d\n",
+            finalAngle, rotatedImage.cols, rotatedImage.rows);
     accept();
 }
 
 void RotationDialog::onReject() {
+    if (fullWatcher->isRunning()) return;
     accepted = false;
     
-    // Restaurar imagem original no viewer
+    // Restaurar imagem original e zoom no viewer
     if (imageViewer) {
         imageViewer->setImage(originalImage);
+        imageViewer->setZoomFactor(initialZoom);
     }
+    clearOverlayPreviews();
     
-    // Limpar preview de rotação do overlay de fragmentos
+    reject();
+}
+
+void RotationDialog::clearOverlayPreviews() {
     if (fragmentRegionsOverlay) {
-        fprintf(stderr, "[ROTATION] Limpando preview de rotação do overlay\n");
         fragmentRegionsOverlay->clearPreviewRotationAngle();
     }
-    
-    // Restaurar minúcias originais se houver fragmento
-    if (currentFragment && !originalMinutiae.isEmpty()) {
-        currentFragment->minutiae = originalMinutiae;
-        
-        // Atualizar overlay visual
-        if (minutiaeOverlay) {
-            minutiaeOverlay->update();
-        }
+    if (minutiaeOverlay) {
+        minutiaeOverlay->clearPreviewTransform();
     }
-    
-    reject();
 }
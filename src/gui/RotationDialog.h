@@ -9,7 +9,10 @@
 #include <QCheckBox>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
+#include <QFuture>
+#include <QFutureWatcher>
 #include <opencv2/opencv.hpp>
+#include "../core/GeometricTransform.h"
 
 class ImageViewer;
 class FragmentRegionsOverlay;
@@ -37,30 +40,44 @@ public:
     cv::Mat getRotatedImage() const { return rotatedImage; }
     bool wasAccepted() const { return accepted; }
 
+    /**
+     * @brief Compor a rotação com a geometria acumulada da entidade (uma reamostragem da base)
+     */
+    void setTransformBase(const TransformBase &base);
+    GeometricTransform getTargetTransform() const { return targetTransform; }
+
 private slots:
     void onSliderChanged(int value);
     void onSpinBoxChanged(double value);
     void onAccept();
     void onReject();
+    void onFullResolutionFinished();
 
 private slots:
     void onTransparentBgChanged(int state);
 
 private:
     cv::Mat originalImage;
-    cv::Mat rotatedImage;
+    cv::Mat rotatedImage;       // Resolução total, calculada ao aplicar
+    cv::Mat previewImage;       // Prévia na resolução da tela
     ImageViewer *imageViewer;
     FingerprintEnhancer::Fragment *currentFragment;
     FingerprintEnhancer::MinutiaeOverlay *minutiaeOverlay;
     FingerprintEnhancer::FingerprintImage *parentImage;
     FragmentRegionsOverlay *fragmentRegionsOverlay;
+    TransformBase transformBase;
+    TransformBase proxyBase;            // Base reduzida para a prévia
+    double proxyScale;
+    GeometricTransform targetTransform;
+
+    QFuture<cv::Mat> fullFuture;
+    QFutureWatcher<cv::Mat> *fullWatcher;
 
     double finalAngle;
     bool accepted;
     bool useTransparentBackground;
-    
-    // Backup das minúcias originais para restaurar no cancelamento
-    QList<FingerprintEnhancer::Minutia> originalMinutiae;
+    bool previewFitted;
+    double initialZoom;
 
     QSlider *angleSlider;
     QDoubleSpinBox *angleSpinBox;
@@ -71,7 +88,8 @@ private:
     QPushButton *cancelButton;
 
     void updatePreview(double angle);
-    cv::Mat rotateImage(const cv::Mat &image, double angle);
+    void buildProxy();
+    void clearOverlayPreviews();
 };
 
 #endif // ROTATIONDIALOG_H
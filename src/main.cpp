@@ -10,6 +10,15 @@
 #include "gui/MainWindow.h"
 #include "gui/SplashScreen.h"
 #include "core/TranslationManager_Simple.h"
+#include "afis/ScoreCalibrationBuilder.h"
+#include "afis/LRDensity.h"
+#include "core/Thinning.h"
+#include "core/CrossingNumber.h"
+#include "core/TileScheduler.h"
+#include "core/NotchDetector.h"
+#include "core/BackgroundEstimator.h"
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
 
 // Configurar logging do Qt
 Q_LOGGING_CATEGORY(fpenhancer, "fpenhancer")
@@ -118,6 +127,239 @@ bool checkSystemDependencies() {
     return true;
 }
 
+/**
+ * @brief Construir tabela de calibração score → LR a partir de um corpus rotulado
+ */
+int runScoreCalibration(const QString &corpusDir, const QString &method, const QString &outputPath) {
+    using namespace FingerprintEnhancer;
+    
+    QVector<CalibrationSample> corpus = ScoreCalibrationBuilder::loadCorpus(corpusDir);
+    if (corpus.size() < 2) {
+        std::cerr << "Corpus insuficiente em " << corpusDir.toStdString() << std::endl;
+        return 1;
+    }
+    
+    ScoreCalibrationConfig config;
+    config.method = (method == "pav") ? CalibrationMethod::PAV : CalibrationMethod::KDE;
+    
+    ScoreCalibrationBuilder builder;
+    builder.computeScores(corpus, config, [](int done, int total) {
+        fprintf(stderr, "\r[LR-Calibration] %d/%d comparações", done, total);
+        fflush(stderr);
+    });
+    fprintf(stderr, "\n");
+    
+    ScoreCalibrationTable table = builder.build(config);
+    if (!table.isValid()) {
+        std::cerr << "Falha ao construir a tabela (são necessários pares genuínos e impostores)" << std::endl;
+        return 1;
+    }
+    
+    QString path = outputPath.isEmpty() ? ScoreCalibrationTable::defaultPath() : outputPath;
+    if (!table.saveToJson(path)) {
+        return 1;
+    }
+    
+    std::cout << "Tabela de calibração (" << method.toStdString() << ", " << table.scores.size()
+              << " nós, " << table.genuineCount << " genuínos, " << table.impostorCount
+              << " impostores) salva em " << path.toStdString() << std::endl;
+    return 0;
+}
+
+/**
+ * @brief Comparar o esqueleto morfológico antigo com o afinamento atual
+ *
+ * Mede a imagem na resolução original e ampliada 2x (ex.: 500 → 1000 ppi).
+ */
+int runThinningBenchmark(const QString &imagePath) {
+    cv::Mat image = cv::imread(imagePath.toStdString(), cv::IMREAD_GRAYSCALE);
+    if (image.empty()) {
+        std::cerr << "Não foi possível abrir " << imagePath.toStdString() << std::endl;
+        return 1;
+    }
+    
+    cv::Mat upscaled;
+    cv::resize(image, upscaled, cv::Size(), 2.0, 2.0, cv::INTER_CUBIC);
+    
+    std::cout << "resolução  tamanho      morfológico(ms/px)   zhang-suen(ms/px)   guo-hall(ms/px)" << std::endl;
+    const std::pair<const char*, cv::Mat> inputs[] = {{"1x", image}, {"2x", upscaled}};
+    for (const auto &input : inputs) {
+        cv::Mat binary;
+        cv::threshold(input.second, binary, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+        
+        ThinningBenchmark b = Thinning::benchmark(binary);
+        fprintf(stdout, "%-10s %5dx%-6d %9.1f / %-8d %9.1f / %-8d %9.1f / %d\n",
+                input.first, b.size.width, b.size.height,
+                b.morphologicalMs, b.morphologicalPixels,
+                b.zhangSuenMs, b.zhangSuenPixels,
+                b.guoHallMs, b.guoHallPixels);
+    }
+    return 0;
+}
+
+/**
+ * @brief Conferir que os filtros em ladrilhos reproduzem a chamada na imagem inteira
+ */
+int runTilingVerification() {
+    // Textura aleatória suavizada (cristas sintéticas) com tamanho não múltiplo do ladrilho
+    cv::Mat gray(1037, 1291, CV_8UC1);
+    cv::randu(gray, 0, 256);
+    cv::GaussianBlur(gray, gray, cv::Size(0, 0), 2.0);
+    cv::Mat color;
+    cv::cvtColor(gray, color, cv::COLOR_GRAY2BGR);
+    
+    TileSchedulerConfig config;
+    config.tileSize = 128;
+    
+    cv::Mat sharpenKernel = (cv::Mat_<float>(3, 3) << 0, -1, 0, -1, 5, -1, 0, -1, 0);
+    cv::Mat backgroundKernel = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(51, 51));
+    
+    struct Check {
+        const char *name;
+        const cv::Mat &input;
+        int halo;
+        TileFilter filter;
+        int outputType;
+    };
+    const Check checks[] = {
+        {"gaussian 5x5", color, 2, [](const cv::Mat &src, cv::Mat &dst) {
+            cv::GaussianBlur(src, dst, cv::Size(5, 5), 1.5); }, -1},
+        {"gaussian sigma=3.2", gray, TileScheduler::gaussianRadius(3.2, CV_8U), [](const cv::Mat &src, cv::Mat &dst) {
+            cv::GaussianBlur(src, dst, cv::Size(0, 0), 3.2, 3.2); }, -1},
+        {"sharpen", color, 1, [sharpenKernel](const cv::Mat &src, cv::Mat &dst) {
+            cv::filter2D(src, dst, -1, sharpenKernel); }, -1},
+        {"threshold", gray, 0, [](const cv::Mat &src, cv::Mat &dst) {
+            cv::threshold(src, dst, 127, 255, cv::THRESH_BINARY); }, -1},
+        {"background", color, 50, [backgroundKernel](const cv::Mat &src, cv::Mat &dst) {
+            cv::Mat g;
+            cv::cvtColor(src, g, cv::COLOR_BGR2GRAY);
+            cv::Mat background;
+            cv::morphologyEx(g, background, cv::MORPH_CLOSE, backgroundKernel);
+            cv::subtract(background, g, dst); }, CV_8UC1},
+    };
+    
+    int failures = 0;
+    for (const auto &check : checks) {
+        bool ok = TileScheduler::verifyAgainstFullImage(check.input, check.halo, check.filter,
+                                                        check.outputType, config);
+        std::cout << (ok ? "OK    " : "FALHA ") << check.name << std::endl;
+        if (!ok) failures++;
+    }
+    
+    // Fechamento van Herk/Gil-Werman deve coincidir com o retangular do OpenCV
+    for (int size : {3, 51, 121}) {
+        cv::Mat reference;
+        cv::morphologyEx(gray, reference, cv::MORPH_CLOSE,
+                         cv::getStructuringElement(cv::MORPH_RECT, cv::Size(size, size)));
+        bool ok = cv::norm(reference, BackgroundEstimator::closeRect(gray, size), cv::NORM_INF) == 0;
+        std::cout << (ok ? "OK    " : "FALHA ") << "van Herk close " << size << "x" << size << std::endl;
+        if (!ok) failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Conferir que a extração de minúcias por tabela reproduz a varredura de referência
+ *
+ * Esqueletos sintéticos (cristas aleatórias afinadas) em tamanhos não múltiplos
+ * de 8 e da faixa paralela, mais casos degenerados; mostra também os tempos.
+ * É uma verificação de autoconsistência (otimização contra a versão pixel a
+ * pixel do mesmo classificador), não de exatidão contra minúcias anotadas.
+ */
+int runMinutiaeVerification() {
+    auto syntheticSkeleton = [](int rows, int cols, double sigma) {
+        cv::Mat noise(rows, cols, CV_8UC1);
+        cv::randu(noise, 0, 256);
+        cv::GaussianBlur(noise, noise, cv::Size(0, 0), sigma);
+        cv::Mat binary;
+        cv::threshold(noise, binary, 0, 255, cv::THRESH_BINARY | cv::THRESH_OTSU);
+        return Thinning::thin(binary);
+    };
+    
+    cv::Mat checkerboard(67, 93, CV_8UC1);
+    for (int y = 0; y < checkerboard.rows; ++y) {
+        for (int x = 0; x < checkerboard.cols; ++x) {
+            checkerboard.at<uchar>(y, x) = ((x + y) % 2) ? 255 : 0;
+        }
+    }
+    
+    const std::pair<const char*, cv::Mat> inputs[] = {
+        {"sintético 1037x1291", syntheticSkeleton(1037, 1291, 3.0)},
+        {"sintético 2500x2047", syntheticSkeleton(2500, 2047, 5.0)},
+        {"sintético 5x9", syntheticSkeleton(5, 9, 1.0)},
+        {"xadrez 67x93", checkerboard},
+        {"vazio 3x3", cv::Mat::zeros(3, 3, CV_8UC1)},
+        {"cheio 64x64", cv::Mat(64, 64, CV_8UC1, cv::Scalar(255))},
+    };
+    
+    fprintf(stdout, "Autoconsistência: extração por tabela contra a varredura pixel a pixel (não mede exatidão)\n");
+    int failures = 0;
+    for (const auto &input : inputs) {
+        CrossingNumberBenchmark b = CrossingNumber::benchmark(input.second);
+        bool ok = b.identical && CrossingNumber::verifyAgainstReference(input.second, 10);
+        fprintf(stdout, "%s %-22s %6d minúcias  referência %8.2f ms  tabela %8.2f ms\n",
+                ok ? "OK   " : "FALHA", input.first, b.minutiae, b.referenceMs, b.tableMs);
+        if (!ok) failures++;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+/**
+ * @brief Conferir as densidades pré-calculadas do modelo de LR contra as fórmulas diretas
+ */
+int runLRDensityVerification() {
+    double maxError = FingerprintEnhancer::LRDensityCheck::verifyAccuracy(true);
+    bool ok = maxError <= 1e-9;
+    fprintf(stdout, "%s densidades von Mises e Gaussiana  erro relativo máximo %.2e\n",
+            ok ? "OK   " : "FALHA", maxError);
+    return ok ? 0 : 1;
+}
+
+/**
+ * @brief Remover padrões periódicos de fundo de todas as imagens de um diretório
+ *
+ * Mesma detecção automática do diálogo de filtro FFT, sem interação.
+ */
+int runNotchBatch(const QString &inputDir, const QString &outputDir) {
+    QDir input(inputDir);
+    if (!input.exists()) {
+        std::cerr << "Diretório não encontrado: " << inputDir.toStdString() << std::endl;
+        return 1;
+    }
+    
+    QDir output(outputDir.isEmpty() ? input.absoluteFilePath("notch") : outputDir);
+    if (!output.exists() && !output.mkpath(".")) {
+        std::cerr << "Não foi possível criar " << output.absolutePath().toStdString() << std::endl;
+        return 1;
+    }
+    
+    const QStringList files = input.entryList(
+        {"*.png", "*.jpg", "*.jpeg", "*.tif", "*.tiff", "*.bmp"}, QDir::Files, QDir::Name);
+    
+    int failures = 0;
+    for (const QString &file : files) {
+        cv::Mat image = cv::imread(input.absoluteFilePath(file).toStdString(), cv::IMREAD_ANYCOLOR);
+        if (image.empty()) {
+            std::cerr << "Não foi possível abrir " << file.toStdString() << std::endl;
+            failures++;
+            continue;
+        }
+        
+        int notches = 0;
+        cv::Mat filtered = NotchDetector::removePeriodicBackground(image, NotchDetectorConfig(), &notches);
+        if (!cv::imwrite(output.absoluteFilePath(file).toStdString(), filtered)) {
+            std::cerr << "Falha ao salvar " << file.toStdString() << std::endl;
+            failures++;
+            continue;
+        }
+        std::cout << file.toStdString() << ": " << notches << " picos removidos" << std::endl;
+    }
+    
+    std::cout << files.size() - failures << "/" << files.size() << " imagens salvas em "
+              << output.absolutePath().toStdString() << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+
 /**
  * @brief Função principal da aplicação
  */
@@ -192,6 +434,12 @@ int main(int argc, char *argv[]) {
     QStringList arguments = app.arguments();
     QString projectFile;
     QString imageFile;
+    QString calibrationCorpus;
+    QString calibrationMethod = "kde";
+    QString calibrationOutput;
+    QString thinningBenchmarkImage;
+    QString notchBatchInput;
+    QString notchBatchOutput;
     
     for (int i = 1; i < arguments.size(); ++i) {
         const QString &arg = arguments.at(i);
@@ -202,6 +450,18 @@ int main(int argc, char *argv[]) {
                       << "  --help, -h          Show this help message\n"
                       << "  --version, -v       Show version information\n"
                       << "  --image <file>      Open image file directly\n"
+                      << "  --calibrate-lr <dir>          Build score-to-LR calibration from a labelled\n"
+                      << "                                minutiae corpus (JSON files) and exit\n"
+                      << "  --calibration-method kde|pav  Calibration method (default: kde)\n"
+                      << "  --calibration-output <file>   Output table (default: app data directory)\n"
+                      << "  --benchmark-thinning <image>  Time skeletonization methods and exit\n"
+                      << "  --verify-tiling               Check tiled and fast filters against reference output\n"
+                      << "  --verify-minutiae             Self-consistency check: table-driven minutiae extraction\n"
+                      << "                                against its per-pixel reference scan (not an accuracy test)\n"
+                      << "  --verify-lr-densities         Check precomputed LR model densities against direct formulas\n"
+                      << "  --batch-notch <dir>           Remove periodic backgrounds (automatic FFT notches)\n"
+                      << "                                from every image in <dir> and exit\n"
+                      << "  --batch-output <dir>          Output directory (default: <dir>/notch)\n"
                       << "\nArguments:\n"
                       << "  project_file        Open project file\n"
                       << std::endl;
@@ -215,11 +475,41 @@ int main(int argc, char *argv[]) {
             return 0;
         } else if (arg == "--image" && i + 1 < arguments.size()) {
             imageFile = arguments.at(++i);
+        } else if (arg == "--calibrate-lr" && i + 1 < arguments.size()) {
+            calibrationCorpus = arguments.at(++i);
+        } else if (arg == "--calibration-method" && i + 1 < arguments.size()) {
+            calibrationMethod = arguments.at(++i).toLower();
+        } else if (arg == "--calibration-output" && i + 1 < arguments.size()) {
+            calibrationOutput = arguments.at(++i);
+        } else if (arg == "--verify-tiling") {
+            return runTilingVerification();
+        } else if (arg == "--verify-minutiae") {
+            return runMinutiaeVerification();
+        } else if (arg == "--verify-lr-densities") {
+            return runLRDensityVerification();
+        } else if (arg == "--benchmark-thinning" && i + 1 < arguments.size()) {
+            thinningBenchmarkImage = arguments.at(++i);
+        } else if (arg == "--batch-notch" && i + 1 < arguments.size()) {
+            notchBatchInput = arguments.at(++i);
+        } else if (arg == "--batch-output" && i + 1 < arguments.size()) {
+            notchBatchOutput = arguments.at(++i);
         } else if (!arg.startsWith("--")) {
             projectFile = arg;
         }
     }
     
+    if (!calibrationCorpus.isEmpty()) {
+        return runScoreCalibration(calibrationCorpus, calibrationMethod, calibrationOutput);
+    }
+    
+    if (!thinningBenchmarkImage.isEmpty()) {
+        return runThinningBenchmark(thinningBenchmarkImage);
+    }
+    
+    if (!notchBatchInput.isEmpty()) {
+        return runNotchBatch(notchBatchInput, notchBatchOutput);
+    }
+    
     try {
         // Exibir splash screen
         SplashScreen splash;